@@ -77,6 +77,16 @@ bool Algorithm::hasIncrementalCreator(void) const
 	return false;
 	}
 
+bool Algorithm::hasPreviewCreator(void) const
+	{
+	return false;
+	}
+
+bool Algorithm::hasElementLoader(void) const
+	{
+	return false;
+	}
+
 GLMotif::Widget* Algorithm::createSettingsDialog(GLMotif::WidgetManager* widgetManager)
 	{
 	return 0;
@@ -108,6 +118,12 @@ Element* Algorithm::startElement(Parameters* extractParameters)
 	return 0;
 	}
 
+Element* Algorithm::startPreviewElement(Parameters* extractParameters)
+	{
+	/* Create a regular element by default: */
+	return startElement(extractParameters);
+	}
+
 bool Algorithm::continueElement(const Realtime::AlarmTimer& alarm)
 	{
 	Misc::throwStdErr("Algorithm: No incremental element creation methods defined");
@@ -119,6 +135,12 @@ void Algorithm::finishElement(void)
 	/* Just don't do anything */
 	}
 
+Element* Algorithm::loadElement(Parameters* extractParameters,IO::SeekableFile& geometryFile)
+	{
+	/* Signal that the geometry can not be loaded: */
+	return 0;
+	}
+
 void Algorithm::continueSlaveElement(void)
 	{
 	/* Just don't do anything */
@@ -36,6 +36,9 @@ class AlarmTimer;
 namespace Cluster {
 class MulticastPipe;
 }
+namespace IO {
+class SeekableFile;
+}
 namespace GLMotif {
 class WidgetManager;
 class Widget;
@@ -98,14 +101,18 @@ class Algorithm
 	virtual bool hasGlobalCreator(void) const; // Returns true if the algorithm has a global creation method
 	virtual bool hasSeededCreator(void) const; // Returns true if the algorithm has a seeded creation method
 	virtual bool hasIncrementalCreator(void) const; // Returns true if the algorithm has incremental creation methods
+	virtual bool hasPreviewCreator(void) const; // Returns true if the algorithm can create coarse previews of incrementally created elements
+	virtual bool hasElementLoader(void) const; // Returns true if the algorithm can restore visualization elements from previously saved geometry
 	virtual GLMotif::Widget* createSettingsDialog(GLMotif::WidgetManager* widgetManager); // Returns a new UI widget to change internal settings of the algorithm
 	virtual void readParameters(ParametersSource& source) =0; // Reads parameters from source and updates algorithm's internal state
 	virtual Parameters* cloneParameters(void) const =0; // Returns a copy of the algorithm's current extraction parameters
 	virtual void setSeedLocator(const DataSet::Locator* seedLocator); // Updates the algorithm's current extraction parameters according to the given seed locator
 	virtual Element* createElement(Parameters* extractParameters); // Creates a complete visualization element using the current extraction settings; inherits parameter object
 	virtual Element* startElement(Parameters* extractParameters); // Starts creating a visualization element using the current extraction settings; inherits parameter object
+	virtual Element* startPreviewElement(Parameters* extractParameters); // Starts creating a coarse preview of a visualization element, which is continued like a regular element; inherits parameter object
 	virtual bool continueElement(const Realtime::AlarmTimer& alarm); // Continues creating the current element; returns true if element is complete
 	virtual void finishElement(void); // Cleans up after an element has been created
+	virtual Element* loadElement(Parameters* extractParameters,IO::SeekableFile& geometryFile); // Creates a complete visualization element from geometry previously saved by Element::saveGeometry instead of extracting it; inherits parameter object on success; returns null without inheriting the parameter object or sending data to slaves if the saved geometry is invalid, and does not inherit the parameter object when throwing an exception
 	virtual Element* startSlaveElement(Parameters* extractParameters) =0; // Starts creating a visualization element on the slave node(s) of a cluster environment; inherits parameter object
 	virtual void continueSlaveElement(void); // Receives a fragment of a visualization element on the slave node(s) of a cluster environment
 	};
@@ -51,6 +51,11 @@ GLMotif::Widget* Element::createSettingsDialog(GLMotif::WidgetManager* widgetMan
 	return 0;
 	}
 
+bool Element::saveGeometry(IO::File& geometryFile) const
+	{
+	return false;
+	}
+
 }
 
 }
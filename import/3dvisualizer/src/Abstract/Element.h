@@ -33,6 +33,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace Misc {
 class File;
 }
+namespace IO {
+class File;
+}
 namespace GLMotif {
 class WidgetManager;
 class Widget;
@@ -77,10 +80,17 @@ class Element:public Threads::RefCounted
 		{
 		return parameters;
 		}
+	Parameters* releaseParameters(void) // Detaches the parameter object from the visualization element and returns it
+		{
+		Parameters* result=parameters;
+		parameters=0;
+		return result;
+		}
 	virtual std::string getName(void) const =0; // Returns a descriptive name for the visualization element
 	virtual size_t getSize(void) const =0; // Returns some size value for the visualization element to compare it to other elements of the same type (number of triangles, points, etc.)
 	virtual bool usesTransparency(void) const; // Returns true if the visualization element uses transparency (and needs to be rendered last)
 	virtual GLMotif::Widget* createSettingsDialog(GLMotif::WidgetManager* widgetManager); // Returns a new UI widget to change internal settings of the element
+	virtual bool saveGeometry(IO::File& geometryFile) const; // Writes the element's extracted geometry to the given file for later restoration by Algorithm::loadElement; returns false and writes nothing if the element does not support saving
 	virtual void glRenderAction(GLRenderState& renderState) const =0; // Renders a visualization element into the given OpenGL context
 	};
 
@@ -1,7 +1,7 @@
 /***********************************************************************
 EarthDataSet - Wrapper class to add an Earth renderer to an arbitrary
 visualization module working on whole-Earth grids.
-Copyright (c) 2007-2012 Oliver Kreylos
+Copyright (c) 2007-2014 Oliver Kreylos
 
 This file is part of the 3D Data Visualizer (Visualizer).
 
@@ -40,6 +40,7 @@ class CoordinateTransformer;
 namespace Concrete {
 class SphericalCoordinateTransformer;
 class PointSet;
+class LODPointSet;
 }
 }
 
@@ -105,6 +106,7 @@ class EarthDataSetRenderer:public DataSetRendererBaseParam // Data set renderer
 	EarthRenderer er; // An Earth renderer object
 	bool drawEarthModel; // Flag whether to draw the Earth model
 	std::vector<PointSet*> pointSets; // List of point sets to render with the Earth model
+	std::vector<LODPointSet*> lodPointSets; // List of out-of-core point sets to render with the Earth model
 	
 	/* Constructors and destructors: */
 	public:
@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageStack - Class to represent scalar-valued Cartesian data sets stored
 as stacks of color or greyscale images.
-Copyright (c) 2005-2011 Oliver Kreylos
+Copyright (c) 2005-2014 Oliver Kreylos
 
 This file is part of the 3D Data Visualizer (Visualizer).
 
@@ -26,6 +26,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <Misc/SizedTypes.h>
+#include <Misc/SelfDestructPointer.h>
+#include <Misc/SelfDestructArray.h>
 #include <Misc/ThrowStdErr.h>
 #include <Plugins/FactoryManager.h>
 #include <IO/OpenFile.h>
@@ -33,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Cluster/MulticastPipe.h>
 #include <Math/Math.h>
 #include <Images/RGBImage.h>
+#include <Images/ImageReader.h>
 #include <Images/ReadImageFile.h>
 
 namespace Visualization {
@@ -197,7 +201,7 @@ void sphereFilter(Misc::Array<unsigned char,3>& data,int sphereRadius,unsigned c
 						++numSamples;
 						}
 					}
-
+				
 				rms=Math::sqrt(rms/double(numSamples));
 				temp[data.calcLinearIndex(index)]=(unsigned char)Math::floor(rms+0.5);
 				}
@@ -217,6 +221,88 @@ void sphereFilter(Misc::Array<unsigned char,3>& data,int sphereRadius,unsigned c
 
 #endif
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Value convertGreyscaleValue(unsigned int value,unsigned int numValueBits) // Converts a pixel value of the given number of bits to the data set's 8-bit value type
+	{
+	if(numValueBits>=8U)
+		return Value(value>>(numValueBits-8U));
+	else
+		return Value((value*255U)/((1U<<numValueBits)-1U));
+	}
+
+template <class PixelParam>
+inline
+void
+copyGreyscaleSlice(
+	const PixelParam* image,
+	unsigned int imageWidth,
+	const int regionOrigin[2],
+	const DS::Index& numVertices,
+	unsigned int numValueBits,
+	Value* slicePtr)
+	{
+	/* Copy the image region into the data set slice, converting pixel values to the data set's value type: */
+	Value* vPtr=slicePtr;
+	for(int y=regionOrigin[1];y<regionOrigin[1]+numVertices[1];++y)
+		{
+		const PixelParam* iPtr=image+(size_t(y)*size_t(imageWidth)+size_t(regionOrigin[0]));
+		for(int x=0;x<numVertices[2];++x,++iPtr,++vPtr)
+			*vPtr=convertGreyscaleValue(*iPtr,numValueBits);
+		}
+	}
+
+void readGreyscaleSlice(Images::ImageReader& reader,const int regionOrigin[2],const DS::Index& numVertices,Value* slicePtr)
+	{
+	/* Get the image's layout before reading advances the reader to the next image: */
+	const Images::ImageReader::ImageSpec& spec=reader.getImageSpec();
+	unsigned int imageSize[2];
+	for(int i=0;i<2;++i)
+		imageSize[i]=spec.size[i];
+	unsigned int numFieldBits=spec.channelSpecs[0].numFieldBits;
+	unsigned int numValueBits=spec.channelSpecs[0].numValueBits;
+	
+	Images::ImageReader::ImagePlane plane;
+	if(numFieldBits==8&&imageSize[0]==(unsigned int)numVertices[2]&&imageSize[1]==(unsigned int)numVertices[1])
+		{
+		/* Read the image directly into the data set slice: */
+		plane.basePtr=slicePtr;
+		plane.pixelStride=sizeof(Value);
+		plane.rowStride=ptrdiff_t(numVertices[2])*sizeof(Value);
+		reader.readNative(&plane);
+		
+		/* Expand pixel values with fewer than 8 bits to the full value range: */
+		if(numValueBits<8)
+			{
+			Value* vPtr=slicePtr;
+			for(size_t i=size_t(numVertices[2])*size_t(numVertices[1]);i>0;--i,++vPtr)
+				*vPtr=convertGreyscaleValue(*vPtr,numValueBits);
+			}
+		}
+	else
+		{
+		/* Read the image into a temporary buffer: */
+		size_t fieldSize=reader.getChannelFieldSize(0);
+		Misc::SelfDestructArray<Misc::UInt8> buffer(size_t(imageSize[0])*size_t(imageSize[1])*fieldSize);
+		plane.basePtr=buffer.getArray();
+		plane.pixelStride=fieldSize;
+		plane.rowStride=ptrdiff_t(imageSize[0])*fieldSize;
+		reader.readNative(&plane);
+		
+		/* Copy the image region into the data set slice: */
+		if(numFieldBits==8)
+			copyGreyscaleSlice(buffer.getArray(),imageSize[0],regionOrigin,numVertices,numValueBits,slicePtr);
+		else
+			copyGreyscaleSlice(reinterpret_cast<const Misc::UInt16*>(buffer.getArray()),imageSize[0],regionOrigin,numVertices,numValueBits,slicePtr);
+		}
+	}
+
+}
+
 /***************************
 Methods of class ImageStack:
 ***************************/
@@ -329,21 +415,53 @@ Visualization::Abstract::DataSet* ImageStack::load(const std::vector<std::string
 		fullSliceFileName.append(sliceFileName);
 		fullSliceFileName=getFullPath(fullSliceFileName);
 		
-		/* Load the slice as an RGB image: */
-		Images::RGBImage slice=Images::readImageFile(fullSliceFileName.c_str(),openFile(fullSliceFileName,pipe));
+		/* Open the slice file: */
+		IO::FilePtr sliceFile=openFile(fullSliceFileName,pipe);
 		
-		/* Check if the slice conforms: */
-		if(slice.getSize(0)<(unsigned int)(regionOrigin[0]+numVertices[2])||slice.getSize(1)<(unsigned int)(regionOrigin[1]+numVertices[1]))
-			Misc::throwStdErr("ImageStack::load: Size of slice file \"%s\" does not match image stack size",fullSliceFileName.c_str());
-		
-		/* Convert the slice's pixels to greyscale and copy them into the data set: */
-		for(int y=regionOrigin[1];y<regionOrigin[1]+numVertices[1];++y)
-			for(int x=regionOrigin[0];x<regionOrigin[0]+numVertices[2];++x,++vertexPtr)
+		Images::RGBImage slice;
+		if(Images::canOpenImageReader(fullSliceFileName.c_str()))
+			{
+			/* Open an image reader to read the slice in its native pixel format: */
+			Misc::SelfDestructPointer<Images::ImageReader> reader(Images::openImageReader(fullSliceFileName.c_str(),sliceFile));
+			const Images::ImageReader::ImageSpec& spec=reader->getImageSpec();
+			
+			/* Check if the slice conforms: */
+			if(spec.size[0]<(unsigned int)(regionOrigin[0]+numVertices[2])||spec.size[1]<(unsigned int)(regionOrigin[1]+numVertices[1]))
+				Misc::throwStdErr("ImageStack::load: Size of slice file \"%s\" does not match image stack size",fullSliceFileName.c_str());
+			
+			if(spec.colorSpace==Images::ImageReader::Grayscale&&spec.numChannels==1&&spec.channelSpecs[0].valueType==Images::ImageReader::UnsignedInt&&(spec.channelSpecs[0].numFieldBits==8||spec.channelSpecs[0].numFieldBits==16))
+				{
+				/* Read the greyscale slice straight into the data set: */
+				readGreyscaleSlice(*reader,regionOrigin,numVertices,vertexPtr);
+				vertexPtr+=numVertices[1]*numVertices[2];
+				}
+			else
 				{
-				const Images::RGBImage::Color& pixel=slice.getPixel(x,y);
-				float value=float(pixel[0])*0.299f+float(pixel[1])*0.587+float(pixel[2])*0.114f;
-				*vertexPtr=(unsigned char)(Math::floor(value+0.5f));
+				/* Read the slice as an RGB image: */
+				slice=reader->readRGB8();
 				}
+			}
+		else
+			{
+			/* Load the slice as an RGB image: */
+			slice=Images::readImageFile(fullSliceFileName.c_str(),sliceFile);
+			}
+		
+		if(slice.isValid())
+			{
+			/* Check if the slice conforms: */
+			if(slice.getSize(0)<(unsigned int)(regionOrigin[0]+numVertices[2])||slice.getSize(1)<(unsigned int)(regionOrigin[1]+numVertices[1]))
+				Misc::throwStdErr("ImageStack::load: Size of slice file \"%s\" does not match image stack size",fullSliceFileName.c_str());
+			
+			/* Convert the slice's pixels to greyscale and copy them into the data set: */
+			for(int y=regionOrigin[1];y<regionOrigin[1]+numVertices[1];++y)
+				for(int x=regionOrigin[0];x<regionOrigin[0]+numVertices[2];++x,++vertexPtr)
+					{
+					const Images::RGBImage::Color& pixel=slice.getPixel(x,y);
+					float value=float(pixel[0])*0.299f+float(pixel[1])*0.587+float(pixel[2])*0.114f;
+					*vertexPtr=(unsigned char)(Math::floor(value+0.5f));
+					}
+			}
 		if(master)
 			std::cout<<"\b\b\b\b"<<std::setw(3)<<((i+1)*100)/numVertices[0]<<"%"<<std::flush;
 		}
@@ -0,0 +1,90 @@
+/***********************************************************************
+LODPointOctreeFile - Definitions describing the layout of out-of-core
+level-of-detail point octree files.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+/***********************************************************************
+An LOD point octree file is stored in little endian byte order, and
+consists of a fixed-size header, the point data of all nodes, and a node
+table:
+- Header:
+  - File tag (32 characters, not NUL-terminated)
+  - Number of nodes (UInt32)
+  - Maximum number of points per node (UInt32)
+  - Minimum corner of the cubic root domain (3 Float32)
+  - Edge length of the cubic root domain (Float32)
+  - File offset of the node table (UInt64)
+- Point data: Cartesian positions (3 Float32 each) of the points of
+  each node, in arbitrary node order
+- Node table: one record per node, with the root node at index 0:
+  - Index of the node's first child (UInt32), or 0 for leaf nodes; the
+    eight children of an interior node are stored consecutively in the
+    order of their octant index (x: bit 0, y: bit 1, z: bit 2)
+  - Number of points in the node (UInt32)
+  - File offset of the node's point data (UInt64)
+Leaf nodes contain all source points inside their domains; interior
+nodes contain a random subset of the points inside their domains to be
+rendered in place of their children at lower levels of detail.
+***********************************************************************/
+
+#ifndef VISUALIZATION_CONCRETE_LODPOINTOCTREEFILE_INCLUDED
+#define VISUALIZATION_CONCRETE_LODPOINTOCTREEFILE_INCLUDED
+
+#include <string.h>
+#include <Misc/SizedTypes.h>
+
+namespace Visualization {
+
+namespace Concrete {
+
+struct LODPointOctreeFile
+	{
+	/* Embedded classes: */
+	public:
+	struct NodeRecord // Structure for entries in the node table
+		{
+		/* Elements: */
+		public:
+		Misc::UInt32 firstChildIndex; // Index of the node's first child, or 0 for leaf nodes
+		Misc::UInt32 numPoints; // Number of points in the node
+		Misc::UInt64 pointOffset; // File offset of the node's point data
+		};
+	
+	/* Elements: */
+	static const size_t fileTagSize=32; // Length of the file tag
+	static const size_t headerSize=fileTagSize+2*sizeof(Misc::UInt32)+4*sizeof(Misc::Float32)+sizeof(Misc::UInt64); // Size of the file header
+	static const size_t pointSize=3*sizeof(Misc::Float32); // Size of a point in the point data
+	
+	/* Methods: */
+	static const char* getFileTag(void) // Returns the file tag identifying LOD point octree files
+		{
+		return "Visualizer LOD Point Octree v1.0";
+		}
+	static bool checkFileTag(const char fileTag[fileTagSize]) // Returns true if the given file tag identifies an LOD point octree file
+		{
+		return memcmp(fileTag,getFileTag(),fileTagSize)==0;
+		}
+	};
+
+}
+
+}
+
+#endif
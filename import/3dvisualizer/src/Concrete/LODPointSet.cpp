@@ -0,0 +1,427 @@
+/***********************************************************************
+LODPointSet - Class to render large sets of scattered 3D points from
+out-of-core level-of-detail point octree files, paging octree nodes from
+disk on demand.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Concrete/LODPointSet.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+#include <IO/OpenFile.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <GL/gl.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/GLFrustum.h>
+#include <Vrui/Vrui.h>
+
+#include <Concrete/LODPointOctreeFile.h>
+
+namespace Visualization {
+
+namespace Concrete {
+
+/*********************************************
+Static elements of class LODPointSet::LRUList:
+*********************************************/
+
+const unsigned int LODPointSet::LRUList::nil;
+
+/**************************************
+Methods of class LODPointSet::DataItem:
+**************************************/
+
+LODPointSet::DataItem::DataItem(unsigned int numNodes)
+	:hasVertexBufferObjectExtension(GLARBVertexBufferObject::isSupported()),
+	 nodeBufferIds(numNodes,0),nodeFrameIndices(numNodes,0),
+	 bufferLru(numNodes),bufferMemorySize(0),
+	 frameIndex(0),numFrameUploads(0)
+	{
+	/* Initialize the vertex buffer object extension: */
+	if(hasVertexBufferObjectExtension)
+		GLARBVertexBufferObject::initExtension();
+	}
+
+LODPointSet::DataItem::~DataItem(void)
+	{
+	/* Destroy all vertex buffer objects: */
+	for(std::vector<GLuint>::iterator nbIt=nodeBufferIds.begin();nbIt!=nodeBufferIds.end();++nbIt)
+		if(*nbIt!=0)
+			glDeleteBuffersARB(1,&*nbIt);
+	}
+
+/****************************
+Methods of class LODPointSet:
+****************************/
+
+void* LODPointSet::loaderThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next load request: */
+		unsigned int nodeIndex;
+		{
+		Threads::Mutex::Lock cacheLock(cacheMutex);
+		while(!shutdownLoader&&loadRequests.empty())
+			requestCond.wait(cacheMutex);
+		if(shutdownLoader)
+			break;
+		
+		/* Take the highest-priority request: */
+		nodeIndex=loadRequests.back().second;
+		loadRequests.pop_back();
+		if(nodes[nodeIndex].points!=0)
+			continue;
+		}
+		
+		try
+			{
+			/* Load the node and have it rendered: */
+			loadNode(nodeIndex);
+			Vrui::requestUpdate();
+			}
+		catch(std::runtime_error err)
+			{
+			std::cerr<<"LODPointSet: Stopping node loader due to exception "<<err.what()<<std::endl;
+			break;
+			}
+		}
+	
+	return 0;
+	}
+
+void LODPointSet::loadNode(unsigned int nodeIndex)
+	{
+	Node& node=nodes[nodeIndex];
+	
+	/* Read the node's points: */
+	Vertex* points=new Vertex[node.numPoints];
+	try
+		{
+		octreeFile->setReadPosAbs(node.pointOffset);
+		for(unsigned int i=0;i<node.numPoints;++i)
+			octreeFile->read(points[i].position.getXyzw(),3);
+		}
+	catch(...)
+		{
+		delete[] points;
+		throw;
+		}
+	
+	/* Add the node to the cache: */
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	node.points=points;
+	cacheMemorySize+=size_t(node.numPoints)*sizeof(Vertex);
+	if(nodeIndex!=0)
+		{
+		/* Mark the node as most recently used; the root node stays in memory permanently: */
+		cacheLru.touch(nodeIndex);
+		}
+	
+	/* Evict least recently used nodes until the cache fits into its budget again: */
+	while(cacheMemorySize>memoryBudget&&!cacheLru.empty()&&cacheLru.getTail()!=nodeIndex)
+		{
+		unsigned int evictIndex=cacheLru.getTail();
+		cacheLru.remove(evictIndex);
+		delete[] nodes[evictIndex].points;
+		nodes[evictIndex].points=0;
+		cacheMemorySize-=size_t(nodes[evictIndex].numPoints)*sizeof(Vertex);
+		}
+	}
+
+bool LODPointSet::prepareNode(unsigned int nodeIndex,LODPointSet::DataItem* dataItem) const
+	{
+	const Node& node=nodes[nodeIndex];
+	
+	/* Empty nodes are always ready: */
+	if(node.numPoints==0)
+		return true;
+	
+	if(dataItem->hasVertexBufferObjectExtension)
+		{
+		if(dataItem->nodeBufferIds[nodeIndex]==0)
+			{
+			/* Bail out if the node is not in memory, or the upload limit for this frame has been reached: */
+			if(node.points==0||dataItem->numFrameUploads>=maxFrameUploads)
+				return false;
+			
+			/* Upload the node's points into a new vertex buffer object: */
+			glGenBuffersARB(1,&dataItem->nodeBufferIds[nodeIndex]);
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->nodeBufferIds[nodeIndex]);
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,node.numPoints*sizeof(Vertex),node.points,GL_STATIC_DRAW_ARB);
+			dataItem->bufferMemorySize+=size_t(node.numPoints)*sizeof(Vertex);
+			++dataItem->numFrameUploads;
+			}
+		
+		/* Mark the node's vertex buffer object as most recently used: */
+		dataItem->bufferLru.touch(nodeIndex);
+		dataItem->nodeFrameIndices[nodeIndex]=dataItem->frameIndex;
+		}
+	else
+		{
+		/* Bail out if the node is not in memory: */
+		if(node.points==0)
+			return false;
+		}
+	
+	/* Mark the node as most recently used if it is held in memory; the root node stays in memory permanently: */
+	if(nodeIndex!=0&&node.points!=0)
+		cacheLru.touch(nodeIndex);
+	
+	return true;
+	}
+
+void LODPointSet::renderNode(unsigned int nodeIndex,LODPointSet::DataItem* dataItem) const
+	{
+	const Node& node=nodes[nodeIndex];
+	if(node.numPoints==0)
+		return;
+	
+	if(dataItem->hasVertexBufferObjectExtension)
+		{
+		/* Render the node from its vertex buffer object: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->nodeBufferIds[nodeIndex]);
+		glVertexPointer(static_cast<const Vertex*>(0));
+		}
+	else
+		{
+		/* Render the node from memory: */
+		glVertexPointer(node.points);
+		}
+	glDrawArrays(GL_POINTS,0,node.numPoints);
+	}
+
+void LODPointSet::renderSubtree(unsigned int nodeIndex,const LODPointSet::Frustum& frustum,LODPointSet::DataItem* dataItem,std::vector<LODPointSet::LoadRequest>& requests) const
+	{
+	const Node& node=nodes[nodeIndex];
+	
+	if(node.firstChildIndex!=0)
+		{
+		/* Calculate the projected distance between neighboring points in the node in pixels: */
+		Scalar projectedRadius=frustum.calcProjectedRadius(node.center,node.radius);
+		Scalar pointDistance=node.numPoints>0?Scalar(2)*projectedRadius/Math::sqrt(Scalar(node.numPoints)):Scalar(0);
+		
+		/* Refine the node if its points are too far apart, or if it is too close to the eye to estimate their distance: */
+		if(projectedRadius<Scalar(0)||pointDistance>detailThreshold)
+			{
+			/* Check whether all visible children are ready for rendering, and request the ones that are not: */
+			bool childrenReady=true;
+			for(unsigned int childIndex=node.firstChildIndex;childIndex<node.firstChildIndex+8;++childIndex)
+				{
+				const Node& child=nodes[childIndex];
+				if(frustum.doesSphereIntersect(child.center,child.radius)&&!prepareNode(childIndex,dataItem))
+					{
+					childrenReady=false;
+					if(child.points==0)
+						requests.push_back(LoadRequest(projectedRadius<Scalar(0)?Math::Constants<Scalar>::max:pointDistance,childIndex));
+					}
+				}
+			
+			if(childrenReady)
+				{
+				/* Render the visible children instead of the node: */
+				for(unsigned int childIndex=node.firstChildIndex;childIndex<node.firstChildIndex+8;++childIndex)
+					{
+					const Node& child=nodes[childIndex];
+					if(frustum.doesSphereIntersect(child.center,child.radius))
+						renderSubtree(childIndex,frustum,dataItem,requests);
+					}
+				return;
+				}
+			}
+		}
+	
+	/* Render the node itself: */
+	renderNode(nodeIndex,dataItem);
+	}
+
+LODPointSet::LODPointSet(const char* octreeFileName,size_t sMemoryBudget)
+	:octreeFile(IO::openSeekableFile(octreeFileName)),
+	 totalNumPoints(0),
+	 detailThreshold(2.0f),
+	 memoryBudget(sMemoryBudget*1024*1024),
+	 bufferMemoryBudget(size_t(256)*1024*1024),
+	 maxFrameUploads(16),
+	 cacheMemorySize(0),
+	 shutdownLoader(false)
+	{
+	typedef LODPointOctreeFile OctreeFile;
+	
+	/* Read the octree file's header: */
+	octreeFile->setEndianness(Misc::LittleEndian);
+	char fileTag[OctreeFile::fileTagSize];
+	octreeFile->read(fileTag,OctreeFile::fileTagSize);
+	if(!OctreeFile::checkFileTag(fileTag))
+		Misc::throwStdErr("LODPointSet::LODPointSet: File \"%s\" is not an LOD point octree file",octreeFileName);
+	unsigned int numNodes=octreeFile->read<Misc::UInt32>();
+	octreeFile->read<Misc::UInt32>(); // Maximum number of points per node is not needed
+	Misc::Float32 domainMin[3];
+	octreeFile->read(domainMin,3);
+	Misc::Float32 domainSize=octreeFile->read<Misc::Float32>();
+	IO::SeekableFile::Offset nodeTableOffset=IO::SeekableFile::Offset(octreeFile->read<Misc::UInt64>());
+	if(numNodes==0)
+		Misc::throwStdErr("LODPointSet::LODPointSet: Octree file \"%s\" is empty",octreeFileName);
+	
+	/* Read the node table: */
+	octreeFile->setReadPosAbs(nodeTableOffset);
+	nodes.resize(numNodes);
+	for(unsigned int i=0;i<numNodes;++i)
+		{
+		Node& node=nodes[i];
+		node.firstChildIndex=octreeFile->read<Misc::UInt32>();
+		node.numPoints=octreeFile->read<Misc::UInt32>();
+		node.pointOffset=IO::SeekableFile::Offset(octreeFile->read<Misc::UInt64>());
+		node.points=0;
+		if(node.firstChildIndex!=0&&(node.firstChildIndex<=i||node.firstChildIndex+8>numNodes))
+			Misc::throwStdErr("LODPointSet::LODPointSet: Corrupted node table in octree file \"%s\"",octreeFileName);
+		if(node.firstChildIndex==0)
+			totalNumPoints+=node.numPoints;
+		}
+	
+	/* Calculate the nodes' domains; children always follow their parents in the node table: */
+	std::vector<Scalar> halfSizes(numNodes);
+	halfSizes[0]=Scalar(domainSize)*Scalar(0.5);
+	for(int i=0;i<3;++i)
+		nodes[0].center[i]=Scalar(domainMin[i])+halfSizes[0];
+	for(unsigned int nodeIndex=0;nodeIndex<numNodes;++nodeIndex)
+		{
+		Node& node=nodes[nodeIndex];
+		node.radius=halfSizes[nodeIndex]*Math::sqrt(Scalar(3));
+		if(node.firstChildIndex!=0)
+			{
+			Scalar childHalfSize=halfSizes[nodeIndex]*Scalar(0.5);
+			for(int childIndex=0;childIndex<8;++childIndex)
+				{
+				unsigned int ci=node.firstChildIndex+childIndex;
+				halfSizes[ci]=childHalfSize;
+				for(int i=0;i<3;++i)
+					nodes[ci].center[i]=childIndex&(0x1<<i)?node.center[i]+childHalfSize:node.center[i]-childHalfSize;
+				}
+			}
+		}
+	
+	/* Load the root node, which stays in memory permanently: */
+	cacheLru.reset(numNodes);
+	if(nodes[0].numPoints>0)
+		loadNode(0);
+	
+	/* Start the background loader: */
+	loaderThread.start(this,&LODPointSet::loaderThreadMethod);
+	
+	std::cout<<totalNumPoints<<" points in "<<numNodes<<" octree nodes opened from "<<octreeFileName<<std::endl;
+	}
+
+LODPointSet::~LODPointSet(void)
+	{
+	/* Shut down the background loader: */
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	shutdownLoader=true;
+	requestCond.signal();
+	}
+	loaderThread.join();
+	
+	/* Release all cached nodes: */
+	for(std::vector<Node>::iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+		delete[] nIt->points;
+	}
+
+void LODPointSet::initContext(GLContextData& contextData) const
+	{
+	/* Create a context data item and store it in the context; nodes are uploaded on demand: */
+	DataItem* dataItem=new DataItem(nodes.size());
+	contextData.addDataItem(this,dataItem);
+	}
+
+void LODPointSet::setDetailThreshold(LODPointSet::Scalar newDetailThreshold)
+	{
+	detailThreshold=newDetailThreshold;
+	}
+
+void LODPointSet::setBufferMemoryBudget(size_t newBufferMemoryBudget)
+	{
+	bufferMemoryBudget=newBufferMemoryBudget*1024*1024;
+	}
+
+void LODPointSet::setMaxFrameUploads(unsigned int newMaxFrameUploads)
+	{
+	maxFrameUploads=newMaxFrameUploads;
+	}
+
+void LODPointSet::glRenderAction(GLContextData& contextData) const
+	{
+	/* Get a pointer to the data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Start a new rendering frame: */
+	++dataItem->frameIndex;
+	dataItem->numFrameUploads=0;
+	
+	/* Get the current view frustum in model coordinates: */
+	Frustum frustum;
+	frustum.setFromGL();
+	
+	GLVertexArrayParts::enable(Vertex::getPartsMask());
+	
+	/* Render the octree's cut at the appropriate level of detail, and collect nodes that should be loaded: */
+	std::vector<LoadRequest> requests;
+	{
+	Threads::Mutex::Lock cacheLock(cacheMutex);
+	if(frustum.doesSphereIntersect(nodes[0].center,nodes[0].radius)&&prepareNode(0,dataItem))
+		renderSubtree(0,frustum,dataItem,requests);
+	
+	/* Replace the loader's request list with this frame's requests, in order of increasing priority: */
+	std::sort(requests.begin(),requests.end());
+	loadRequests.swap(requests);
+	if(!loadRequests.empty())
+		requestCond.signal();
+	}
+	
+	if(dataItem->hasVertexBufferObjectExtension)
+		{
+		/* Protect the vertex buffer objects: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+		
+		/* Release the least recently used vertex buffer objects that were not rendered in this frame until the buffers fit into their budget again: */
+		while(dataItem->bufferMemorySize>bufferMemoryBudget&&!dataItem->bufferLru.empty())
+			{
+			unsigned int evictIndex=dataItem->bufferLru.getTail();
+			if(dataItem->nodeFrameIndices[evictIndex]==dataItem->frameIndex)
+				break;
+			dataItem->bufferLru.remove(evictIndex);
+			glDeleteBuffersARB(1,&dataItem->nodeBufferIds[evictIndex]);
+			dataItem->nodeBufferIds[evictIndex]=0;
+			dataItem->bufferMemorySize-=size_t(nodes[evictIndex].numPoints)*sizeof(Vertex);
+			}
+		}
+	
+	/* Restore OpenGL state: */
+	GLVertexArrayParts::disable(Vertex::getPartsMask());
+	}
+
+}
+
+}
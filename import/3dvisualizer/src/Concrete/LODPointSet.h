@@ -0,0 +1,205 @@
+/***********************************************************************
+LODPointSet - Class to render large sets of scattered 3D points from
+out-of-core level-of-detail point octree files, paging octree nodes from
+disk on demand.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_CONCRETE_LODPOINTSET_INCLUDED
+#define VISUALIZATION_CONCRETE_LODPOINTSET_INCLUDED
+
+#include <stddef.h>
+#include <utility>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/Thread.h>
+#include <IO/SeekableFile.h>
+#include <Geometry/Point.h>
+#include <GL/gl.h>
+#define GLVERTEX_NONSTANDARD_TEMPLATES
+#include <GL/GLVertex.h>
+#include <GL/GLObject.h>
+
+/* Forward declarations: */
+template <class ScalarParam>
+class GLFrustum;
+
+namespace Visualization {
+
+namespace Concrete {
+
+class LODPointSet:public GLObject
+	{
+	/* Embedded classes: */
+	private:
+	typedef float Scalar; // Scalar type for point coordinates
+	typedef Geometry::Point<Scalar,3> Point; // Type for points
+	typedef GLVertex<void,0,void,0,void,GLfloat,3> Vertex; // Vertex type for points (position only)
+	typedef GLFrustum<Scalar> Frustum; // Type for view frustums
+	
+	class LRUList // Class for doubly-linked lists of node indices in least-recently used order
+		{
+		/* Elements: */
+		private:
+		static const unsigned int nil=~0U; // Index terminating the list
+		std::vector<unsigned int> pred,succ; // Predecessor and successor of each node in the list, or nil; both are nil for nodes not in the list
+		unsigned int head,tail; // Most and least recently used nodes, or nil if the list is empty
+		
+		/* Constructors and destructors: */
+		public:
+		LRUList(unsigned int numNodes =0) // Creates an empty list for the given number of nodes
+			:pred(numNodes,nil),succ(numNodes,nil),
+			 head(nil),tail(nil)
+			{
+			}
+		
+		/* Methods: */
+		void reset(unsigned int numNodes) // Empties the list and resizes it for the given number of nodes
+			{
+			pred.assign(numNodes,nil);
+			succ.assign(numNodes,nil);
+			head=tail=nil;
+			}
+		bool contains(unsigned int nodeIndex) const // Returns true if the given node is in the list
+			{
+			return head==nodeIndex||pred[nodeIndex]!=nil;
+			}
+		bool empty(void) const // Returns true if the list is empty
+			{
+			return head==nil;
+			}
+		unsigned int getTail(void) const // Returns the least recently used node; list must not be empty
+			{
+			return tail;
+			}
+		void remove(unsigned int nodeIndex) // Removes the given node from the list; node must be in the list
+			{
+			if(pred[nodeIndex]!=nil)
+				succ[pred[nodeIndex]]=succ[nodeIndex];
+			else
+				head=succ[nodeIndex];
+			if(succ[nodeIndex]!=nil)
+				pred[succ[nodeIndex]]=pred[nodeIndex];
+			else
+				tail=pred[nodeIndex];
+			pred[nodeIndex]=nil;
+			succ[nodeIndex]=nil;
+			}
+		void touch(unsigned int nodeIndex) // Moves the given node to the front of the list, or adds it if it is not in the list
+			{
+			if(head==nodeIndex)
+				return;
+			if(contains(nodeIndex))
+				remove(nodeIndex);
+			succ[nodeIndex]=head;
+			if(head!=nil)
+				pred[head]=nodeIndex;
+			else
+				tail=nodeIndex;
+			head=nodeIndex;
+			}
+		};
+	
+	struct Node // Structure for octree nodes
+		{
+		/* Elements: */
+		public:
+		unsigned int firstChildIndex; // Index of the node's first child, or 0 for leaf nodes
+		unsigned int numPoints; // Number of points in the node
+		IO::SeekableFile::Offset pointOffset; // Offset of the node's point data in the octree file
+		Point center; // Center of the node's domain
+		Scalar radius; // Radius of the node's domain's bounding sphere
+		Vertex* points; // Node's points if they are loaded into memory, or 0
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		bool hasVertexBufferObjectExtension; // Flag whether the vertex buffer object extension is supported
+		std::vector<GLuint> nodeBufferIds; // IDs of vertex buffer objects containing each node's points, or 0 for nodes that are not uploaded
+		std::vector<unsigned int> nodeFrameIndices; // Index of the most recent frame in which each node was rendered
+		LRUList bufferLru; // List of uploaded nodes in least-recently used order
+		size_t bufferMemorySize; // Total size of all uploaded nodes in bytes
+		unsigned int frameIndex; // Index of the current rendering frame
+		unsigned int numFrameUploads; // Number of nodes uploaded during the current rendering frame
+		
+		/* Constructors and destructors: */
+		DataItem(unsigned int numNodes); // Creates a data item for an octree of the given number of nodes
+		virtual ~DataItem(void); // Destroys a data item
+		};
+	
+	typedef std::pair<Scalar,unsigned int> LoadRequest; // Type for node load requests; priority first, node index second
+	
+	/* Elements: */
+	IO::SeekableFilePtr octreeFile; // The octree file; only accessed by the loader thread after construction
+	std::vector<Node> nodes; // The octree's nodes, root at index 0
+	size_t totalNumPoints; // Total number of points in the octree's leaf nodes
+	Scalar detailThreshold; // Projected distance between neighboring points in pixels above which a node is refined
+	size_t memoryBudget; // Maximum total size of nodes held in memory in bytes
+	size_t bufferMemoryBudget; // Maximum total size of nodes uploaded to vertex buffer objects in each OpenGL context in bytes
+	unsigned int maxFrameUploads; // Maximum number of nodes uploaded to an OpenGL context during a single frame
+	mutable Threads::Mutex cacheMutex; // Mutex serializing access to the node cache and the request list
+	mutable Threads::Cond requestCond; // Condition variable to wake up the loader thread when new nodes are requested
+	mutable LRUList cacheLru; // List of nodes held in memory in least-recently used order
+	size_t cacheMemorySize; // Total size of nodes held in memory in bytes
+	mutable std::vector<LoadRequest> loadRequests; // List of nodes to be loaded, in order of increasing priority
+	bool shutdownLoader; // Flag to tell the loader thread to terminate
+	Threads::Thread loaderThread; // Thread loading requested nodes from the octree file
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Method loading requested nodes in the background
+	void loadNode(unsigned int nodeIndex); // Reads the given node's points from the octree file; must be called with the cache mutex unlocked
+	bool prepareNode(unsigned int nodeIndex,DataItem* dataItem) const; // Makes the given node ready for rendering in the current OpenGL context; returns false if the node is not available yet; must be called with the cache mutex locked
+	void renderNode(unsigned int nodeIndex,DataItem* dataItem) const; // Renders the given prepared node
+	void renderSubtree(unsigned int nodeIndex,const Frustum& frustum,DataItem* dataItem,std::vector<LoadRequest>& requests) const; // Renders the given visible and prepared node or its children, depending on the node's projected point density
+	
+	/* Constructors and destructors: */
+	public:
+	LODPointSet(const char* octreeFileName,size_t sMemoryBudget =512); // Opens an LOD point octree file and starts the background loader with the given memory budget in MB
+	private:
+	LODPointSet(const LODPointSet& source); // Prohibit copy constructor
+	LODPointSet& operator=(const LODPointSet& source); // Prohibit assignment operator
+	public:
+	virtual ~LODPointSet(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	size_t getTotalNumPoints(void) const // Returns the total number of points in the point set
+		{
+		return totalNumPoints;
+		}
+	Scalar getDetailThreshold(void) const // Returns the projected point distance above which nodes are refined
+		{
+		return detailThreshold;
+		}
+	void setDetailThreshold(Scalar newDetailThreshold); // Sets the projected point distance in pixels above which nodes are refined
+	void setBufferMemoryBudget(size_t newBufferMemoryBudget); // Sets the per-context vertex buffer memory budget in MB
+	void setMaxFrameUploads(unsigned int newMaxFrameUploads); // Sets the maximum number of nodes uploaded per frame
+	void glRenderAction(GLContextData& contextData) const; // Renders the point set into the current OpenGL context at a level of detail appropriate for the current view
+	};
+
+}
+
+}
+
+#endif
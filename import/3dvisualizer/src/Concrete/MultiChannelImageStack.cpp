@@ -2,7 +2,7 @@
 MultiChannelImageStack - Class to represent multivariate scalaar-valued
 Cartesian data sets stored as multiple matching stacks of color or
 greyscale images.
-Copyright (c) 2009-2011 Oliver Kreylos
+Copyright (c) 2009-2014 Oliver Kreylos
 
 This file is part of the 3D Data Visualizer (Visualizer).
 
@@ -29,16 +29,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <iostream>
 #include <iomanip>
-#ifdef IMAGES_CONFIG_HAVE_TIFF
-#include <tiffio.h>
-#endif
+#include <Misc/SizedTypes.h>
 #include <Misc/SelfDestructPointer.h>
+#include <Misc/SelfDestructArray.h>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/Timer.h>
-#include <Misc/FileNameExtensions.h>
 #include <Plugins/FactoryManager.h>
 #include <Math/Math.h>
 #include <Images/RGBImage.h>
+#include <Images/ImageReader.h>
 #include <Images/ReadImageFile.h>
 
 namespace Visualization {
@@ -92,96 +91,112 @@ struct StackDescriptor
 Helper functions:
 ****************/
 
-#ifdef IMAGES_HAVE_TIFF
-
 template <class PixelParam>
 inline
 void
-convertGreyscaleTiffImage(
+copyGreyscaleImage(
 	StackDescriptor& sd,
 	Value* slicePtr,
-	TIFF* image,
+	const PixelParam* image,
+	unsigned int imageWidth,
 	int offset)
 	{
-	/* Read and convert the image row by row: */
-	uint32 width;
-	TIFFGetField(image,TIFFTAG_IMAGEWIDTH,&width);
-	PixelParam* rowBuffer=new PixelParam[width];
-	
 	/* Copy the image's pixels into the data set: */
 	Value* rowPtr=slicePtr;
 	for(int y=sd.regionOrigin[1];y<sd.regionOrigin[1]+sd.numVertices[1];++y,rowPtr+=sd.dataSet.getVertexStride(1))
 		{
-		/* Read the pixel row: */
-		TIFFReadScanline(image,rowBuffer,y);
-		
+		const PixelParam* iPtr=image+(size_t(y)*size_t(imageWidth)+size_t(sd.regionOrigin[0]));
 		Value* vPtr=rowPtr;
-		for(int x=sd.regionOrigin[0];x<sd.regionOrigin[0]+sd.numVertices[0];++x,vPtr+=sd.dataSet.getVertexStride(0))
-			*vPtr=Value(int(rowBuffer[x])+offset);
+		for(int x=sd.regionOrigin[0];x<sd.regionOrigin[0]+sd.numVertices[0];++x,++iPtr,vPtr+=sd.dataSet.getVertexStride(0))
+			*vPtr=Value(int(*iPtr)+offset);
 		}
-	
-	delete[] rowBuffer;
 	}
 
-void loadGreyscaleTiffImage(StackDescriptor& sd,Value* slicePtr,const char* imageFileName)
+bool loadNativeGreyscaleImage(StackDescriptor& sd,Value* slicePtr,Images::ImageReader& reader,const char* imageFileName)
 	{
-	/* Open the TIFF image: */
-	TIFF* image=TIFFOpen(imageFileName,"r");
-	if(image==0)
-		Misc::throwStdErr("MultiChannelImageStack::load: Unable to open image file %s",imageFileName);
-	
-	/* Get the image size and type: */
-	uint32 size[2];
-	uint16 numBits,numSamples,sampleFormat;
-	TIFFGetField(image,TIFFTAG_IMAGEWIDTH,&size[0]);
-	TIFFGetField(image,TIFFTAG_IMAGELENGTH,&size[1]);
-	TIFFGetField(image,TIFFTAG_BITSPERSAMPLE,&numBits);
-	TIFFGetField(image,TIFFTAG_SAMPLESPERPIXEL,&numSamples);
-	TIFFGetField(image,TIFFTAG_SAMPLEFORMAT,&sampleFormat);
+	/* Check if the image is a greyscale image with 8-bit or 16-bit integer pixels: */
+	const Images::ImageReader::ImageSpec& spec=reader.getImageSpec();
+	if(spec.colorSpace!=Images::ImageReader::Grayscale||spec.numChannels!=1)
+		return false;
+	Images::ImageReader::ChannelValueType valueType=spec.channelSpecs[0].valueType;
+	unsigned int numFieldBits=spec.channelSpecs[0].numFieldBits;
+	unsigned int numValueBits=spec.channelSpecs[0].numValueBits;
+	if((valueType!=Images::ImageReader::UnsignedInt&&valueType!=Images::ImageReader::SignedInt)||(numFieldBits!=8&&numFieldBits!=16))
+		return false;
 	
 	/* Check if the image conforms: */
-	if(numSamples!=1)
-		{
-		TIFFClose(image);
-		Misc::throwStdErr("MultiChannelImageStack::load: Image file %s is not a greyscale image",imageFileName);
-		}
-	if(size[0]<(unsigned int)(sd.regionOrigin[0]+sd.numVertices[0])||size[1]<(unsigned int)(sd.regionOrigin[1]+sd.numVertices[1]))
-		{
-		TIFFClose(image);
+	unsigned int imageSize[2];
+	for(int i=0;i<2;++i)
+		imageSize[i]=spec.size[i];
+	if(imageSize[0]<(unsigned int)(sd.regionOrigin[0]+sd.numVertices[0])||imageSize[1]<(unsigned int)(sd.regionOrigin[1]+sd.numVertices[1]))
 		Misc::throwStdErr("MultiChannelImageStack::load: Size of image file \"%s\" does not match image stack size",imageFileName);
-		}
 	
-	/* Load the image based on its pixel format: */
-	if(numBits==16)
+	Images::ImageReader::ImagePlane plane;
+	if(valueType==Images::ImageReader::UnsignedInt&&numFieldBits==16&&imageSize[0]==(unsigned int)sd.numVertices[0]&&imageSize[1]==(unsigned int)sd.numVertices[1])
 		{
-		if(sampleFormat==SAMPLEFORMAT_INT)
-			convertGreyscaleTiffImage<signed short int>(sd,slicePtr,image,32768);
-		else
-			convertGreyscaleTiffImage<unsigned short int>(sd,slicePtr,image,0);
-		}
-	else if(numBits==8)
-		{
-		if(sampleFormat==SAMPLEFORMAT_INT)
-			convertGreyscaleTiffImage<signed char>(sd,slicePtr,image,128);
-		else
-			convertGreyscaleTiffImage<unsigned char>(sd,slicePtr,image,0);
+		/* Read the image directly into the data set: */
+		plane.basePtr=slicePtr;
+		plane.pixelStride=sd.dataSet.getVertexStride(0)*sizeof(Value);
+		plane.rowStride=sd.dataSet.getVertexStride(1)*sizeof(Value);
+		reader.readNative(&plane);
 		}
 	else
 		{
-		TIFFClose(image);
-		Misc::throwStdErr("MultiChannelImageStack::load: Image file \"%s\" has an unsupported pixel format",imageFileName);
+		/* Read the image into a temporary buffer: */
+		size_t fieldSize=numFieldBits/8;
+		Misc::SelfDestructArray<Misc::UInt8> buffer(size_t(imageSize[0])*size_t(imageSize[1])*fieldSize);
+		plane.basePtr=buffer.getArray();
+		plane.pixelStride=fieldSize;
+		plane.rowStride=ptrdiff_t(imageSize[0])*fieldSize;
+		reader.readNative(&plane);
+		
+		/* Convert the image's pixels and copy them into the data set: */
+		if(numFieldBits==16)
+			{
+			if(valueType==Images::ImageReader::SignedInt)
+				copyGreyscaleImage(sd,slicePtr,reinterpret_cast<const Misc::SInt16*>(buffer.getArray()),imageSize[0],32768);
+			else
+				copyGreyscaleImage(sd,slicePtr,reinterpret_cast<const Misc::UInt16*>(buffer.getArray()),imageSize[0],0);
+			}
+		else
+			{
+			if(valueType==Images::ImageReader::SignedInt)
+				copyGreyscaleImage(sd,slicePtr,reinterpret_cast<const Misc::SInt8*>(buffer.getArray()),imageSize[0],128);
+			else
+				{
+				/* Expand pixel values with fewer than 8 bits to the full 8-bit value range: */
+				if(numValueBits<8)
+					{
+					Misc::UInt8* bPtr=buffer.getArray();
+					for(size_t i=size_t(imageSize[0])*size_t(imageSize[1]);i>0;--i,++bPtr)
+						*bPtr=Misc::UInt8((unsigned int)(*bPtr)*255U/((1U<<numValueBits)-1U));
+					}
+				copyGreyscaleImage(sd,slicePtr,buffer.getArray(),imageSize[0],0);
+				}
+			}
 		}
 	
-	/* Close the TIFF image: */
-	TIFFClose(image);
+	return true;
 	}
 
-#endif
-
 void loadGreyscaleImage(StackDescriptor& sd,Value* slicePtr,const char* imageFileName)
 	{
-	/* Load the image as an RGB image: */
-	Images::RGBImage image=Images::readImageFile(imageFileName);
+	Images::RGBImage image;
+	if(Images::canOpenImageReader(imageFileName))
+		{
+		/* Try reading the image in its native pixel format: */
+		Misc::SelfDestructPointer<Images::ImageReader> reader(Images::openImageReader(imageFileName));
+		if(loadNativeGreyscaleImage(sd,slicePtr,*reader,imageFileName))
+			return;
+		
+		/* Read the image as an RGB image: */
+		image=reader->readRGB8();
+		}
+	else
+		{
+		/* Load the image as an RGB image: */
+		image=Images::readImageFile(imageFileName);
+		}
 	
 	/* Check if the image conforms: */
 	if(image.getSize(0)<(unsigned int)(sd.regionOrigin[0]+sd.numVertices[0])||image.getSize(1)<(unsigned int)(sd.regionOrigin[1]+sd.numVertices[1]))
@@ -203,12 +218,6 @@ void loadGreyscaleImage(StackDescriptor& sd,Value* slicePtr,const char* imageFil
 
 void loadGreyscaleImageStack(StackDescriptor& sd,int newSliceIndex,const char* imageFileNameTemplate)
 	{
-	#ifdef IMAGES_HAVE_TIFF
-	/* Check if the image file name template matches TIFF images: */
-	const char* ext=Misc::getExtension(imageFileNameTemplate);
-	bool isTiff=strcasecmp(ext,".tif")==0||strcasecmp(ext,".tiff")==0;
-	#endif
-	
 	/* Get a pointer to the slice: */
 	Value* slicePtr=sd.dataSet.getSliceArray(newSliceIndex);
 	if(sd.master)
@@ -223,14 +232,7 @@ void loadGreyscaleImageStack(StackDescriptor& sd,int newSliceIndex,const char* i
 		imageFileName.append(imageFileNameBuffer);
 		
 		/* Load the image: */
-		#ifdef IMAGES_HAVE_TIFF
-		if(isTiff)
-			loadGreyscaleTiffImage(sd,slicePtr,imageFileName.c_str());
-		else
-			loadGreyscaleImage(sd,slicePtr,imageFileName.c_str());
-		#else
 		loadGreyscaleImage(sd,slicePtr,imageFileName.c_str());
-		#endif
 		
 		if(sd.master)
 			std::cout<<"\b\b\b\b"<<std::setw(3)<<((imageIndex+1)*100)/sd.numVertices[2]<<"%"<<std::flush;
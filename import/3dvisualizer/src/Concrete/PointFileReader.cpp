@@ -0,0 +1,282 @@
+/***********************************************************************
+PointFileReader - Class to read scattered 3D points from spreadsheet
+files in text format one point at a time, converting spherical
+coordinates to Cartesian coordinates.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Concrete/PointFileReader.h>
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <Misc/ThrowStdErr.h>
+#include <Math/Math.h>
+
+namespace Visualization {
+
+namespace Concrete {
+
+namespace {
+
+/*********************************************************
+Helper function to parse spreadsheet files in text format:
+*********************************************************/
+
+int
+getNextValue(
+	Misc::File& file,
+	char* valueBuffer,
+	size_t valueBufferSize)
+	{
+	/* Skip all whitespace: */
+	int nextChar;
+	do
+		{
+		nextChar=file.getc();
+		}
+	while(isspace(nextChar)&&nextChar!='\n'&&nextChar!=EOF);
+	
+	/* Check for end-of-line or end-of-file condition: */
+	if(nextChar=='\n'||nextChar==EOF)
+		return nextChar;
+	
+	/* Read the value: */
+	char* vPtr=valueBuffer;
+	if(nextChar=='"')
+		{
+		/* Read characters until next quotation mark: */
+		while(true)
+			{
+			nextChar=file.getc();
+			if(nextChar!='"')
+				{
+				if(valueBufferSize>1)
+					{
+					*vPtr=char(nextChar);
+					++vPtr;
+					--valueBufferSize;
+					}
+				}
+			else
+				break;
+			}
+		}
+	else
+		{
+		/* Append the first character to the result string: */
+		if(valueBufferSize>1)
+			{
+			*vPtr=char(nextChar);
+			++vPtr;
+			--valueBufferSize;
+			}
+		
+		/* Read characters until next whitespace: */
+		while(true)
+			{
+			nextChar=file.getc();
+			if(!isspace(nextChar))
+				{
+				if(valueBufferSize>1)
+					{
+					*vPtr=char(nextChar);
+					++vPtr;
+					--valueBufferSize;
+					}
+				}
+			else
+				{
+				file.ungetc(nextChar);
+				break;
+				}
+			}
+		}
+	*vPtr='\0';
+	
+	return 0;
+	}
+
+/**********************************************************************
+Helper functions to convert spherical (geoid) to Cartesian coordinates:
+**********************************************************************/
+
+inline
+void
+calcRadiusPos(
+	float latitude,
+	float longitude,
+	float radius,
+	double scaleFactor,
+	float pos[3])
+	{
+	double s0=Math::sin(double(latitude));
+	double c0=Math::cos(double(latitude));
+	double r=radius*scaleFactor;
+	double xy=r*c0;
+	double s1=Math::sin(double(longitude));
+	double c1=Math::cos(double(longitude));
+	pos[0]=float(xy*c1);
+	pos[1]=float(xy*s1);
+	pos[2]=float(r*s0);
+	}
+
+inline
+void
+calcDepthPos(
+	float latitude,
+	float longitude,
+	float depth,
+	double flatteningFactor,
+	double scaleFactor,
+	float pos[3])
+	{
+	/* Constant parameters for geoid formula: */
+	const double a=6378.14e3; // Equatorial radius in m
+	
+	double s0=Math::sin(double(latitude));
+	double c0=Math::cos(double(latitude));
+	double r=(a*(1.0-flatteningFactor*Math::sqr(s0))-depth)*scaleFactor;
+	double xy=r*c0;
+	double s1=Math::sin(double(longitude));
+	double c1=Math::cos(double(longitude));
+	pos[0]=float(xy*c1);
+	pos[1]=float(xy*s1);
+	pos[2]=float(r*s0);
+	}
+
+}
+
+/********************************
+Methods of class PointFileReader:
+********************************/
+
+PointFileReader::PointFileReader(const char* sPointFileName,double sFlatteningFactor,double sScaleFactor)
+	:pointFileName(sPointFileName),
+	 pointFile(sPointFileName,"rt"),
+	 flatteningFactor(sFlatteningFactor),scaleFactor(sScaleFactor),
+	 latIndex(-1),lngIndex(-1),radiusIndex(-1),radiusMode(RADIUS),
+	 finished(false),numPoints(0)
+	{
+	/* Read the header line from the point file: */
+	int index=0;
+	while(true)
+		{
+		char valueBuffer[40];
+		int terminator=getNextValue(pointFile,valueBuffer,sizeof(valueBuffer));
+		if(terminator=='\n')
+			break;
+		else if(terminator==EOF)
+			Misc::throwStdErr("PointFileReader::PointFileReader: Early end of file in input file \"%s\"",sPointFileName);
+		else if(strcasecmp(valueBuffer,"Latitude")==0||strcasecmp(valueBuffer,"Lat")==0)
+			latIndex=index;
+		else if(strcasecmp(valueBuffer,"Longitude")==0||strcasecmp(valueBuffer,"Long")==0||strcasecmp(valueBuffer,"Lon")==0)
+			lngIndex=index;
+		else if(strcasecmp(valueBuffer,"Radius")==0)
+			{
+			radiusIndex=index;
+			radiusMode=RADIUS;
+			}
+		else if(strcasecmp(valueBuffer,"Depth")==0)
+			{
+			radiusIndex=index;
+			radiusMode=DEPTH;
+			}
+		else if(strcasecmp(valueBuffer,"Negative Depth")==0||strcasecmp(valueBuffer,"Neg Depth")==0||strcasecmp(valueBuffer,"NegDepth")==0)
+			{
+			radiusIndex=index;
+			radiusMode=NEGDEPTH;
+			}
+		++index;
+		}
+	
+	/* Check if all required portions have been detected: */
+	if(latIndex<0||lngIndex<0||radiusIndex<0)
+		Misc::throwStdErr("PointFileReader::PointFileReader: Missing point components in input file \"%s\"",sPointFileName);
+	}
+
+bool PointFileReader::readPoint(float position[3])
+	{
+	while(!finished)
+		{
+		/* Read the next line from the input file: */
+		int index=0;
+		float sphericalCoordinates[3]={0.0f,0.0f,0.0f}; // Initialization just to shut up gcc
+		int parsedComponentsMask=0x0;
+		while(true)
+			{
+			char valueBuffer[40];
+			int terminator=getNextValue(pointFile,valueBuffer,sizeof(valueBuffer));
+			if(terminator=='\n')
+				break;
+			else if(terminator==EOF)
+				{
+				finished=true;
+				break;
+				}
+			else if(index==latIndex)
+				{
+				sphericalCoordinates[0]=Math::rad(float(atof(valueBuffer)));
+				parsedComponentsMask|=0x1;
+				}
+			else if(index==lngIndex)
+				{
+				sphericalCoordinates[1]=Math::rad(float(atof(valueBuffer)));
+				parsedComponentsMask|=0x2;
+				}
+			else if(index==radiusIndex)
+				{
+				sphericalCoordinates[2]=float(atof(valueBuffer));
+				parsedComponentsMask|=0x4;
+				}
+			++index;
+			}
+		
+		/* Check if a complete set of coordinates has been parsed: */
+		if(parsedComponentsMask==0x7&&!isnan(sphericalCoordinates[2]))
+			{
+			/* Convert the read spherical coordinates to Cartesian coordinates: */
+			switch(radiusMode)
+				{
+				case RADIUS:
+					calcRadiusPos(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,position);
+					break;
+				
+				case DEPTH:
+					calcDepthPos(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,flatteningFactor,scaleFactor,position);
+					break;
+				
+				case NEGDEPTH:
+					calcDepthPos(sphericalCoordinates[0],sphericalCoordinates[1],-sphericalCoordinates[2]*1000.0f,flatteningFactor,scaleFactor,position);
+					break;
+				}
+			
+			++numPoints;
+			return true;
+			}
+		}
+	
+	return false;
+	}
+
+}
+
+}
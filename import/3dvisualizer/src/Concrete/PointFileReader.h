@@ -0,0 +1,74 @@
+/***********************************************************************
+PointFileReader - Class to read scattered 3D points from spreadsheet
+files in text format one point at a time, converting spherical
+coordinates to Cartesian coordinates.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_CONCRETE_POINTFILEREADER_INCLUDED
+#define VISUALIZATION_CONCRETE_POINTFILEREADER_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <Misc/File.h>
+
+namespace Visualization {
+
+namespace Concrete {
+
+class PointFileReader
+	{
+	/* Embedded classes: */
+	private:
+	enum RadiusMode // Enumerated type for the interpretation of the radial point component
+		{
+		RADIUS,DEPTH,NEGDEPTH
+		};
+	
+	/* Elements: */
+	std::string pointFileName; // Name of the point file, for error messages
+	Misc::File pointFile; // The point file
+	double flatteningFactor; // Flattening factor to apply to the geoid formula
+	double scaleFactor; // Scale factor to apply to Cartesian coordinates
+	int latIndex,lngIndex,radiusIndex; // Column indices of the point components
+	RadiusMode radiusMode; // Interpretation of the radial point component
+	bool finished; // Flag whether the end of the point file has been reached
+	size_t numPoints; // Number of points read so far
+	
+	/* Constructors and destructors: */
+	public:
+	PointFileReader(const char* sPointFileName,double sFlatteningFactor,double sScaleFactor); // Opens the given point file and parses its header line; applies flattening factor to geoid formula and scale factor to Cartesian coordinates
+	
+	/* Methods: */
+	const std::string& getPointFileName(void) const // Returns the name of the point file
+		{
+		return pointFileName;
+		}
+	bool readPoint(float position[3]); // Reads the next complete point from the point file into the given Cartesian position; returns false at the end of the file
+	size_t getNumPoints(void) const // Returns the number of points read so far
+		{
+		return numPoints;
+		}
+	};
+
+}
+
+}
+
+#endif
@@ -1,6 +1,6 @@
 /***********************************************************************
 PointSet - Class to represent and render sets of scattered 3D points.
-Copyright (c) 2005-2012 Oliver Kreylos
+Copyright (c) 2005-2014 Oliver Kreylos
 
 This file is part of the 3D Data Visualizer (Visualizer).
 
@@ -21,152 +21,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Concrete/PointSet.h>
 
-#include <ctype.h>
-#include <math.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <string>
 #include <iostream>
-#include <Misc/ThrowStdErr.h>
-#include <Misc/File.h>
-#include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLVertexArrayParts.h>
 #include <GL/GLContextData.h>
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 
+#include <Concrete/PointFileReader.h>
+
 namespace Visualization {
 
 namespace Concrete {
 
 namespace {
 
-/*********************************************************
-Helper function to parse spreadsheet files in text format:
-*********************************************************/
-
-int
-getNextValue(
-	Misc::File& file,
-	char* valueBuffer,
-	size_t valueBufferSize)
-	{
-	/* Skip all whitespace: */
-	int nextChar;
-	do
-		{
-		nextChar=file.getc();
-		}
-	while(isspace(nextChar)&&nextChar!='\n'&&nextChar!=EOF);
-	
-	/* Check for end-of-line or end-of-file condition: */
-	if(nextChar=='\n'||nextChar==EOF)
-		return nextChar;
-	
-	/* Read the value: */
-	char* vPtr=valueBuffer;
-	if(nextChar=='"')
-		{
-		/* Read characters until next quotation mark: */
-		while(true)
-			{
-			nextChar=file.getc();
-			if(nextChar!='"')
-				{
-				if(valueBufferSize>1)
-					{
-					*vPtr=char(nextChar);
-					++vPtr;
-					--valueBufferSize;
-					}
-				}
-			else
-				break;
-			}
-		}
-	else
-		{
-		/* Append the first character to the result string: */
-		if(valueBufferSize>1)
-			{
-			*vPtr=char(nextChar);
-			++vPtr;
-			--valueBufferSize;
-			}
-		
-		/* Read characters until next whitespace: */
-		while(true)
-			{
-			nextChar=file.getc();
-			if(!isspace(nextChar))
-				{
-				if(valueBufferSize>1)
-					{
-					*vPtr=char(nextChar);
-					++vPtr;
-					--valueBufferSize;
-					}
-				}
-			else
-				{
-				file.ungetc(nextChar);
-				break;
-				}
-			}
-		}
-	*vPtr='\0';
-	
-	return 0;
-	}
-
-/**********************************************************************
-Helper functions to convert spherical (geoid) to Cartesian coordinates:
-**********************************************************************/
-
-inline
-void
-calcRadiusPos(
-	float latitude,
-	float longitude,
-	float radius,
-	double scaleFactor,
-	float pos[3])
-	{
-	double s0=Math::sin(double(latitude));
-	double c0=Math::cos(double(latitude));
-	double r=radius*scaleFactor;
-	double xy=r*c0;
-	double s1=Math::sin(double(longitude));
-	double c1=Math::cos(double(longitude));
-	pos[0]=float(xy*c1);
-	pos[1]=float(xy*s1);
-	pos[2]=float(r*s0);
-	}
-
-inline
-void
-calcDepthPos(
-	float latitude,
-	float longitude,
-	float depth,
-	double flatteningFactor,
-	double scaleFactor,
-	float pos[3])
-	{
-	/* Constant parameters for geoid formula: */
-	const double a=6378.14e3; // Equatorial radius in m
-	
-	double s0=Math::sin(double(latitude));
-	double c0=Math::cos(double(latitude));
-	double r=(a*(1.0-flatteningFactor*Math::sqr(s0))-depth)*scaleFactor;
-	double xy=r*c0;
-	double s1=Math::sin(double(longitude));
-	double c1=Math::cos(double(longitude));
-	pos[0]=float(xy*c1);
-	pos[1]=float(xy*s1);
-	pos[2]=float(r*s0);
-	}
-
 /**********************************************
 Helper classes to upload and render point sets:
 **********************************************/
@@ -246,113 +114,14 @@ Methods of class PointSet:
 
 PointSet::PointSet(const char* pointFileName,double flatteningFactor,double scaleFactor)
 	{
-	/* Open the point file: */
-	Misc::File pointFile(pointFileName,"rt");
-	
-	/* Read the header line from the point file: */
-	int latIndex=-1;
-	int lngIndex=-1;
-	int radiusIndex=-1;
-	enum RadiusMode
-		{
-		RADIUS,DEPTH,NEGDEPTH
-		} radiusMode=RADIUS;
-	int index=0;
-	while(true)
-		{
-		char valueBuffer[40];
-		int terminator=getNextValue(pointFile,valueBuffer,sizeof(valueBuffer));
-		if(terminator=='\n')
-			break;
-		else if(terminator==EOF)
-			Misc::throwStdErr("PointSet::PointSet: Early end of file in input file \"%s\"",pointFileName);
-		else if(strcasecmp(valueBuffer,"Latitude")==0||strcasecmp(valueBuffer,"Lat")==0)
-			latIndex=index;
-		else if(strcasecmp(valueBuffer,"Longitude")==0||strcasecmp(valueBuffer,"Long")==0||strcasecmp(valueBuffer,"Lon")==0)
-			lngIndex=index;
-		else if(strcasecmp(valueBuffer,"Radius")==0)
-			{
-			radiusIndex=index;
-			radiusMode=RADIUS;
-			}
-		else if(strcasecmp(valueBuffer,"Depth")==0)
-			{
-			radiusIndex=index;
-			radiusMode=DEPTH;
-			}
-		else if(strcasecmp(valueBuffer,"Negative Depth")==0||strcasecmp(valueBuffer,"Neg Depth")==0||strcasecmp(valueBuffer,"NegDepth")==0)
-			{
-			radiusIndex=index;
-			radiusMode=NEGDEPTH;
-			}
-		++index;
-		}
-	
-	/* Check if all required portions have been detected: */
-	if(latIndex<0||lngIndex<0||radiusIndex<0)
-		Misc::throwStdErr("PointSet::PointSet: Missing point components in input file \"%s\"",pointFileName);
-	
 	/* Read all point positions from the point file: */
-	bool finished=false;
-	while(!finished)
+	PointFileReader reader(pointFileName,flatteningFactor,scaleFactor);
+	Vertex p;
+	p.position=Vertex::Position(0,0,0); // To shut up gcc
+	while(reader.readPoint(p.position.getXyzw()))
 		{
-		/* Read the next line from the input file: */
-		int index=0;
-		float sphericalCoordinates[3]={0.0f,0.0f,0.0f}; // Initialization just to shut up gcc
-		int parsedComponentsMask=0x0;
-		while(true)
-			{
-			char valueBuffer[40];
-			int terminator=getNextValue(pointFile,valueBuffer,sizeof(valueBuffer));
-			if(terminator=='\n')
-				break;
-			else if(terminator==EOF)
-				{
-				finished=true;
-				break;
-				}
-			else if(index==latIndex)
-				{
-				sphericalCoordinates[0]=Math::rad(float(atof(valueBuffer)));
-				parsedComponentsMask|=0x1;
-				}
-			else if(index==lngIndex)
-				{
-				sphericalCoordinates[1]=Math::rad(float(atof(valueBuffer)));
-				parsedComponentsMask|=0x2;
-				}
-			else if(index==radiusIndex)
-				{
-				sphericalCoordinates[2]=float(atof(valueBuffer));
-				parsedComponentsMask|=0x4;
-				}
-			++index;
-			}
-		
-		/* Check if a complete set of coordinates has been parsed: */
-		if(parsedComponentsMask==0x7&&!isnan(sphericalCoordinates[2]))
-			{
-			/* Convert the read spherical coordinates to Cartesian coordinates: */
-			Vertex p;
-			p.position=Vertex::Position(0,0,0); // To shut up gcc
-			switch(radiusMode)
-				{
-				case RADIUS:
-					calcRadiusPos(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,p.position.getXyzw());
-					break;
-				
-				case DEPTH:
-					calcDepthPos(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,flatteningFactor,scaleFactor,p.position.getXyzw());
-					break;
-				
-				case NEGDEPTH:
-					calcDepthPos(sphericalCoordinates[0],sphericalCoordinates[1],-sphericalCoordinates[2]*1000.0f,flatteningFactor,scaleFactor,p.position.getXyzw());
-					break;
-				}
-			
-			/* Append the point to the point set: */
-			points.push_back(p);
-			}
+		/* Append the point to the point set: */
+		points.push_back(p);
 		}
 	std::cout<<points.size()<<" points parsed from "<<pointFileName<<std::endl;
 	}
@@ -231,7 +231,7 @@ Visualization::Abstract::DataSet* StructuredGridASCII::load(const std::vector<st
 	/* Finalize the grid structure: */
 	if(master)
 		std::cout<<"Finalizing grid structure..."<<std::flush;
-	dataSet.finalizeGrid();
+	dataSet.finalizeGrid(argIt->c_str());
 	if(master)
 		std::cout<<" done"<<std::endl;
 	
@@ -303,7 +303,7 @@ Visualization::Abstract::DataSet* StructuredGridVTK::load(const std::vector<std:
 	/* Finalize the grid structure: */
 	if(master)
 		std::cout<<"Finalizing grid structure..."<<std::flush;
-	dataSet.finalizeGrid();
+	dataSet.finalizeGrid(args[0].c_str());
 	if(master)
 		std::cout<<" done"<<std::endl;
 	
@@ -71,6 +71,7 @@ void readGrid(UnstructuredPlot3DFile::DS* dataSet,const char* gridFileName)
 	int numTetrahedra=gridFile.read<int>();
 	
 	/* Add all (uninitialized) vertices to the data set: */
+	dataSet->reserveVertices(numVertices);
 	UnstructuredPlot3DFile::DS::GridVertexIterator* vertices=new UnstructuredPlot3DFile::DS::GridVertexIterator[numVertices];
 	for(int i=0;i<numVertices;++i)
 		vertices[i]=dataSet->addVertex(UnstructuredPlot3DFile::DS::Point(),UnstructuredPlot3DFile::DS::Value());
@@ -93,6 +94,7 @@ void readGrid(UnstructuredPlot3DFile::DS* dataSet,const char* gridFileName)
 	gridFile.read(tetVertexIndices,numTetrahedra*4);
 	
 	/* Add all tetrahedra to the data set: */
+	dataSet->reserveCells(numTetrahedra);
 	for(int i=0;i<numTetrahedra;++i)
 		{
 		/* Convert the one-based indices to vertex iterators: */
@@ -109,7 +111,7 @@ void readGrid(UnstructuredPlot3DFile::DS* dataSet,const char* gridFileName)
 	delete[] vertices;
 	
 	/* Finalize the mesh structure: */
-	dataSet->finalizeGrid();
+	dataSet->finalizeGrid(gridFileName);
 	}
 
 SolutionParameters readData(UnstructuredPlot3DFile::DS* grid,const char* solutionFileName)
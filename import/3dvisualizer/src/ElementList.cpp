@@ -22,9 +22,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "ElementList.h"
 
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
 #include <Misc/StandardMarshallers.h>
 #include <Misc/File.h>
 #include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/VariableMemoryFile.h>
 #include <GLMotif/PopupWindow.h>
 #include <GLMotif/RowColumn.h>
 #include <GLMotif/Margin.h>
@@ -38,6 +42,36 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Abstract/FileParametersSink.h>
 #include <Abstract/Element.h>
 
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const char* geometryFileHeader="Visualizer Element Geometry v1.1"; // Identifier written at the beginning of geometry sidecar files
+
+/****************
+Helper functions:
+****************/
+
+Misc::UInt64 hashElementFile(const char* elementFileName) // Returns a 64-bit FNV-1a hash of the given element file's contents
+	{
+	IO::FilePtr elementFile(IO::openFile(elementFileName));
+	Misc::UInt64 hash=0xcbf29ce484222325ULL;
+	void* buffer;
+	size_t bufferSize;
+	while((bufferSize=elementFile->readInBuffer(buffer))!=0)
+		{
+		const unsigned char* bPtr=static_cast<const unsigned char*>(buffer);
+		for(size_t i=0;i<bufferSize;++i)
+			hash=(hash^Misc::UInt64(bPtr[i]))*0x100000001b3ULL;
+		}
+	
+	return hash;
+	}
+
+}
+
 /****************************
 Methods of class ElementList:
 ****************************/
@@ -253,7 +287,7 @@ void ElementList::addElement(Element* newElement,const char* elementName)
 		}
 	}
 
-void ElementList::saveElements(const char* elementFileName,bool ascii,const Visualization::Abstract::VariableManager* variableManager) const
+void ElementList::saveElements(const char* elementFileName,bool ascii,const Visualization::Abstract::VariableManager* variableManager,const char* dataSetStamp) const
 	{
 	if(ascii)
 		{
@@ -293,6 +327,100 @@ void ElementList::saveElements(const char* elementFileName,bool ascii,const Visu
 				veIt->element->getParameters()->write(sink);
 				}
 		}
+	
+	if(dataSetStamp!=0)
+		{
+		/* Create the geometry sidecar file and write its header: */
+		IO::FilePtr geometryFile(Vrui::openFile(getGeometryFileName(elementFileName).c_str(),IO::File::WriteOnly));
+		geometryFile->setEndianness(Misc::LittleEndian);
+		Misc::Marshaller<std::string>::write(geometryFileHeader,*geometryFile);
+		Misc::Marshaller<std::string>::write(dataSetStamp,*geometryFile);
+		
+		/* Write the element file's size and content hash to detect later changes to the element file: */
+		geometryFile->write<Misc::UInt64>(IO::openSeekableFile(elementFileName)->getSize());
+		geometryFile->write<Misc::UInt64>(hashElementFile(elementFileName));
+		
+		Misc::UInt32 numSavedElements=0;
+		for(ListElementList::const_iterator veIt=elements.begin();veIt!=elements.end();++veIt)
+			if(veIt->show)
+				++numSavedElements;
+		geometryFile->write<Misc::UInt32>(numSavedElements);
+		
+		/* Save the geometry of all visible visualization elements in the same order as the element file: */
+		for(ListElementList::const_iterator veIt=elements.begin();veIt!=elements.end();++veIt)
+			if(veIt->show)
+				{
+				/* Write the element's geometry into a memory buffer to determine its size: */
+				IO::VariableMemoryFile geometryBuffer;
+				geometryBuffer.setEndianness(Misc::LittleEndian);
+				if(veIt->element->saveGeometry(geometryBuffer))
+					{
+					/* Write the geometry record: */
+					geometryFile->write<Misc::UInt64>(geometryBuffer.getDataSize());
+					geometryBuffer.writeToSink(*geometryFile);
+					}
+				else
+					{
+					/* Write an empty geometry record: */
+					geometryFile->write<Misc::UInt64>(0);
+					}
+				}
+		}
+	}
+
+std::string ElementList::getGeometryFileName(const char* elementFileName)
+	{
+	return std::string(elementFileName)+".geom";
+	}
+
+bool ElementList::readGeometryIndex(const char* elementFileName,const std::string& dataSetStamp,std::vector<IO::SeekableFile::Offset>& geometryOffsets)
+	{
+	geometryOffsets.clear();
+	try
+		{
+		/* Open the geometry sidecar file and check its header and data set stamp: */
+		IO::SeekableFilePtr geometryFile(IO::openSeekableFile(getGeometryFileName(elementFileName).c_str()));
+		geometryFile->setEndianness(Misc::LittleEndian);
+		if(Misc::Marshaller<std::string>::read(*geometryFile)!=geometryFileHeader)
+			return false;
+		if(Misc::Marshaller<std::string>::read(*geometryFile)!=dataSetStamp)
+			return false;
+		
+		/* Check that the element file has not changed since the geometry was saved: */
+		if(geometryFile->read<Misc::UInt64>()!=Misc::UInt64(IO::openSeekableFile(elementFileName)->getSize()))
+			return false;
+		if(geometryFile->read<Misc::UInt64>()!=hashElementFile(elementFileName))
+			return false;
+		
+		/* Read the sizes of all geometry records and skip their contents: */
+		Misc::UInt32 numSavedElements=geometryFile->read<Misc::UInt32>();
+		for(Misc::UInt32 i=0;i<numSavedElements;++i)
+			{
+			Misc::UInt64 geometrySize=geometryFile->read<Misc::UInt64>();
+			if(geometrySize!=0)
+				{
+				geometryOffsets.push_back(geometryFile->getReadPos());
+				geometryFile->setReadPosRel(IO::SeekableFile::Offset(geometrySize));
+				}
+			else
+				geometryOffsets.push_back(0);
+			}
+		
+		/* Reject truncated files: */
+		if(geometryFile->getReadPos()>geometryFile->getSize())
+			{
+			geometryOffsets.clear();
+			return false;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Treat unreadable sidecar files as missing: */
+		geometryOffsets.clear();
+		return false;
+		}
+	
+	return true;
 	}
 
 void ElementList::renderElements(GLRenderState& renderState,bool transparent) const
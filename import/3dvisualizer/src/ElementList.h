@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string>
 #include <vector>
 #include <Misc/Autopointer.h>
+#include <IO/SeekableFile.h>
 #include <GLMotif/WidgetManager.h>
 #include <GLMotif/ToggleButton.h>
 #include <GLMotif/ListBox.h>
@@ -93,7 +94,9 @@ class ElementList
 	/* Methods: */
 	void clear(void); // Deletes all elements from the list
 	void addElement(Element* newElement,const char* elementName); // Adds a new visualization element to the list
-	void saveElements(const char* elementFileName,bool ascii,const Visualization::Abstract::VariableManager* variableManager) const; // Saves all visible visualization elements to the given file
+	void saveElements(const char* elementFileName,bool ascii,const Visualization::Abstract::VariableManager* variableManager,const char* dataSetStamp =0) const; // Saves all visible visualization elements to the given file; also saves their extracted geometry into a sidecar file tagged with the given data set stamp if the stamp is not null
+	static std::string getGeometryFileName(const char* elementFileName); // Returns the name of the geometry sidecar file belonging to the given element file
+	static bool readGeometryIndex(const char* elementFileName,const std::string& dataSetStamp,std::vector<IO::SeekableFile::Offset>& geometryOffsets); // Returns the positions of the elements' saved geometry in the given element file's sidecar file, in element file order, or 0 for elements without saved geometry; returns false if there is no valid sidecar file for the given data set stamp and the element file's current contents
 	GLMotif::PopupWindow* getElementListDialog(void) // Returns the element list dialog
 		{
 		return elementListDialogPopup;
@@ -0,0 +1,269 @@
+/***********************************************************************
+ElementLoader - Class to restore visualization elements from element
+files on a pool of background threads, handing finished elements to the
+main thread as they become available.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "ElementLoader.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <Misc/Timer.h>
+#include <IO/OpenFile.h>
+#include <Cluster/MulticastPipe.h>
+#include <Vrui/Vrui.h>
+
+#include <Abstract/VariableManager.h>
+#include <Abstract/Parameters.h>
+#include <Abstract/ParametersSink.h>
+#include <Abstract/Algorithm.h>
+#include <Abstract/Element.h>
+
+#include "ElementList.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class VariablePreparer:public Visualization::Abstract::ParametersSink // Class to prepare all variables referenced by a parameter object
+	{
+	/* Elements: */
+	private:
+	Visualization::Abstract::VariableManager* preparingVariableManager; // Non-const pointer to the variable manager
+	
+	/* Constructors and destructors: */
+	public:
+	VariablePreparer(Visualization::Abstract::VariableManager* sVariableManager)
+		:Visualization::Abstract::ParametersSink(sVariableManager),
+		 preparingVariableManager(sVariableManager)
+		{
+		}
+	
+	/* Methods from ParametersSink: */
+	virtual void write(const char* name,const Visualization::Abstract::WriterBase& value)
+		{
+		}
+	virtual void writeScalarVariable(const char* name,int scalarVariableIndex)
+		{
+		preparingVariableManager->getScalarExtractor(scalarVariableIndex);
+		}
+	virtual void writeVectorVariable(const char* name,int vectorVariableIndex)
+		{
+		preparingVariableManager->getVectorExtractor(vectorVariableIndex);
+		}
+	};
+
+}
+
+/******************************
+Methods of class ElementLoader:
+******************************/
+
+void* ElementLoader::workerThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next queued visualization element: */
+		Job job;
+		{
+		Threads::MutexCond::Lock jobLock(jobCond);
+		while(!shutdown&&jobs.empty())
+			jobCond.wait(jobLock);
+		if(jobs.empty())
+			break;
+		job=jobs.front();
+		jobs.pop_front();
+		}
+		
+		/* Restore the visualization element: */
+		Misc::Timer restoreTimer;
+		bool master=job.algorithm->isMaster();
+		ElementPointer element;
+		bool loaded=false;
+		try
+			{
+			if(!master)
+				{
+				/* Receive the visualization element from the master: */
+				element=job.algorithm->startSlaveElement(job.parameters);
+				job.algorithm->continueSlaveElement();
+				}
+			else if(!job.geometryFileName.empty()&&job.algorithm->hasElementLoader())
+				{
+				/* Open the geometry file; slaves are not involved until the saved geometry has been validated: */
+				IO::SeekableFilePtr geometryFile;
+				try
+					{
+					geometryFile=IO::openSeekableFile(job.geometryFileName.c_str());
+					}
+				catch(std::runtime_error)
+					{
+					/* Treat an unreadable geometry file as invalid saved geometry: */
+					}
+				
+				if(geometryFile!=0)
+					{
+					/* Read the visualization element's saved geometry: */
+					geometryFile->setEndianness(Misc::LittleEndian);
+					geometryFile->setReadPosAbs(job.geometryOffset);
+					element=job.algorithm->loadElement(job.parameters,*geometryFile);
+					loaded=element!=0;
+					}
+				
+				/* Extract the visualization element if the saved geometry is missing or invalid: */
+				if(!loaded)
+					element=job.algorithm->createElement(job.parameters);
+				}
+			else
+				{
+				/* Extract the visualization element: */
+				element=job.algorithm->createElement(job.parameters);
+				}
+			}
+		catch(std::runtime_error err)
+			{
+			if(master)
+				std::cout<<"Cancelled "<<job.name<<" due to exception "<<err.what()<<std::endl;
+			
+			/* Destroy the extraction parameters unless a partial visualization element already inherited them: */
+			if(element==0)
+				delete job.parameters;
+			}
+		
+		/* Destroy the algorithm, which closes its pipe in lock-step with the other cluster nodes: */
+		delete job.algorithm;
+		
+		restoreTimer.elapse();
+		if(master&&element!=0)
+			std::cout<<(loaded?"Loaded ":"Created ")<<job.name<<" in "<<restoreTimer.getTime()*1000.0<<" ms"<<std::endl;
+		
+		/* Hand the visualization element to the main thread, even if it failed, to keep the submission order: */
+		{
+		Threads::MutexCond::Lock finishedElementsLock(finishedElementsCond);
+		FinishedElement& fe=finishedElements[job.ticket];
+		fe.element=element;
+		fe.name=job.name;
+		finishedElementsCond.broadcast();
+		}
+		Vrui::requestUpdate();
+		}
+	
+	return 0;
+	}
+
+ElementLoader::ElementLoader(ElementLoader::VariableManager* sVariableManager,unsigned int sNumWorkers)
+	:variableManager(sVariableManager),
+	 numWorkers(sNumWorkers>0?sNumWorkers:1),workers(new Threads::Thread[numWorkers]),
+	 shutdown(false),
+	 nextTicket(0),nextAddTicket(0)
+	{
+	/* Start the worker threads: */
+	for(unsigned int i=0;i<numWorkers;++i)
+		workers[i].start(this,&ElementLoader::workerThreadMethod);
+	}
+
+ElementLoader::~ElementLoader(void)
+	{
+	/* Tell the worker threads to exit after restoring all queued elements, to keep cluster nodes in lock-step: */
+	{
+	Threads::MutexCond::Lock jobLock(jobCond);
+	shutdown=true;
+	jobCond.broadcast();
+	}
+	for(unsigned int i=0;i<numWorkers;++i)
+		workers[i].join();
+	delete[] workers;
+	}
+
+void ElementLoader::addElement(const std::string& name,ElementLoader::Algorithm* algorithm,ElementLoader::Parameters* parameters,const std::string& geometryFileName,IO::SeekableFile::Offset geometryOffset)
+	{
+	/* Prepare all variables referenced by the parameters from the main thread, as variable preparation is not thread-safe: */
+	VariablePreparer preparer(variableManager);
+	parameters->write(preparer);
+	
+	/* Queue the visualization element and wake up a worker thread: */
+	Job job;
+	job.ticket=nextTicket++;
+	job.name=name;
+	job.algorithm=algorithm;
+	job.parameters=parameters;
+	job.geometryFileName=geometryFileName;
+	job.geometryOffset=geometryOffset;
+	Threads::MutexCond::Lock jobLock(jobCond);
+	jobs.push_back(job);
+	jobCond.signal();
+	}
+
+void ElementLoader::addFinishedElements(ElementList& elementList)
+	{
+	/*********************************************************************
+	Worker threads finish visualization elements in a different order on
+	each cluster node. To keep the element lists identical, elements are
+	added in submission order, and the master decides how many of them are
+	added during each frame:
+	*********************************************************************/
+	
+	Cluster::MulticastPipe* pipe=Vrui::getMainPipe();
+	unsigned int numNewElements=0;
+	if(pipe==0||Vrui::isMaster())
+		{
+		/* Count the finished visualization elements following the last added one: */
+		{
+		Threads::MutexCond::Lock finishedElementsLock(finishedElementsCond);
+		while(finishedElements.find(nextAddTicket+numNewElements)!=finishedElements.end())
+			++numNewElements;
+		}
+		
+		if(pipe!=0)
+			{
+			/* Send the number of visualization elements to add to the slaves: */
+			pipe->write<unsigned int>(numNewElements);
+			}
+		}
+	else
+		{
+		/* Receive the number of visualization elements to add from the master: */
+		numNewElements=pipe->read<unsigned int>();
+		}
+	
+	if(numNewElements==0)
+		return;
+	
+	/* Grab the visualization elements to add, waiting for ones that the master already finished: */
+	std::vector<FinishedElement> newElements;
+	{
+	Threads::MutexCond::Lock finishedElementsLock(finishedElementsCond);
+	for(unsigned int i=0;i<numNewElements;++i,++nextAddTicket)
+		{
+		std::map<unsigned int,FinishedElement>::iterator feIt;
+		while((feIt=finishedElements.find(nextAddTicket))==finishedElements.end())
+			finishedElementsCond.wait(finishedElementsLock);
+		newElements.push_back(feIt->second);
+		finishedElements.erase(feIt);
+		}
+	}
+	
+	/* Add the successfully restored visualization elements to the list: */
+	for(std::vector<FinishedElement>::iterator feIt=newElements.begin();feIt!=newElements.end();++feIt)
+		if(feIt->element!=0)
+			elementList.addElement(feIt->element.getPointer(),feIt->name.c_str());
+	}
@@ -0,0 +1,112 @@
+/***********************************************************************
+ElementLoader - Class to restore visualization elements from element
+files on a pool of background threads, handing finished elements to the
+main thread as they become available.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef ELEMENTLOADER_INCLUDED
+#define ELEMENTLOADER_INCLUDED
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <map>
+#include <Misc/Autopointer.h>
+#include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <IO/SeekableFile.h>
+
+/* Forward declarations: */
+namespace Visualization {
+namespace Abstract {
+class VariableManager;
+class Parameters;
+class Algorithm;
+class Element;
+}
+}
+class ElementList;
+
+class ElementLoader
+	{
+	/* Embedded classes: */
+	public:
+	typedef Visualization::Abstract::VariableManager VariableManager;
+	typedef Visualization::Abstract::Parameters Parameters;
+	typedef Visualization::Abstract::Algorithm Algorithm;
+	typedef Visualization::Abstract::Element Element;
+	typedef Misc::Autopointer<Element> ElementPointer;
+	
+	private:
+	struct Job // Structure describing a visualization element to be restored
+		{
+		/* Elements: */
+		public:
+		unsigned int ticket; // Position of the visualization element in submission order
+		std::string name; // Name of the algorithm creating the visualization element
+		Algorithm* algorithm; // Algorithm creating the visualization element; owned by the job
+		Parameters* parameters; // Extraction parameters of the visualization element; inherited by the algorithm
+		std::string geometryFileName; // Name of the sidecar file containing the element's saved geometry, or empty to extract the element
+		IO::SeekableFile::Offset geometryOffset; // Position of the element's saved geometry in the sidecar file
+		};
+	
+	struct FinishedElement // Structure passing a restored visualization element to the main thread
+		{
+		/* Elements: */
+		public:
+		ElementPointer element; // The restored visualization element, or null if restoration failed
+		std::string name; // Name of the algorithm that created the visualization element
+		};
+	
+	/* Elements: */
+	VariableManager* variableManager; // Variable manager used by all loaded visualization elements
+	unsigned int numWorkers; // Number of worker threads
+	Threads::Thread* workers; // Array of worker threads
+	Threads::MutexCond jobCond; // Condition variable protecting the job queue and signaling new jobs
+	std::deque<Job> jobs; // Queue of visualization elements waiting to be restored
+	bool shutdown; // Flag telling the worker threads to exit once the job queue is empty
+	unsigned int nextTicket; // Ticket assigned to the next queued visualization element
+	Threads::MutexCond finishedElementsCond; // Condition variable protecting the map of finished visualization elements and signaling newly finished ones
+	std::map<unsigned int,FinishedElement> finishedElements; // Map from tickets to visualization elements restored but not yet added to the element list
+	unsigned int nextAddTicket; // Ticket of the next visualization element to be added to the element list
+	
+	/* Private methods: */
+	void* workerThreadMethod(void); // Thread method restoring queued visualization elements
+	
+	/* Constructors and destructors: */
+	public:
+	ElementLoader(VariableManager* sVariableManager,unsigned int sNumWorkers); // Creates an element loader with the given number of worker threads
+	private:
+	ElementLoader(const ElementLoader& source); // Prohibit copy constructor
+	ElementLoader& operator=(const ElementLoader& source); // Prohibit assignment operator
+	public:
+	~ElementLoader(void); // Finishes all queued visualization elements and shuts down the worker threads
+	
+	/* Methods: */
+	unsigned int getNumWorkers(void) const // Returns the number of worker threads
+		{
+		return numWorkers;
+		}
+	void addElement(const std::string& name,Algorithm* algorithm,Parameters* parameters,const std::string& geometryFileName,IO::SeekableFile::Offset geometryOffset); // Queues a visualization element for restoration; extracts the element if the geometry file name is empty; inherits algorithm and parameter objects
+	void addFinishedElements(ElementList& elementList); // Adds restored visualization elements to the given element list in submission order and in lock-step across a cluster; must be called from the main thread's frame function
+	};
+
+#endif
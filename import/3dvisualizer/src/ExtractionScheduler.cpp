@@ -0,0 +1,234 @@
+/***********************************************************************
+ExtractionScheduler - Class to distribute a per-frame budget of
+extraction time between all currently active incremental extractors,
+based on measured frame times and a target frame rate.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include "ExtractionScheduler.h"
+
+/************************************
+Methods of class ExtractionScheduler:
+************************************/
+
+ExtractionScheduler::ClientState* ExtractionScheduler::findClient(const Extractor* extractor)
+	{
+	for(std::vector<ClientState>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		if(cIt->extractor==extractor)
+			return &*cIt;
+	return 0;
+	}
+
+const ExtractionScheduler::ClientState* ExtractionScheduler::findClient(const Extractor* extractor) const
+	{
+	for(std::vector<ClientState>::const_iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		if(cIt->extractor==extractor)
+			return &*cIt;
+	return 0;
+	}
+
+ExtractionScheduler::ExtractionScheduler(double sTargetFrameRate)
+	:targetFrameTime(1.0/sTargetFrameRate),
+	 minSliceTime(0.002),
+	 maxBudget(targetFrameTime),
+	 budget(0.5*targetFrameTime),
+	 averageFrameTime(0.0),
+	 frameIndex(0),
+	 frameStartTime(Misc::Time::now())
+	{
+	}
+
+void ExtractionScheduler::frame(double frameTime)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	
+	/* Smooth the measured frame time: */
+	if(averageFrameTime==0.0)
+		averageFrameTime=frameTime;
+	else
+		averageFrameTime=averageFrameTime*0.9+frameTime*0.1;
+	
+	/* Adapt the extraction budget while extractors are competing with the renderer: */
+	bool haveActive=false;
+	for(std::vector<ClientState>::iterator cIt=clients.begin();cIt!=clients.end()&&!haveActive;++cIt)
+		haveActive=cIt->active;
+	if(haveActive)
+		{
+		if(averageFrameTime>targetFrameTime*1.1)
+			{
+			/* Back off quickly when the frame rate drops below the target: */
+			budget*=0.75;
+			}
+		else if(averageFrameTime<targetFrameTime)
+			{
+			/* Probe slowly for spare time: */
+			budget+=targetFrameTime*0.05;
+			}
+		}
+	if(budget<minSliceTime)
+		budget=minSliceTime;
+	if(budget>maxBudget)
+		budget=maxBudget;
+	
+	/* Start the next frame: */
+	++frameIndex;
+	frameStartTime=Misc::Time::now();
+	}
+
+void ExtractionScheduler::setTargetFrameRate(double newTargetFrameRate)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	
+	/* Scale the budget limits along with the target frame time: */
+	double scale=(1.0/newTargetFrameRate)/targetFrameTime;
+	targetFrameTime=1.0/newTargetFrameRate;
+	maxBudget*=scale;
+	budget*=scale;
+	}
+
+void ExtractionScheduler::setMinSliceTime(double newMinSliceTime)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	minSliceTime=newMinSliceTime;
+	}
+
+void ExtractionScheduler::setMaxBudget(double newMaxBudget)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	maxBudget=newMaxBudget;
+	if(budget>maxBudget)
+		budget=maxBudget;
+	}
+
+double ExtractionScheduler::getBudget(void) const
+	{
+	Threads::Mutex::Lock lock(mutex);
+	return budget;
+	}
+
+double ExtractionScheduler::getAverageFrameTime(void) const
+	{
+	Threads::Mutex::Lock lock(mutex);
+	return averageFrameTime;
+	}
+
+unsigned int ExtractionScheduler::getNumActiveExtractors(void) const
+	{
+	Threads::Mutex::Lock lock(mutex);
+	unsigned int result=0;
+	for(std::vector<ClientState>::const_iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		if(cIt->active)
+			++result;
+	return result;
+	}
+
+void ExtractionScheduler::addExtractor(const Extractor* extractor,unsigned int priority)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	ClientState newClient;
+	newClient.extractor=extractor;
+	newClient.priority=priority>0?priority:1;
+	newClient.active=false;
+	newClient.lastFrameIndex=frameIndex-1;
+	newClient.sliceTime=0.0;
+	clients.push_back(newClient);
+	}
+
+void ExtractionScheduler::removeExtractor(const Extractor* extractor)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	for(std::vector<ClientState>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		if(cIt->extractor==extractor)
+			{
+			clients.erase(cIt);
+			break;
+			}
+	}
+
+unsigned int ExtractionScheduler::getPriority(const Extractor* extractor) const
+	{
+	Threads::Mutex::Lock lock(mutex);
+	const ClientState* client=findClient(extractor);
+	return client!=0?client->priority:0;
+	}
+
+void ExtractionScheduler::setPriority(const Extractor* extractor,unsigned int newPriority)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	ClientState* client=findClient(extractor);
+	if(client!=0)
+		client->priority=newPriority>0?newPriority:1;
+	}
+
+double ExtractionScheduler::getSliceTime(const Extractor* extractor) const
+	{
+	Threads::Mutex::Lock lock(mutex);
+	const ClientState* client=findClient(extractor);
+	return client!=0?client->sliceTime:0.0;
+	}
+
+double ExtractionScheduler::startSlice(const Extractor* extractor)
+	{
+	double sliceTime=minSliceTime;
+	double delay=0.0;
+	{
+	Threads::Mutex::Lock lock(mutex);
+	ClientState* client=findClient(extractor);
+	if(client==0)
+		return sliceTime;
+	
+	/* Mark the extractor as active: */
+	client->active=true;
+	
+	/* Check if the extractor already received a time slice during the current frame: */
+	if(client->lastFrameIndex==frameIndex)
+		{
+		/* Wait until the next frame is expected to start, but never longer than one target frame time: */
+		Misc::Time now=Misc::Time::now();
+		delay=targetFrameTime-(double(now.tv_sec-frameStartTime.tv_sec)+double(now.tv_nsec-frameStartTime.tv_nsec)/1.0e9);
+		if(delay<=0.0||delay>targetFrameTime)
+			delay=targetFrameTime;
+		}
+	client->lastFrameIndex=frameIndex;
+	
+	/* Share the budget between all active extractors by priority: */
+	unsigned int prioritySum=0;
+	for(std::vector<ClientState>::const_iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+		if(cIt->active)
+			prioritySum+=cIt->priority;
+	sliceTime=budget*double(client->priority)/double(prioritySum);
+	if(sliceTime<minSliceTime)
+		sliceTime=minSliceTime;
+	client->sliceTime=sliceTime;
+	}
+	
+	/* Yield the processor until the extractor's next time slice is due: */
+	if(delay>0.0)
+		Misc::sleep(Misc::Time(delay));
+	
+	return sliceTime;
+	}
+
+void ExtractionScheduler::finishElement(const Extractor* extractor)
+	{
+	Threads::Mutex::Lock lock(mutex);
+	ClientState* client=findClient(extractor);
+	if(client!=0)
+		client->active=false;
+	}
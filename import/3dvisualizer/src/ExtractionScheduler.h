@@ -0,0 +1,101 @@
+/***********************************************************************
+ExtractionScheduler - Class to distribute a per-frame budget of
+extraction time between all currently active incremental extractors,
+based on measured frame times and a target frame rate.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef EXTRACTIONSCHEDULER_INCLUDED
+#define EXTRACTIONSCHEDULER_INCLUDED
+
+#include <vector>
+#include <Misc/Time.h>
+#include <Threads/Mutex.h>
+
+/* Forward declarations: */
+class Extractor;
+
+class ExtractionScheduler
+	{
+	/* Embedded classes: */
+	private:
+	struct ClientState // Structure describing the scheduling state of a registered extractor
+		{
+		/* Elements: */
+		public:
+		const Extractor* extractor; // Pointer to the extractor
+		unsigned int priority; // Extractor's scheduling priority; budget is shared in proportion to priorities
+		bool active; // Flag whether the extractor is currently growing a visualization element
+		unsigned int lastFrameIndex; // Index of the frame during which the extractor received its most recent time slice
+		double sliceTime; // Length of the extractor's most recent time slice in seconds
+		};
+	
+	/* Elements: */
+	mutable Threads::Mutex mutex; // Mutex serializing access to the scheduler state
+	double targetFrameTime; // Desired time between frames in seconds
+	double minSliceTime; // Minimum length of an extractor's time slice in seconds, to guarantee progress
+	double maxBudget; // Maximum total extraction time per frame in seconds
+	double budget; // Current total extraction time per frame in seconds
+	double averageFrameTime; // Smoothed measured time between frames in seconds, or 0.0 before the first frame
+	unsigned int frameIndex; // Index of the most recently started frame
+	Misc::Time frameStartTime; // Time at which the most recent frame was started
+	std::vector<ClientState> clients; // States of all registered extractors
+	
+	/* Private methods: */
+	ClientState* findClient(const Extractor* extractor); // Returns the state of the given extractor, or 0
+	const ClientState* findClient(const Extractor* extractor) const; // Ditto
+	
+	/* Constructors and destructors: */
+	public:
+	ExtractionScheduler(double sTargetFrameRate =60.0); // Creates a scheduler aiming for the given frame rate in Hz
+	
+	/* Methods to be called from the main thread: */
+	void frame(double frameTime); // Updates the extraction budget based on the duration of the last frame in seconds
+	double getTargetFrameRate(void) const // Returns the desired frame rate in Hz
+		{
+		return 1.0/targetFrameTime;
+		}
+	void setTargetFrameRate(double newTargetFrameRate); // Sets the desired frame rate in Hz
+	double getMinSliceTime(void) const // Returns the minimum time slice length in seconds
+		{
+		return minSliceTime;
+		}
+	void setMinSliceTime(double newMinSliceTime); // Sets the minimum time slice length in seconds
+	double getMaxBudget(void) const // Returns the maximum total extraction time per frame in seconds
+		{
+		return maxBudget;
+		}
+	void setMaxBudget(double newMaxBudget); // Sets the maximum total extraction time per frame in seconds
+	double getBudget(void) const; // Returns the current total extraction time per frame in seconds
+	double getAverageFrameTime(void) const; // Returns the smoothed measured time between frames in seconds
+	unsigned int getNumActiveExtractors(void) const; // Returns the number of extractors currently growing visualization elements
+	
+	/* Methods to manage extractors: */
+	void addExtractor(const Extractor* extractor,unsigned int priority =1); // Registers an extractor with the given scheduling priority
+	void removeExtractor(const Extractor* extractor); // Unregisters an extractor
+	unsigned int getPriority(const Extractor* extractor) const; // Returns an extractor's scheduling priority
+	void setPriority(const Extractor* extractor,unsigned int newPriority); // Changes an extractor's scheduling priority
+	double getSliceTime(const Extractor* extractor) const; // Returns the length of an extractor's most recent time slice in seconds
+	
+	/* Methods to be called from extractor threads: */
+	double startSlice(const Extractor* extractor); // Blocks until the extractor is due for its next time slice, and returns the slice's length in seconds
+	void finishElement(const Extractor* extractor); // Notifies the scheduler that the extractor finished growing its current visualization element
+	};
+
+#endif
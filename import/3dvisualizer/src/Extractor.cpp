@@ -34,6 +34,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Abstract/Algorithm.h>
 #include <Abstract/Element.h>
 
+#include "ExtractionScheduler.h"
+
 /**************************
 Methods of class Extractor:
 **************************/
@@ -47,36 +49,63 @@ void* Extractor::masterExtractorThreadMethod(void)
 	/* Create a data sink for the multicast pipe: */
 	Visualization::Abstract::BinaryParametersSink sink(extractor->getVariableManager(),*extractor->getPipe(),true);
 	
+	/* Check whether the extractor creates coarse previews while seed locators are being dragged: */
+	bool createPreviews=extractor->hasIncrementalCreator()&&extractor->hasPreviewCreator();
+	Parameters* previewParameters=0; // Extraction parameters of the most recent preview element, kept for refinement
+	unsigned int previewRequestID=0; // ID of the seed request that created the most recent preview element
+	
 	/* Handle extraction requests until interrupted: */
 	Realtime::AlarmTimer alarm;
 	Misc::Time expirationTime(0.1);
 	while(true)
 		{
-		/* Wait until there is a seed request: */
+		/* Wait until there is a seed or refinement request: */
 		Parameters* parameters;
 		unsigned int requestID;
+		bool preview;
 		{
 		Threads::Mutex::Lock seedRequestLock(seedRequestMutex);
 		#if !THREADS_CONFIG_CAN_CANCEL
-		while(!terminate&&seedParameters==0)
+		while(!terminate&&seedParameters==0&&(previewParameters==0||refineRequestID!=previewRequestID))
 			seedRequestCond.wait(seedRequestMutex);
 		if(terminate)
+			{
+			delete previewParameters;
 			return 0;
+			}
 		#else
-		while(seedParameters==0)
+		while(seedParameters==0&&(previewParameters==0||refineRequestID!=previewRequestID))
 			seedRequestCond.wait(seedRequestMutex);
 		#endif
 		
-		/* Grab the seed request parameters: */
-		parameters=seedParameters;
-		seedParameters=0;
-		
-		/* Grab the seed request ID: */
-		requestID=seedRequestID;
+		if(previewParameters!=0&&refineRequestID==previewRequestID)
+			{
+			/* Refine the finalized preview element to full resolution before handling any new seed requests: */
+			parameters=previewParameters;
+			previewParameters=0;
+			requestID=previewRequestID;
+			preview=false;
+			}
+		else
+			{
+			/* Grab the seed request parameters: */
+			parameters=seedParameters;
+			seedParameters=0;
+			
+			/* Grab the seed request ID: */
+			requestID=seedRequestID;
+			
+			/* Create a preview unless the seed request has already been finalized: */
+			preview=createPreviews&&requestID!=refineRequestID;
+			}
 		}
 		
+		/* Discard the parameters of the previous preview element, which has been superseded: */
+		delete previewParameters;
+		previewParameters=0;
+		
 		/* Start a new visualization element: */
-		std::pair<ElementPointer,unsigned int>& element=trackedElements.startNewValue();
+		TrackedElement& element=trackedElements.startNewValue();
 		if(parameters->isValid())
 			{
 			/* Prepare for extracting a new visualization element: */
@@ -84,6 +113,7 @@ void* Extractor::masterExtractorThreadMethod(void)
 				{
 				/* Notify the slave nodes that a new visualization element is coming: */
 				extractor->getPipe()->write<unsigned int>(requestID);
+				extractor->getPipe()->write<unsigned char>(preview?1:0);
 				
 				/* Send the extraction parameters to the slaves: */
 				parameters->write(sink);
@@ -93,15 +123,27 @@ void* Extractor::masterExtractorThreadMethod(void)
 			if(extractor->hasIncrementalCreator())
 				{
 				/* Start the visualization element: */
-				element.first=extractor->startElement(parameters);
-				element.second=requestID;
+				if(preview)
+					{
+					/* Keep the extraction parameters to refine the preview later: */
+					previewParameters=parameters->clone();
+					previewRequestID=requestID;
+					element.element=extractor->startPreviewElement(parameters);
+					}
+				else
+					element.element=extractor->startElement(parameters);
+				element.requestID=requestID;
+				element.preview=preview;
 				
 				/* Continue extracting the visualization element until it is done: */
 				bool keepGrowing;
 				do
 					{
-					/* Grow the visualization element by a little bit: */
-					alarm.armTimer(expirationTime);
+					/* Grow the visualization element by a little bit, for as long as the scheduler allows: */
+					if(scheduler!=0)
+						alarm.armTimer(Misc::Time(scheduler->startSlice(this)));
+					else
+						alarm.armTimer(expirationTime);
 					keepGrowing=!extractor->continueElement(alarm);
 					
 					/* Push this visualization element to the main thread: */
@@ -124,14 +166,19 @@ void* Extractor::masterExtractorThreadMethod(void)
 					}
 				while(keepGrowing);
 				
+				/* Release the extractor's share of the extraction budget: */
+				if(scheduler!=0)
+					scheduler->finishElement(this);
+				
 				/* Finish the element: */
 				extractor->finishElement();
 				}
 			else
 				{
 				/* Extract the visualization element: */
-				element.first=extractor->createElement(parameters);
-				element.second=requestID;
+				element.element=extractor->createElement(parameters);
+				element.requestID=requestID;
+				element.preview=false;
 				
 				if(extractor->getPipe()!=0)
 					{
@@ -156,8 +203,9 @@ void* Extractor::masterExtractorThreadMethod(void)
 				}
 			
 			/* Store an invalid visualization element: */
-			element.first=0;
-			element.second=requestID;
+			element.element=0;
+			element.requestID=requestID;
+			element.preview=false;
 			
 			/* Push this visualization element to the main thread: */
 			trackedElements.postNewValue();
@@ -195,16 +243,18 @@ void* Extractor::slaveExtractorThreadMethod(void)
 		#endif
 		
 		/* Start a new visualization element: */
-		std::pair<ElementPointer,unsigned int>& element=trackedElements.startNewValue();
+		TrackedElement& element=trackedElements.startNewValue();
 		if(requestID!=0)
 			{
-			/* Receive the new element's parameters from the master: */
+			/* Receive the new element's preview flag and parameters from the master: */
+			bool preview=extractor->getPipe()->read<unsigned char>()!=0;
 			Parameters* parameters=extractor->cloneParameters();
 			parameters->read(source);
 			
 			/* Start receiving the visualization element from the master: */
-			element.first=extractor->startSlaveElement(parameters);
-			element.second=requestID;
+			element.element=extractor->startSlaveElement(parameters);
+			element.requestID=requestID;
+			element.preview=preview;
 			
 			/* Receive fragments of the visualization element until finished: */
 			do
@@ -223,8 +273,9 @@ void* Extractor::slaveExtractorThreadMethod(void)
 			unsigned int requestID=extractor->getPipe()->read<unsigned int>();
 			
 			/* Store an invalid visualization element: */
-			element.first=0;
-			element.second=requestID;
+			element.element=0;
+			element.requestID=requestID;
+			element.preview=false;
 			
 			/* Push this visualization element to the main thread: */
 			trackedElements.postNewValue();
@@ -235,24 +286,29 @@ void* Extractor::slaveExtractorThreadMethod(void)
 	return 0;
 	}
 
-Extractor::Extractor(Extractor::Algorithm* sExtractor)
-	:extractor(sExtractor),
+Extractor::Extractor(Extractor::Algorithm* sExtractor,ExtractionScheduler* sScheduler)
+	:extractor(sExtractor),scheduler(sScheduler),
 	 #if !THREADS_CONFIG_CAN_CANCEL
 	 terminate(false),
 	 #endif
 	 finalElementPending(false),finalSeedRequestID(0),
 	 seedParameters(0),
-	 seedRequestID(0)
+	 seedRequestID(0),refineRequestID(0)
 	{
 	/* Initialize the extraction thread communications: */
 	for(int i=0;i<3;++i)
 		{
-		trackedElements.getBuffer(i).first=0;
-		trackedElements.getBuffer(i).second=0;
+		trackedElements.getBuffer(i).element=0;
+		trackedElements.getBuffer(i).requestID=0;
+		trackedElements.getBuffer(i).preview=false;
 		}
 	
 	if(extractor->isMaster())
 		{
+		/* Register with the extraction scheduler: */
+		if(scheduler!=0)
+			scheduler->addExtractor(this);
+		
 		/* Start the master-side extraction thread: */
 		extractorThread.start(this,&Extractor::masterExtractorThreadMethod);
 		}
@@ -292,6 +348,10 @@ Extractor::~Extractor(void)
 	#endif
 	extractorThread.join();
 	
+	/* Unregister from the extraction scheduler: */
+	if(scheduler!=0)
+		scheduler->removeExtractor(this);
+	
 	/* Clear the extractor thread communication: */
 	delete seedParameters;
 	
@@ -299,6 +359,12 @@ Extractor::~Extractor(void)
 	delete extractor;
 	}
 
+void Extractor::setSchedulingPriority(unsigned int newSchedulingPriority)
+	{
+	if(scheduler!=0)
+		scheduler->setPriority(this,newSchedulingPriority);
+	}
+
 void Extractor::seedRequest(unsigned int newSeedRequestID,Extractor::Parameters* newSeedParameters)
 	{
 	/* Request another visualization element extraction: */
@@ -314,6 +380,11 @@ void Extractor::finalize(unsigned int newFinalSeedRequestID)
 	{
 	finalElementPending=true;
 	finalSeedRequestID=newFinalSeedRequestID;
+	
+	/* Ask the extraction thread to refine the final seed request's preview element: */
+	Threads::Mutex::Lock seedRequestLock(seedRequestMutex);
+	refineRequestID=newFinalSeedRequestID;
+	seedRequestCond.signal();
 	}
 
 Extractor::ElementPointer Extractor::checkUpdates(void)
@@ -322,7 +393,7 @@ Extractor::ElementPointer Extractor::checkUpdates(void)
 	if(trackedElements.hasNewValue())
 		{
 		/* Delete the currently locked visualization element: */
-		trackedElements.getLockedValue().first=0;
+		trackedElements.getLockedValue().element=0;
 		
 		/* Lock the most recent visualization element: */
 		trackedElements.lockNewValue();
@@ -330,11 +401,11 @@ Extractor::ElementPointer Extractor::checkUpdates(void)
 	
 	/* Check if the final element from a concluded dragging operation or an immediate extraction has arrived: */
 	ElementPointer result=0;
-	if(finalElementPending&&trackedElements.getLockedValue().second==finalSeedRequestID)
+	if(finalElementPending&&!trackedElements.getLockedValue().preview&&trackedElements.getLockedValue().requestID==finalSeedRequestID)
 		{
 		/* Return the new element: */
-		result=trackedElements.getLockedValue().first;
-		trackedElements.getLockedValue().first=0;
+		result=trackedElements.getLockedValue().element;
+		trackedElements.getLockedValue().element=0;
 		
 		/* Reset the finalization marker: */
 		finalElementPending=false;
@@ -346,7 +417,7 @@ Extractor::ElementPointer Extractor::checkUpdates(void)
 void Extractor::glRenderAction(GLRenderState& renderState,bool transparent) const
 	{
 	/* Render the tracked visualization element if its transparency matches the parameter: */
-	const Element* element=trackedElements.getLockedValue().first.getPointer();
+	const Element* element=trackedElements.getLockedValue().element.getPointer();
 	if(element!=0&&element->usesTransparency()==transparent)
 		element->glRenderAction(renderState);
 	}
@@ -23,7 +23,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef EXTRACTOR_INCLUDED
 #define EXTRACTOR_INCLUDED
 
-#include <utility>
 #include <Misc/Autopointer.h>
 #include <Threads/Config.h>
 #include <Threads/Mutex.h>
@@ -40,6 +39,7 @@ class Element;
 }
 }
 class GLRenderState;
+class ExtractionScheduler;
 
 class Extractor
 	{
@@ -50,11 +50,22 @@ class Extractor
 	typedef Visualization::Abstract::Element Element;
 	typedef Misc::Autopointer<Element> ElementPointer;
 	
+	private:
+	struct TrackedElement // Structure to pass visualization elements from the extractor thread to the main thread
+		{
+		/* Elements: */
+		public:
+		ElementPointer element; // Pointer to the visualization element
+		unsigned int requestID; // ID of the seed request that created the visualization element
+		bool preview; // Flag whether the visualization element is a coarse preview that will be refined once its seed request is finalized
+		};
+	
 	/* Elements: */
 	protected:
 	
 	/* Persistent state: */
 	Algorithm* extractor; // Visualization element extractor
+	ExtractionScheduler* scheduler; // Scheduler assigning time slices to the extractor thread, or 0 to use fixed time slices
 	
 	/* Persistent extractor thread state: */
 	private:
@@ -72,9 +83,10 @@ class Extractor
 	Threads::Cond seedRequestCond; // Condition variable for the extractor thread to block on
 	Parameters* volatile seedParameters; // Extraction parameters for the most recently requested visualization element
 	volatile unsigned int seedRequestID; // ID of current seed request
+	volatile unsigned int refineRequestID; // ID of the finalized seed request whose preview needs to be refined
 	
 	/* Extractor thread communication output: */
-	Threads::TripleBuffer<std::pair<ElementPointer,unsigned int> > trackedElements; // Triple-buffer of currently tracked visualization elements and their IDs
+	Threads::TripleBuffer<TrackedElement> trackedElements; // Triple-buffer of currently tracked visualization elements and their IDs
 	
 	/* Private methods: */
 	private:
@@ -83,7 +95,7 @@ class Extractor
 	
 	/* Constructors and destructors: */
 	public:
-	Extractor(Algorithm* sExtractor); // Creates extractor for the given algorithm; inherits algorithm
+	Extractor(Algorithm* sExtractor,ExtractionScheduler* sScheduler =0); // Creates extractor for the given algorithm, scheduled by the optional extraction scheduler; inherits algorithm
 	virtual ~Extractor(void); // Destroys the extractor
 	
 	/* Methods: */
@@ -91,6 +103,7 @@ class Extractor
 		{
 		return extractor;
 		}
+	void setSchedulingPriority(unsigned int newSchedulingPriority); // Sets the extractor's share of the extraction budget relative to other extractors
 	void seedRequest(unsigned int newSeedRequestID,Parameters* newSeedParameters); // Posts a new seed request to the extraction thread
 	void finalize(unsigned int newFinalSeedRequestID); // Posts a finalization request for the given seed request ID
 	bool isFinalizationPending(void) const // Returns true if the main thread is waiting for a new final visualization element
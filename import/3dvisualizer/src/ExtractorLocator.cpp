@@ -79,7 +79,7 @@ void ExtractorLocator::busyFunction(float newCompletionPercentage)
 	}
 
 ExtractorLocator::ExtractorLocator(Vrui::LocatorTool* sLocatorTool,Visualizer* sApplication,Extractor::Algorithm* sExtractor,const Misc::ConfigurationFileSection* cfg)
-	:BaseLocator(sLocatorTool,sApplication),Extractor(sExtractor),
+	:BaseLocator(sLocatorTool,sApplication),Extractor(sExtractor,sApplication->extractionScheduler),
 	 settingsDialog(extractor->createSettingsDialog(Vrui::getWidgetManager())),
 	 busyDialog(createBusyDialog(extractor->getName())),
 	 locator(application->dataSet->getLocator()),
@@ -90,6 +90,9 @@ ExtractorLocator::ExtractorLocator(Vrui::LocatorTool* sLocatorTool,Visualizer* s
 	/* Set the algorithm's busy function: */
 	extractor->setBusyFunction(Misc::createFunctionCall(this,&ExtractorLocator::busyFunction));
 	
+	/* Give local locators preference over remote ones when extractors compete for time: */
+	setSchedulingPriority(2);
+	
 	#ifdef VISUALIZER_USE_COLLABORATION
 	if(application->sharedVisualizationClient!=0)
 		{
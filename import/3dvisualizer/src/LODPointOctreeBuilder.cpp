@@ -0,0 +1,427 @@
+/***********************************************************************
+LODPointOctreeBuilder - Program to convert scattered 3D point files in
+spreadsheet format into out-of-core level-of-detail point octree files.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/File.h>
+
+#include <Concrete/PointFileReader.h>
+#include <Concrete/LODPointOctreeFile.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct Point // Structure for points during octree construction
+	{
+	/* Elements: */
+	public:
+	Misc::Float32 pos[3]; // Point's Cartesian position
+	};
+
+class OctantSplitter // Functor to partition point arrays along one coordinate axis
+	{
+	/* Elements: */
+	private:
+	int axis; // Coordinate axis along which to partition
+	Misc::Float32 split; // Splitting plane position
+	
+	/* Constructors and destructors: */
+	public:
+	OctantSplitter(int sAxis,Misc::Float32 sSplit)
+		:axis(sAxis),split(sSplit)
+		{
+		}
+	
+	/* Methods: */
+	bool operator()(const Point& p) const // Returns true if the point is on the lower side of the splitting plane
+		{
+		return p.pos[axis]<split;
+		}
+	};
+
+class OctreeBuilder // Class to build an LOD point octree file from a temporary file of unordered points
+	{
+	/* Embedded classes: */
+	private:
+	typedef Visualization::Concrete::LODPointOctreeFile OctreeFile;
+	
+	/* Elements: */
+	unsigned int maxNodePoints; // Maximum number of points stored in a node
+	size_t maxInCorePoints; // Maximum number of points of a subtree to process in memory
+	unsigned int maxDepth; // Maximum depth of the octree, to limit subdivision of coincident points
+	std::string tempDirectory; // Directory in which to create temporary point files
+	Misc::File& octreeFile; // The octree file being written
+	Misc::UInt64 writeOffset; // Current write position in the octree file
+	std::vector<OctreeFile::NodeRecord> nodes; // Node table of the octree
+	Misc::UInt64 randomState; // State of the random number generator used for subsampling
+	
+	/* Private methods: */
+	Misc::UInt64 random(Misc::UInt64 range) // Returns a pseudo-random number in [0, range)
+		{
+		/* Advance a xorshift generator: */
+		randomState^=randomState<<13;
+		randomState^=randomState>>7;
+		randomState^=randomState<<17;
+		return randomState%range;
+		}
+	void sample(std::vector<Point>& lodPoints,size_t pointIndex,const Point& p) // Adds the given point to a reservoir sample of the points seen so far
+		{
+		if(lodPoints.size()<maxNodePoints)
+			lodPoints.push_back(p);
+		else
+			{
+			Misc::UInt64 slot=random(Misc::UInt64(pointIndex)+1);
+			if(slot<maxNodePoints)
+				lodPoints[slot]=p;
+			}
+		}
+	void writeNodePoints(unsigned int nodeIndex,const Point* points,size_t numPoints); // Writes the given points as the given node's point data
+	unsigned int createChildren(unsigned int nodeIndex); // Creates the eight children of the given node and returns the index of the first child
+	void buildInCore(unsigned int nodeIndex,const Misc::Float32 min[3],Misc::Float32 size,unsigned int depth,Point* points,size_t numPoints); // Builds the subtree rooted at the given node from the given in-memory points
+	void buildOutOfCore(unsigned int nodeIndex,const Misc::Float32 min[3],Misc::Float32 size,unsigned int depth,const std::string& pointFileName,size_t numPoints); // Builds the subtree rooted at the given node from the given temporary point file, and deletes the file
+	
+	/* Constructors and destructors: */
+	public:
+	OctreeBuilder(unsigned int sMaxNodePoints,size_t sMaxInCorePoints,const std::string& sTempDirectory,Misc::File& sOctreeFile,Misc::UInt64 sWriteOffset)
+		:maxNodePoints(sMaxNodePoints),maxInCorePoints(sMaxInCorePoints),maxDepth(24),
+		 tempDirectory(sTempDirectory),
+		 octreeFile(sOctreeFile),writeOffset(sWriteOffset),
+		 randomState(0x2545f4914f6cdd1dULL)
+		{
+		}
+	
+	/* Methods: */
+	std::string createTempFile(void); // Creates a new empty temporary point file and returns its name
+	void build(const Misc::Float32 min[3],Misc::Float32 size,const std::string& pointFileName,size_t numPoints); // Builds the octree from the given temporary point file, and deletes the file
+	const std::vector<OctreeFile::NodeRecord>& getNodes(void) const // Returns the node table
+		{
+		return nodes;
+		}
+	Misc::UInt64 getWriteOffset(void) const // Returns the current write position in the octree file
+		{
+		return writeOffset;
+		}
+	};
+
+void OctreeBuilder::writeNodePoints(unsigned int nodeIndex,const Point* points,size_t numPoints)
+	{
+	nodes[nodeIndex].numPoints=Misc::UInt32(numPoints);
+	nodes[nodeIndex].pointOffset=numPoints>0?writeOffset:0;
+	for(size_t i=0;i<numPoints;++i)
+		octreeFile.write(points[i].pos,3);
+	writeOffset+=Misc::UInt64(numPoints)*OctreeFile::pointSize;
+	}
+
+unsigned int OctreeBuilder::createChildren(unsigned int nodeIndex)
+	{
+	/* Append eight empty leaf nodes to the node table: */
+	unsigned int firstChildIndex=(unsigned int)nodes.size();
+	OctreeFile::NodeRecord child;
+	child.firstChildIndex=0;
+	child.numPoints=0;
+	child.pointOffset=0;
+	for(int i=0;i<8;++i)
+		nodes.push_back(child);
+	nodes[nodeIndex].firstChildIndex=firstChildIndex;
+	
+	return firstChildIndex;
+	}
+
+void OctreeBuilder::buildInCore(unsigned int nodeIndex,const Misc::Float32 min[3],Misc::Float32 size,unsigned int depth,Point* points,size_t numPoints)
+	{
+	/* Store all points in a leaf node if there are few enough, or if the maximum depth has been reached: */
+	if(numPoints<=maxNodePoints||depth>=maxDepth)
+		{
+		writeNodePoints(nodeIndex,points,numPoints);
+		return;
+		}
+	
+	/* Store a random subset of the points in the node: */
+	std::vector<Point> lodPoints;
+	lodPoints.reserve(maxNodePoints);
+	for(size_t i=0;i<numPoints;++i)
+		sample(lodPoints,i,points[i]);
+	writeNodePoints(nodeIndex,&lodPoints[0],lodPoints.size());
+	
+	/* Partition the points into the node's octants, in order of octant index: */
+	Misc::Float32 childSize=size*0.5f;
+	Misc::Float32 center[3];
+	for(int i=0;i<3;++i)
+		center[i]=min[i]+childSize;
+	Point* bounds[9];
+	bounds[0]=points;
+	bounds[8]=points+numPoints;
+	bounds[4]=std::partition(bounds[0],bounds[8],OctantSplitter(2,center[2]));
+	for(int z=0;z<8;z+=4)
+		{
+		bounds[z+2]=std::partition(bounds[z],bounds[z+4],OctantSplitter(1,center[1]));
+		for(int y=z;y<z+4;y+=2)
+			bounds[y+1]=std::partition(bounds[y],bounds[y+2],OctantSplitter(0,center[0]));
+		}
+	
+	/* Build the node's children: */
+	unsigned int firstChildIndex=createChildren(nodeIndex);
+	for(int childIndex=0;childIndex<8;++childIndex)
+		{
+		Misc::Float32 childMin[3];
+		for(int i=0;i<3;++i)
+			childMin[i]=childIndex&(0x1<<i)?center[i]:min[i];
+		buildInCore(firstChildIndex+childIndex,childMin,childSize,depth+1,bounds[childIndex],bounds[childIndex+1]-bounds[childIndex]);
+		}
+	}
+
+void OctreeBuilder::buildOutOfCore(unsigned int nodeIndex,const Misc::Float32 min[3],Misc::Float32 size,unsigned int depth,const std::string& pointFileName,size_t numPoints)
+	{
+	if(numPoints<=maxInCorePoints||depth>=maxDepth)
+		{
+		/* Read the points into memory: */
+		std::vector<Point> points(numPoints);
+		{
+		Misc::File pointFile(pointFileName.c_str(),"rb");
+		if(numPoints>0)
+			pointFile.readRaw(&points[0],numPoints*sizeof(Point));
+		}
+		unlink(pointFileName.c_str());
+		
+		/* Build the subtree in memory: */
+		buildInCore(nodeIndex,min,size,depth,numPoints>0?&points[0]:0,numPoints);
+		return;
+		}
+	
+	/* Create temporary point files for the node's children: */
+	Misc::Float32 childSize=size*0.5f;
+	Misc::Float32 center[3];
+	for(int i=0;i<3;++i)
+		center[i]=min[i]+childSize;
+	std::string childFileNames[8];
+	size_t childNumPoints[8];
+	std::vector<Point> lodPoints;
+	lodPoints.reserve(maxNodePoints);
+	{
+	Misc::File* childFiles[8];
+	for(int childIndex=0;childIndex<8;++childIndex)
+		{
+		childFileNames[childIndex]=createTempFile();
+		childFiles[childIndex]=new Misc::File(childFileNames[childIndex].c_str(),"wb");
+		childNumPoints[childIndex]=0;
+		}
+	
+	/* Stream the node's points into its subsample and its children's point files: */
+	Misc::File pointFile(pointFileName.c_str(),"rb");
+	const size_t blockSize=65536;
+	std::vector<Point> block(blockSize);
+	for(size_t blockStart=0;blockStart<numPoints;blockStart+=blockSize)
+		{
+		size_t numBlockPoints=std::min(blockSize,numPoints-blockStart);
+		pointFile.readRaw(&block[0],numBlockPoints*sizeof(Point));
+		for(size_t i=0;i<numBlockPoints;++i)
+			{
+			const Point& p=block[i];
+			sample(lodPoints,blockStart+i,p);
+			int childIndex=0x0;
+			for(int j=0;j<3;++j)
+				if(p.pos[j]>=center[j])
+					childIndex|=0x1<<j;
+			childFiles[childIndex]->writeRaw(&p,sizeof(Point));
+			++childNumPoints[childIndex];
+			}
+		}
+	
+	for(int childIndex=0;childIndex<8;++childIndex)
+		delete childFiles[childIndex];
+	}
+	unlink(pointFileName.c_str());
+	
+	/* Store the subsample in the node: */
+	writeNodePoints(nodeIndex,&lodPoints[0],lodPoints.size());
+	
+	/* Build the node's children: */
+	unsigned int firstChildIndex=createChildren(nodeIndex);
+	for(int childIndex=0;childIndex<8;++childIndex)
+		{
+		Misc::Float32 childMin[3];
+		for(int i=0;i<3;++i)
+			childMin[i]=childIndex&(0x1<<i)?center[i]:min[i];
+		buildOutOfCore(firstChildIndex+childIndex,childMin,childSize,depth+1,childFileNames[childIndex],childNumPoints[childIndex]);
+		}
+	}
+
+std::string OctreeBuilder::createTempFile(void)
+	{
+	std::string fileName=tempDirectory;
+	fileName.append("/LODPointOctreeBuilderXXXXXX");
+	std::vector<char> fileNameBuffer(fileName.begin(),fileName.end());
+	fileNameBuffer.push_back('\0');
+	int fd=mkstemp(&fileNameBuffer[0]);
+	if(fd<0)
+		Misc::throwStdErr("LODPointOctreeBuilder: Unable to create temporary file in directory %s",tempDirectory.c_str());
+	close(fd);
+	
+	return std::string(&fileNameBuffer[0]);
+	}
+
+void OctreeBuilder::build(const Misc::Float32 min[3],Misc::Float32 size,const std::string& pointFileName,size_t numPoints)
+	{
+	/* Create the root node: */
+	nodes.clear();
+	OctreeFile::NodeRecord root;
+	root.firstChildIndex=0;
+	root.numPoints=0;
+	root.pointOffset=0;
+	nodes.push_back(root);
+	
+	/* Build the tree recursively: */
+	buildOutOfCore(0,min,size,0,pointFileName,numPoints);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* pointFileName=0;
+	const char* octreeFileName=0;
+	double flatteningFactor=1.0/298.257;
+	double scaleFactor=1.0e-3;
+	unsigned int maxNodePoints=4096;
+	size_t memorySize=512;
+	const char* tempDirectory="/tmp";
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"flatteningFactor")==0&&i+1<argc)
+				flatteningFactor=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"scaleFactor")==0&&i+1<argc)
+				scaleFactor=atof(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"maxNodePoints")==0&&i+1<argc)
+				maxNodePoints=(unsigned int)atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"memorySize")==0&&i+1<argc)
+				memorySize=size_t(atol(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"tempDir")==0&&i+1<argc)
+				tempDirectory=argv[++i];
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else if(pointFileName==0)
+			pointFileName=argv[i];
+		else if(octreeFileName==0)
+			octreeFileName=argv[i];
+		else
+			std::cerr<<"Ignoring extra argument "<<argv[i]<<std::endl;
+		}
+	if(pointFileName==0||octreeFileName==0||maxNodePoints<1)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-flatteningFactor <factor>] [-scaleFactor <factor>] [-maxNodePoints <number of points>] [-memorySize <MB>] [-tempDir <directory>] <point file name> <octree file name>"<<std::endl;
+		return 1;
+		}
+	
+	typedef Visualization::Concrete::LODPointOctreeFile OctreeFile;
+	try
+		{
+		/* Open the octree file and reserve space for the header: */
+		Misc::File octreeFile(octreeFileName,"wb",Misc::File::LittleEndian);
+		char header[OctreeFile::headerSize];
+		memset(header,0,sizeof(header));
+		octreeFile.writeRaw(header,sizeof(header));
+		
+		/* Convert all points from the point file into a temporary file of raw points and calculate their bounding box: */
+		OctreeBuilder builder(maxNodePoints,memorySize*1024*1024/sizeof(Point),tempDirectory,octreeFile,OctreeFile::headerSize);
+		std::string rawPointFileName=builder.createTempFile();
+		size_t numPoints=0;
+		Misc::Float32 bbMin[3],bbMax[3];
+		for(int i=0;i<3;++i)
+			{
+			bbMin[i]=Misc::Float32(1.0e30);
+			bbMax[i]=Misc::Float32(-1.0e30);
+			}
+		{
+		Visualization::Concrete::PointFileReader reader(pointFileName,flatteningFactor,scaleFactor);
+		Misc::File rawPointFile(rawPointFileName.c_str(),"wb");
+		Point p;
+		while(reader.readPoint(p.pos))
+			{
+			for(int i=0;i<3;++i)
+				{
+				if(bbMin[i]>p.pos[i])
+					bbMin[i]=p.pos[i];
+				if(bbMax[i]<p.pos[i])
+					bbMax[i]=p.pos[i];
+				}
+			rawPointFile.writeRaw(&p,sizeof(Point));
+			}
+		numPoints=reader.getNumPoints();
+		}
+		std::cout<<numPoints<<" points parsed from "<<pointFileName<<std::endl;
+		
+		/* Calculate a cubic root domain slightly enlarged to contain all points on the lower sides of the octree's splitting planes: */
+		Misc::Float32 domainMin[3];
+		Misc::Float32 domainSize=0.0f;
+		for(int i=0;i<3;++i)
+			if(numPoints>0&&domainSize<bbMax[i]-bbMin[i])
+				domainSize=bbMax[i]-bbMin[i];
+		domainSize=domainSize*1.001f+1.0e-3f;
+		for(int i=0;i<3;++i)
+			domainMin[i]=numPoints>0?(bbMin[i]+bbMax[i]-domainSize)*0.5f:0.0f;
+		
+		/* Build the octree: */
+		builder.build(domainMin,domainSize,rawPointFileName,numPoints);
+		
+		/* Write the node table: */
+		const std::vector<OctreeFile::NodeRecord>& nodes=builder.getNodes();
+		for(std::vector<OctreeFile::NodeRecord>::const_iterator nIt=nodes.begin();nIt!=nodes.end();++nIt)
+			{
+			octreeFile.write(nIt->firstChildIndex);
+			octreeFile.write(nIt->numPoints);
+			octreeFile.write(nIt->pointOffset);
+			}
+		
+		/* Write the header: */
+		octreeFile.seekSet(0);
+		octreeFile.writeRaw(OctreeFile::getFileTag(),OctreeFile::fileTagSize);
+		octreeFile.write(Misc::UInt32(nodes.size()));
+		octreeFile.write(Misc::UInt32(maxNodePoints));
+		octreeFile.write(domainMin,3);
+		octreeFile.write(domainSize);
+		octreeFile.write(builder.getWriteOffset());
+		
+		std::cout<<"Octree with "<<nodes.size()<<" nodes written to "<<octreeFileName<<std::endl;
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<" while building octree file "<<octreeFileName<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
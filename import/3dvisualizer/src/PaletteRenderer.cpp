@@ -239,28 +239,29 @@ void PaletteRenderer::uploadTexture2D(VolumeRenderer::DataItem* dataItem,int axi
 		#endif
 		
 		/* Upload a texture slice: */
-		const Voxel* slicePtr=values+index*increments[axis];
+		int sliceIncrements[2];
+		const Voxel* slicePtr=getSliceValues(dataItem,axis,index,sliceIncrements);
 		switch(axis)
 			{
 			case 0:
 				glTexImage2D(GL_TEXTURE_2D,0,internalFormat,textureSize[2],textureSize[1],0,uploadFormat,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[1],increments[2],increments[1],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[1],sliceIncrements[0],sliceIncrements[1],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			
 			case 1:
 				glTexImage2D(GL_TEXTURE_2D,0,internalFormat,textureSize[2],textureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[0],increments[2],increments[0],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[0],sliceIncrements[0],sliceIncrements[1],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			
 			case 2:
 				glTexImage2D(GL_TEXTURE_2D,0,internalFormat,textureSize[1],textureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[1],size[0],increments[1],increments[0],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[1],size[0],sliceIncrements[0],sliceIncrements[1],uploadFormat,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			}
 		}
 	}
 
-void PaletteRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem) const
+void PaletteRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem,const VolumeBrickMap::Brick& brick) const
 	{
 	/* Get pointer to our own data item: */
 	DataItem* myDataItem=static_cast<DataItem*>(dataItem);
@@ -277,8 +278,8 @@ void PaletteRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem) const
 		glTexParameteri(GL_TEXTURE_3D,GL_TEXTURE_MIN_FILTER,interpolationMode);
 		}
 	
-	/* Upload a color map only if necessary: */
-	if(myDataItem->renderingPath==PalettedTexture&&myDataItem->uploadColorMap)
+	/* Upload a color map only if necessary (brick textures uploaded for the first time always need one): */
+	if(myDataItem->renderingPath==PalettedTexture&&(myDataItem->uploadColorMap||(myDataItem->uploadData&&!sharePalette)))
 		{
 		/* Set the texture's color map: */
 		#ifdef __SGI_IRIX__
@@ -302,18 +303,22 @@ void PaletteRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem) const
 			}
 		#endif
 		
-		/* Upload the texture block: */
+		/* Upload the brick texture: */
+		int brickTextureSize[3];
+		calcBrickTextureSize(brick,brickTextureSize);
+		const Voxel* brickValues=extractBrickValues(dataItem,brick);
 		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
 		glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_UNPACK_ROW_LENGTH,0); // increments[1]); // Seems to be a bug in OpenGL - consistent across SGI/nVidia platforms
+		glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
 		glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
-		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT,0); // increments[0]);
+		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT,0);
 		glPixelStorei(GL_UNPACK_SKIP_IMAGES,0);
 		#ifdef __SGI_IRIX__
-		glTexImage3D(GL_TEXTURE_3D,0,internalFormat,textureSize[2],textureSize[1],textureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,values);
+		glTexImage3D(GL_TEXTURE_3D,0,internalFormat,brickTextureSize[2],brickTextureSize[1],brickTextureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,0);
+		glTexSubImage3D(GL_TEXTURE_3D,0,0,0,0,brick.voxelSize[2],brick.voxelSize[1],brick.voxelSize[0],uploadFormat,GL_UNSIGNED_BYTE,brickValues);
 		#else
-		glTexImage3DEXT(GL_TEXTURE_3D,0,internalFormat,textureSize[2],textureSize[1],textureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,0);
-		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,size[2],size[1],size[0],uploadFormat,GL_UNSIGNED_BYTE,values);
+		glTexImage3DEXT(GL_TEXTURE_3D,0,internalFormat,brickTextureSize[2],brickTextureSize[1],brickTextureSize[0],0,uploadFormat,GL_UNSIGNED_BYTE,0);
+		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,brick.voxelSize[2],brick.voxelSize[1],brick.voxelSize[0],uploadFormat,GL_UNSIGNED_BYTE,brickValues);
 		#endif
 		}
 	}
@@ -511,6 +516,13 @@ void PaletteRenderer::setColorMap(const GLColorMap* newColorMap)
 		{
 		++colorMapVersion;
 		colorMap=newColorMap;
+		
+		/* Classify the voxel block's bricks against the new color map; entries with all-zero components do not contribute to the blended image: */
+		bool visibleValues[256];
+		const GLColorMap::Color* colors=colorMap->getColors();
+		for(int i=0;i<256;++i)
+			visibleValues[i]=colors[i][0]!=0.0f||colors[i][1]!=0.0f||colors[i][2]!=0.0f||colors[i][3]!=0.0f;
+		brickMap.classify(visibleValues);
 		}
 	}
 
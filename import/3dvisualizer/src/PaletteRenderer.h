@@ -68,7 +68,7 @@ class PaletteRenderer:public VolumeRenderer
 	
 	/* Protected methods inherited from VolumeRenderer: */
 	void uploadTexture2D(VolumeRenderer::DataItem* dataItem,int axis,int index) const;
-	void uploadTexture3D(VolumeRenderer::DataItem* dataItem) const;
+	void uploadTexture3D(VolumeRenderer::DataItem* dataItem,const VolumeBrickMap::Brick& brick) const;
 	void prepareRenderAxisAligned(VolumeRenderer::DataItem* dataItem) const;
 	void prepareRenderViewPerpendicular(VolumeRenderer::DataItem* dataItem) const;
 	
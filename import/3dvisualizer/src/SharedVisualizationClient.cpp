@@ -47,8 +47,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 Methods of class SharedVisualizationClient::RemoteLocator:
 *********************************************************/
 
-SharedVisualizationClient::RemoteLocator::RemoteLocator(SharedVisualizationClient::Algorithm* sExtractor)
-	:Extractor(sExtractor)
+SharedVisualizationClient::RemoteLocator::RemoteLocator(SharedVisualizationClient::Algorithm* sExtractor,ExtractionScheduler* sScheduler)
+	:Extractor(sExtractor,sScheduler)
 	{
 	}
 
@@ -113,7 +113,7 @@ void SharedVisualizationClient::receiveRemoteLocator(SharedVisualizationClient::
 	if(algorithm!=0)
 		{
 		/* Create a new remote locator and add it to the client's hash table: */
-		RemoteLocator* newRemoteLocator=new RemoteLocator(algorithm);
+		RemoteLocator* newRemoteLocator=new RemoteLocator(algorithm,application->extractionScheduler);
 		{
 		Threads::Mutex::Lock locatorLock(rcs->locatorMutex);
 		rcs->locators.setEntry(RemoteLocatorHash::Entry(newLocatorID,newRemoteLocator));
@@ -57,7 +57,7 @@ class SharedVisualizationClient:public Collaboration::ProtocolClient,private Sha
 		{
 		/* Constructors and destructors: */
 		public:
-		RemoteLocator(Algorithm* sExtractor); // Creates a remote locator for the given algorithm
+		RemoteLocator(Algorithm* sExtractor,ExtractionScheduler* sScheduler); // Creates a remote locator for the given algorithm, scheduled by the given extraction scheduler
 		
 		/* Methods from Extractor: */
 		virtual void update(void);
@@ -0,0 +1,85 @@
+/***********************************************************************
+SharedVoxelBlock - Class to describe a view into a block of byte-valued
+voxels owned by a reference-counted storage object, such as the vertex
+array of a Cartesian data set, so that volume renderers can render the
+block without creating private copies.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SHAREDVOXELBLOCK_INCLUDED
+#define SHAREDVOXELBLOCK_INCLUDED
+
+#include <stddef.h>
+#include <Misc/RefCounted.h>
+#include <Misc/Autopointer.h>
+
+class SharedVoxelBlock
+	{
+	/* Embedded classes: */
+	public:
+	typedef unsigned char Voxel; // Type for voxel data
+	
+	/* Elements: */
+	Misc::Autopointer<Misc::RefCounted> storage; // Object owning the voxel memory; kept alive as long as the view exists
+	const Voxel* voxels; // Pointer to the first voxel of the block
+	ptrdiff_t strides[3]; // Pointer strides between neighbouring voxels along each axis
+	Voxel valueMap[256]; // Table mapping stored voxel values to rendered voxel values
+	bool identityMap; // Flag if the value map is the identity, i.e., voxels can be used unchanged
+	
+	/* Constructors and destructors: */
+	SharedVoxelBlock(void) // Creates an invalid view
+		:voxels(0),identityMap(true)
+		{
+		for(int i=0;i<3;++i)
+			strides[i]=0;
+		for(int i=0;i<256;++i)
+			valueMap[i]=Voxel(i);
+		}
+	
+	/* Methods: */
+	bool isValid(void) const // Returns true if the view refers to a voxel block
+		{
+		return voxels!=0;
+		}
+	void updateIdentityMap(void) // Updates the identity map flag after the value map has been changed
+		{
+		identityMap=true;
+		for(int i=0;i<256&&identityMap;++i)
+			identityMap=valueMap[i]==Voxel(i);
+		}
+	void copySlab(const unsigned int size[3],unsigned int slabStart,unsigned int slabSize,Voxel* dest,const ptrdiff_t destStrides[3]) const // Copies the slab of the given number of z slices starting at the given z index of a block of the given size into the given array, mapping voxel values
+		{
+		const Voxel* sPlane=voxels+ptrdiff_t(slabStart)*strides[2];
+		Voxel* dPlane=dest;
+		for(unsigned int x=0;x<size[0];++x,sPlane+=strides[0],dPlane+=destStrides[0])
+			{
+			const Voxel* sRow=sPlane;
+			Voxel* dRow=dPlane;
+			for(unsigned int y=0;y<size[1];++y,sRow+=strides[1],dRow+=destStrides[1])
+				{
+				const Voxel* sPtr=sRow;
+				Voxel* dPtr=dRow;
+				for(unsigned int z=0;z<slabSize;++z,sPtr+=strides[2],dPtr+=destStrides[2])
+					*dPtr=valueMap[*sPtr];
+				}
+			}
+		}
+	};
+
+#endif
@@ -46,7 +46,7 @@ SingleChannelRaycaster::DataItem::DataItem(void)
 	if(haveFloatTextures)
 		GLARBTextureFloat::initExtension();
 	GLEXTTexture3D::initExtension();
-
+	
 	/* Create the volume texture object: */
 	glGenTextures(1,&volumeTextureID);
 	
@@ -123,7 +123,32 @@ void SingleChannelRaycaster::bindShader(const Raycaster::PTransform& pmv,const R
 	if(myDataItem->volumeTextureVersion!=dataVersion)
 		{
 		/* Upload the new volume data: */
-		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,dataSize[0],dataSize[1],dataSize[2],GL_LUMINANCE,GL_UNSIGNED_BYTE,data);
+		if(data!=0)
+			glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,dataSize[0],dataSize[1],dataSize[2],GL_LUMINANCE,GL_UNSIGNED_BYTE,data);
+		else
+			{
+			/* Stage the shared voxel block in slabs of z slices to limit temporary memory: */
+			unsigned int sliceSize=dataSize[0]*dataSize[1];
+			unsigned int slabSize=sliceSize!=0?(4U*1024U*1024U)/sliceSize:1U;
+			if(slabSize<1U)
+				slabSize=1U;
+			if(slabSize>dataSize[2])
+				slabSize=dataSize[2];
+			Voxel* slab=new Voxel[size_t(sliceSize)*size_t(slabSize)];
+			ptrdiff_t slabStrides[3];
+			slabStrides[0]=1;
+			slabStrides[1]=dataSize[0];
+			slabStrides[2]=sliceSize;
+			for(unsigned int slabStart=0;slabStart<dataSize[2];slabStart+=slabSize)
+				{
+				unsigned int numSlices=dataSize[2]-slabStart;
+				if(numSlices>slabSize)
+					numSlices=slabSize;
+				sharedData.copySlab(dataSize,slabStart,numSlices,slab,slabStrides);
+				glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,slabStart,dataSize[0],dataSize[1],numSlices,GL_LUMINANCE,GL_UNSIGNED_BYTE,slab);
+				}
+			delete[] slab;
+			}
 		
 		/* Mark the volume texture as up-to-date: */
 		myDataItem->volumeTextureVersion=dataVersion;
@@ -162,6 +187,13 @@ SingleChannelRaycaster::SingleChannelRaycaster(const unsigned int sDataSize[3],c
 	{
 	}
 
+SingleChannelRaycaster::SingleChannelRaycaster(const unsigned int sDataSize[3],const Raycaster::Box& sDomain,const SharedVoxelBlock& sSharedData)
+	:Raycaster(sDataSize,sDomain),
+	 data(0),sharedData(sSharedData),dataVersion(0),
+	 colorMap(0),transparencyGamma(1.0f)
+	{
+	}
+
 SingleChannelRaycaster::~SingleChannelRaycaster(void)
 	{
 	/* Delete the volume dataset: */
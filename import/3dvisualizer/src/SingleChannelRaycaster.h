@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLColorMap.h>
 
 #include <Raycaster.h>
+#include <SharedVoxelBlock.h>
 
 class SingleChannelRaycaster:public Raycaster
 	{
@@ -54,7 +55,8 @@ class SingleChannelRaycaster:public Raycaster
 	
 	/* Elements: */
 	protected:
-	Voxel* data; // Pointer to the volume dataset
+	Voxel* data; // Pointer to the private volume dataset; null if the raycaster renders a shared voxel block
+	SharedVoxelBlock sharedData; // View into a shared voxel block rendered instead of the private volume dataset
 	unsigned int dataVersion; // Version number of the volume dataset to track changes
 	const GLColorMap* colorMap; // Pointer to the color map
 	GLfloat transparencyGamma; // Adjustment factor for color map's overall opacity
@@ -69,6 +71,7 @@ class SingleChannelRaycaster:public Raycaster
 	/* Constructors and destructors: */
 	public:
 	SingleChannelRaycaster(const unsigned int sDataSize[3],const Box& sDomain); // Creates a volume renderer
+	SingleChannelRaycaster(const unsigned int sDataSize[3],const Box& sDomain,const SharedVoxelBlock& sSharedData); // Creates a volume renderer for a shared voxel block without allocating a private volume dataset
 	virtual ~SingleChannelRaycaster(void); // Destroys the raycaster
 	
 	/* Methods from GLObject: */
@@ -78,7 +81,15 @@ class SingleChannelRaycaster:public Raycaster
 	virtual void setStepSize(Scalar newStepSize);
 	
 	/* New methods: */
-	const Voxel* getData(void) const // Returns pointer to the volume dataset
+	bool isDataShared(void) const // Returns true if the raycaster renders a shared voxel block
+		{
+		return data==0;
+		}
+	size_t getPrivateMemorySize(void) const // Returns the size of the private volume dataset in bytes
+		{
+		return data!=0?size_t(dataSize[0])*size_t(dataSize[1])*size_t(dataSize[2])*sizeof(Voxel):0;
+		}
+	const Voxel* getData(void) const // Returns pointer to the volume dataset; null if the raycaster renders a shared voxel block
 		{
 		return data;
 		}
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define VISUALIZATION_TEMPLATIZED_CARTESIAN_INCLUDED
 
 #include <Misc/Array.h>
+#include <Misc/Autopointer.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -32,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Templatized/Tesseract.h>
 #include <Templatized/LinearIndexID.h>
 #include <Templatized/IteratorWrapper.h>
+#include <Templatized/SharedValueArray.h>
 
 namespace Visualization {
 
@@ -247,6 +249,7 @@ class Cartesian
 	private:
 	Index numVertices; // Number of vertices in data set in each dimension
 	Array vertices; // Array of vertices defining data set
+	mutable Misc::Autopointer<SharedValueArray<Value> > vertexStorage; // Reference-counted owner of the vertex array once it has been shared with other objects
 	int vertexStrides[dimension]; // Array of pointer stride values in the vertex array
 	Index numCells; // Number of cells in data set in each dimension
 	int vertexOffsets[CellTopology::numVertices]; // Array of pointer offsets from a cell's base vertex to all cell vertices
@@ -280,6 +283,7 @@ class Cartesian
 		{
 		return vertices;
 		}
+	SharedValueArray<Value>* shareVertices(void) const; // Hands ownership of the vertex array to a reference-counted storage object and returns it; the array must not be resized through getVertices() afterwards
 	Point getVertexPosition(const Index& vertexIndex) const; // Returns a vertex' position
 	const Value& getVertexValue(const Index& vertexIndex) const // Returns a vertex' data value
 		{
@@ -356,6 +356,7 @@ class Curvilinear
 		return numCells;
 		}
 	void finalizeGrid(void); // Recalculates derived grid information after grid structure change
+	void finalizeGrid(const char* sourceFileName); // Ditto; reuses or updates the cell center tree cached alongside the given source file
 	CellID findClosestCell(const Point& position) const; // Finds the cell whose center is closest to the given position, or an invalid ID if there is no close cell
 	Scalar getLocatorEpsilon(void) const // Returns the current default accuracy threshold for locators working on this data set
 		{
@@ -30,6 +30,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace Cluster {
 class MulticastPipe;
 }
+namespace IO {
+class File;
+class SeekableFile;
+}
 
 namespace Visualization {
 
@@ -160,6 +164,9 @@ class IndexedTriangleSet:public GLObject
 		}
 	void receive(void); // Receives triangle set data via multicast pipe until next flush() point
 	void flush(void); // Sends pending triangle set data across the multicast pipe and terminates receive() method on slaves
+	void write(IO::File& file) const; // Writes all vertices and triangles to the given binary file
+	static bool check(IO::SeekableFile& file); // Returns true if the given binary file contains a complete triangle set of this vertex type at its current read position; does not change the read position
+	void read(IO::File& file); // Replaces the triangle set's contents with vertices and triangles read from the given binary file; caller must flush() to terminate receive() method on slaves
 	size_t getNumVertices(void) const // Returns number of vertices currently in buffer
 		{
 		return numVertices;
@@ -0,0 +1,68 @@
+/***********************************************************************
+IsosurfacePreviewer - Class to quickly extract coarse full-extent
+previews of isosurfaces while a seeded isosurface is being dragged. The
+generic version does not support previews; data set types that can
+create previews provide specialized versions.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_TEMPLATIZED_ISOSURFACEPREVIEWER_INCLUDED
+#define VISUALIZATION_TEMPLATIZED_ISOSURFACEPREVIEWER_INCLUDED
+
+#include <stddef.h>
+
+namespace Visualization {
+
+namespace Templatized {
+
+template <class DataSetParam,class ScalarExtractorParam,class IsosurfaceParam>
+class IsosurfacePreviewer
+	{
+	/* Embedded classes: */
+	public:
+	typedef DataSetParam DataSet; // Type of the data set the isosurface previewer works on
+	typedef ScalarExtractorParam ScalarExtractor; // Type to extract scalar values from a data set
+	typedef typename ScalarExtractor::Scalar VScalar; // Value type of scalar extractor
+	typedef IsosurfaceParam Isosurface; // Type of isosurface representation
+	
+	/* Constructors and destructors: */
+	public:
+	IsosurfacePreviewer(const DataSet* sDataSet,const ScalarExtractor& sScalarExtractor) // Creates an isosurface previewer for the given data set and scalar extractor
+		{
+		}
+	
+	/* Methods: */
+	bool canPreview(void) const // Returns true if the previewer can create isosurface previews
+		{
+		return false;
+		}
+	void update(const DataSet* newDataSet,const ScalarExtractor& newScalarExtractor) // Sets a new data set and scalar extractor for subsequent previews
+		{
+		}
+	bool extractPreview(VScalar isovalue,size_t maxNumTriangles,double maxTime,Isosurface& isosurface) // Extracts a coarse isosurface preview whose size and extraction time fit the given budgets; returns false if no preview was created
+		{
+		return false;
+		}
+	};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+/***********************************************************************
+IsosurfacePreviewerCartesian - Specialized isosurface previewer class
+for Cartesian data sets, using a pyramid of per-block minimum/maximum
+values to extract coarse isosurfaces from subsampled grids.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_TEMPLATIZED_ISOSURFACEPREVIEWERCARTESIAN_INCLUDED
+#define VISUALIZATION_TEMPLATIZED_ISOSURFACEPREVIEWERCARTESIAN_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/Array.h>
+
+#include <Templatized/IsosurfacePreviewer.h>
+
+/* Forward declarations: */
+namespace Visualization {
+namespace Templatized {
+template <class ScalarParam,int dimensionParam,class ValueParam>
+class Cartesian;
+template <class CellTopologyParam>
+class IsosurfaceCaseTable;
+}
+}
+
+namespace Visualization {
+
+namespace Templatized {
+
+template <class ScalarParam,class ValueParam,class ScalarExtractorParam,class IsosurfaceParam>
+class IsosurfacePreviewer<Cartesian<ScalarParam,3,ValueParam>,ScalarExtractorParam,IsosurfaceParam>
+	{
+	/* Embedded classes: */
+	public:
+	typedef Cartesian<ScalarParam,3,ValueParam> DataSet; // Type of the data set the isosurface previewer works on
+	typedef typename DataSet::Scalar Scalar; // Scalar type of the data set's domain
+	typedef typename DataSet::Point Point; // Type for points in the data set's domain
+	typedef typename DataSet::Vector Vector; // Type for vectors in the data set's domain
+	typedef typename DataSet::Index Index; // Type for vertex and cell indices
+	typedef ScalarExtractorParam ScalarExtractor; // Type to extract scalar values from a data set
+	typedef typename ScalarExtractor::Scalar VScalar; // Value type of scalar extractor
+	typedef IsosurfaceParam Isosurface; // Type of isosurface representation
+	
+	private:
+	typedef typename DataSet::CellTopology CellTopology; // Topology of the data set's cells
+	typedef IsosurfaceCaseTable<CellTopology> CaseTable; // Type of isosurface case table
+	typedef typename Isosurface::Vertex Vertex; // Type of vertices stored in isosurface
+	typedef typename Isosurface::Index VertexIndex; // Type for vertex indices in the isosurface
+	
+	struct ValueRange // Structure for the range of scalar values inside a block of cells
+		{
+		/* Elements: */
+		public:
+		VScalar min,max; // Minimum and maximum scalar value
+		};
+	
+	typedef Misc::Array<ValueRange,3> RangeArray; // Type for arrays of block value ranges forming one pyramid level
+	
+	/* Elements: */
+	const DataSet* dataSet; // Data set the isosurface previewer works on
+	ScalarExtractor scalarExtractor; // Scalar extractor working on data set
+	std::vector<RangeArray*> levels; // Min/max pyramid; levels[i] contains value ranges of blocks of 2^(i+1) cells along each axis
+	double blockTime; // Running estimate of the time to extract the isosurface fragment of one active block, in seconds
+	double blockNumTriangles; // Running estimate of the number of triangles created by one active block
+	
+	/* Private methods: */
+	void clearPyramid(void); // Deletes the current min/max pyramid
+	void buildPyramid(void); // Builds the min/max pyramid for the current data set and scalar extractor
+	static size_t countActiveBlocks(const RangeArray& level,VScalar isovalue); // Returns the number of blocks in the given pyramid level that potentially intersect the isosurface
+	
+	/* Constructors and destructors: */
+	public:
+	IsosurfacePreviewer(const DataSet* sDataSet,const ScalarExtractor& sScalarExtractor); // Creates an isosurface previewer for the given data set and scalar extractor
+	private:
+	IsosurfacePreviewer(const IsosurfacePreviewer& source); // Prohibit copy constructor
+	IsosurfacePreviewer& operator=(const IsosurfacePreviewer& source); // Prohibit assignment operator
+	public:
+	~IsosurfacePreviewer(void); // Destroys the isosurface previewer
+	
+	/* Methods: */
+	bool canPreview(void) const // Returns true if the previewer can create isosurface previews
+		{
+		return true;
+		}
+	void update(const DataSet* newDataSet,const ScalarExtractor& newScalarExtractor); // Sets a new data set and scalar extractor for subsequent previews; invalidates the min/max pyramid
+	bool extractPreview(VScalar isovalue,size_t maxNumTriangles,double maxTime,Isosurface& isosurface); // Extracts a coarse isosurface preview whose size and extraction time fit the given budgets; returns false if no preview was created
+	};
+
+}
+
+}
+
+#ifndef VISUALIZATION_TEMPLATIZED_ISOSURFACEPREVIEWERCARTESIAN_IMPLEMENTATION
+#include <Templatized/IsosurfacePreviewerCartesian.icpp>
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+/***********************************************************************
+LocatorCache - Class to store derived point location data of a data set,
+such as its cell center kd-tree, in a cache file associated with the
+data set's source file.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Templatized/LocatorCache.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <IO/OpenFile.h>
+
+namespace Visualization {
+
+namespace Templatized {
+
+namespace {
+
+/**************
+Helper objects:
+**************/
+
+static const char locatorCacheFileHeader[24]="Visualizer Locator 1.0\n"; // Header including terminating NUL
+
+}
+
+/*****************************
+Methods of class LocatorCache:
+*****************************/
+
+LocatorCache::LocatorCache(const char* sourceFileName)
+	:valid(false),
+	 sourceSize(0),sourceModTime(0)
+	{
+	/* Bail out if caching is disabled: */
+	if(getenv("VISUALIZER_NO_LOCATORCACHE")!=0)
+		return;
+	
+	/* Inspect the source file: */
+	struct stat sourceStat;
+	if(sourceFileName==0||stat(sourceFileName,&sourceStat)!=0||!S_ISREG(sourceStat.st_mode))
+		return;
+	sourceSize=Misc::UInt64(sourceStat.st_size);
+	sourceModTime=Misc::SInt64(sourceStat.st_mtime);
+	
+	/* Create the cache file name and a temporary file name unique to this host and process: */
+	cacheFileName=sourceFileName;
+	cacheFileName.append(".locatorcache");
+	char hostName[256];
+	if(gethostname(hostName,sizeof(hostName))!=0)
+		hostName[0]='\0';
+	hostName[sizeof(hostName)-1]='\0';
+	char tempSuffix[300];
+	snprintf(tempSuffix,sizeof(tempSuffix),".%s.%d.tmp",hostName,int(getpid()));
+	tempFileName=cacheFileName;
+	tempFileName.append(tempSuffix);
+	
+	valid=true;
+	}
+
+LocatorCache::MemMappedFilePtr LocatorCache::open(void) const
+	{
+	MemMappedFilePtr result;
+	if(!valid)
+		return result;
+	
+	try
+		{
+		/* Map the cache file: */
+		result=new IO::MemMappedFile(cacheFileName.c_str());
+		
+		/* Check the header: */
+		char header[sizeof(locatorCacheFileHeader)];
+		result->read<char>(header,sizeof(header));
+		if(memcmp(header,locatorCacheFileHeader,sizeof(header))!=0)
+			return MemMappedFilePtr();
+		
+		/* Check that the cache file is current with the source file: */
+		Misc::UInt64 cacheSourceSize;
+		result->readRaw(&cacheSourceSize,sizeof(Misc::UInt64));
+		Misc::SInt64 cacheSourceModTime;
+		result->readRaw(&cacheSourceModTime,sizeof(Misc::SInt64));
+		if(cacheSourceSize!=sourceSize||cacheSourceModTime!=sourceModTime)
+			return MemMappedFilePtr();
+		}
+	catch(std::runtime_error)
+		{
+		/* Treat any problem as a missing cache file: */
+		return MemMappedFilePtr();
+		}
+	
+	return result;
+	}
+
+IO::FilePtr LocatorCache::create(void)
+	{
+	IO::FilePtr result;
+	if(!valid)
+		return result;
+	
+	try
+		{
+		/* Create the temporary cache file: */
+		result=IO::openFile(tempFileName.c_str(),IO::File::WriteOnly);
+		
+		/* Write the header and the source file's identification; the header pads the identification to 8-byte alignment: */
+		result->write<char>(locatorCacheFileHeader,sizeof(locatorCacheFileHeader));
+		result->writeRaw(&sourceSize,sizeof(Misc::UInt64));
+		result->writeRaw(&sourceModTime,sizeof(Misc::SInt64));
+		}
+	catch(std::runtime_error)
+		{
+		/* The source file's directory is probably not writable; don't cache: */
+		result=0;
+		}
+	
+	return result;
+	}
+
+void LocatorCache::commit(IO::FilePtr& cacheFile)
+	{
+	/* Close the temporary file: */
+	cacheFile=0;
+	
+	/* Atomically replace the cache file, in case other cluster nodes are reading it concurrently: */
+	if(rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+		unlink(tempFileName.c_str());
+	}
+
+void LocatorCache::discard(IO::FilePtr& cacheFile)
+	{
+	/* Close and delete the temporary file: */
+	cacheFile=0;
+	unlink(tempFileName.c_str());
+	}
+
+}
+
+}
@@ -0,0 +1,70 @@
+/***********************************************************************
+LocatorCache - Class to store derived point location data of a data set,
+such as its cell center kd-tree, in a cache file associated with the
+data set's source file.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_TEMPLATIZED_LOCATORCACHE_INCLUDED
+#define VISUALIZATION_TEMPLATIZED_LOCATORCACHE_INCLUDED
+
+#include <string>
+#include <Misc/SizedTypes.h>
+#include <Misc/Autopointer.h>
+#include <IO/File.h>
+#include <IO/MemMappedFile.h>
+
+namespace Visualization {
+
+namespace Templatized {
+
+class LocatorCache
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::Autopointer<IO::MemMappedFile> MemMappedFilePtr; // Type for pointers to memory-mapped cache files
+	
+	/* Elements: */
+	private:
+	bool valid; // Flag whether the source file exists and caching is enabled
+	std::string cacheFileName; // Name of the cache file associated with the source file
+	std::string tempFileName; // Name of the temporary file to which a new cache file is written
+	Misc::UInt64 sourceSize; // Size of the source file
+	Misc::SInt64 sourceModTime; // Modification time of the source file
+	
+	/* Constructors and destructors: */
+	public:
+	LocatorCache(const char* sourceFileName); // Creates a cache associated with the given source file; caching can be disabled by setting environment variable VISUALIZER_NO_LOCATORCACHE
+	
+	/* Methods: */
+	bool isValid(void) const // Returns true if the cache can be used
+		{
+		return valid;
+		}
+	MemMappedFilePtr open(void) const; // Returns the memory-mapped cache file positioned behind its header if it is current with the source file; returns null pointer otherwise
+	IO::FilePtr create(void); // Creates a new temporary cache file and writes its header; returns null pointer if the cache file can not be created
+	void commit(IO::FilePtr& cacheFile); // Closes the given cache file returned by create() and atomically replaces any existing cache file with it
+	void discard(IO::FilePtr& cacheFile); // Closes the given cache file returned by create() and deletes it
+	};
+
+}
+
+}
+
+#endif
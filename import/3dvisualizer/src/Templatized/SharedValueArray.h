@@ -0,0 +1,84 @@
+/***********************************************************************
+SharedValueArray - Reference-counted storage for arrays of data set
+values, to share a data set's value array with other objects (such as
+volume renderers) without copying it.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualizer (Visualizer).
+
+The 3D Data Visualizer is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The 3D Data Visualizer is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualizer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef VISUALIZATION_TEMPLATIZED_SHAREDVALUEARRAY_INCLUDED
+#define VISUALIZATION_TEMPLATIZED_SHAREDVALUEARRAY_INCLUDED
+
+#include <stddef.h>
+#include <Misc/RefCounted.h>
+
+namespace Visualization {
+
+namespace Templatized {
+
+template <class ValueParam>
+class SharedValueArray:public Misc::RefCounted
+	{
+	/* Embedded classes: */
+	public:
+	typedef ValueParam Value; // Type of stored values
+	
+	/* Elements: */
+	private:
+	size_t numValues; // Number of values in the array
+	Value* values; // The value array, allocated with new[]
+	
+	/* Constructors and destructors: */
+	public:
+	SharedValueArray(size_t sNumValues,Value* sValues) // Adopts the given value array; array will be deleted when the last reference goes away
+		:numValues(sNumValues),values(sValues)
+		{
+		}
+	private:
+	SharedValueArray(const SharedValueArray& source); // Prohibit copy constructor
+	SharedValueArray& operator=(const SharedValueArray& source); // Prohibit assignment operator
+	public:
+	virtual ~SharedValueArray(void)
+		{
+		delete[] values;
+		}
+	
+	/* Methods: */
+	size_t getNumValues(void) const // Returns the number of values in the array
+		{
+		return numValues;
+		}
+	size_t getMemorySize(void) const // Returns the size of the value array in bytes
+		{
+		return numValues*sizeof(Value);
+		}
+	const Value* getValues(void) const // Returns the value array
+		{
+		return values;
+		}
+	Value* getValues(void) // Ditto
+		{
+		return values;
+		}
+	};
+
+}
+
+}
+
+#endif
@@ -2,7 +2,7 @@
 Simplical - Base class for vertex-centered simplical (unstructured)
 data sets containing arbitrary value types (scalars, vectors, tensors,
 etc.).
-Copyright (c) 2004-2011 Oliver Kreylos
+Copyright (c) 2004-2014 Oliver Kreylos
 
 This file is part of the 3D Data Visualizer (Visualizer).
 
@@ -24,9 +24,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef VISUALIZATION_TEMPLATIZED_SIMPLICAL_INCLUDED
 #define VISUALIZATION_TEMPLATIZED_SIMPLICAL_INCLUDED
 
-#include <utility>
-#include <Misc/PoolAllocator.h>
-#include <Misc/HashTable.h>
+#include <vector>
+#include <Misc/UnorderedTuple.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -35,7 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Geometry/ArrayKdTree.h>
 
 #include <Templatized/Simplex.h>
-#include <Templatized/PointerID.h>
+#include <Templatized/LinearIndexID.h>
 #include <Templatized/IteratorWrapper.h>
 
 namespace Visualization {
@@ -61,24 +60,31 @@ class Simplical
 	/* Definition of the data set's value space: */
 	typedef ValueParam Value; // Data set's value type
 	
+	/* First batch of data set interface classes: */
+	typedef LinearIndexID VertexID; // ID type for vertices
+	typedef VertexID::Index VertexIndex; // Index type for vertices
+	typedef Misc::UnorderedTuple<VertexIndex,2> EdgeID; // ID type for cell edges
+	typedef LinearIndexID CellID; // ID type for cells
+	typedef CellID::Index CellIndex; // Index type for cells
+	
 	/* Low-level definitions of data set storage: */
-	struct GridVertex // Structure for valued grid vertices
+	struct GridVertex // Proxy structure to access the components of a grid vertex, which are stored in separate arrays
 		{
 		/* Elements: */
 		public:
-		Point pos; // Position of grid vertex in data set's domain
-		Value value; // Grid vertex' value
-		GridVertex* succ; // Pointer to next grid vertex in data set
+		Point& pos; // Position of grid vertex in data set's domain
+		Value& value; // Grid vertex' value
 		
 		/* Constructors and destructors: */
-		GridVertex(void) // Dummy constructor
-			:succ(0)
+		GridVertex(Point& sPos,Value& sValue) // Elementwise constructor
+			:pos(sPos),value(sValue)
 			{
 			}
-		GridVertex(const Point& sPos,const Value& sValue) // Elementwise constructor
-			:pos(sPos),value(sValue),
-			 succ(0)
+		
+		/* Methods: */
+		GridVertex* operator->(void) // Allows grid vertex iterators to return proxies from their arrow operators
 			{
+			return this;
 			}
 		};
 	
@@ -88,17 +94,18 @@ class Simplical
 		
 		/* Elements: */
 		private:
-		GridVertex* vertex; // Vertex pointed to by iterator
+		Simplical* ds; // Pointer to data set containing the vertex
+		VertexIndex index; // Index of vertex pointed to by iterator
 		
 		/* Constructors and destructors: */
 		public:
 		GridVertexIterator(void) // Creates invalid iterator
-			:vertex(0)
+			:ds(0),index(~VertexIndex(0))
 			{
 			}
 		private:
-		GridVertexIterator(GridVertex* sVertex) // Creates iterator to the given vertex
-			:vertex(sVertex)
+		GridVertexIterator(Simplical* sDs,VertexIndex sIndex) // Creates iterator to the given vertex
+			:ds(sDs),index(sIndex)
 			{
 			}
 		
@@ -106,74 +113,73 @@ class Simplical
 		public:
 		friend bool operator==(const GridVertexIterator& vi1,const GridVertexIterator& vi2) // Compares two vertex iterators for equality
 			{
-			return vi1.vertex==vi2.vertex;
+			return vi1.index==vi2.index;
 			}
 		friend bool operator!=(const GridVertexIterator& vi1,const GridVertexIterator& vi2) // Compares two vertex iterators for inequality
 			{
-			return vi1.vertex!=vi2.vertex;
+			return vi1.index!=vi2.index;
 			}
-		GridVertex& operator*(void) const // Returns vertex pointed to by the iterator
+		VertexID getID(void) const // Returns ID of vertex pointed to by the iterator
 			{
-			return *vertex;
+			return VertexID(index);
 			}
-		GridVertex* operator->(void) const // Returns vertex pointed to by the iterator
+		GridVertex operator*(void) const // Returns vertex pointed to by the iterator
 			{
-			return vertex;
+			return GridVertex(ds->gridVertices[index],ds->vertexValues[index]);
+			}
+		GridVertex operator->(void) const // Returns vertex pointed to by the iterator
+			{
+			return GridVertex(ds->gridVertices[index],ds->vertexValues[index]);
 			}
 		GridVertexIterator& operator++(void) // Pre-increment operator
 			{
-			vertex=vertex->succ;
+			++index;
 			return *this;
 			}
 		};
 	
 	private:
-	struct GridCell // Structure for simplical grid cells
+	typedef std::vector<Point> GridVertexList; // Type to store the positions of all grid vertices
+	typedef std::vector<Value> VertexValueList; // Type to store the values of all grid vertices
+	typedef std::vector<VertexIndex> CellVertexList; // Type to store the vertex indices of all grid cells, CellTopology::numVertices per cell
+	typedef std::vector<CellIndex> CellNeighbourList; // Type to store the neighbour indices of all grid cells, CellTopology::numFaces per cell
+	typedef Misc::UnorderedTuple<VertexIndex,CellTopology::numFaceVertices> GridFace; // Type to identify faces of grid cells
+	
+	struct CellFace // Structure to associate a grid face with the cell face defining it; used during data set construction
 		{
 		/* Elements: */
 		public:
-		GridVertex* vertices[CellTopology::numVertices]; // Array of pointers to cell's vertices
-		GridCell* neighbours[CellTopology::numFaces]; // Array of pointers to neighbouring cells
-		GridCell* succ; // Pointer to next grid cell in data set
+		GridFace face; // The grid face
+		CellIndex cellFaceIndex; // Index of cell face defining the grid face, i.e., cell index times number of cell faces plus face index
 		
-		/* Constructors and destructors: */
-		GridCell(void); // Creates a nonconnected grid cell with uninitialized vertex pointers
+		/* Methods: */
+		friend bool operator<(const CellFace& cf1,const CellFace& cf2) // Lexicographically compares the faces' sorted vertex indices
+			{
+			const VertexIndex* v1=cf1.face.getElements();
+			const VertexIndex* v2=cf2.face.getElements();
+			for(int i=0;i<CellTopology::numFaceVertices;++i)
+				if(v1[i]!=v2[i])
+					return v1[i]<v2[i];
+			return false;
+			}
 		};
 	
-	struct GridFace // Structure for faces of grid cells
+	struct ConnectCellsArgs // Structure to hold arguments for cell connection threads
 		{
 		/* Elements: */
 		public:
-		GridVertex* vertices[CellTopology::numFaceVertices]; // Array of pointers to face's vertices
+		CellFace* begin; // First face record in the range of records processed by the thread
+		CellFace* end; // Behind last face record in the range
 		
 		/* Constructors and destructors: */
-		GridFace(GridVertex* sVertices[CellTopology::numFaceVertices]); // Creates grid face from given vertex pointer array
-		
-		/* Methods: */
-		inline friend bool operator!=(const GridFace& f1,const GridFace& f2)
-			{
-			for(int i=0;i<CellTopology::numFaceVertices;++i)
-				if(f1.vertices[i]!=f2.vertices[i])
-					return true;
-			return false;
-			}
-		inline static size_t hash(const GridFace& source,size_t tableSize)
+		ConnectCellsArgs(void)
+			:begin(0),end(0)
 			{
-			size_t result=0;
-			for(int i=0;i<CellTopology::numFaceVertices;++i)
-				result=(result+reinterpret_cast<size_t>(source.vertices[i]))*17;
-			return result%tableSize;
 			}
 		};
 	
-	typedef Misc::PoolAllocator<GridVertex> GridVertexAllocator; // Type of memory allocators for grid vertices
-	typedef Misc::PoolAllocator<GridCell> GridCellAllocator; // Type of memory allocators for grid cells
-	typedef Misc::HashTable<GridFace,std::pair<GridCell*,int>,GridFace> FaceHasher; // Data type for hash tables used during data set construction
-	
 	/* Data set interface classes: */
 	public:
-	typedef PointerID<GridVertex> VertexID; // Class to identify vertices
-	
 	class Vertex // Class to represent and iterate through vertices
 		{
 		friend class Simplical;
@@ -181,17 +187,17 @@ class Simplical
 		/* Elements: */
 		private:
 		const Simplical* ds; // Pointer to data set containing the vertex
-		const GridVertex* vertex; // Pointer to the grid vertex
+		VertexIndex index; // Index of vertex in vertex list
 		
 		/* Constructors and destructors: */
 		public:
 		Vertex(void) // Creates an invalid vertex
-			:ds(0),vertex(0)
+			:ds(0),index(~VertexIndex(0))
 			{
 			}
 		private:
-		Vertex(const Simplical* sDs,const GridVertex* sVertex)
-			:ds(sDs),vertex(sVertex)
+		Vertex(const Simplical* sDs,VertexIndex sIndex)
+			:ds(sDs),index(sIndex)
 			{
 			}
 		
@@ -199,74 +205,41 @@ class Simplical
 		public:
 		const Point& getPosition(void) const // Returns vertex' position in domain
 			{
-			return vertex->pos;
+			return ds->gridVertices[index];
 			}
 		template <class ValueExtractorParam>
 		typename ValueExtractorParam::DestValue getValue(const ValueExtractorParam& extractor) const // Returns vertex' value based on given extractor
 			{
-			return extractor.getValue(vertex->value);
+			return extractor.getValue(ds->vertexValues[index]);
 			}
 		template <class ScalarExtractorParam>
 		Vector calcGradient(const ScalarExtractorParam& extractor) const // Returns gradient at the vertex, based on given scalar extractor
 			{
-			return ds->calcVertexGradient(vertex,extractor);
+			return ds->calcVertexGradient(index,extractor);
 			}
 		VertexID getID(void) const // Returns vertex' ID
 			{
-			return VertexID(vertex);
+			return VertexID(index);
 			}
 		
 		/* Iterator methods: */
 		friend bool operator==(const Vertex& v1,const Vertex& v2)
 			{
-			return v1.vertex==v2.vertex;
+			return v1.index==v2.index&&v1.ds==v2.ds;
 			}
 		friend bool operator!=(const Vertex& v1,const Vertex& v2)
 			{
-			return v1.vertex!=v2.vertex;
+			return v1.index!=v2.index||v1.ds!=v2.ds;
 			}
 		Vertex& operator++(void) // Pre-increment operator
 			{
-			vertex=vertex->succ;
+			++index;
 			return *this;
 			}
 		};
 	
 	typedef IteratorWrapper<Vertex> VertexIterator; // Class to iterate through vertices
 	
-	class EdgeID // Class to identify cell edges
-		{
-		friend class Cell;
-		
-		/* Elements: */
-		private:
-		const GridVertex* vertices[2]; // The vertices of the edge, sorted by pointer value
-		
-		/* Constructors: */
-		public:
-		EdgeID(void)
-			{
-			vertices[0]=vertices[1]=0;
-			}
-		EdgeID(const GridVertex* v0,const GridVertex* v1); // Elementwise constructor
-		
-		/* Methods: */
-		friend bool operator==(const EdgeID& ei1,const EdgeID& ei2) // Compares two cell edges for equality
-			{
-			return ei1.vertices[0]==ei2.vertices[0]&&ei1.vertices[1]==ei2.vertices[1];
-			}
-		friend bool operator!=(const EdgeID& ei1,const EdgeID& ei2) // Compares two cell edges for inequality
-			{
-			return ei1.vertices[0]!=ei2.vertices[0]||ei1.vertices[1]!=ei2.vertices[1];
-			}
-		static size_t hash(const EdgeID& ei,size_t tableSize) // Calculates hash index for a cell edge
-			{
-			return (reinterpret_cast<size_t>(ei.vertices[0])*17+reinterpret_cast<size_t>(ei.vertices[1])*31)%tableSize;
-			}
-		};
-	
-	typedef PointerID<GridCell> CellID; // Class to identify cells
-	
 	class Locator;
 	
 	class Cell // Class to represent and iterate through cells
@@ -276,69 +249,90 @@ class Simplical
 		
 		/* Elements: */
 		private:
-		const Simplical* ds; // Pointer to data set containing the vertex
-		const GridCell* cell; // Grid cell represented by the cell
+		const Simplical* ds; // Pointer to data set containing the cell
+		CellIndex index; // Index of cell in cell list
+		const VertexIndex* vertices; // Direct pointer to the cell's vertex indices
+		const CellIndex* neighbours; // Direct pointer to the cell's neighbour indices
+		
+		/* Private methods: */
+		void setIndex(CellIndex newIndex) // Sets the cell to the given cell index
+			{
+			index=newIndex;
+			vertices=&ds->cellVertices.front()+size_t(index)*CellTopology::numVertices;
+			neighbours=&ds->cellNeighbours.front()+size_t(index)*CellTopology::numFaces;
+			}
 		
 		/* Constructors and destructors: */
 		public:
 		Cell(void) // Creates an invalid cell
-			:ds(0),cell(0)
+			:ds(0),index(~CellIndex(0)),vertices(0),neighbours(0)
 			{
 			}
 		private:
-		Cell(const Simplical* sDs,const GridCell* sCell) // Elementwise constructor
-			:ds(sDs),cell(sCell)
+		Cell(const Simplical* sDs) // Creates an invalid cell for the given data set
+			:ds(sDs),index(~CellIndex(0)),vertices(0),neighbours(0)
+			{
+			}
+		Cell(const Simplical* sDs,CellIndex sIndex) // Elementwise constructor
+			:ds(sDs),index(~CellIndex(0)),vertices(0),neighbours(0)
 			{
+			if(sIndex!=~CellIndex(0))
+				setIndex(sIndex);
 			}
 		
 		/* Methods: */
 		public:
 		bool isValid(void) const // Returns true if the cell is valid
 			{
-			return cell!=0;
+			return vertices!=0;
 			}
 		VertexID getVertexID(int vertexIndex) const // Returns ID of given vertex of the cell
 			{
-			return VertexID(cell->vertices[vertexIndex]);
+			return VertexID(vertices[vertexIndex]);
 			}
 		Vertex getVertex(int vertexIndex) const // Returns given vertex of the cell
 			{
-			return Vertex(ds,cell->vertices[vertexIndex]);
+			return Vertex(ds,vertices[vertexIndex]);
 			}
 		const Point& getVertexPosition(int vertexIndex) const // Returns position of given vertex of the cell
 			{
-			return cell->vertices[vertexIndex]->pos;
+			return ds->gridVertices[vertices[vertexIndex]];
 			}
 		template <class ValueExtractorParam>
 		typename ValueExtractorParam::DestValue getVertexValue(int vertexIndex,const ValueExtractorParam& extractor) const // Returns value of given vertex of the cell, based on given extractor
 			{
-			return extractor.getValue(cell->vertices[vertexIndex]->value);
+			return extractor.getValue(ds->vertexValues[vertices[vertexIndex]]);
 			}
 		template <class ScalarExtractorParam>
 		Vector calcVertexGradient(int vertexIndex,const ScalarExtractorParam& extractor) const; // Returns gradient at given vertex of the cell, based on given scalar extractor
-		EdgeID getEdgeID(int edgeIndex) const; // Returns ID of given edge of the cell
+		EdgeID getEdgeID(int edgeIndex) const // Returns ID of given edge of the cell
+			{
+			return EdgeID(vertices[CellTopology::edgeVertexIndices[edgeIndex][0]],vertices[CellTopology::edgeVertexIndices[edgeIndex][1]]);
+			}
 		Point calcEdgePosition(int edgeIndex,Scalar weight) const; // Returns an interpolated point along the given edge
 		CellID getID(void) const // Returns cell's ID
 			{
-			return CellID(cell);
+			return CellID(index);
 			}
 		CellID getNeighbourID(int neighbourIndex) const // Returns ID of neighbour across the given face of the cell
 			{
-			return CellID(cell->neighbours[neighbourIndex]);
+			return CellID(neighbours[neighbourIndex]);
 			}
 		
 		/* Iterator methods: */
 		friend bool operator==(const Cell& cell1,const Cell& cell2) // Compares two cells for equality
 			{
-			return cell1.cell==cell2.cell;
+			return cell1.index==cell2.index&&cell1.ds==cell2.ds;
 			}
 		friend bool operator!=(const Cell& cell1,const Cell& cell2) // Compares two cells for inequality
 			{
-			return cell1.cell!=cell2.cell;
+			return cell1.index!=cell2.index||cell1.ds!=cell2.ds;
 			}
 		Cell& operator++(void) // Pre-increment operator
 			{
-			cell=cell->succ;
+			++index;
+			vertices+=CellTopology::numVertices;
+			neighbours+=CellTopology::numFaces;
 			return *this;
 			}
 		};
@@ -355,7 +349,9 @@ class Simplical
 		
 		/* Elements: */
 		using Cell::ds;
-		using Cell::cell;
+		using Cell::index;
+		using Cell::vertices;
+		using Cell::neighbours;
 		CellPosition cellPos; // Local coordinates of last located point inside its cell
 		Scalar epsilon,epsilon2; // Accuracy threshold of point location algorithm
 		
@@ -385,20 +381,17 @@ class Simplical
 	typedef Geometry::ValuedPoint<Point,CellID> CellCenter; // Data type to associate a cell's center point and its ID
 	typedef Geometry::ArrayKdTree<CellCenter> CellCenterTree; // Data type for kd-trees to locate closest cell centers
 	
+	friend class GridVertexIterator;
 	friend class Vertex;
 	friend class Cell;
 	friend class Locator;
 	
 	/* Elements: */
 	private:
-	GridVertexAllocator vertexAllocator; // Memory allocator for grid vertices
-	size_t totalNumVertices; // Total number of vertices in data set
-	GridVertex* firstGridVertex; // Pointer to first vertex in data set
-	GridVertex* lastGridVertex; // Pointer to last vertex in data set
-	GridCellAllocator cellAllocator; // Memory allocator for grid cells
-	size_t totalNumCells; // Total number of cells in data set
-	GridCell* firstGridCell; // Pointer to first cell in data set
-	GridCell* lastGridCell; // Pointer to last cell in data set
+	GridVertexList gridVertices; // Positions of all grid vertices
+	VertexValueList vertexValues; // Values of all grid vertices
+	CellVertexList cellVertices; // Vertex indices of all grid cells
+	CellNeighbourList cellNeighbours; // Neighbour indices of all grid cells; invalid indices denote boundary faces
 	CellCenterTree cellCenterTree; // Kd-tree containing cell centers
 	VertexIterator firstVertex,lastVertex; // Bounds of vertex list
 	CellIterator firstCell,lastCell; // Bounds of cell list
@@ -406,7 +399,9 @@ class Simplical
 	Scalar locatorEpsilon; // Default accuracy threshold for locators working on this data set
 	
 	/* Private methods: */
-	void connectCells(void); // Creates simplical mesh from unconnected simplices by connecting shared faces
+	void* connectCellsThreaded(ConnectCellsArgs* args); // Connects all matching faces in a range of face records sorted by a single thread
+	void connectCells(int numThreads); // Creates simplical mesh from unconnected simplices by connecting shared faces, using the given number of threads
+	void finalizeGridStructure(void); // Initializes the vertex and cell list bounds and calculates the domain's bounding box
 	
 	/* Constructors and destructors: */
 	public:
@@ -414,29 +409,32 @@ class Simplical
 	~Simplical(void); // Destroys the data set
 	
 	/* Data set construction methods: */
+	void reserveVertices(size_t numVertices); // Prepares the data set for subsequent addition of the given number of grid vertices (optional performance boost)
+	void reserveCells(size_t numCells); // Prepares the data set for subsequent addition of the given number of grid cells (optional performance boost)
 	GridVertexIterator addVertex(const Point& pos,const Value& value); // Adds a new grid vertex to the data set
-	CellIterator addCell(GridVertexIterator cellVertices[GridCell::numVertices]); // Adds a new cell to the data set
+	CellIterator addCell(GridVertexIterator cellVertices[CellTopology::numVertices]); // Adds a new cell to the data set
 	
 	/* Low-level data access methods: */
 	GridVertexIterator beginGridVertices(void) // Returns iterator to the first vertex
 		{
-		return GridVertexIterator(firstGridVertex);
+		return GridVertexIterator(this,0);
 		}
 	GridVertexIterator endGridVertices(void) // Returns iterator behind last vertex
 		{
-		return GridVertexIterator(0);
+		return GridVertexIterator(this,VertexIndex(gridVertices.size()));
 		}
 	void finalizeGrid(void); // Recalculates derived grid information after grid structure change
+	void finalizeGrid(const char* sourceFileName); // Ditto; reuses or updates the cell center tree cached alongside the given source file
 	void setLocatorEpsilon(Scalar newLocatorEpsilon); // Sets the default accuracy threshold for locators working on this data set
 	
 	/* Methods implementing the data set interface: */
 	size_t getTotalNumVertices(void) const // Returns total number of vertices in the data set
 		{
-		return totalNumVertices;
+		return gridVertices.size();
 		}
 	Vertex getVertex(const VertexID& vertexID) const // Returns vertex of given valid ID
 		{
-		return Vertex(this,vertexID.getObject());
+		return Vertex(this,vertexID.getIndex());
 		}
 	const VertexIterator& beginVertices(void) const // Returns iterator to first vertex in the data set
 		{
@@ -448,11 +446,11 @@ class Simplical
 		}
 	size_t getTotalNumCells(void) const // Returns total number of cells in the data set
 		{
-		return totalNumCells;
+		return cellNeighbours.size()/CellTopology::numFaces;
 		}
 	Cell getCell(const CellID& cellID) const // Returns cell of given valid ID
 		{
-		return Cell(this,cellID.getObject());
+		return Cell(this,cellID.getIndex());
 		}
 	const CellIterator& beginCells(void) const // Returns iterator to first cell in the data set
 		{
@@ -344,6 +344,7 @@ class SlicedCurvilinear
 		return numCells;
 		}
 	void finalizeGrid(void); // Recalculates derived grid information after grid structure change
+	void finalizeGrid(const char* sourceFileName); // Ditto; reuses or updates the cell center tree cached alongside the given source file
 	Scalar getLocatorEpsilon(void) const // Returns the current default accuracy threshold for locators working on this data set
 		{
 		return locatorEpsilon;
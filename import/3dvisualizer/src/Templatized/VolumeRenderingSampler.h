@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define VISUALIZATION_TEMPLATIZED_VOLUMERENDERINGSAMPLER_INCLUDED
 
 /* Forward declarations: */
+class SharedVoxelBlock;
 namespace Cluster {
 class MulticastPipe;
 }
@@ -66,6 +67,11 @@ class VolumeRenderingSampler
 		}
 	template <class ScalarExtractorParam,class VoxelParam>
 	void sample(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,typename ScalarExtractorParam::Scalar outOfDomainValue,VoxelParam* voxels,const ptrdiff_t voxelStrides[3],Cluster::MulticastPipe* pipe,float percentageScale,float percentageOffset,Visualization::Abstract::Algorithm* algorithm) const; // Samples scalar values from the given scalar extractor into the given voxel block
+	template <class ScalarExtractorParam>
+	bool share(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,SharedVoxelBlock& voxelBlock) const // Sets up the given voxel block to render the data set's values directly; returns false if the values must be sampled
+		{
+		return false;
+		}
 	};
 
 }
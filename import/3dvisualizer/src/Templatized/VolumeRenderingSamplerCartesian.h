@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Templatized/VolumeRenderingSampler.h>
 
 /* Forward declarations: */
+class SharedVoxelBlock;
 namespace Cluster {
 class MulticastPipe;
 }
@@ -38,6 +39,8 @@ template <class ScalarParam,int dimensionParam,class ValueParam>
 class Cartesian;
 template <class ScalarParam,int dimensionParam,class ValueScalarParam>
 class SlicedCartesian;
+template <class ScalarParam,class SourceValueParam>
+class ScalarExtractor;
 }
 }
 
@@ -72,6 +75,13 @@ class VolumeRenderingSampler<Cartesian<ScalarParam,3,ValueParam> >
 		}
 	template <class ScalarExtractorParam,class VoxelParam>
 	void sample(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,typename ScalarExtractorParam::Scalar outOfDomainValue,VoxelParam* voxels,const ptrdiff_t voxelStrides[3],Cluster::MulticastPipe* pipe,float percentageScale,float percentageOffset,Visualization::Abstract::Algorithm* algorithm) const; // Samples scalar values from the given scalar extractor into the given voxel block
+	template <class ScalarExtractorParam>
+	bool share(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,SharedVoxelBlock& voxelBlock) const // Sets up the given voxel block to render the data set's values directly; returns false if the values must be sampled
+		{
+		return false;
+		}
+	template <class VScalarParam>
+	bool share(const ScalarExtractor<VScalarParam,unsigned char>& scalarExtractor,VScalarParam minValue,VScalarParam maxValue,SharedVoxelBlock& voxelBlock) const; // Shares the data set's byte-valued vertex array with the given voxel block
 	};
 
 template <class ScalarParam,class ValueScalarParam>
@@ -101,6 +111,11 @@ class VolumeRenderingSampler<SlicedCartesian<ScalarParam,3,ValueScalarParam> >
 		}
 	template <class ScalarExtractorParam,class VoxelParam>
 	void sample(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,typename ScalarExtractorParam::Scalar outOfDomainValue,VoxelParam* voxels,const ptrdiff_t voxelStrides[3],Cluster::MulticastPipe* pipe,float percentageScale,float percentageOffset,Visualization::Abstract::Algorithm* algorithm) const; // Samples scalar values from the given scalar extractor into the given voxel block
+	template <class ScalarExtractorParam>
+	bool share(const ScalarExtractorParam& scalarExtractor,typename ScalarExtractorParam::Scalar minValue,typename ScalarExtractorParam::Scalar maxValue,SharedVoxelBlock& voxelBlock) const // Sets up the given voxel block to render the data set's values directly; returns false if the values must be sampled
+		{
+		return false;
+		}
 	};
 
 }
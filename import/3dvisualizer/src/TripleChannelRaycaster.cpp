@@ -129,7 +129,50 @@ void TripleChannelRaycaster::bindShader(const Raycaster::PTransform& pmv,const R
 	if(myDataItem->volumeTextureVersion!=dataVersion)
 		{
 		/* Upload the new volume data: */
-		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,dataSize[0],dataSize[1],dataSize[2],GL_RGB,GL_UNSIGNED_BYTE,data);
+		if(data!=0&&!sharedChannels[0].isValid()&&!sharedChannels[1].isValid()&&!sharedChannels[2].isValid())
+			glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,dataSize[0],dataSize[1],dataSize[2],GL_RGB,GL_UNSIGNED_BYTE,data);
+		else
+			{
+			/* Interleave the private and shared channels in slabs of z slices to limit temporary memory: */
+			size_t sliceSize=size_t(dataSize[0])*size_t(dataSize[1]);
+			unsigned int slabSize=sliceSize!=0?(unsigned int)((4U*1024U*1024U)/sliceSize):1U;
+			if(slabSize<1U)
+				slabSize=1U;
+			if(slabSize>dataSize[2])
+				slabSize=dataSize[2];
+			Voxel* slab=new Voxel[sliceSize*slabSize*3];
+			ptrdiff_t slabStrides[3];
+			slabStrides[0]=3;
+			slabStrides[1]=ptrdiff_t(dataSize[0])*3;
+			slabStrides[2]=ptrdiff_t(sliceSize)*3;
+			for(unsigned int slabStart=0;slabStart<dataSize[2];slabStart+=slabSize)
+				{
+				unsigned int numSlices=dataSize[2]-slabStart;
+				if(numSlices>slabSize)
+					numSlices=slabSize;
+				size_t numSlabVoxels=sliceSize*numSlices;
+				for(int channel=0;channel<3;++channel)
+					{
+					Voxel* sPtr=slab+channel;
+					if(sharedChannels[channel].isValid())
+						sharedChannels[channel].copySlab(dataSize,slabStart,numSlices,sPtr,slabStrides);
+					else if(data!=0)
+						{
+						/* Copy the channel from the private volume dataset, which has the same layout as the slab: */
+						const Voxel* dPtr=data+(size_t(slabStart)*sliceSize*3+channel);
+						for(size_t i=0;i<numSlabVoxels;++i,sPtr+=3,dPtr+=3)
+							*sPtr=*dPtr;
+						}
+					else
+						{
+						for(size_t i=0;i<numSlabVoxels;++i,sPtr+=3)
+							*sPtr=Voxel(0);
+						}
+					}
+				glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,slabStart,dataSize[0],dataSize[1],numSlices,GL_RGB,GL_UNSIGNED_BYTE,slab);
+				}
+			delete[] slab;
+			}
 		
 		/* Mark the volume texture as up-to-date: */
 		myDataItem->volumeTextureVersion=dataVersion;
@@ -145,7 +188,7 @@ void TripleChannelRaycaster::bindShader(const Raycaster::PTransform& pmv,const R
 		glActiveTextureARB(GL_TEXTURE2_ARB+channel);
 		glBindTexture(GL_TEXTURE_1D,myDataItem->colorMapTextureIDs[channel]);
 		colorMapSamplers[channel]=2+channel;
-
+		
 		/* Create the stepsize-adjusted colormap with pre-multiplied alpha: */
 		GLColorMap adjustedColorMap(*colorMaps[channel]);
 		adjustedColorMap.changeTransparency(stepSize*transparencyGammas[channel]);
@@ -175,7 +218,7 @@ void TripleChannelRaycaster::unbindShader(Raycaster::DataItem* dataItem) const
 
 TripleChannelRaycaster::TripleChannelRaycaster(const unsigned int sDataSize[3],const Raycaster::Box& sDomain)
 	:Raycaster(sDataSize,sDomain),
-	 data(new Voxel[dataSize[0]*dataSize[1]*dataSize[2]*3]),dataVersion(0)
+	 data(0),dataVersion(0)
 	{
 	/* Multiply the data stride values with the number of channels: */
 	for(int dim=0;dim<3;++dim)
@@ -232,6 +275,23 @@ void TripleChannelRaycaster::setStepSize(Raycaster::Scalar newStepSize)
 	Raycaster::setStepSize(newStepSize);
 	}
 
+TripleChannelRaycaster::Voxel* TripleChannelRaycaster::getData(int channel)
+	{
+	/* Allocate the private volume dataset on first access: */
+	if(data==0)
+		data=new Voxel[dataSize[0]*dataSize[1]*dataSize[2]*3];
+	
+	/* Render the given channel from the private volume dataset: */
+	sharedChannels[channel]=SharedVoxelBlock();
+	
+	return data+channel;
+	}
+
+void TripleChannelRaycaster::setChannelData(int channel,const SharedVoxelBlock& newChannelData)
+	{
+	sharedChannels[channel]=newChannelData;
+	}
+
 void TripleChannelRaycaster::updateData(void)
 	{
 	/* Bump up the data version number: */
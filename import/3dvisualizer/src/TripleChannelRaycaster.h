@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLColorMap.h>
 
 #include <Raycaster.h>
+#include <SharedVoxelBlock.h>
 
 class TripleChannelRaycaster:public Raycaster
 	{
@@ -56,7 +57,8 @@ class TripleChannelRaycaster:public Raycaster
 	
 	/* Elements: */
 	protected:
-	Voxel* data; // Pointer to the volume dataset
+	Voxel* data; // Pointer to the interleaved private volume dataset; allocated on first access to a non-shared channel
+	SharedVoxelBlock sharedChannels[3]; // Views into shared voxel blocks rendered instead of the private volume dataset's channels
 	unsigned int dataVersion; // Version number of the volume dataset to track changes
 	bool channelEnableds[3]; // Flags to enable/disable each channel separately
 	const GLColorMap* colorMaps[3]; // Pointers to the three channel color maps
@@ -81,13 +83,19 @@ class TripleChannelRaycaster:public Raycaster
 	virtual void setStepSize(Scalar newStepSize);
 	
 	/* New methods: */
-	const Voxel* getData(int channel) const // Returns pointer to the volume dataset for the given channel
+	const Voxel* getData(int channel) const // Returns pointer to the volume dataset for the given channel; null if no channel has been written
 		{
-		return data+channel;
+		return data!=0?data+channel:0;
 		}
-	Voxel* getData(int channel) // Ditto
+	Voxel* getData(int channel); // Ditto; allocates the private volume dataset on first access, and stops sharing the given channel
+	bool isChannelShared(int channel) const // Returns true if the given channel renders a shared voxel block
 		{
-		return data+channel;
+		return sharedChannels[channel].isValid();
+		}
+	void setChannelData(int channel,const SharedVoxelBlock& newChannelData); // Renders the given shared voxel block in the given channel without copying it
+	size_t getPrivateMemorySize(void) const // Returns the size of the private volume dataset in bytes
+		{
+		return data!=0?size_t(dataSize[0])*size_t(dataSize[1])*size_t(dataSize[2])*3*sizeof(Voxel):0;
 		}
 	virtual void updateData(void); // Notifies the raycaster that the volume dataset has changed
 	bool getChannelEnabled(int channel) const // Returns the enabled flag for the given channel
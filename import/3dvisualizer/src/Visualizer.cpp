@@ -24,6 +24,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <ctype.h>
 #include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <stdexcept>
 #include <vector>
 #include <iostream>
@@ -89,6 +92,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "VectorEvaluationLocator.h"
 #include "ExtractorLocator.h"
 #include "ElementList.h"
+#include "ElementLoader.h"
+#include "ExtractionScheduler.h"
 #include "GLRenderState.h"
 
 #include "TraceTool.h"
@@ -377,6 +382,13 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 		/* Create a data sink to send element parameters to the slaves: */
 		Visualization::Abstract::BinaryParametersSink sink(variableManager,*pipe,true);
 		
+		/* Check for saved element geometry matching the current data set: */
+		std::string geometryFileName=ElementList::getGeometryFileName(elementFileName);
+		std::vector<IO::SeekableFile::Offset> geometryOffsets;
+		if(ElementList::readGeometryIndex(elementFileName,dataSetStamp,geometryOffsets))
+			std::cout<<"Restoring elements from saved geometry in "<<geometryFileName<<std::endl;
+		size_t elementIndex=0;
+		
 		if(ascii)
 			{
 			/* Open the element file: */
@@ -403,12 +415,13 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 				Cluster::MulticastPipe* algorithmPipe=Vrui::openPipe();
 				Algorithm* algorithm=module->getAlgorithm(algorithmName.c_str(),variableManager,algorithmPipe);
 				
-				/* Extract an element using the given extractor: */
+				/* Find the element's saved geometry: */
+				IO::SeekableFile::Offset geometryOffset=elementIndex<geometryOffsets.size()?geometryOffsets[elementIndex]:0;
+				++elementIndex;
+				
+				/* Queue an element for restoration using the given extractor: */
 				if(algorithm!=0)
 					{
-					std::cout<<"Creating "<<algorithmName<<"..."<<std::flush;
-					Misc::Timer extractionTimer;
-					
 					try
 						{
 						/* Read the element's extraction parameters from the file: */
@@ -424,11 +437,8 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 							pipe->flush();
 							}
 						
-						/* Extract the element: */
-						Element* element=algorithm->createElement(parameters);
-						
-						/* Store the element: */
-						elementList->addElement(element,algorithmName.c_str());
+						/* Restore the element on a worker thread; the element loader inherits the extractor: */
+						elementLoader->addElement(algorithmName,algorithm,parameters,geometryOffset!=0?geometryFileName:std::string(),geometryOffset);
 						}
 					catch(std::runtime_error err)
 						{
@@ -439,14 +449,11 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 							pipe->flush();
 							}
 						
-						std::cout<<"Cancelled due to exception "<<err.what()<<"...";
+						std::cout<<"Cancelled "<<algorithmName<<" due to exception "<<err.what()<<std::endl;
+						
+						/* Destroy the extractor: */
+						delete algorithm;
 						}
-					
-					/* Destroy the extractor: */
-					delete algorithm;
-					
-					extractionTimer.elapse();
-					std::cout<<" done in "<<extractionTimer.getTime()*1000.0<<" ms"<<std::endl;
 					}
 				else
 					{
@@ -478,12 +485,13 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 				Cluster::MulticastPipe* algorithmPipe=Vrui::openPipe();
 				Algorithm* algorithm=module->getAlgorithm(algorithmName.c_str(),variableManager,algorithmPipe);
 				
-				/* Extract an element using the given extractor: */
+				/* Find the element's saved geometry: */
+				IO::SeekableFile::Offset geometryOffset=elementIndex<geometryOffsets.size()?geometryOffsets[elementIndex]:0;
+				++elementIndex;
+				
+				/* Queue an element for restoration using the given extractor: */
 				if(algorithm!=0)
 					{
-					std::cout<<"Creating "<<algorithmName<<"..."<<std::flush;
-					Misc::Timer extractionTimer;
-					
 					try
 						{
 						/* Read the element's extraction parameters from the file: */
@@ -498,11 +506,8 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 							pipe->flush();
 							}
 						
-						/* Extract the element: */
-						Element* element=algorithm->createElement(parameters);
-						
-						/* Store the element: */
-						elementList->addElement(element,algorithmName.c_str());
+						/* Restore the element on a worker thread; the element loader inherits the extractor: */
+						elementLoader->addElement(algorithmName,algorithm,parameters,geometryOffset!=0?geometryFileName:std::string(),geometryOffset);
 						}
 					catch(std::runtime_error err)
 						{
@@ -513,14 +518,11 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 							pipe->flush();
 							}
 						
-						std::cout<<"Cancelled due to exception "<<err.what()<<"...";
+						std::cout<<"Cancelled "<<algorithmName<<" due to exception "<<err.what()<<std::endl;
+						
+						/* Destroy the extractor: */
+						delete algorithm;
 						}
-					
-					/* Destroy the extractor: */
-					delete algorithm;
-					
-					extractionTimer.elapse();
-					std::cout<<" done in "<<extractionTimer.getTime()*1000.0<<" ms"<<std::endl;
 					}
 				else
 					{
@@ -560,7 +562,7 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 			Cluster::MulticastPipe* algorithmPipe=Vrui::openPipe();
 			Algorithm* algorithm=module->getAlgorithm(algorithmName.c_str(),variableManager,algorithmPipe);
 			
-			/* Extract an element using the given extractor: */
+			/* Queue an element for reception using the given extractor: */
 			if(algorithm!=0)
 				{
 				/* Check if there are valid parameters: */
@@ -572,19 +574,14 @@ void Visualizer::loadElements(const char* elementFileName,bool ascii)
 					Parameters* parameters=algorithm->cloneParameters();
 					parameters->read(source);
 					
-					std::cout<<"Receiving element"<<std::endl;
-					/* Receive the element: */
-					Element* element=algorithm->startSlaveElement(parameters);
-					algorithm->continueSlaveElement();
-					
-					std::cout<<"Done"<<std::endl;
-
-					/* Store the element: */
-					elementList->addElement(element,algorithmName.c_str());
+					/* Receive the element on a worker thread; the element loader inherits the extractor: */
+					elementLoader->addElement(algorithmName,algorithm,parameters,std::string(),0);
+					}
+				else
+					{
+					/* Destroy the extractor: */
+					delete algorithm;
 					}
-				
-				/* Destroy the extractor: */
-				delete algorithm;
 				}
 			else
 				delete algorithmPipe;
@@ -612,7 +609,9 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 	 collaborationClient(0),sharedVisualizationClient(0),
 	 #endif
 	 numCuttingPlanes(0),cuttingPlanes(0),
-	 elementList(0),
+	 extractionScheduler(0),
+	 elementList(0),elementLoader(0),
+	 saveElementGeometry(false),
 	 algorithm(0),
 	 mainMenu(0),
 	 inLoadPalette(false),inLoadElements(false)
@@ -623,6 +622,9 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 	std::vector<std::string> dataSetArgs;
 	const char* argColorMapName=0;
 	std::vector<const char*> loadFileNames;
+	double extractionFrameRate=60.0;
+	double extractionBudget=0.0;
+	unsigned int numLoadThreads=0;
 	for(int i=1;i<argc;++i)
 		{
 		if(argv[i][0]=='-')
@@ -649,6 +651,32 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 				else
 					std::cerr<<"Missing palette file name after -palette"<<std::endl;
 				}
+			else if(strcasecmp(argv[i]+1,"extractionFrameRate")==0)
+				{
+				++i;
+				if(i<argc)
+					extractionFrameRate=atof(argv[i]);
+				else
+					std::cerr<<"Missing frame rate after -extractionFrameRate"<<std::endl;
+				}
+			else if(strcasecmp(argv[i]+1,"extractionBudget")==0)
+				{
+				++i;
+				if(i<argc)
+					extractionBudget=atof(argv[i])*0.001;
+				else
+					std::cerr<<"Missing time in ms after -extractionBudget"<<std::endl;
+				}
+			else if(strcasecmp(argv[i]+1,"loadThreads")==0)
+				{
+				++i;
+				if(i<argc)
+					numLoadThreads=(unsigned int)atoi(argv[i]);
+				else
+					std::cerr<<"Missing number of threads after -loadThreads"<<std::endl;
+				}
+			else if(strcasecmp(argv[i]+1,"saveGeometry")==0)
+				saveElementGeometry=true;
 			else if(strcasecmp(argv[i]+1,"load")==0)
 				{
 				++i;
@@ -804,15 +832,19 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 	try
 		{
 		/* Load the appropriate visualization module: */
+		Vrui::beginStartupSpan("Loading visualization module");
 		module=moduleManager.loadClass(moduleClassName.c_str());
 		module->setBaseDirectory(baseDirectory);
+		Vrui::endStartupSpan();
 		
 		/* Load a data set: */
+		Vrui::beginStartupSpan("Loading data set");
 		Misc::Timer t;
 		Cluster::MulticastPipe* pipe=Vrui::openPipe(); // Implicit synchronization point
 		dataSet=module->load(dataSetArgs,pipe);
 		delete pipe; // Implicit synchronization point
 		t.elapse();
+		Vrui::endStartupSpan();
 		if(Vrui::isMaster())
 			std::cout<<"Time to load data set: "<<t.getTime()*1000.0<<" ms"<<std::endl;
 		}
@@ -821,6 +853,24 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 		Misc::throwStdErr("Visualizer::Visualizer: Could not load data set due to exception %s",err.what());
 		}
 	
+	/* Create a stamp identifying the loaded data set, to validate saved element geometry: */
+	dataSetStamp=moduleClassName;
+	for(std::vector<std::string>::const_iterator dsaIt=dataSetArgs.begin();dsaIt!=dataSetArgs.end();++dsaIt)
+		{
+		dataSetStamp.push_back(' ');
+		dataSetStamp.append(*dsaIt);
+		
+		/* Add the size and modification time of arguments naming files: */
+		std::string fileName=(*dsaIt)[0]=='/'?*dsaIt:baseDirectory+*dsaIt;
+		struct stat fileStats;
+		if(stat(fileName.c_str(),&fileStats)==0)
+			{
+			char fileStamp[64];
+			snprintf(fileStamp,sizeof(fileStamp)," (%lld,%lld)",(long long)fileStats.st_size,(long long)fileStats.st_mtime);
+			dataSetStamp.append(fileStamp);
+			}
+		}
+	
 	/* Create a variable manager: */
 	variableManager=new VariableManager(dataSet,argColorMapName);
 	variableManager->getColorBarDialog()->setCloseButton(true);
@@ -843,6 +893,11 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 	if(dataSet->getUnit().unit!=Geometry::LinearUnit::UNKNOWN)
 		Vrui::getCoordinateManager()->setUnit(dataSet->getUnit());
 	
+	/* Create the extraction scheduler: */
+	extractionScheduler=new ExtractionScheduler(extractionFrameRate>0.0?extractionFrameRate:60.0);
+	if(extractionBudget>0.0)
+		extractionScheduler->setMaxBudget(extractionBudget);
+	
 	/* Create cutting planes: */
 	numCuttingPlanes=6;
 	cuttingPlanes=new CuttingPlane[numCuttingPlanes];
@@ -885,6 +940,15 @@ Visualizer::Visualizer(int& argc,char**& argv,char**& appDefaults)
 	elementList->getElementListDialog()->setCloseButton(true);
 	elementList->getElementListDialog()->getCloseCallbacks().add(this,&Visualizer::elementListClosedCallback);
 	
+	/* Create the element loader: */
+	if(numLoadThreads==0)
+		{
+		/* Use one worker thread per CPU, but leave one CPU for rendering: */
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numLoadThreads=numCpus>2?(unsigned int)(numCpus-1):1;
+		}
+	elementLoader=new ElementLoader(variableManager,numLoadThreads);
+	
 	/* Load all element files listed on the command line: */
 	for(std::vector<const char*>::const_iterator lfnIt=loadFileNames.begin();lfnIt!=loadFileNames.end();++lfnIt)
 		{
@@ -913,6 +977,9 @@ Visualizer::~Visualizer(void)
 	{
 	delete mainMenu;
 	
+	/* Finish all queued visualization elements and shut down the element loader: */
+	delete elementLoader;
+	
 	/* Delete all finished visualization elements: */
 	delete elementList;
 	
@@ -928,6 +995,9 @@ Visualizer::~Visualizer(void)
 	delete collaborationClient;
 	#endif
 	
+	/* Delete the extraction scheduler: */
+	delete extractionScheduler;
+	
 	/* Delete the coordinate transformer: */
 	delete coordinateTransformer;
 	
@@ -1048,6 +1118,12 @@ void Visualizer::toolDestructionCallback(Vrui::ToolManager::ToolDestructionCallb
 
 void Visualizer::frame(void)
 	{
+	/* Adapt the extraction budget to the measured frame rate: */
+	extractionScheduler->frame(Vrui::getFrameTime());
+	
+	/* Add all visualization elements restored since the last frame to the element list: */
+	elementLoader->addFinishedElements(*elementList);
+	
 	#ifdef VISUALIZER_USE_COLLABORATION
 	if(collaborationClient!=0)
 		{
@@ -1360,14 +1436,14 @@ void Visualizer::saveElementsCallback(Misc::CallbackData*)
 		Misc::createNumberedFileName("SavedElements.asciielem",4,elementFileNameBuffer);
 		
 		/* Save the visible elements to an ASCII file: */
-		elementList->saveElements(elementFileNameBuffer,true,variableManager);
+		elementList->saveElements(elementFileNameBuffer,true,variableManager,saveElementGeometry?dataSetStamp.c_str():0);
 		#else
 		/* Create the binary element file: */
 		char elementFileNameBuffer[256];
 		Misc::createNumberedFileName("SavedElements.binelem",4,elementFileNameBuffer);
 		
 		/* Save the visible elements to a binary file: */
-		elementList->saveElements(elementFileNameBuffer,false,variableManager);
+		elementList->saveElements(elementFileNameBuffer,false,variableManager,saveElementGeometry?dataSetStamp.c_str():0);
 		#endif
 		}
 	}
@@ -70,6 +70,8 @@ class SharedVisualizationClient;
 #endif
 class BaseLocator;
 class ElementList;
+class ElementLoader;
+class ExtractionScheduler;
 
 class Visualizer:public Vrui::Application
 	{
@@ -126,8 +128,12 @@ class Visualizer:public Vrui::Application
 	#endif
 	size_t numCuttingPlanes; // Maximum number of cutting planes supported
 	CuttingPlane* cuttingPlanes; // Array of available cutting planes
+	ExtractionScheduler* extractionScheduler; // Scheduler distributing extraction time between active extractors
 	BaseLocatorList baseLocators; // List of active locators
 	ElementList* elementList; // List of previously extracted visualization elements
+	ElementLoader* elementLoader; // Pool of worker threads restoring visualization elements from element files
+	std::string dataSetStamp; // Identifier of the loaded data set and the sizes and modification times of its files, to validate saved element geometry
+	bool saveElementGeometry; // Flag whether to save the extracted geometry of visualization elements alongside their parameters
 	int algorithm; // The currently selected algorithm
 	GLMotif::PopupMenu* mainMenu; // The main menu widget
 	GLMotif::ToggleButton* showColorBarToggle; // Toggle button to show the color bar
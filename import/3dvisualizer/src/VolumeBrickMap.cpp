@@ -0,0 +1,249 @@
+/***********************************************************************
+VolumeBrickMap - Class to subdivide blocks of cartesian voxel data into
+bricks, and to classify bricks as visible or fully transparent based on
+their value ranges and a palette-based transfer function.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualization Library (3DVis).
+
+The 3D Data Visualization Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The 3D Data Visualization Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualization Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include "VolumeBrickMap.h"
+
+/*******************************
+Methods of class VolumeBrickMap:
+*******************************/
+
+VolumeBrickMap::VolumeBrickMap(int sBrickSize)
+	:brickSize(sBrickSize<4?4:sBrickSize),brickCells(0),
+	 bricks(0),numVisibleBricks(0)
+	{
+	for(int i=0;i<3;++i)
+		{
+		numCells[i]=0;
+		numBricks[i]=0;
+		}
+	
+	/* Initially, all voxel values are visible: */
+	visibleValueSums[0]=0;
+	for(int i=0;i<256;++i)
+		{
+		visibleValues[i]=true;
+		visibleValueSums[i+1]=visibleValueSums[i]+1;
+		}
+	}
+
+VolumeBrickMap::~VolumeBrickMap(void)
+	{
+	delete[] bricks;
+	}
+
+void VolumeBrickMap::setBrickSize(int newBrickSize)
+	{
+	clear();
+	brickSize=newBrickSize<4?4:newBrickSize;
+	}
+
+void VolumeBrickMap::clear(void)
+	{
+	delete[] bricks;
+	bricks=0;
+	for(int i=0;i<3;++i)
+		{
+		numCells[i]=0;
+		numBricks[i]=0;
+		}
+	brickCells=0;
+	numVisibleBricks=0;
+	}
+
+void VolumeBrickMap::update(const VolumeBrickMap::Voxel* values,const int size[3],const int increments[3],bool vertexCentered,const VolumeBrickMap::Voxel* valueMap)
+	{
+	/* Calculate the brick layout: */
+	int newNumCells[3];
+	int newBrickCells=vertexCentered?brickSize-1:brickSize-2;
+	int newNumBricks[3];
+	for(int i=0;i<3;++i)
+		{
+		newNumCells[i]=vertexCentered?size[i]-1:size[i];
+		if(newNumCells[i]<0)
+			newNumCells[i]=0;
+		newNumBricks[i]=(newNumCells[i]+newBrickCells-1)/newBrickCells;
+		}
+	
+	/* Reallocate the brick array if the layout changed: */
+	if(bricks==0||newBrickCells!=brickCells||newNumBricks[0]!=numBricks[0]||newNumBricks[1]!=numBricks[1]||newNumBricks[2]!=numBricks[2])
+		{
+		delete[] bricks;
+		brickCells=newBrickCells;
+		for(int i=0;i<3;++i)
+			numBricks[i]=newNumBricks[i];
+		bricks=new Brick[numBricks[0]*numBricks[1]*numBricks[2]];
+		}
+	for(int i=0;i<3;++i)
+		numCells[i]=newNumCells[i];
+	
+	/* Calculate each brick's cell and voxel ranges and its value range: */
+	numVisibleBricks=0;
+	Brick* bPtr=bricks;
+	int index[3];
+	for(index[0]=0;index[0]<numBricks[0];++index[0])
+		for(index[1]=0;index[1]<numBricks[1];++index[1])
+			for(index[2]=0;index[2]<numBricks[2];++index[2],++bPtr)
+				{
+				for(int i=0;i<3;++i)
+					{
+					/* Calculate the brick's cell range: */
+					bPtr->cellOrigin[i]=index[i]*brickCells;
+					int cellEnd=bPtr->cellOrigin[i]+brickCells;
+					if(cellEnd>numCells[i])
+						cellEnd=numCells[i];
+					bPtr->cellSize[i]=cellEnd-bPtr->cellOrigin[i];
+					
+					/* Calculate the brick's voxel range: */
+					if(vertexCentered)
+						{
+						/* Cells are bounded by the voxels at their corners: */
+						bPtr->voxelOrigin[i]=bPtr->cellOrigin[i];
+						bPtr->voxelSize[i]=bPtr->cellSize[i]+1;
+						}
+					else
+						{
+						/* Interpolation near cell boundaries reaches into the neighbouring cells: */
+						int voxelEnd=cellEnd+1;
+						if(voxelEnd>size[i])
+							voxelEnd=size[i];
+						bPtr->voxelOrigin[i]=bPtr->cellOrigin[i]>0?bPtr->cellOrigin[i]-1:0;
+						bPtr->voxelSize[i]=voxelEnd-bPtr->voxelOrigin[i];
+						}
+					}
+				
+				/* Calculate the brick's value range: */
+				Voxel minValue=Voxel(255);
+				Voxel maxValue=Voxel(0);
+				const Voxel* vPlane=values+(bPtr->voxelOrigin[0]*increments[0]+bPtr->voxelOrigin[1]*increments[1]+bPtr->voxelOrigin[2]*increments[2]);
+				for(int x=0;x<bPtr->voxelSize[0];++x,vPlane+=increments[0])
+					{
+					const Voxel* vRow=vPlane;
+					for(int y=0;y<bPtr->voxelSize[1];++y,vRow+=increments[1])
+						{
+						const Voxel* vPtr=vRow;
+						for(int z=0;z<bPtr->voxelSize[2];++z,vPtr+=increments[2])
+							{
+							Voxel value=valueMap!=0?valueMap[*vPtr]:*vPtr;
+							if(minValue>value)
+								minValue=value;
+							if(maxValue<value)
+								maxValue=value;
+							}
+						}
+					}
+				bPtr->minValue=minValue;
+				bPtr->maxValue=maxValue;
+				
+				/* Classify the brick against the current transfer function: */
+				bPtr->visible=isRangeVisible(minValue,maxValue);
+				if(bPtr->visible)
+					++numVisibleBricks;
+				}
+	}
+
+int VolumeBrickMap::getMaxBrickVoxels(void) const
+	{
+	/* The first brick is always the largest: */
+	if(bricks==0||getNumBricks()==0)
+		return 0;
+	return bricks[0].voxelSize[0]*bricks[0].voxelSize[1]*bricks[0].voxelSize[2];
+	}
+
+int VolumeBrickMap::classify(const bool newVisibleValues[256])
+	{
+	/* Update the visibility flags and their prefix sums, and find the voxel values whose visibility changed: */
+	unsigned int changedValueSums[257];
+	changedValueSums[0]=0;
+	for(int i=0;i<256;++i)
+		{
+		changedValueSums[i+1]=changedValueSums[i];
+		if(visibleValues[i]!=newVisibleValues[i])
+			{
+			++changedValueSums[i+1];
+			visibleValues[i]=newVisibleValues[i];
+			}
+		visibleValueSums[i+1]=visibleValueSums[i]+(visibleValues[i]?1:0);
+		}
+	
+	/* Bail out if no value changed visibility: */
+	if(changedValueSums[256]==0)
+		return 0;
+	
+	/* Reclassify only those bricks whose value ranges contain changed values: */
+	int numChangedBricks=0;
+	Brick* bEnd=bricks+getNumBricks();
+	for(Brick* bPtr=bricks;bPtr!=bEnd;++bPtr)
+		if(changedValueSums[bPtr->maxValue+1]!=changedValueSums[bPtr->minValue])
+			{
+			bool newVisible=isRangeVisible(bPtr->minValue,bPtr->maxValue);
+			if(bPtr->visible!=newVisible)
+				{
+				bPtr->visible=newVisible;
+				if(newVisible)
+					++numVisibleBricks;
+				else
+					--numVisibleBricks;
+				++numChangedBricks;
+				}
+			}
+	
+	return numChangedBricks;
+	}
+
+void VolumeBrickMap::getVisibleBricks(const int cellMin[3],const int cellMax[3],const bool descending[3],std::vector<int>& brickIndices) const
+	{
+	/* Calculate the range of bricks intersecting the cell range along each axis: */
+	int first[3],last[3],step[3];
+	for(int i=0;i<3;++i)
+		{
+		int cMin=cellMin[i]>0?cellMin[i]:0;
+		int cMax=cellMax[i]<numCells[i]?cellMax[i]:numCells[i];
+		if(cMin>=cMax)
+			return;
+		int bMin=cMin/brickCells;
+		int bMax=(cMax-1)/brickCells;
+		if(descending[i])
+			{
+			first[i]=bMax;
+			last[i]=bMin-1;
+			step[i]=-1;
+			}
+		else
+			{
+			first[i]=bMin;
+			last[i]=bMax+1;
+			step[i]=1;
+			}
+		}
+	
+	/* Traverse the brick range in the requested order: */
+	for(int x=first[0];x!=last[0];x+=step[0])
+		for(int y=first[1];y!=last[1];y+=step[1])
+			for(int z=first[2];z!=last[2];z+=step[2])
+				{
+				int brickIndex=(x*numBricks[1]+y)*numBricks[2]+z;
+				if(bricks[brickIndex].visible)
+					brickIndices.push_back(brickIndex);
+				}
+	}
@@ -0,0 +1,103 @@
+/***********************************************************************
+VolumeBrickMap - Class to subdivide blocks of cartesian voxel data into
+bricks, and to classify bricks as visible or fully transparent based on
+their value ranges and a palette-based transfer function.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the 3D Data Visualization Library (3DVis).
+
+The 3D Data Visualization Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The 3D Data Visualization Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the 3D Data Visualization Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VOLUMEBRICKMAP_INCLUDED
+#define VOLUMEBRICKMAP_INCLUDED
+
+#include <vector>
+
+class VolumeBrickMap
+	{
+	/* Embedded classes: */
+	public:
+	typedef unsigned char Voxel; // Type for voxel data
+	
+	struct Brick // Structure describing one brick of the voxel block
+		{
+		/* Elements: */
+		public:
+		int cellOrigin[3],cellSize[3]; // Range of cells rendered by the brick
+		int voxelOrigin[3],voxelSize[3]; // Range of voxels needed to render the brick's cells, including overlap with neighbouring bricks
+		Voxel minValue,maxValue; // Range of voxel values inside the brick's voxel range
+		bool visible; // Flag if any value in the brick's value range maps to a non-transparent transfer function entry
+		};
+	
+	/* Elements: */
+	private:
+	int brickSize; // Maximum number of voxels in a brick along each axis, including overlap
+	int numCells[3]; // Number of cells in the subdivided voxel block
+	int brickCells; // Number of cells covered by an interior brick along each axis
+	int numBricks[3]; // Number of bricks along each axis
+	Brick* bricks; // Array of bricks, in the same axis order as the voxel block
+	bool visibleValues[256]; // Flags whether each voxel value maps to a non-transparent transfer function entry
+	unsigned int visibleValueSums[257]; // Prefix sums of the visibility flags, to classify value ranges in constant time
+	int numVisibleBricks; // Number of bricks currently classified as visible
+	
+	/* Constructors and destructors: */
+	public:
+	VolumeBrickMap(int sBrickSize =64); // Creates an empty brick map with the given maximum brick size in voxels; all voxel values are initially visible
+	private:
+	VolumeBrickMap(const VolumeBrickMap& source); // Prohibit copy constructor
+	VolumeBrickMap& operator=(const VolumeBrickMap& source); // Prohibit assignment operator
+	public:
+	~VolumeBrickMap(void);
+	
+	/* Methods: */
+	int getBrickSize(void) const // Returns the maximum brick size in voxels
+		{
+		return brickSize;
+		}
+	void setBrickSize(int newBrickSize); // Sets the maximum brick size in voxels; clears the brick map
+	void clear(void); // Removes all bricks
+	void update(const Voxel* values,const int size[3],const int increments[3],bool vertexCentered,const Voxel* valueMap =0); // Subdivides the given voxel block into bricks and calculates the bricks' value ranges; applies the optional value map to the voxel values
+	int getNumBricks(void) const // Returns the total number of bricks
+		{
+		return numBricks[0]*numBricks[1]*numBricks[2];
+		}
+	int getNumBricks(int dimension) const // Returns the number of bricks along the given axis
+		{
+		return numBricks[dimension];
+		}
+	const Brick& getBrick(int brickIndex) const // Returns the brick of the given index
+		{
+		return bricks[brickIndex];
+		}
+	int getMaxBrickVoxels(void) const; // Returns the number of voxels in the largest brick
+	bool isValueVisible(Voxel value) const // Returns true if the given voxel value is visible under the current transfer function
+		{
+		return visibleValues[value];
+		}
+	bool isRangeVisible(Voxel minValue,Voxel maxValue) const // Returns true if any value in the given closed range is visible under the current transfer function
+		{
+		return visibleValueSums[maxValue+1]!=visibleValueSums[minValue];
+		}
+	int getNumVisibleBricks(void) const // Returns the number of bricks currently classified as visible
+		{
+		return numVisibleBricks;
+		}
+	int classify(const bool newVisibleValues[256]); // Reclassifies the bricks affected by changes in the given value visibility flags; returns the number of bricks whose visibility changed
+	void getVisibleBricks(const int cellMin[3],const int cellMax[3],const bool descending[3],std::vector<int>& brickIndices) const; // Appends the indices of all visible bricks intersecting the given half-open cell range, ordered along each axis as requested
+	};
+
+#endif
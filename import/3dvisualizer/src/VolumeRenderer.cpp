@@ -21,6 +21,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 02111-1307 USA
 ***********************************************************************/
 
+#include <vector>
 #include <Misc/PriorityHeap.h>
 #include <Misc/File.h>
 #include <Math/Math.h>
@@ -35,6 +36,8 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLTransformationWrappers.h>
 #include <GLTextures.h>
 
+#include "SharedVoxelBlock.h"
+
 #include "VolumeRenderer.h"
 
 int numPolygons;
@@ -47,8 +50,9 @@ VolumeRenderer::DataItem::DataItem(void)
 	:has3DTextures(GLEXTTexture3D::isSupported()),
 	 hasNPOTDTextures(GLARBTextureNonPowerOfTwo::isSupported()),
 	 dataVersion(0),settingsVersion(0),
-	 numTextureObjects(0),textureObjectIDs(0),
-	 setParameters(true),uploadData(true)
+	 numTextureObjects(0),textureObjectIDs(0),brickTexturesValid(0),
+	 setParameters(true),uploadData(true),
+	 stagingBufferSize(0),stagingBuffer(0)
 	{
 	/* Initialize relevant OpenGL extensions: */
 	if(has3DTextures)
@@ -63,7 +67,9 @@ VolumeRenderer::DataItem::~DataItem(void)
 		{
 		glDeleteTextures(numTextureObjects,textureObjectIDs);
 		delete[] textureObjectIDs;
+		delete[] brickTexturesValid;
 		}
+	delete[] stagingBuffer;
 	}
 
 void VolumeRenderer::DataItem::updateTextureCache(const VolumeRenderer* renderer,int majorAxis)
@@ -73,9 +79,10 @@ void VolumeRenderer::DataItem::updateTextureCache(const VolumeRenderer* renderer
 	if(dataVersion!=renderer->dataVersion||majorAxis!=cachedAxis)
 		{
 		/* Calculate the number of required texture objects: */
-		int requiredNumTextures=1;
+		int requiredNumTextures=renderer->brickMap.getNumBricks();
 		if(!has3DTextures||renderer->renderingMode==VolumeRenderer::AXIS_ALIGNED)
 			{
+			requiredNumTextures=1;
 			for(int i=0;i<3;++i)
 				if(requiredNumTextures<renderer->size[i])
 					requiredNumTextures=renderer->size[i];
@@ -88,10 +95,12 @@ void VolumeRenderer::DataItem::updateTextureCache(const VolumeRenderer* renderer
 				{
 				glDeleteTextures(numTextureObjects,textureObjectIDs);
 				delete[] textureObjectIDs;
+				delete[] brickTexturesValid;
 				}
 			numTextureObjects=requiredNumTextures;
 			textureObjectIDs=new GLuint[numTextureObjects];
 			glGenTextures(numTextureObjects,textureObjectIDs);
+			brickTexturesValid=new bool[numTextureObjects];
 			}
 		
 		/* Invalidate the texture cache: */
@@ -117,11 +126,13 @@ void VolumeRenderer::DataItem::deleteTextureCache(void)
 		{
 		/* Delete all textures: */
 		glDeleteTextures(numTextureObjects,textureObjectIDs);
-
+		
 		/* Delete the texture cache: */
 		numTextureObjects=0;
 		delete[] textureObjectIDs;
 		textureObjectIDs=0;
+		delete[] brickTexturesValid;
+		brickTexturesValid=0;
 		textureCacheValid=false;
 		cachedAxis=-1;
 		}
@@ -148,7 +159,49 @@ void VolumeRenderer::deletePrivateData(void)
 	
 	/* Reset elements: */
 	privateData=false;
+	sharedStorage=0;
+	mapValues=false;
 	values=0;
+	brickMap.clear();
+	}
+
+VolumeRenderer::Voxel* VolumeRenderer::getStagingBuffer(VolumeRenderer::DataItem* dataItem,int numVoxels) const
+	{
+	if(dataItem->stagingBufferSize<numVoxels)
+		{
+		delete[] dataItem->stagingBuffer;
+		dataItem->stagingBufferSize=numVoxels;
+		dataItem->stagingBuffer=new Voxel[dataItem->stagingBufferSize];
+		}
+	return dataItem->stagingBuffer;
+	}
+
+const VolumeRenderer::Voxel* VolumeRenderer::getSliceValues(VolumeRenderer::DataItem* dataItem,int axis,int index,int sliceIncrements[2]) const
+	{
+	/* Determine the slice's two axes, faster-changing first: */
+	int sAxis=axis==2?1:2;
+	int tAxis=axis==0?1:0;
+	const Voxel* slicePtr=values+index*increments[axis];
+	if(!mapValues)
+		{
+		/* Upload the slice directly from the voxel block: */
+		sliceIncrements[0]=increments[sAxis];
+		sliceIncrements[1]=increments[tAxis];
+		return slicePtr;
+		}
+	
+	/* Map the slice's voxel values into the staging buffer: */
+	Voxel* sPtr=getStagingBuffer(dataItem,size[sAxis]*size[tAxis]);
+	const Voxel* vRow=slicePtr;
+	for(int t=0;t<size[tAxis];++t,vRow+=increments[tAxis])
+		{
+		const Voxel* vPtr=vRow;
+		for(int s=0;s<size[sAxis];++s,vPtr+=increments[sAxis],++sPtr)
+			*sPtr=valueMap[*vPtr];
+		}
+	sliceIncrements[0]=1;
+	sliceIncrements[1]=size[sAxis];
+	return dataItem->stagingBuffer;
 	}
 
 void VolumeRenderer::uploadTexture2D(VolumeRenderer::DataItem* dataItem,int axis,int index) const
@@ -167,26 +220,76 @@ void VolumeRenderer::uploadTexture2D(VolumeRenderer::DataItem* dataItem,int axis
 	if(dataItem->uploadData)
 		{
 		/* Upload a texture slice: */
-		const Voxel* slicePtr=values+index*increments[axis];
+		int sliceIncrements[2];
+		const Voxel* slicePtr=getSliceValues(dataItem,axis,index,sliceIncrements);
 		switch(axis)
 			{
 			case 0:
 				glTexImage2D(GL_TEXTURE_2D,0,GL_INTENSITY8,textureSize[2],textureSize[1],0,GL_LUMINANCE,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[1],increments[2],increments[1],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[1],sliceIncrements[0],sliceIncrements[1],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			case 1:
 				glTexImage2D(GL_TEXTURE_2D,0,GL_INTENSITY8,textureSize[2],textureSize[0],0,GL_LUMINANCE,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[0],increments[2],increments[0],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[2],size[0],sliceIncrements[0],sliceIncrements[1],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			case 2:
 				glTexImage2D(GL_TEXTURE_2D,0,GL_INTENSITY8,textureSize[1],textureSize[0],0,GL_LUMINANCE,GL_UNSIGNED_BYTE,0);
-				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[1],size[0],increments[1],increments[0],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size[1],size[0],sliceIncrements[0],sliceIncrements[1],GL_LUMINANCE,GL_UNSIGNED_BYTE,slicePtr);
 				break;
 			}
 		}
 	}
 
-void VolumeRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem) const
+void VolumeRenderer::calcBrickTextureSize(const VolumeBrickMap::Brick& brick,int brickTextureSize[3]) const
+	{
+	for(int i=0;i<3;++i)
+		{
+		if(useNPOTDTextures)
+			{
+			/* Just use the brick size as texture image size: */
+			brickTextureSize[i]=brick.voxelSize[i];
+			}
+		else
+			{
+			/* Adjust texture image size to the next power of two: */
+			for(brickTextureSize[i]=1;brickTextureSize[i]<brick.voxelSize[i];brickTextureSize[i]+=brickTextureSize[i])
+				;
+			}
+		}
+	}
+
+const VolumeRenderer::Voxel* VolumeRenderer::extractBrickValues(VolumeRenderer::DataItem* dataItem,const VolumeBrickMap::Brick& brick) const
+	{
+	/* Make room in the staging buffer: */
+	int numBrickVoxels=brick.voxelSize[0]*brick.voxelSize[1]*brick.voxelSize[2];
+	int maxBrickVoxels=brickMap.getMaxBrickVoxels();
+	Voxel* bvPtr=getStagingBuffer(dataItem,maxBrickVoxels>numBrickVoxels?maxBrickVoxels:numBrickVoxels);
+	
+	/* Copy the brick's voxel values in texture order: */
+	const Voxel* vPlane=values+(brick.voxelOrigin[0]*increments[0]+brick.voxelOrigin[1]*increments[1]+brick.voxelOrigin[2]*increments[2]);
+	for(int x=0;x<brick.voxelSize[0];++x,vPlane+=increments[0])
+		{
+		const Voxel* vRow=vPlane;
+		for(int y=0;y<brick.voxelSize[1];++y,vRow+=increments[1])
+			{
+			const Voxel* vPtr=vRow;
+			if(mapValues)
+				{
+				for(int z=0;z<brick.voxelSize[2];++z,vPtr+=increments[2],++bvPtr)
+					*bvPtr=valueMap[*vPtr];
+				}
+			else
+				{
+				for(int z=0;z<brick.voxelSize[2];++z,vPtr+=increments[2],++bvPtr)
+					*bvPtr=*vPtr;
+				}
+			}
+		}
+	
+	return dataItem->stagingBuffer;
+	}
+
+void VolumeRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem,const VolumeBrickMap::Brick& brick) const
 	{
 	if(dataItem->setParameters)
 		{
@@ -202,15 +305,18 @@ void VolumeRenderer::uploadTexture3D(VolumeRenderer::DataItem* dataItem) const
 	
 	if(dataItem->uploadData)
 		{
-		/* Upload the texture block: */
+		/* Upload the brick texture: */
+		int brickTextureSize[3];
+		calcBrickTextureSize(brick,brickTextureSize);
+		const Voxel* brickValues=extractBrickValues(dataItem,brick);
 		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
 		glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_UNPACK_ROW_LENGTH,0); // increments[1]); // Seems to be a bug in OpenGL - consistent across SGI/nVidia platforms
+		glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
 		glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
-		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT,0); // increments[0]);
+		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT,0);
 		glPixelStorei(GL_UNPACK_SKIP_IMAGES,0);
-		glTexImage3DEXT(GL_TEXTURE_3D,0,GL_INTENSITY8,textureSize[2],textureSize[1],textureSize[0],0,GL_LUMINANCE,GL_UNSIGNED_BYTE,0);
-		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,size[2],size[1],size[0],GL_LUMINANCE,GL_UNSIGNED_BYTE,values);
+		glTexImage3DEXT(GL_TEXTURE_3D,0,GL_INTENSITY8,brickTextureSize[2],brickTextureSize[1],brickTextureSize[0],0,GL_LUMINANCE,GL_UNSIGNED_BYTE,0);
+		glTexSubImage3DEXT(GL_TEXTURE_3D,0,0,0,0,brick.voxelSize[2],brick.voxelSize[1],brick.voxelSize[0],GL_LUMINANCE,GL_UNSIGNED_BYTE,brickValues);
 		}
 	}
 
@@ -345,12 +451,12 @@ void VolumeRenderer::prepareRenderViewPerpendicular(VolumeRenderer::DataItem* da
 	{
 	}
 
-void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,const VolumeRenderer::Vector& viewDirection) const
+void VolumeRenderer::renderBoxSlices(const VolumeRenderer::BoxCorner boxCorners[8],const VolumeRenderer::Vector& viewDirection) const
 	{
 	/* Calculate the corners' parameters along the viewing direction: */
 	Scalar cornerD[8];
 	for(int i=0;i<8;++i)
-		cornerD[i]=corners[i].position*viewDirection;
+		cornerD[i]=boxCorners[i].position*viewDirection;
 	
 	/* Find the box's distance range and the farthest away corner: */
 	int maxCorner=0;
@@ -381,16 +487,16 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 		/* Initialize the edge: */
 		nextEdge->expired=false;
 		nextEdge->startIndex=maxCorner;
-		int endCorner=corners[maxCorner].neighbours[i];
+		int endCorner=boxCorners[maxCorner].neighbours[i];
 		nextEdge->endIndex=endCorner;
 		Scalar rangeD=cornerD[endCorner]-cornerD[maxCorner];
 		if(rangeD!=Scalar(0))
 			{
-			nextEdge->dPoint=(corners[endCorner].position-corners[maxCorner].position)/rangeD;
-			nextEdge->point=corners[maxCorner].position+nextEdge->dPoint*(sliceD-cornerD[maxCorner]);
+			nextEdge->dPoint=(boxCorners[endCorner].position-boxCorners[maxCorner].position)/rangeD;
+			nextEdge->point=boxCorners[maxCorner].position+nextEdge->dPoint*(sliceD-cornerD[maxCorner]);
 			nextEdge->dPoint*=sliceDistance;
-			nextEdge->dTexture=(corners[endCorner].texture-corners[maxCorner].texture)/rangeD;
-			nextEdge->texture=corners[maxCorner].texture+nextEdge->dTexture*(sliceD-cornerD[maxCorner]);
+			nextEdge->dTexture=(boxCorners[endCorner].texture-boxCorners[maxCorner].texture)/rangeD;
+			nextEdge->texture=boxCorners[maxCorner].texture+nextEdge->dTexture*(sliceD-cornerD[maxCorner]);
 			nextEdge->dTexture*=sliceDistance;
 			}
 		nextEdge->pred=&edges[(i+2)%3];
@@ -400,27 +506,6 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 		expirations.insert(EdgeExpiration(cornerD[endCorner],nextEdge));
 		}
 	
-	/* Create/delete the texture cache if necessary: */
-	if(textureCachingEnabled)
-		dataItem->updateTextureCache(this,-1);
-	else
-		dataItem->deleteTextureCache();
-	
-	/* Set up OpenGL texturing parameters: */
-	prepareRenderViewPerpendicular(dataItem);
-	
-	#if 1
-	/* Upload the block texture: */
-	if(textureCachingEnabled)
-		{
-		glBindTexture(GL_TEXTURE_3D,dataItem->textureObjectIDs[0]);
-		if(!dataItem->textureCacheValid)
-			uploadTexture3D(dataItem);
-		}
-	else
-		uploadTexture3D(dataItem);
-	#endif
-	
 	/* Generate slices while updating the active edge list: */
 	while(sliceD>minD)
 		{
@@ -443,16 +528,16 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 				/* Create the two new edges: */
 				nextEdge->expired=false;
 				nextEdge->startIndex=startIndex;
-				int endIndex1=corners[startIndex].incomingEdgeSuccessors[edge->startIndex];
+				int endIndex1=boxCorners[startIndex].incomingEdgeSuccessors[edge->startIndex];
 				nextEdge->endIndex=endIndex1;
 				Scalar rangeD1=cornerD[endIndex1]-cornerD[startIndex];
 				if(rangeD1!=Scalar(0))
 					{
-					nextEdge->dPoint=(corners[endIndex1].position-corners[startIndex].position)/rangeD1;
-					nextEdge->point=corners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
+					nextEdge->dPoint=(boxCorners[endIndex1].position-boxCorners[startIndex].position)/rangeD1;
+					nextEdge->point=boxCorners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
 					nextEdge->dPoint*=sliceDistance;
-					nextEdge->dTexture=(corners[endIndex1].texture-corners[startIndex].texture)/rangeD1;
-					nextEdge->texture=corners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
+					nextEdge->dTexture=(boxCorners[endIndex1].texture-boxCorners[startIndex].texture)/rangeD1;
+					nextEdge->texture=boxCorners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
 					nextEdge->dTexture*=sliceDistance;
 					}
 				nextEdge->pred=edge->pred;
@@ -464,16 +549,16 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 				++nextEdge;
 				nextEdge->expired=false;
 				nextEdge->startIndex=startIndex;
-				int endIndex2=corners[startIndex].incomingEdgeSuccessors[endIndex1];
+				int endIndex2=boxCorners[startIndex].incomingEdgeSuccessors[endIndex1];
 				nextEdge->endIndex=endIndex2;
 				Scalar rangeD2=cornerD[endIndex2]-cornerD[startIndex];
 				if(rangeD2!=Scalar(0))
 					{
-					nextEdge->dPoint=(corners[endIndex2].position-corners[startIndex].position)/rangeD2;
-					nextEdge->point=corners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
+					nextEdge->dPoint=(boxCorners[endIndex2].position-boxCorners[startIndex].position)/rangeD2;
+					nextEdge->point=boxCorners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
 					nextEdge->dPoint*=sliceDistance;
-					nextEdge->dTexture=(corners[endIndex2].texture-corners[startIndex].texture)/rangeD2;
-					nextEdge->texture=corners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
+					nextEdge->dTexture=(boxCorners[endIndex2].texture-boxCorners[startIndex].texture)/rangeD2;
+					nextEdge->texture=boxCorners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
 					nextEdge->dTexture*=sliceDistance;
 					}
 				nextEdge->pred=nextEdge-1;
@@ -506,16 +591,16 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 				/* Create the new edge: */
 				nextEdge->expired=false;
 				nextEdge->startIndex=startIndex;
-				int endIndex=corners[startIndex].incomingEdgeSuccessors[pred->startIndex];
+				int endIndex=boxCorners[startIndex].incomingEdgeSuccessors[pred->startIndex];
 				nextEdge->endIndex=endIndex;
 				Scalar rangeD=cornerD[endIndex]-cornerD[startIndex];
 				if(rangeD!=Scalar(0))
 					{
-					nextEdge->dPoint=(corners[endIndex].position-corners[startIndex].position)/rangeD;
-					nextEdge->point=corners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
+					nextEdge->dPoint=(boxCorners[endIndex].position-boxCorners[startIndex].position)/rangeD;
+					nextEdge->point=boxCorners[startIndex].position+nextEdge->dPoint*(sliceD-cornerD[startIndex]);
 					nextEdge->dPoint*=sliceDistance;
-					nextEdge->dTexture=(corners[endIndex].texture-corners[startIndex].texture)/rangeD;
-					nextEdge->texture=corners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
+					nextEdge->dTexture=(boxCorners[endIndex].texture-boxCorners[startIndex].texture)/rangeD;
+					nextEdge->texture=boxCorners[startIndex].texture+nextEdge->dTexture*(sliceD-cornerD[startIndex]);
 					nextEdge->dTexture*=sliceDistance;
 					}
 				nextEdge->pred=pred->pred;
@@ -559,6 +644,112 @@ void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,
 		/* Go to the next slice: */
 		sliceD-=sliceDistance;
 		}
+	}
+
+bool VolumeRenderer::calcBrickBox(const VolumeBrickMap::Brick& brick,VolumeRenderer::BoxCorner brickCorners[8]) const
+	{
+	int brickTextureSize[3];
+	calcBrickTextureSize(brick,brickTextureSize);
+	
+	int iMask=0x1;
+	for(int i=0;i<3;++i,iMask+=iMask)
+		{
+		/* Clip the brick's cell range against the selected subblock: */
+		int cellMin=brick.cellOrigin[i];
+		if(cellMin<subOrigin[i])
+			cellMin=subOrigin[i];
+		int cellMax=brick.cellOrigin[i]+brick.cellSize[i];
+		if(cellMax>subOrigin[i]+subSize[i])
+			cellMax=subOrigin[i]+subSize[i];
+		if(cellMin>=cellMax)
+			return false;
+		
+		/* Calculate the clipped brick's corner positions in model coordinates: */
+		Scalar coordMin=origin[i]+Scalar(cellMin)*extent[i]/Scalar(numCells[i]);
+		Scalar coordMax=origin[i]+Scalar(cellMax)*extent[i]/Scalar(numCells[i]);
+		
+		/* Calculate the clipped brick's texture coordinates relative to the brick texture: */
+		Scalar texMin,texMax;
+		if(alignment==CELL_CENTERED)
+			{
+			texMin=Scalar(cellMin-brick.voxelOrigin[i])/Scalar(brickTextureSize[i]);
+			texMax=Scalar(cellMax-brick.voxelOrigin[i])/Scalar(brickTextureSize[i]);
+			}
+		else
+			{
+			texMin=(Scalar(cellMin-brick.voxelOrigin[i])+Scalar(0.5))/Scalar(brickTextureSize[i]);
+			texMax=(Scalar(cellMax-brick.voxelOrigin[i])+Scalar(0.5))/Scalar(brickTextureSize[i]);
+			}
+		
+		/* Update the brick box's corners: */
+		for(int j=0;j<8;++j)
+			{
+			brickCorners[j].position[i]=j&iMask?coordMax:coordMin;
+			brickCorners[j].texture[2-i]=j&iMask?texMax:texMin;
+			}
+		}
+	
+	return true;
+	}
+
+void VolumeRenderer::renderViewPerpendicular(VolumeRenderer::DataItem* dataItem,const VolumeRenderer::Vector& viewDirection) const
+	{
+	/* Create/delete the texture cache if necessary: */
+	if(textureCachingEnabled)
+		{
+		dataItem->updateTextureCache(this,-1);
+		
+		/* Invalidate all brick textures if the texture cache is invalid: */
+		if(!dataItem->textureCacheValid)
+			for(int i=0;i<dataItem->numTextureObjects;++i)
+				dataItem->brickTexturesValid[i]=false;
+		}
+	else
+		dataItem->deleteTextureCache();
+	
+	/* Set up OpenGL texturing parameters: */
+	prepareRenderViewPerpendicular(dataItem);
+	
+	/* Collect the visible bricks intersecting the selected subblock in back-to-front order: */
+	int subEnd[3];
+	bool descending[3];
+	for(int i=0;i<3;++i)
+		{
+		subEnd[i]=subOrigin[i]+subSize[i];
+		descending[i]=viewDirection[i]>Scalar(0);
+		}
+	std::vector<int> visibleBricks;
+	brickMap.getVisibleBricks(subOrigin,subEnd,descending,visibleBricks);
+	
+	/* Render each visible brick as a separate stack of slices, using the same slice planes for all bricks: */
+	BoxCorner brickCorners[8];
+	for(int i=0;i<8;++i)
+		brickCorners[i]=corners[i];
+	for(std::vector<int>::const_iterator bIt=visibleBricks.begin();bIt!=visibleBricks.end();++bIt)
+		{
+		const VolumeBrickMap::Brick& brick=brickMap.getBrick(*bIt);
+		if(!calcBrickBox(brick,brickCorners))
+			continue;
+		
+		/* Upload the brick texture: */
+		if(textureCachingEnabled)
+			{
+			glBindTexture(GL_TEXTURE_3D,dataItem->textureObjectIDs[*bIt]);
+			if(!dataItem->brickTexturesValid[*bIt])
+				{
+				/* Bricks that were skipped so far need a complete upload: */
+				dataItem->setParameters=true;
+				dataItem->uploadData=true;
+				uploadTexture3D(dataItem,brick);
+				dataItem->brickTexturesValid[*bIt]=true;
+				}
+			}
+		else
+			uploadTexture3D(dataItem,brick);
+		
+		/* Render the brick: */
+		renderBoxSlices(brickCorners,viewDirection);
+		}
 	
 	#if 1
 	if(textureCachingEnabled)
@@ -674,6 +865,12 @@ void VolumeRenderer::updateVoxelBlock(void)
 			}
 		}
 	
+	/* Subdivide the voxel block into bricks: */
+	if(values!=0)
+		brickMap.update(values,size,increments,alignment==VERTEX_CENTERED,mapValues?valueMap:0);
+	else
+		brickMap.clear();
+	
 	/* Update other settings depending on the voxel block size: */
 	calcBoxTexCoords();
 	calcBoxGeometry();
@@ -737,7 +934,7 @@ void VolumeRenderer::calcSlicingParameters(void)
 	}
 
 VolumeRenderer::VolumeRenderer(void)
-	:privateData(false),values(0),rowLength(0),imageHeight(0),
+	:privateData(false),mapValues(false),values(0),rowLength(0),imageHeight(0),
 	 useNPOTDTextures(false),renderingMode(AXIS_ALIGNED),
 	 interpolationMode(GL_NEAREST),textureFunction(GL_REPLACE),sliceFactor(Scalar(0.5)),
 	 autosaveGLState(true),textureCachingEnabled(false),
@@ -747,7 +944,7 @@ VolumeRenderer::VolumeRenderer(void)
 	}
 
 VolumeRenderer::VolumeRenderer(const char* filename)
-	:privateData(false),values(0),rowLength(0),imageHeight(0),
+	:privateData(false),mapValues(false),values(0),rowLength(0),imageHeight(0),
 	 useNPOTDTextures(false),renderingMode(AXIS_ALIGNED),
 	 interpolationMode(GL_NEAREST),textureFunction(GL_REPLACE),sliceFactor(Scalar(0.5)),
 	 autosaveGLState(true),textureCachingEnabled(false),
@@ -758,7 +955,7 @@ VolumeRenderer::VolumeRenderer(const char* filename)
 	}
 
 VolumeRenderer::VolumeRenderer(const VolumeRenderer::Voxel* sValues,const int sSize[3],int sBorderSize,VolumeRenderer::VoxelAlignment sAlignment)
-	:privateData(false),values(0),rowLength(0),imageHeight(0),
+	:privateData(false),mapValues(false),values(0),rowLength(0),imageHeight(0),
 	 useNPOTDTextures(false),renderingMode(AXIS_ALIGNED),
 	 interpolationMode(GL_NEAREST),textureFunction(GL_REPLACE),sliceFactor(Scalar(0.5)),
 	 autosaveGLState(true),textureCachingEnabled(false),
@@ -782,6 +979,15 @@ void VolumeRenderer::setUseNPOTDTextures(bool newUseNPOTDTextures)
 	updateVoxelBlock();
 	}
 
+void VolumeRenderer::setBrickSize(int newBrickSize)
+	{
+	/* Set the brick size: */
+	brickMap.setBrickSize(newBrickSize);
+	
+	/* Re-calculate the voxel block layout: */
+	updateVoxelBlock();
+	}
+
 void VolumeRenderer::clearVoxelBlock(void)
 	{
 	deletePrivateData();
@@ -811,6 +1017,10 @@ void VolumeRenderer::finishVoxelBlock(void)
 
 void VolumeRenderer::updateVoxelBlockData(void)
 	{
+	/* Update the bricks' value ranges: */
+	if(values!=0)
+		brickMap.update(values,size,increments,alignment==VERTEX_CENTERED,mapValues?valueMap:0);
+	
 	/* Update the data version counter: */
 	++dataVersion;
 	}
@@ -932,6 +1142,41 @@ void VolumeRenderer::setVoxelBlock(const SourceVoxelType* newValues,const int ne
 	updateVoxelBlock();
 	}
 
+void VolumeRenderer::setVoxelBlock(const SharedVoxelBlock& newBlock,const int newSize[3],VolumeRenderer::VoxelAlignment newAlignment)
+	{
+	deletePrivateData();
+	
+	/* Reference the shared voxel array and keep its owner alive: */
+	sharedStorage=newBlock.storage;
+	values=newBlock.voxels;
+	
+	/* Copy the given specifications: */
+	for(int i=0;i<3;++i)
+		{
+		size[i]=newSize[i];
+		increments[i]=int(newBlock.strides[i]);
+		}
+	borderSize=0;
+	alignment=newAlignment;
+	
+	/* Copy the shared block's value map: */
+	mapValues=!newBlock.identityMap;
+	for(int i=0;i<256;++i)
+		valueMap[i]=newBlock.valueMap[i];
+	
+	/* Update other data depending on the block specification: */
+	updateVoxelBlock();
+	}
+
+size_t VolumeRenderer::getPrivateMemorySize(void) const
+	{
+	if(!privateData)
+		return 0;
+	
+	/* The outermost increment spans one padded slab of the private block: */
+	return size_t(increments[0])*size_t(size[0]+borderSize+borderSize)*sizeof(Voxel);
+	}
+
 void VolumeRenderer::setRowLength(int newRowLength)
 	{
 	rowLength=newRowLength;
@@ -1092,7 +1337,7 @@ VolumeRenderer& VolumeRenderer::loadVolumeFile(const char* filename)
 		newIncrements[i-1]=newIncrements[i]*(newSize[i]+2*newBorderSize);
 		newValues+=newBorderSize*newIncrements[i-1];
 		}
-
+	
 	/* Set the voxel block as private data: */
 	setVoxelBlock(newValues,newSize,newBorderSize,VERTEX_CENTERED);
 	borderValue=0;
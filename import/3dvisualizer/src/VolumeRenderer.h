@@ -29,8 +29,15 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
 #include <GL/gl.h>
+#include <Misc/RefCounted.h>
+#include <Misc/Autopointer.h>
 #include <GL/GLObject.h>
 
+#include "VolumeBrickMap.h"
+
+/* Forward declarations: */
+class SharedVoxelBlock;
+
 class VolumeRenderer:public GLObject
 	{
 	/* Embedded classes: */
@@ -71,6 +78,7 @@ class VolumeRenderer:public GLObject
 		unsigned int dataVersion,settingsVersion; // Counters to synchronize volume renderer and texture cache states
 		int numTextureObjects; // Number of cached textures (texture objects)
 		GLuint* textureObjectIDs; // Array of texture object IDs
+		bool* brickTexturesValid; // Array of flags whether the texture objects of individual bricks have been uploaded
 		bool textureCacheValid; // Flag if the currently cached textures are valid
 		int cachedAxis; // When axis-aligned textures are used, major axis for which textures are cached
 		
@@ -78,6 +86,10 @@ class VolumeRenderer:public GLObject
 		bool setParameters;
 		bool uploadData;
 		
+		/* Staging buffer to assemble brick and slice textures: */
+		int stagingBufferSize; // Allocated size of staging buffer
+		Voxel* stagingBuffer; // Buffer holding the voxel values of the brick or slice currently being uploaded
+		
 		/* Constructors and destructors: */
 		DataItem(void);
 		virtual ~DataItem(void);
@@ -136,6 +148,9 @@ class VolumeRenderer:public GLObject
 	/* Elements: */
 	/* Data block description: */
 	bool privateData; // Flag if the voxel array has been allocated by the volume renderer itself
+	Misc::Autopointer<Misc::RefCounted> sharedStorage; // Object owning a shared voxel array; null if the voxel array is private or owned by the caller
+	bool mapValues; // Flag if voxel values have to be mapped through the value map before uploading
+	Voxel valueMap[256]; // Table mapping stored voxel values to rendered voxel values
 	const Voxel* values; // Pointer to the first interior voxel (not border voxel)
 	int size[3]; // Extents of voxel block
 	int borderSize; // Width of border around voxel block
@@ -146,6 +161,7 @@ class VolumeRenderer:public GLObject
 	int increments[3]; // Pointer increments for voxel block
 	bool useNPOTDTextures; // Flag whether the renderer should use non-power-of-two-dimension textures
 	int textureSize[3]; // Size of 2D/3D texture that can hold the complete data block
+	VolumeBrickMap brickMap; // Subdivision of the voxel block into independently textured and classified bricks
 	
 	/* Data block geometry description: */
 	Point origin; // Position of data block's origin in model coordinates
@@ -169,12 +185,18 @@ class VolumeRenderer:public GLObject
 	
 	/* Protected methods: */
 	virtual void deletePrivateData(void); // Deletes all privately allocated memory
+	Voxel* getStagingBuffer(DataItem* dataItem,int numVoxels) const; // Returns a staging buffer holding at least the given number of voxels
+	const Voxel* getSliceValues(DataItem* dataItem,int axis,int index,int sliceIncrements[2]) const; // Returns a pointer to the voxel values of the given slice, mapped through the value map if necessary, and their pointer increments along the slice's two axes
 	virtual void uploadTexture2D(DataItem* dataItem,int axis,int index) const; // Uploads a slice of voxel values as a 2D texture
-	virtual void uploadTexture3D(DataItem* dataItem) const; // Uploads the complete voxel block as a 3D texture
+	void calcBrickTextureSize(const VolumeBrickMap::Brick& brick,int brickTextureSize[3]) const; // Calculates the size of the 3D texture holding the given brick
+	const Voxel* extractBrickValues(DataItem* dataItem,const VolumeBrickMap::Brick& brick) const; // Copies the given brick's voxel values into a contiguous buffer
+	virtual void uploadTexture3D(DataItem* dataItem,const VolumeBrickMap::Brick& brick) const; // Uploads one brick of the voxel block as a 3D texture
 	virtual void prepareRenderAxisAligned(DataItem* dataItem) const; // Called right before the texture slices are rendered
 	void renderAxisAligned(DataItem* dataItem,const Vector& viewDirection) const; // Renders the voxel block as a stack of axis-aligned slices using 2D textures
 	virtual void prepareRenderViewPerpendicular(DataItem* dataItem) const; // Called right before the texture block is rendered
-	void renderViewPerpendicular(DataItem* dataItem,const Vector& viewDirection) const; // Renders the voxel block as a stack of view-perpendicular slices using 3D textures
+	bool calcBrickBox(const VolumeBrickMap::Brick& brick,BoxCorner brickCorners[8]) const; // Calculates the corners of the given brick clipped to the current subblock; returns false if the clipped brick is empty
+	void renderBoxSlices(const BoxCorner boxCorners[8],const Vector& viewDirection) const; // Renders the given box as a stack of view-perpendicular slices
+	void renderViewPerpendicular(DataItem* dataItem,const Vector& viewDirection) const; // Renders the voxel block's visible bricks as stacks of view-perpendicular slices using 3D textures
 	void calcIncrements(void); // Calculates pointer increments to navigate the voxel data
 	Voxel* createPrivateMemoryBlock(const int newSize[3],int newBorderSize); // Calculates "optimal" memory layout for the given voxel block specification (sometimes counter-intuitive)
 	void initBoxStructure(void); // Initializes the box corner structure
@@ -244,6 +266,15 @@ class VolumeRenderer:public GLObject
 		return useNPOTDTextures;
 		}
 	void setUseNPOTDTextures(bool newUseNPOTDTextures); // Sets the non-power-of-two-dimension textures flag
+	const VolumeBrickMap& getBrickMap(void) const // Returns the voxel block's brick map
+		{
+		return brickMap;
+		}
+	int getBrickSize(void) const // Returns the maximum size of a 3D texture brick in voxels
+		{
+		return brickMap.getBrickSize();
+		}
+	void setBrickSize(int newBrickSize); // Sets the maximum size of a 3D texture brick in voxels; should be a power of two
 	const Point& getOrigin(void) const // Returns the voxel block's origin in model coordinates
 		{
 		return origin;
@@ -298,6 +329,12 @@ class VolumeRenderer:public GLObject
 	void updateVoxelBlockData(void); // Notifies the volume renderer that data in the voxel block has changed
 	void setVoxelBlock(const Voxel* newValues,const int newSize[3],int newBorderSize,VoxelAlignment newAlignment); // Sets the volume renderer to a new voxel block
 	void setVoxelBlock(const Voxel* newValues,const int newSize[3],int newBorderSize,const int newIncrements[3],VoxelAlignment newAlignment); // Sets the volume renderer to a new voxel block
+	void setVoxelBlock(const SharedVoxelBlock& newBlock,const int newSize[3],VoxelAlignment newAlignment); // Sets the volume renderer to a shared voxel block without copying it
+	bool isVoxelBlockShared(void) const // Returns true if the volume renderer renders a shared voxel block
+		{
+		return sharedStorage!=0;
+		}
+	size_t getPrivateMemorySize(void) const; // Returns the size of the privately allocated voxel block in bytes
 	template <class SourceVoxelType>
 	void setVoxelBlock(const SourceVoxelType* newValues,const int newSize[3],int newBorderSize,const int newIncrements[3],VoxelAlignment newAlignment,SourceVoxelType rangeMin,SourceVoxelType rangeMax); // Sets the volume renderer to a new voxel block with conversion
 	virtual void setRowLength(int newRowLength); // Sets the special row length
@@ -29,5 +29,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Templatized/SliceCaseTableTesseract.h>
 #include <Templatized/IsosurfaceCaseTableTesseract.h>
 #include <Templatized/VolumeRenderingSamplerCartesian.h>
+#include <Templatized/IsosurfacePreviewerCartesian.h>
 
 #endif
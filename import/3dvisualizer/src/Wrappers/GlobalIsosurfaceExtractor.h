@@ -134,6 +134,10 @@ class GlobalIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 		{
 		return true;
 		}
+	virtual bool hasElementLoader(void) const
+		{
+		return true;
+		}
 	virtual GLMotif::Widget* createSettingsDialog(GLMotif::WidgetManager* widgetManager);
 	virtual void readParameters(Visualization::Abstract::ParametersSource& source);
 	virtual Visualization::Abstract::Parameters* cloneParameters(void) const
@@ -141,6 +145,7 @@ class GlobalIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 		return new Parameters(parameters);
 		}
 	virtual Visualization::Abstract::Element* createElement(Visualization::Abstract::Parameters* extractParameters);
+	virtual Visualization::Abstract::Element* loadElement(Visualization::Abstract::Parameters* extractParameters,IO::SeekableFile& geometryFile);
 	virtual Visualization::Abstract::Element* startSlaveElement(Visualization::Abstract::Parameters* extractParameters);
 	
 	/* New methods: */
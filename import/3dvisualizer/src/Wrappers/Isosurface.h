@@ -74,6 +74,7 @@ class Isosurface:public Visualization::Abstract::Element
 	/* Methods from Visualization::Abstract::Element: */
 	virtual std::string getName(void) const;
 	virtual size_t getSize(void) const;
+	virtual bool saveGeometry(IO::File& geometryFile) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
 	
 	/* New methods: */
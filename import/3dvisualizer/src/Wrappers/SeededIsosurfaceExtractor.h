@@ -48,6 +48,8 @@ template <class ScalarParam,class SourceValueParam>
 class ScalarExtractor;
 template <class DataSetParam,class ScalarExtractorParam,class IsosurfaceParam>
 class IsosurfaceExtractor;
+template <class DataSetParam,class ScalarExtractorParam,class IsosurfaceParam>
+class IsosurfacePreviewer;
 }
 namespace Wrappers {
 template <class SEParam>
@@ -80,6 +82,7 @@ class SeededIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 	typedef Misc::Autopointer<Isosurface> IsosurfacePointer; // Type for pointers to created visualization elements
 	typedef typename Isosurface::Surface Surface; // Type of low-level surface representation
 	typedef Visualization::Templatized::IsosurfaceExtractor<DS,SE,Surface> ISE; // Type of templatized isosurface extractor
+	typedef Visualization::Templatized::IsosurfacePreviewer<DS,SE,Surface> ISP; // Type of templatized isosurface previewer
 	
 	private:
 	class Parameters:public Visualization::Abstract::Parameters // Class to store extraction parameters for seeded isosurfaces
@@ -122,7 +125,11 @@ class SeededIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 	static const char* name; // Identifying name of this algorithm
 	Parameters parameters; // The isosurface extraction parameters used by this extractor
 	ISE ise; // The templatized isosurface extractor
+	ISP isp; // The templatized isosurface previewer
+	int previewScalarVariableIndex; // Index of the scalar variable for which the isosurface previewer was last updated
+	double maxPreviewTime; // Time budget for extracting an isosurface preview in seconds
 	IsosurfacePointer currentIsosurface; // The currently extracted isosurface visualization element
+	bool currentIsPreview; // Flag whether the currently extracted isosurface is a coarse preview
 	
 	/* UI components: */
 	GLMotif::TextFieldSlider* maxNumTrianglesSlider; // Slider to adjust maximum number of extracted triangles
@@ -151,6 +158,14 @@ class SeededIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 		{
 		return true;
 		}
+	virtual bool hasPreviewCreator(void) const
+		{
+		return isp.canPreview();
+		}
+	virtual bool hasElementLoader(void) const
+		{
+		return true;
+		}
 	virtual GLMotif::Widget* createSettingsDialog(GLMotif::WidgetManager* widgetManager);
 	virtual void readParameters(Visualization::Abstract::ParametersSource& source);
 	virtual Visualization::Abstract::Parameters* cloneParameters(void) const
@@ -160,8 +175,10 @@ class SeededIsosurfaceExtractor:public Visualization::Abstract::Algorithm
 	virtual void setSeedLocator(const Visualization::Abstract::DataSet::Locator* seedLocator);
 	virtual Visualization::Abstract::Element* createElement(Visualization::Abstract::Parameters* extractParameters);
 	virtual Visualization::Abstract::Element* startElement(Visualization::Abstract::Parameters* extractParameters);
+	virtual Visualization::Abstract::Element* startPreviewElement(Visualization::Abstract::Parameters* extractParameters);
 	virtual bool continueElement(const Realtime::AlarmTimer& alarm);
 	virtual void finishElement(void);
+	virtual Visualization::Abstract::Element* loadElement(Visualization::Abstract::Parameters* extractParameters,IO::SeekableFile& geometryFile);
 	virtual Visualization::Abstract::Element* startSlaveElement(Visualization::Abstract::Parameters* extractParameters);
 	virtual void continueSlaveElement(void);
 	
@@ -139,6 +139,10 @@ class SeededSliceExtractor:public Visualization::Abstract::Algorithm
 		{
 		return true;
 		}
+	virtual bool hasElementLoader(void) const
+		{
+		return true;
+		}
 	virtual void readParameters(Visualization::Abstract::ParametersSource& source);
 	virtual Visualization::Abstract::Parameters* cloneParameters(void) const
 		{
@@ -149,6 +153,7 @@ class SeededSliceExtractor:public Visualization::Abstract::Algorithm
 	virtual Visualization::Abstract::Element* startElement(Visualization::Abstract::Parameters* extractParameters);
 	virtual bool continueElement(const Realtime::AlarmTimer& alarm);
 	virtual void finishElement(void);
+	virtual Visualization::Abstract::Element* loadElement(Visualization::Abstract::Parameters* extractParameters,IO::SeekableFile& geometryFile);
 	virtual Visualization::Abstract::Element* startSlaveElement(Visualization::Abstract::Parameters* extractParameters);
 	virtual void continueSlaveElement(void);
 	
@@ -45,6 +45,7 @@ size_t MulticastPipe::readData(IO::File::Byte* buffer,size_t bufferSize)
 	
 	/* Get the next packet from the multiplexer: */
 	packet=multiplexer->receivePacket(pipeId);
+	numBytes+=packet->packetSize;
 	
 	/* Install the new packet as the buffered file's read buffer: */
 	setReadBuffer(Packet::maxPacketSize,reinterpret_cast<Byte*>(packet->packet),false);
@@ -61,6 +62,7 @@ void MulticastPipe::writeData(const IO::File::Byte* buffer,size_t bufferSize)
 	sendPacket->packetSize=bufferSize;
 	multiplexer->sendPacket(pipeId,sendPacket);
 	}
+	numBytes+=bufferSize;
 	
 	/* Install a fresh cluster packet as the write buffer: */
 	packet=multiplexer->newPacket();
@@ -75,7 +77,7 @@ void MulticastPipe::flushPipe(void)
 
 MulticastPipe::MulticastPipe(Multiplexer* sMultiplexer)
 	:IO::File(),ClusterPipe(sMultiplexer),
-	 packet(0)
+	 packet(0),numBytes(0)
 	{
 	/* Set up the master or slave buffers: */
 	if(isMaster())
@@ -41,6 +41,7 @@ class MulticastPipe:public IO::File,public ClusterPipe
 	private:
 	Packet* packet; // Pointer to current packet
 	size_t packetPos; // Data position in current packet
+	size_t numBytes; // Total number of bytes passed to the multiplexer (master) or received from the multiplexer (slaves)
 	
 	/* Protected methods from IO::File: */
 	protected:
@@ -66,6 +67,10 @@ class MulticastPipe:public IO::File,public ClusterPipe
 	virtual void resizeWriteBuffer(size_t newWriteBufferSize);
 	
 	/* New methods: */
+	size_t getNumBytes(void) const // Returns the total number of bytes written into (master) or received through (slaves) the pipe so far
+		{
+		return isMaster()?numBytes+size_t(getWritePtr()):numBytes;
+		}
 	template <class DataParam>
 	void broadcast(DataParam& data) // Sends single value of arbitrary type from master to all slaves; does not change value on master
 		{
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Cluster/Multiplexer.h>
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -43,6 +44,12 @@ namespace Cluster {
 
 namespace {
 
+/****************
+Helper constants:
+****************/
+
+const unsigned int parityPipeIdFlag=0x40000000U; // Flag set in the pipe ID of forward error correction parity packets
+
 /****************
 Helper functions:
 ****************/
@@ -123,7 +130,8 @@ Multiplexer::PipeState::PipeState(unsigned int nodeIndex,unsigned int numSlaves)
 	 headStreamPos(0),
 	 slaveStreamPosOffsets(0),numHeadSlaves(0),
 	 barrierId(0),slaveBarrierIds(0),minSlaveBarrierId(0),
-	 slaveGatherValues(0)
+	 slaveGatherValues(0),
+	 fecGroupStart(0),fecNumPackets(0),fecParitySize(0),fecParity(0),fecValid(false)
 	 #if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 	 ,
 	 numResentPackets(0),numResentBytes(0)
@@ -162,6 +170,9 @@ Multiplexer::PipeState::~PipeState(void)
 	
 	/* Destroy slave gather value array: */
 	delete[] slaveGatherValues;
+	
+	/* Destroy the parity accumulator: */
+	delete fecParity;
 	}
 	}
 
@@ -356,6 +367,173 @@ void Multiplexer::processAcknowledgment(Multiplexer::LockedPipe& pipeState,int s
 		}
 	}
 
+void Multiplexer::accumulateParity(Multiplexer::LockedPipe& pipeState,const Packet* packet)
+	{
+	/* Start a new parity packet if this is the first packet in the group: */
+	if(pipeState->fecParity==0)
+		pipeState->fecParity=newPacket();
+	if(pipeState->fecNumPackets==0)
+		pipeState->fecParitySize=0;
+	
+	/* XOR the packet's data into the parity data, treating the parity data as zero-padded: */
+	char* parity=pipeState->fecParity->packet+2*sizeof(unsigned int);
+	size_t overlap=packet->packetSize<pipeState->fecParitySize?packet->packetSize:pipeState->fecParitySize;
+	for(size_t i=0;i<overlap;++i)
+		parity[i]^=packet->packet[i];
+	if(packet->packetSize>pipeState->fecParitySize)
+		{
+		memcpy(parity+pipeState->fecParitySize,packet->packet+pipeState->fecParitySize,packet->packetSize-pipeState->fecParitySize);
+		pipeState->fecParitySize=packet->packetSize;
+		}
+	
+	++pipeState->fecNumPackets;
+	}
+
+Packet* Multiplexer::finishParity(Multiplexer::LockedPipe& pipeState,unsigned int pipeId)
+	{
+	/* Bail out if the group is empty: */
+	if(pipeState->fecNumPackets==0)
+		return 0;
+	
+	/* Complete the parity packet: */
+	Packet* parity=pipeState->fecParity;
+	parity->pipeId=pipeId|parityPipeIdFlag;
+	parity->streamPos=pipeState->fecGroupStart;
+	unsigned int groupHeader[2]; // Stream position after the group's last packet, and number of packets in the group
+	groupHeader[0]=pipeState->streamPos;
+	groupHeader[1]=pipeState->fecNumPackets;
+	memcpy(parity->packet,groupHeader,sizeof(groupHeader));
+	parity->packetSize=sizeof(groupHeader)+pipeState->fecParitySize;
+	
+	/* Start a new parity group: */
+	pipeState->fecParity=0;
+	pipeState->fecNumPackets=0;
+	
+	return parity;
+	}
+
+void Multiplexer::sendParity(Packet* parity)
+	{
+	/* Send the parity packet behind the group's last data packet: */
+	{
+	// SocketMutex::Lock socketLock(socketMutex);
+	sendto(socketFd,&parity->pipeId,parity->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
+	}
+	deletePacket(parity);
+	}
+
+void Multiplexer::deliverPacket(Multiplexer::LockedPipe& pipeState,Packet* packet)
+	{
+	/* Wake up sleeping receivers if the delivery queue is currently empty: */
+	if(pipeState->packetList.empty())
+		pipeState->receiveCond.signal();
+	
+	/* Append the packet to the pipe state's delivery queue: */
+	pipeState->streamPos+=packet->packetSize;
+	pipeState->packetList.push_back(packet);
+	}
+
+void Multiplexer::deliverHeldPackets(Multiplexer::LockedPipe& pipeState)
+	{
+	/* Deliver held-back packets while they continue the stream without a gap: */
+	while(!pipeState->fecHeldPackets.empty()&&pipeState->fecHeldPackets.front()->streamPos==pipeState->streamPos)
+		deliverPacket(pipeState,pipeState->fecHeldPackets.pop_front());
+	}
+
+void Multiplexer::abandonParity(Multiplexer::LockedPipe& pipeState)
+	{
+	/* Return all held-back packets to the packet pool; the master will resend them: */
+	while(!pipeState->fecHeldPackets.empty())
+		deletePacket(pipeState->fecHeldPackets.pop_front());
+	
+	/* Invalidate the parity accumulator until the stream reaches the next group boundary: */
+	pipeState->fecValid=false;
+	pipeState->fecNumPackets=0;
+	}
+
+void Multiplexer::sendPacketLoss(Multiplexer::LockedPipe& pipeState,unsigned int packetPos)
+	{
+	if(!pipeState->packetLossMode)
+		{
+		/* Send negative acknowledgment to the master: */
+		StreamMessage msg(nodeIndex|0x80000000U,Message::PACKETLOSS,pipeState->pipeId,pipeState->streamPos,packetPos);
+		{
+		// SocketMutex::Lock socketLock(socketMutex);
+		for(int i=0;i<slaveMessageBurstSize;++i)
+			sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
+		}
+		
+		/* Enable packet loss mode to prohibit sending further loss messages until the missing packet arrives: */
+		pipeState->packetLossMode=true;
+		}
+	}
+
+void Multiplexer::processParity(Multiplexer::LockedPipe& pipeState,const Packet* parity)
+	{
+	/* Extract the parity group's layout from the parity packet: */
+	unsigned int groupHeader[2]; // Stream position after the group's last packet, and number of packets in the group
+	memcpy(groupHeader,parity->packet,sizeof(groupHeader));
+	unsigned int groupEnd=groupHeader[0];
+	const char* parityData=parity->packet+2*sizeof(unsigned int);
+	size_t paritySize=parity->packetSize-2*sizeof(unsigned int);
+	
+	/* Check if exactly one packet of the current parity group is missing: */
+	if(pipeState->fecValid&&parity->streamPos==pipeState->fecGroupStart&&pipeState->fecNumPackets+1==groupHeader[1])
+		{
+		/* The missing packet starts at the current stream position and ends at the first held-back packet or the group's end: */
+		unsigned int missingEnd=groupEnd;
+		if(!pipeState->fecHeldPackets.empty())
+			{
+			/* All held-back packets must be part of this group: */
+			const Packet* lastHeld=pipeState->fecHeldPackets.back();
+			if(lastHeld->streamPos+lastHeld->packetSize==groupEnd)
+				missingEnd=pipeState->fecHeldPackets.front()->streamPos;
+			else
+				missingEnd=pipeState->streamPos;
+			}
+		size_t missingSize=missingEnd-pipeState->streamPos;
+		if(missingSize>0&&missingSize<=paritySize&&missingSize<=Packet::maxPacketSize)
+			{
+			/* Recover the missing packet by XORing the parity data with all received packets of the group: */
+			Packet* packet=newPacket();
+			packet->pipeId=pipeState->pipeId;
+			packet->streamPos=pipeState->streamPos;
+			packet->packetSize=missingSize;
+			memcpy(packet->packet,parityData,missingSize);
+			if(pipeState->fecNumPackets>0)
+				{
+				const char* accumulated=pipeState->fecParity->packet+2*sizeof(unsigned int);
+				size_t overlap=missingSize<pipeState->fecParitySize?missingSize:pipeState->fecParitySize;
+				for(size_t i=0;i<overlap;++i)
+					packet->packet[i]^=accumulated[i];
+				}
+			
+			/* Deliver the recovered packet and all held-back packets behind it: */
+			pipeState->packetLossMode=false;
+			deliverPacket(pipeState,packet);
+			deliverHeldPackets(pipeState);
+			}
+		}
+	
+	if(pipeState->fecHeldPackets.empty()&&pipeState->streamPos==groupEnd)
+		{
+		/* The stream is complete up to the end of the group; start the next parity group: */
+		pipeState->fecValid=true;
+		pipeState->fecGroupStart=groupEnd;
+		pipeState->fecNumPackets=0;
+		}
+	else
+		{
+		/* Check if data before the end of the group is still missing; watch for stream position wrap-around: */
+		bool dataMissing=!pipeState->fecHeldPackets.empty()||groupEnd-pipeState->streamPos<=0x80000000U;
+		
+		/* Give up on the parity group, and request retransmission of any missing data from the master: */
+		abandonParity(pipeState);
+		if(dataMissing)
+			sendPacketLoss(pipeState,groupEnd);
+		}
+	}
+
 void* Multiplexer::packetHandlingThreadMaster(void)
 	{
 	Threads::Thread::setCancelState(Threads::Thread::CANCEL_ENABLE);
@@ -489,7 +667,7 @@ void* Multiplexer::packetHandlingThreadMaster(void)
 									do
 										{
 										++lastPipeId;
-										if(lastPipeId==0x80000000U) // Ensure that pipeId never has the MSB set
+										if(lastPipeId==parityPipeIdFlag) // Ensure that pipeId never has the MSB set, or the parity packet flag
 											lastPipeId=1;
 										}
 									while(pipeStateTable.isEntry(lastPipeId));
@@ -848,6 +1026,10 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 			{
 			slaveThreadPacket->packetSize=size_t(numBytesReceived-2*sizeof(unsigned int));
 			
+			/* Drop stream packets at random to simulate an unreliable network: */
+			if(slaveThreadPacket->pipeId!=0&&simulatedPacketLoss>0.0&&double(rand())<simulatedPacketLoss*(double(RAND_MAX)+1.0))
+				continue;
+			
 			if(slaveThreadPacket->pipeId==0)
 				{
 				/* It's a message for the pipe multiplexer itself: */
@@ -979,6 +1161,15 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 						}
 					}
 				}
+			else if(slaveThreadPacket->pipeId&parityPipeIdFlag)
+				{
+				/* It's a forward error correction parity packet; get a handle on the state object of the pipe it protects: */
+				LockedPipe pipeState(pipeStateTable,pipeStateTableMutex,slaveThreadPacket->pipeId&~parityPipeIdFlag);
+				
+				/* Process the parity packet if forward error correction is enabled: */
+				if(pipeState.isValid()&&fecGroupSize>0&&slaveThreadPacket->packetSize>=2*sizeof(unsigned int))
+					processParity(pipeState,slaveThreadPacket);
+				}
 			else
 				{
 				/* Get a handle on the state object of the pipe the packet is meant for: */
@@ -1004,32 +1195,39 @@ void* Multiplexer::packetHandlingThreadSlave(void)
 							sendAckIn=0;
 							}
 						
-						/* Wake up sleeping receivers if the delivery queue is currently empty: */
-						if(pipeState->packetList.empty())
-							pipeState->receiveCond.signal();
+						/* Add the packet to the current parity group: */
+						if(pipeState->fecValid)
+							accumulateParity(pipeState,slaveThreadPacket);
 						
 						/* Append the packet to the pipe state's delivery queue: */
-						pipeState->streamPos+=slaveThreadPacket->packetSize;
-						pipeState->packetList.push_back(slaveThreadPacket);
+						deliverPacket(pipeState,slaveThreadPacket);
 						
 						/* Get a new packet: */
 						slaveThreadPacket=newPacket();
+						
+						/* Deliver any held-back packets that follow the new packet: */
+						deliverHeldPackets(pipeState);
 						}
 					else
 						{
 						/* Check if there is data missing between the packet's stream position and the pipe's stream position; watch for stream position wrap-around: */
-						if(!pipeState->packetLossMode&&slaveThreadPacket->streamPos-pipeState->streamPos<=0x80000000U)
-							{
-							/* At least one packet must have been lost; send negative acknowledgment to the master: */
-							StreamMessage msg(sendNodeIndex,Message::PACKETLOSS,slaveThreadPacket->pipeId,pipeState->streamPos,slaveThreadPacket->streamPos);
+						if(slaveThreadPacket->streamPos-pipeState->streamPos<=0x80000000U)
 							{
-							// SocketMutex::Lock socketLock(socketMutex);
-							for(int i=0;i<slaveMessageBurstSize;++i)
-								sendto(socketFd,&msg,sizeof(StreamMessage),0,(const sockaddr*)otherAddress,sizeof(struct sockaddr_in));
-							}
-
-							/* Enable packet loss mode to prohibit sending further loss messages until the missing packet arrives: */
-							pipeState->packetLossMode=true;
+							/* Check if the missing data is a single gap that can be recovered from the current parity group: */
+							PipeState::PacketList& held=pipeState->fecHeldPackets;
+							if(pipeState->fecValid&&held.size()+1<fecGroupSize&&(held.empty()||held.back()->streamPos+held.back()->packetSize==slaveThreadPacket->streamPos))
+								{
+								/* Hold the packet back until the group's parity packet recovers the missing data: */
+								accumulateParity(pipeState,slaveThreadPacket);
+								held.push_back(slaveThreadPacket);
+								slaveThreadPacket=newPacket();
+								}
+							else
+								{
+								/* At least one packet must have been lost; fall back to requesting retransmission from the master: */
+								abandonParity(pipeState);
+								sendPacketLoss(pipeState,slaveThreadPacket->streamPos);
+								}
 							}
 						}
 					}
@@ -1065,6 +1263,7 @@ Multiplexer::Multiplexer(unsigned int sNumSlaves,unsigned int sNodeIndex,std::st
 	 receiveWaitTimeout(0.25),
 	 barrierWaitTimeout(0.1),
 	 sendBufferSize(20),
+	 fecGroupSize(0),simulatedPacketLoss(0.0),
 	 packetPoolHead(0)
 	{
 	/* Lookup master's IP address: */
@@ -1248,6 +1447,16 @@ void Multiplexer::setSendBufferSize(unsigned int newSendBufferSize)
 	sendBufferSize=newSendBufferSize;
 	}
 
+void Multiplexer::setFecGroupSize(unsigned int newFecGroupSize)
+	{
+	fecGroupSize=newFecGroupSize;
+	}
+
+void Multiplexer::setSimulatedPacketLoss(double newSimulatedPacketLoss)
+	{
+	simulatedPacketLoss=newSimulatedPacketLoss;
+	}
+
 void Multiplexer::waitForConnection(void)
 	{
 	{
@@ -1279,6 +1488,9 @@ unsigned int Multiplexer::openPipe(void)
 		/* If the new pipe state hasn't been created already, do it here: */
 		newPipeState=new PipeState(nodeIndex,numSlaves);
 		
+		/* Start accumulating the first parity group on slave nodes if forward error correction is enabled: */
+		newPipeState->fecValid=nodeIndex!=0&&fecGroupSize>0;
+		
 		/* Add the new pipe state to the new pipe map: */
 		newPipes[threadId]=newPipeState;
 		}
@@ -1458,6 +1670,25 @@ void Multiplexer::sendPacket(unsigned int pipeId,Packet* packet)
 	pipeState->streamPos+=packet->packetSize;
 	pipeState->packetList.push_back(packet);
 	
+	/* Add the packet to the pipe's current forward error correction parity group: */
+	Packet* parity=0;
+	if(fecGroupSize>0)
+		{
+		if(pipeState->fecNumPackets==0)
+			pipeState->fecGroupStart=packet->streamPos;
+		accumulateParity(pipeState,packet);
+		
+		/*******************************************************************
+		Finish the parity packet if the group is complete, or if the packet
+		is short. Short packets are sent when the pipe is flushed, so no more
+		packets may follow for a while, and slaves would otherwise hold back
+		the group's tail until the packet loss timeout:
+		*******************************************************************/
+		
+		if(pipeState->fecNumPackets>=fecGroupSize||packet->packetSize<Packet::maxPacketSize)
+			parity=finishParity(pipeState,pipeId);
+		}
+	
 	/* It's safe to unlock the pipe state now: */
 	pipeState.unlock();
 	
@@ -1466,6 +1697,9 @@ void Multiplexer::sendPacket(unsigned int pipeId,Packet* packet)
 	// SocketMutex::Lock socketLock(socketMutex);
 	sendto(socketFd,&packet->pipeId,packet->packetSize+2*sizeof(unsigned int),0,(const sockaddr*)otherAddress,sizeof(sockaddr_in));
 	}
+	
+	if(parity!=0)
+		sendParity(parity);
 	}
 
 Packet* Multiplexer::receivePacket(unsigned int pipeId)
@@ -1513,6 +1747,11 @@ void Multiplexer::barrier(unsigned int pipeId)
 	
 	if(nodeIndex==0)
 		{
+		/* Complete the current parity group, as no more packets will be sent until all slaves have received the ones already sent: */
+		Packet* parity=finishParity(pipeState,pipeId);
+		if(parity!=0)
+			sendParity(parity);
+		
 		/* Wait until barrier messages from all slaves have been received: */
 		while(pipeState->minSlaveBarrierId<nextBarrierId)
 			{
@@ -1581,6 +1820,11 @@ unsigned int Multiplexer::gather(unsigned int pipeId,unsigned int value,GatherOp
 	
 	if(nodeIndex==0)
 		{
+		/* Complete the current parity group, as no more packets will be sent until all slaves have received the ones already sent: */
+		Packet* parity=finishParity(pipeState,pipeId);
+		if(parity!=0)
+			sendParity(parity);
+		
 		/* Wait until gather messages from all slaves have been received: */
 		while(pipeState->minSlaveBarrierId<nextBarrierId)
 			{
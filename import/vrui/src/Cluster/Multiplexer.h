@@ -98,6 +98,12 @@ class Multiplexer
 		unsigned int minSlaveBarrierId; // Smallest barrier ID currently in the state array
 		unsigned int* slaveGatherValues; // Array of most recently received gather values from the slaves
 		unsigned int masterGatherValue; // Final value of last completed gather operation in pipe
+		unsigned int fecGroupStart; // Stream position of the first packet in the current forward error correction parity group
+		unsigned int fecNumPackets; // Number of data packets accumulated into the current parity group so far
+		size_t fecParitySize; // Size of the largest data packet accumulated into the current parity group so far
+		Packet* fecParity; // Packet holding the running XOR of the current parity group's data packets behind a two-word header, or NULL
+		bool fecValid; // Flag if the parity accumulator covers all received packets of the current parity group (slave side only)
+		PacketList fecHeldPackets; // Packets received after a single missing packet, held back until the group's parity packet arrives (slave side only)
 		#if CLUSTER_CONFIG_DEBUG_MULTIPLEXER
 		size_t numResentPackets;
 		size_t numResentBytes;
@@ -200,12 +206,22 @@ class Multiplexer
 	Misc::Time receiveWaitTimeout; // Timeout between packet loss messages from the slaves
 	Misc::Time barrierWaitTimeout; // Timeout between barrier messages from the slaves
 	unsigned int sendBufferSize; // Maximum number of packets buffered for each pipe
+	unsigned int fecGroupSize; // Number of data packets protected by each forward error correction parity packet; 0 disables forward error correction
+	double simulatedPacketLoss; // Probability with which a slave drops received stream packets to test packet loss recovery
 	Threads::Spinlock packetPoolMutex; // Mutex protecting the free packet pool
 	Packet* packetPoolHead; // Pool of recently deleted packets to minimize number of new/delete calls
 	
 	/* Private methods: */
 	Packet* allocatePacket(void);
 	void processAcknowledgment(LockedPipe& pipeState,int slaveIndex,unsigned int streamPos); // Processes an acknowlegment (positive or implied-positive) from a slave
+	void accumulateParity(LockedPipe& pipeState,const Packet* packet); // XORs the given data packet into the pipe's current parity group
+	Packet* finishParity(LockedPipe& pipeState,unsigned int pipeId); // Completes the pipe's current, possibly partial, parity group on the master node; returns the parity packet, or NULL if the group is empty
+	void sendParity(Packet* parity); // Sends the given parity packet from the master node to the slaves and deletes it
+	void deliverPacket(LockedPipe& pipeState,Packet* packet); // Appends the given in-order packet to the pipe's delivery queue on a slave node
+	void deliverHeldPackets(LockedPipe& pipeState); // Delivers held-back packets that have become in-order on a slave node
+	void abandonParity(LockedPipe& pipeState); // Discards the pipe's current parity group and all held-back packets on a slave node
+	void sendPacketLoss(LockedPipe& pipeState,unsigned int packetPos); // Requests retransmission of missing data from the master unless already in packet loss mode
+	void processParity(LockedPipe& pipeState,const Packet* parity); // Recovers a single lost packet from the given parity packet on a slave node
 	void* packetHandlingThreadMaster(void); // Packet handling thread method for the master
 	void* packetHandlingThreadSlave(void); // Packet handling thread method for the slaves
 	
@@ -256,6 +272,12 @@ class Multiplexer
 	void setReceiveWaitTimeout(Misc::Time newReceiveWaitTimeout); // Sets the timeout when waiting for data packages
 	void setBarrierWaitTimeout(Misc::Time newBarrierWaitTimeout); // Sets the timeout when waiting for barrier messages
 	void setSendBufferSize(unsigned int newSendBufferSize); // Sets the maximum number of packets held in each pipe's send queue
+	unsigned int getFecGroupSize(void) const // Returns the number of data packets protected by each parity packet; 0 if forward error correction is disabled
+		{
+		return fecGroupSize;
+		}
+	void setFecGroupSize(unsigned int newFecGroupSize); // Sets the number of data packets protected by each parity packet, i.e., the inverse of the parity overhead; 0 disables forward error correction; must be set identically on all nodes
+	void setSimulatedPacketLoss(double newSimulatedPacketLoss); // Sets the probability with which a slave drops received stream packets, for testing
 	void waitForConnection(void); // Waits until all slaves have connected to the master
 	
 	/* Pipe management interface: */
@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/SeekableFilter.h>
 #include <IO/StandardDirectory.h>
 #include <Comm/HttpFile.h>
+#include <Comm/ParallelHttpFile.h>
 #include <Cluster/Multiplexer.h>
 #include <Cluster/StandardFile.h>
 #include <Cluster/TCPPipe.h>
@@ -50,8 +51,15 @@ IO::FilePtr openFile(Multiplexer* multiplexer,const char* fileName,IO::File::Acc
 		
 		if(multiplexer==0)
 			{
-			/* Open a non-shared remote file via the HTTP/1.1 protocol: */
-			result=new Comm::HttpFile(fileName);
+			/* Open a non-shared remote file via parallel HTTP/1.1 range requests, or via a single streaming request if the server does not support ranges: */
+			try
+				{
+				result=new Comm::ParallelHttpFile(fileName);
+				}
+			catch(IO::File::OpenError err)
+				{
+				result=new Comm::HttpFile(fileName);
+				}
 			}
 		else if(multiplexer->isMaster())
 			{
@@ -33,7 +33,8 @@ struct Packet
 	/* Embedded classes: */
 	public:
 	static const size_t maxRawPacketSize=CLUSTER_CONFIG_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE; // Configured MTU size minus IP header size minus UDP header size
-	static const size_t maxPacketSize=CLUSTER_CONFIG_MTU_SIZE-CLUSTER_CONFIG_IP_HEADER_SIZE-CLUSTER_CONFIG_UDP_HEADER_SIZE-2*sizeof(unsigned int); // Maximum size of multicast packet data payload in bytes
+	static const size_t maxPayloadSize=maxRawPacketSize-2*sizeof(unsigned int); // Raw packet size minus pipe ID and stream position header
+	static const size_t maxPacketSize=maxPayloadSize-2*sizeof(unsigned int); // Maximum size of multicast packet data payload in bytes; leaves room for the header of forward error correction parity packets
 	
 	class Reader // Simple class to read data from packets
 		{
@@ -112,7 +113,7 @@ struct Packet
 	size_t packetSize; // Actual size of packet
 	unsigned int pipeId; // ID of the pipe this packet is intended for
 	unsigned int streamPos; // Position of packet data in entire stream that has been sent on pipe so far
-	char packet[maxPacketSize]; // Packet data
+	char packet[maxPayloadSize]; // Packet data; only parity packets use more than maxPacketSize bytes
 	
 	/* Constructors and destructors: */
 	Packet(void) // Creates empty packet
@@ -29,53 +29,316 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <unistd.h>
 #include <string.h>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <Threads/Thread.h>
+#include <Threads/MutexCond.h>
 #include <Cluster/Packet.h>
 #include <Cluster/Multiplexer.h>
 
 #ifdef __APPLE__
 #define lseek64 lseek
+#define pread64 pread
 #endif
 
 namespace Cluster {
 
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const unsigned int readAheadMinSequentialReads=16; // Number of sequential packet-sized reads after which read-ahead is started
+
+}
+
+/*******************************************************
+Declaration of class StandardFileMaster::ReadAheadState:
+*******************************************************/
+
+struct StandardFileMaster::ReadAheadState
+	{
+	/* Embedded classes: */
+	public:
+	struct Block // Structure for a block of data read ahead
+		{
+		/* Elements: */
+		public:
+		Byte* data; // Pointer to the block's data
+		size_t size; // Amount of data in the block
+		int errorType; // Type of error encountered while reading the block; 2: end-of-file, 3: fatal error
+		int errorCode; // Error code of a fatal error
+		};
+	
+	/* Elements: */
+	int fd; // File descriptor of the underlying file
+	size_t blockSize; // Size of each read-ahead block
+	unsigned int numBlocks; // Number of read-ahead blocks
+	Byte* buffer; // Memory holding the data of all read-ahead blocks
+	Block* blocks; // Ring buffer of read-ahead blocks
+	Threads::MutexCond blockCond; // Condition variable protecting the block ring buffer and signaling block state changes
+	bool shutdown; // Flag to shut down the read-ahead thread
+	bool active; // Flag whether the read-ahead thread is supposed to read blocks
+	bool stopped; // Flag whether the read-ahead thread reached end-of-file or encountered an error
+	unsigned int generation; // Counter incremented whenever the read-ahead position changes, to discard blocks read for an old position
+	Offset filePos; // File position of the next block to be read
+	unsigned int headBlock; // Index of the oldest full block in the ring buffer
+	unsigned int numFullBlocks; // Number of full blocks in the ring buffer
+	size_t headOffset; // Amount of data already consumed from the oldest full block
+	Offset numBytesRead; // Total number of bytes read by the read-ahead thread
+	double readTime; // Total time spent reading blocks in seconds
+	Threads::Thread readAheadThread; // The read-ahead thread
+	
+	/* Private methods: */
+	void* readAheadThreadMethod(void); // Thread method reading blocks from the file
+	
+	/* Constructors and destructors: */
+	ReadAheadState(int sFd,size_t sBlockSize,unsigned int sNumBlocks);
+	~ReadAheadState(void);
+	
+	/* Methods: */
+	void start(Offset newFilePos); // Discards all read-ahead blocks and starts reading ahead from the given file position
+	void stop(void); // Discards all read-ahead blocks and stops reading ahead
+	size_t read(Byte* readBuffer,size_t readBufferSize,int& errorType,int& errorCode); // Reads data from the oldest full block; blocks until data is available
+	};
+
+/***************************************************
+Methods of class StandardFileMaster::ReadAheadState:
+***************************************************/
+
+void* StandardFileMaster::ReadAheadState::readAheadThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait until there is a block to read: */
+		unsigned int readGeneration;
+		Offset readPos;
+		Block* block;
+		{
+		Threads::MutexCond::Lock blockLock(blockCond);
+		while(!shutdown&&(!active||stopped||numFullBlocks==numBlocks))
+			blockCond.wait(blockLock);
+		if(shutdown)
+			break;
+		readGeneration=generation;
+		readPos=filePos;
+		block=&blocks[(headBlock+numFullBlocks)%numBlocks];
+		}
+		
+		/* Read the block without holding the lock: */
+		Misc::Timer readTimer;
+		size_t readSize=0;
+		int errorType=0;
+		int errorCode=0;
+		while(readSize<blockSize)
+			{
+			ssize_t readResult=pread64(fd,block->data+readSize,blockSize-readSize,readPos+readSize);
+			if(readResult>0)
+				readSize+=size_t(readResult);
+			else if(readResult==0)
+				break;
+			else if(errno!=EAGAIN&&errno!=EWOULDBLOCK&&errno!=EINTR)
+				{
+				errorType=3; // Fatal error
+				errorCode=errno;
+				break;
+				}
+			}
+		readTimer.elapse();
+		
+		/* Report errors only on the block following the last successfully read data: */
+		if(readSize>0)
+			errorType=0;
+		else if(errorType==0)
+			errorType=2; // End of file
+		
+		/* Publish the block unless the read-ahead position changed in the meantime: */
+		{
+		Threads::MutexCond::Lock blockLock(blockCond);
+		if(readGeneration==generation)
+			{
+			block->size=readSize;
+			block->errorType=errorType;
+			block->errorCode=errorCode;
+			filePos+=readSize;
+			++numFullBlocks;
+			if(errorType!=0)
+				stopped=true;
+			numBytesRead+=readSize;
+			readTime+=readTimer.getTime();
+			blockCond.broadcast();
+			}
+		}
+		}
+	
+	return 0;
+	}
+
+StandardFileMaster::ReadAheadState::ReadAheadState(int sFd,size_t sBlockSize,unsigned int sNumBlocks)
+	:fd(sFd),blockSize(sBlockSize),numBlocks(sNumBlocks),
+	 buffer(new Byte[blockSize*numBlocks]),blocks(new Block[numBlocks]),
+	 shutdown(false),active(false),stopped(false),generation(0),
+	 filePos(0),headBlock(0),numFullBlocks(0),headOffset(0),
+	 numBytesRead(0),readTime(0.0)
+	{
+	/* Initialize the block ring buffer: */
+	for(unsigned int i=0;i<numBlocks;++i)
+		{
+		blocks[i].data=buffer+blockSize*i;
+		blocks[i].size=0;
+		blocks[i].errorType=0;
+		blocks[i].errorCode=0;
+		}
+	
+	/* Start the read-ahead thread: */
+	readAheadThread.start(this,&StandardFileMaster::ReadAheadState::readAheadThreadMethod);
+	}
+
+StandardFileMaster::ReadAheadState::~ReadAheadState(void)
+	{
+	/* Shut down the read-ahead thread: */
+	{
+	Threads::MutexCond::Lock blockLock(blockCond);
+	shutdown=true;
+	blockCond.broadcast();
+	}
+	readAheadThread.join();
+	
+	delete[] blocks;
+	delete[] buffer;
+	}
+
+void StandardFileMaster::ReadAheadState::start(IO::SeekableFile::Offset newFilePos)
+	{
+	Threads::MutexCond::Lock blockLock(blockCond);
+	
+	/* Discard all read-ahead blocks and restart at the given position: */
+	++generation;
+	active=true;
+	stopped=false;
+	filePos=newFilePos;
+	headBlock=0;
+	numFullBlocks=0;
+	headOffset=0;
+	blockCond.broadcast();
+	}
+
+void StandardFileMaster::ReadAheadState::stop(void)
+	{
+	Threads::MutexCond::Lock blockLock(blockCond);
+	
+	/* Discard all read-ahead blocks and put the read-ahead thread to sleep: */
+	++generation;
+	active=false;
+	headBlock=0;
+	numFullBlocks=0;
+	headOffset=0;
+	}
+
+size_t StandardFileMaster::ReadAheadState::read(IO::File::Byte* readBuffer,size_t readBufferSize,int& errorType,int& errorCode)
+	{
+	Threads::MutexCond::Lock blockLock(blockCond);
+	
+	/* Wait until the oldest block has been read: */
+	while(numFullBlocks==0)
+		blockCond.wait(blockLock);
+	
+	/* Check for errors; error blocks are never consumed: */
+	Block& block=blocks[headBlock];
+	if(block.errorType!=0)
+		{
+		errorType=block.errorType;
+		errorCode=block.errorCode;
+		return 0;
+		}
+	
+	/* Copy data from the oldest block: */
+	size_t readSize=block.size-headOffset;
+	if(readSize>readBufferSize)
+		readSize=readBufferSize;
+	memcpy(readBuffer,block.data+headOffset,readSize);
+	headOffset+=readSize;
+	
+	/* Hand the block back to the read-ahead thread if it has been consumed completely: */
+	if(headOffset==block.size)
+		{
+		headBlock=(headBlock+1)%numBlocks;
+		--numFullBlocks;
+		headOffset=0;
+		blockCond.broadcast();
+		}
+	
+	return readSize;
+	}
+
 /***********************************
 Methods of class StandardFileMaster:
 ***********************************/
 
 size_t StandardFileMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 	{
+	Misc::Timer forwardTimer;
+	
 	/* Collect error codes: */
 	int errorType=0;
 	int errorCode=0;
 	size_t readSize=0;
 	
-	/* Check if file needs to be repositioned: */
-	if(filePos!=readPos)
+	/* Stop reading ahead if the file was repositioned: */
+	if(readPos!=nextReadPos)
 		{
-		/* Set the file position and check for seek errors: */
-		if(lseek64(fd,readPos,SEEK_SET)<0)
-			errorType=1; // Seek error
+		if(readAhead!=0)
+			readAhead->stop();
+		numSequentialReads=0;
 		}
 	
-	if(errorType==0)
+	if(readAhead!=0&&readAhead->active)
+		{
+		/* Read data from the read-ahead buffer: */
+		readSize=readAhead->read(buffer,bufferSize,errorType,errorCode);
+		}
+	else
 		{
-		/* Read more data from source: */
-		ssize_t readResult;
-		do
+		/* Check if file needs to be repositioned: */
+		if(filePos!=readPos)
 			{
-			readResult=::read(fd,buffer,bufferSize);
+			/* Set the file position and check for seek errors: */
+			if(lseek64(fd,readPos,SEEK_SET)<0)
+				errorType=1; // Seek error
 			}
-		while(readResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR));
 		
-		/* Check for errors: */
-		if(readResult>0)
-			readSize=size_t(readResult);
-		else if(readResult==0)
-			errorType=2; // End of file
-		else
+		if(errorType==0)
 			{
-			errorType=3; // Fatal error
-			errorCode=errno;
+			/* Read more data from source: */
+			ssize_t readResult;
+			do
+				{
+				readResult=::read(fd,buffer,bufferSize);
+				}
+			while(readResult<0&&(errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR));
+			
+			/* Check for errors: */
+			if(readResult>0)
+				readSize=size_t(readResult);
+			else if(readResult==0)
+				errorType=2; // End of file
+			else
+				{
+				errorType=3; // Fatal error
+				errorCode=errno;
+				}
+			
+			/* Update the file's read/write pointer: */
+			if(readResult>=0)
+				filePos=readPos+readSize;
+			}
+		
+		/* Start reading ahead in large blocks once the file is read sequentially: */
+		if(errorType==0&&readAheadNumBlocks>0&&++numSequentialReads>=readAheadMinSequentialReads)
+			{
+			if(readAhead==0)
+				readAhead=new ReadAheadState(fd,readAheadBlockSize,readAheadNumBlocks);
+			readAhead->start(readPos+readSize);
 			}
 		}
 	
@@ -93,7 +356,12 @@ size_t StandardFileMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 		
 		/* Advance the read pointer: */
 		readPos+=readSize;
-		filePos=readPos;
+		nextReadPos=readPos;
+		
+		/* Update the forwarding statistics: */
+		numBytesForwarded+=readSize;
+		forwardTimer.elapse();
+		forwardTime+=forwardTimer.getTime();
 		
 		return readSize;
 		}
@@ -121,7 +389,7 @@ size_t StandardFileMaster::readData(IO::File::Byte* buffer,size_t bufferSize)
 			throw Error(Misc::printStdErrMsg("Cluster::StandardFile: Fatal error %d while reading from file",errorCode));
 		
 		/* Only reached in case of end-of-file: */
-		filePos=readPos;
+		nextReadPos=readPos;
 		return 0;
 		}
 	}
@@ -141,8 +409,11 @@ void StandardFileMaster::writeData(const IO::File::Byte* buffer,size_t bufferSiz
 			errorType=1; // Seek error
 		}
 	
-	/* Invalidate the read buffer to prevent reading stale data: */
+	/* Invalidate the read buffer and any read-ahead data to prevent reading stale data: */
 	flushReadBuffer();
+	if(readAhead!=0)
+		readAhead->stop();
+	numSequentialReads=0;
 	
 	/* Write all data in the given buffer: */
 	while(errorType==0&&bufferSize>0)
@@ -254,7 +525,10 @@ void StandardFileMaster::openFile(const char* fileName,IO::File::AccessMode acce
 StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode)
 	:IO::SeekableFile(disableRead(accessMode)),ClusterPipe(sMultiplexer),
 	 fd(-1),
-	 filePos(0)
+	 filePos(0),
+	 readAheadBlockSize(256*1024),readAheadNumBlocks(4),readAhead(0),
+	 nextReadPos(0),numSequentialReads(0),
+	 numBytesForwarded(0),forwardTime(0.0)
 	{
 	/* Create flags and mode to open the file: */
 	int flags=O_CREAT;
@@ -269,7 +543,10 @@ StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fil
 StandardFileMaster::StandardFileMaster(Multiplexer* sMultiplexer,const char* fileName,IO::File::AccessMode accessMode,int flags,int mode)
 	:SeekableFile(disableRead(accessMode)),ClusterPipe(sMultiplexer),
 	 fd(-1),
-	 filePos(0)
+	 filePos(0),
+	 readAheadBlockSize(256*1024),readAheadNumBlocks(4),readAhead(0),
+	 nextReadPos(0),numSequentialReads(0),
+	 numBytesForwarded(0),forwardTime(0.0)
 	{
 	/* Open the file: */
 	openFile(fileName,accessMode,flags,mode);
@@ -279,6 +556,7 @@ StandardFileMaster::~StandardFileMaster(void)
 	{
 	/* Flush the write buffer, and then close the file: */
 	flush();
+	delete readAhead;
 	if(fd>=0)
 		close(fd);
 	}
@@ -324,6 +602,33 @@ IO::SeekableFile::Offset StandardFileMaster::getSize(void) const
 	return fileSize;
 	}
 
+void StandardFileMaster::setReadAhead(size_t newReadAheadBlockSize,unsigned int newReadAheadNumBlocks)
+	{
+	/* Shut down the current read-ahead thread; it will be restarted with the new settings on the next sequential reads: */
+	delete readAhead;
+	readAhead=0;
+	numSequentialReads=0;
+	
+	readAheadBlockSize=newReadAheadBlockSize;
+	if(readAheadBlockSize<Packet::maxPacketSize)
+		readAheadBlockSize=Packet::maxPacketSize;
+	readAheadNumBlocks=newReadAheadNumBlocks;
+	}
+
+double StandardFileMaster::getReadThroughput(void) const
+	{
+	if(readAhead==0)
+		return 0.0;
+	
+	Threads::MutexCond::Lock blockLock(readAhead->blockCond);
+	return readAhead->readTime>0.0?double(readAhead->numBytesRead)/readAhead->readTime:0.0;
+	}
+
+double StandardFileMaster::getForwardThroughput(void) const
+	{
+	return forwardTime>0.0?double(numBytesForwarded)/forwardTime:0.0;
+	}
+
 /**********************************
 Methods of class StandardFileSlave:
 **********************************/
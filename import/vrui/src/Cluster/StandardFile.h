@@ -35,10 +35,20 @@ namespace Cluster {
 
 class StandardFileMaster:public IO::SeekableFile,public ClusterPipe // Class to represent cluster-transparent standard files on the master node
 	{
-	/* Elements: */
+	/* Embedded classes: */
 	private:
+	struct ReadAheadState; // Structure holding the state of a background thread reading large blocks ahead of the current read position
+	
+	/* Elements: */
 	int fd; // File descriptor of the underlying file
 	Offset filePos; // Current position of the underlying file's read/write pointer
+	size_t readAheadBlockSize; // Size of blocks read by the background read-ahead thread
+	unsigned int readAheadNumBlocks; // Maximum number of blocks read ahead of the current read position; 0 disables read-ahead
+	ReadAheadState* readAhead; // State of the background read-ahead thread, or NULL if read-ahead has not been started yet
+	Offset nextReadPos; // Read position directly following the most recently read data, to detect sequential reads
+	unsigned int numSequentialReads; // Number of sequential reads since the last seek or write
+	Offset numBytesForwarded; // Total number of bytes read by the master and forwarded to the slaves
+	double forwardTime; // Total time spent reading data and forwarding it to the slaves in seconds
 	
 	/* Protected methods from IO::File: */
 	protected:
@@ -60,6 +70,11 @@ class StandardFileMaster:public IO::SeekableFile,public ClusterPipe // Class to
 	
 	/* Methods from IO::SeekableFile: */
 	virtual Offset getSize(void) const;
+	
+	/* New methods: */
+	void setReadAhead(size_t newReadAheadBlockSize,unsigned int newReadAheadNumBlocks); // Sets the block size and number of blocks read ahead on a background thread once the file is read sequentially; 0 blocks disables read-ahead
+	double getReadThroughput(void) const; // Returns the rate at which the background read-ahead thread read data from the file while busy, in bytes per second
+	double getForwardThroughput(void) const; // Returns the rate at which data was read and forwarded to the slaves while the file was being read, in bytes per second
 	};
 
 class StandardFileSlave:public IO::SeekableFile,public ClusterPipe // Class to represent cluster-transparent standard files on the slave nodes
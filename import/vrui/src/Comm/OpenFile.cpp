@@ -30,6 +30,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <IO/GzipFilter.h>
 #include <IO/SeekableFilter.h>
 #include <Comm/HttpFile.h>
+#include <Comm/ParallelHttpFile.h>
 
 namespace Comm {
 
@@ -43,8 +44,15 @@ IO::FilePtr openFile(const char* fileName,IO::File::AccessMode accessMode)
 		if(accessMode==IO::File::WriteOnly||accessMode==IO::File::ReadWrite)
 			Misc::throwStdErr("Comm::openFile: Write access to HTTP files not supported");
 		
-		/* Open a remote file via the HTTP/1.1 protocol: */
-		result=new HttpFile(fileName);
+		/* Open a remote file via parallel HTTP/1.1 range requests, or via a single streaming request if the server does not support ranges: */
+		try
+			{
+			result=new ParallelHttpFile(fileName);
+			}
+		catch(IO::File::OpenError err)
+			{
+			result=new HttpFile(fileName);
+			}
 		}
 	else
 		{
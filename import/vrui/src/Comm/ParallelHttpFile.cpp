@@ -0,0 +1,621 @@
+/***********************************************************************
+ParallelHttpFile - Class for high-performance reading from remote files
+using HTTP/1.1 range requests over several parallel server connections,
+with read-ahead, seeking, and an optional validated on-disk cache.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Portable Communications Library (Comm).
+
+The Portable Communications Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Portable Communications Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Communications Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Comm/ParallelHttpFile.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/Time.h>
+#include <Comm/TCPPipe.h>
+
+namespace Comm {
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct ReplyHeader // Structure holding the relevant fields of an HTTP reply header
+	{
+	/* Elements: */
+	public:
+	unsigned int statusCode; // The reply's status code
+	bool haveContentLength; // Flag whether the reply has a fixed-size body
+	IO::SeekableFile::Offset contentLength; // Size of the reply body
+	IO::SeekableFile::Offset totalSize; // Total size of the resource from a Content-Range field, or -1 if unknown
+	bool contentEncoded; // Flag whether the reply body has a content or transfer encoding
+	bool closeConnection; // Flag whether the server will close the connection after the reply
+	std::string entityTag; // The resource's entity tag, or empty
+	std::string lastModified; // The resource's last modification date, or empty
+	
+	/* Constructors and destructors: */
+	ReplyHeader(void)
+		:statusCode(0),haveContentLength(false),contentLength(0),totalSize(-1),
+		 contentEncoded(false),closeConnection(false)
+		{
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+std::string readHeaderLine(Pipe& pipe) // Reads a CR/LF-terminated header line from the pipe and returns it without the line terminator
+	{
+	std::string result;
+	int c;
+	while((c=pipe.getChar())!='\n')
+		{
+		if(c<0)
+			Misc::throwStdErr("Comm::ParallelHttpFile: Connection closed by server");
+		result.push_back(char(c));
+		}
+	if(!result.empty()&&result[result.size()-1]=='\r')
+		result.erase(result.size()-1);
+	return result;
+	}
+
+std::string trim(const std::string& string) // Returns the given string without leading and trailing whitespace
+	{
+	std::string::size_type start=string.find_first_not_of(" \t");
+	if(start==std::string::npos)
+		return std::string();
+	std::string::size_type end=string.find_last_not_of(" \t");
+	return string.substr(start,end+1-start);
+	}
+
+void sendRangeRequest(Pipe& pipe,const HttpFile::URLParts& urlParts,IO::SeekableFile::Offset first,IO::SeekableFile::Offset last) // Sends a GET request for the given inclusive byte range
+	{
+	/* Assemble the GET request: */
+	char buffer[2048];
+	int requestSize=snprintf(buffer,sizeof(buffer),"GET %s HTTP/1.1\r\nHost: %s:%d\r\nRange: bytes=%llu-%llu\r\n\r\n",urlParts.resourcePath.c_str(),urlParts.serverName.c_str(),urlParts.portNumber,(unsigned long long)first,(unsigned long long)last);
+	if(requestSize<0||size_t(requestSize)>=sizeof(buffer))
+		Misc::throwStdErr("Comm::ParallelHttpFile: Resource path too long");
+	
+	/* Send the GET request: */
+	pipe.writeRaw(buffer,requestSize);
+	pipe.flush();
+	}
+
+void readReplyHeader(Pipe& pipe,const HttpFile::URLParts& urlParts,ReplyHeader& header) // Reads an HTTP reply's status line and header fields
+	{
+	/* Wait for the server's reply: */
+	if(!pipe.waitForData(Misc::Time(30,0)))
+		Misc::throwStdErr("Comm::ParallelHttpFile: Timeout while waiting for reply from server \"%s\" on port %d",urlParts.serverName.c_str(),urlParts.portNumber);
+	
+	/* Read the status line: */
+	std::string statusLine=readHeaderLine(pipe);
+	if(statusLine.compare(0,5,"HTTP/")!=0)
+		Misc::throwStdErr("Comm::ParallelHttpFile: Malformed HTTP reply from server \"%s\" on port %d",urlParts.serverName.c_str(),urlParts.portNumber);
+	std::string::size_type codeStart=statusLine.find(' ');
+	if(codeStart==std::string::npos)
+		Misc::throwStdErr("Comm::ParallelHttpFile: Malformed HTTP reply from server \"%s\" on port %d",urlParts.serverName.c_str(),urlParts.portNumber);
+	header.statusCode=(unsigned int)(strtoul(statusLine.c_str()+codeStart+1,0,10));
+	
+	/* HTTP/1.0 servers close the connection after each reply: */
+	if(statusLine.compare(0,8,"HTTP/1.0")==0)
+		header.closeConnection=true;
+	
+	/* Parse header fields until the first empty line: */
+	while(true)
+		{
+		std::string line=readHeaderLine(pipe);
+		if(line.empty())
+			break;
+		std::string::size_type colon=line.find(':');
+		if(colon==std::string::npos)
+			continue;
+		std::string field=line.substr(0,colon);
+		std::string value=trim(line.substr(colon+1));
+		
+		/* Handle the header field: */
+		if(strcasecmp(field.c_str(),"Content-Length")==0)
+			{
+			header.haveContentLength=true;
+			header.contentLength=IO::SeekableFile::Offset(strtoull(value.c_str(),0,10));
+			}
+		else if(strcasecmp(field.c_str(),"Content-Range")==0)
+			{
+			/* Extract the total resource size following the slash: */
+			std::string::size_type slash=value.find('/');
+			if(slash!=std::string::npos&&value[slash+1]!='*')
+				header.totalSize=IO::SeekableFile::Offset(strtoull(value.c_str()+slash+1,0,10));
+			}
+		else if(strcasecmp(field.c_str(),"Transfer-Encoding")==0||strcasecmp(field.c_str(),"Content-Encoding")==0)
+			{
+			if(strcasecmp(value.c_str(),"identity")!=0)
+				header.contentEncoded=true;
+			}
+		else if(strcasecmp(field.c_str(),"Connection")==0)
+			{
+			if(strcasecmp(value.c_str(),"close")==0)
+				header.closeConnection=true;
+			}
+		else if(strcasecmp(field.c_str(),"ETag")==0)
+			header.entityTag=value;
+		else if(strcasecmp(field.c_str(),"Last-Modified")==0)
+			header.lastModified=value;
+		}
+	}
+
+std::string hashUrl(const char* url) // Returns a file name-safe hash of the given URL
+	{
+	/* Calculate the 64-bit FNV-1a hash of the URL: */
+	unsigned long long hash=14695981039346656037ULL;
+	for(const char* uPtr=url;*uPtr!='\0';++uPtr)
+		{
+		hash^=(unsigned long long)(static_cast<unsigned char>(*uPtr));
+		hash*=1099511628211ULL;
+		}
+	
+	char result[17];
+	snprintf(result,sizeof(result),"%016llx",hash);
+	return result;
+	}
+
+bool writeAll(int fd,const void* buffer,size_t bufferSize,off_t offset) // Writes the entire buffer at the given file offset; returns false on error
+	{
+	const char* bufPtr=static_cast<const char*>(buffer);
+	while(bufferSize>0)
+		{
+		ssize_t writeSize=pwrite(fd,bufPtr,bufferSize,offset);
+		if(writeSize<=0)
+			return false;
+		bufPtr+=writeSize;
+		bufferSize-=writeSize;
+		offset+=writeSize;
+		}
+	return true;
+	}
+
+bool readAll(int fd,void* buffer,size_t bufferSize,off_t offset) // Reads the entire buffer from the given file offset; returns false on error
+	{
+	char* bufPtr=static_cast<char*>(buffer);
+	while(bufferSize>0)
+		{
+		ssize_t readSize=pread(fd,bufPtr,bufferSize,offset);
+		if(readSize<=0)
+			return false;
+		bufPtr+=readSize;
+		bufferSize-=readSize;
+		offset+=readSize;
+		}
+	return true;
+	}
+
+}
+
+/*****************************************
+Static elements of class ParallelHttpFile:
+*****************************************/
+
+unsigned int ParallelHttpFile::defaultNumConnections=4;
+size_t ParallelHttpFile::defaultBlockSize=1024*1024;
+std::string ParallelHttpFile::defaultCacheDirectory;
+
+/*********************************
+Methods of class ParallelHttpFile:
+*********************************/
+
+size_t ParallelHttpFile::readData(IO::File::Byte* buffer,size_t bufferSize)
+	{
+	/* Check for end-of-file: */
+	if(readPos>=fileSize)
+		return 0;
+	
+	/* Determine the block containing the current read position and the read-ahead window; only read ahead during sequential access: */
+	unsigned int blockIndex=(unsigned int)(readPos/Offset(blockSize));
+	bool sequential=blockIndex==lastBlockIndex||blockIndex==lastBlockIndex+1;
+	lastBlockIndex=blockIndex;
+	unsigned int windowEnd=blockIndex+(sequential?numReadAheadBlocks:0U)+1;
+	if(windowEnd>numBlocks)
+		windowEnd=numBlocks;
+	
+	Threads::MutexCond::Lock blockLock(blockCond);
+	
+	/* Drop queued requests that fell out of the read-ahead window after a seek: */
+	for(std::deque<unsigned int>::iterator rIt=requests.begin();rIt!=requests.end();)
+		{
+		if(*rIt<blockIndex||*rIt>=windowEnd)
+			{
+			blocks[*rIt].state=Absent;
+			--numBlocksInMemory;
+			rIt=requests.erase(rIt);
+			}
+		else
+			++rIt;
+		}
+	
+	/* Request the current block and the read-ahead blocks: */
+	for(unsigned int i=blockIndex;i<windowEnd;++i)
+		requestBlock(i,blockIndex,windowEnd);
+	
+	/* Wait until the current block is ready: */
+	Block& block=blocks[blockIndex];
+	while(block.state!=Ready&&block.state!=Failed)
+		{
+		if(block.state==Absent)
+			{
+			/* Enqueue the block forcefully if it could not be requested due to memory limits: */
+			block.state=Queued;
+			++numBlocksInMemory;
+			requests.push_front(blockIndex);
+			blockCond.broadcast();
+			}
+		blockCond.wait(blockLock);
+		}
+	if(block.state==Failed)
+		{
+		/* Reset the block to allow retrying, and report the error: */
+		block.state=Absent;
+		--numBlocksInMemory;
+		throw Error(Misc::printStdErrMsg("Comm::ParallelHttpFile: Unable to read from resource \"%s\" on server \"%s\" on port %d due to error %s",urlParts.resourcePath.c_str(),urlParts.serverName.c_str(),urlParts.portNumber,fetchError.c_str()));
+		}
+	block.lastUse=++useCounter;
+	
+	/* Copy data from the block: */
+	Offset blockStart=Offset(blockIndex)*Offset(blockSize);
+	size_t blockOffset=size_t(readPos-blockStart);
+	size_t blockDataSize=blockIndex<numBlocks-1?blockSize:size_t(fileSize-blockStart);
+	size_t copySize=blockDataSize-blockOffset;
+	if(copySize>bufferSize)
+		copySize=bufferSize;
+	memcpy(buffer,block.data+blockOffset,copySize);
+	
+	/* Advance the read position: */
+	readPos+=copySize;
+	return copySize;
+	}
+
+void ParallelHttpFile::openCache(const std::string& cacheDirectory,const char* fileUrl)
+	{
+	/* Caches can only be validated if the server supplies a validator: */
+	if(entityTag.empty()&&lastModified.empty())
+		return;
+	
+	/* Open the cache's index and data files: */
+	std::string cacheName=cacheDirectory;
+	if(cacheName[cacheName.size()-1]!='/')
+		cacheName.push_back('/');
+	cacheName.append(hashUrl(fileUrl));
+	std::string indexName=cacheName+".index";
+	std::string dataName=cacheName+".data";
+	cacheIndexFd=open(indexName.c_str(),O_RDWR|O_CREAT,0644);
+	cacheDataFd=open(dataName.c_str(),O_RDWR|O_CREAT,0644);
+	if(cacheIndexFd<0||cacheDataFd<0)
+		{
+		/* Disable caching: */
+		if(cacheIndexFd>=0)
+			close(cacheIndexFd);
+		if(cacheDataFd>=0)
+			close(cacheDataFd);
+		cacheIndexFd=-1;
+		cacheDataFd=-1;
+		return;
+		}
+	
+	/* Assemble the index header describing the current version of the remote file: */
+	char sizes[64];
+	snprintf(sizes,sizeof(sizes),"%llu %llu\n",(unsigned long long)fileSize,(unsigned long long)blockSize);
+	std::string header="Comm::ParallelHttpFile cache 1.0\n";
+	header.append(fileUrl);
+	header.push_back('\n');
+	header.append(entityTag);
+	header.push_back('\n');
+	header.append(lastModified);
+	header.push_back('\n');
+	header.append(sizes);
+	cacheIndexHeaderSize=off_t(header.size());
+	
+	/* Check whether the existing index matches the current version of the remote file: */
+	cachedBlocks.resize(numBlocks,false);
+	std::vector<char> existing(header.size()+numBlocks);
+	if(readAll(cacheIndexFd,&existing[0],existing.size(),0)&&memcmp(&existing[0],header.data(),header.size())==0)
+		{
+		/* Retrieve the flags of all already cached blocks: */
+		for(unsigned int i=0;i<numBlocks;++i)
+			cachedBlocks[i]=existing[header.size()+i]!=0;
+		}
+	else
+		{
+		/* Invalidate the stale cache and write a new index: */
+		std::vector<char> newIndex(header.begin(),header.end());
+		newIndex.resize(header.size()+numBlocks,0);
+		if(ftruncate(cacheIndexFd,0)!=0||ftruncate(cacheDataFd,0)!=0||!writeAll(cacheIndexFd,&newIndex[0],newIndex.size(),0))
+			{
+			/* Disable caching: */
+			close(cacheIndexFd);
+			close(cacheDataFd);
+			cacheIndexFd=-1;
+			cacheDataFd=-1;
+			cachedBlocks.clear();
+			}
+		}
+	}
+
+void ParallelHttpFile::requestBlock(unsigned int blockIndex,unsigned int windowStart,unsigned int windowEnd)
+	{
+	Block& block=blocks[blockIndex];
+	if(block.state!=Absent)
+		return;
+	
+	/* Make room by evicting old blocks if the memory limit is reached: */
+	while(numBlocksInMemory>=maxNumBlocks)
+		if(!evictBlock(windowStart,windowEnd))
+			return;
+	
+	/* Queue the block and wake up a fetcher thread: */
+	block.state=Queued;
+	++numBlocksInMemory;
+	requests.push_back(blockIndex);
+	blockCond.broadcast();
+	}
+
+bool ParallelHttpFile::evictBlock(unsigned int windowStart,unsigned int windowEnd)
+	{
+	/* Find a failed block, or the least-recently used ready block, outside the window; failed blocks hold no data and are released first: */
+	unsigned int evictIndex=numBlocks;
+	for(unsigned int i=0;i<numBlocks;++i)
+		if(i<windowStart||i>=windowEnd)
+			{
+			if(blocks[i].state==Failed)
+				{
+				evictIndex=i;
+				break;
+				}
+			if(blocks[i].state==Ready&&(evictIndex==numBlocks||blocks[i].lastUse<blocks[evictIndex].lastUse))
+				evictIndex=i;
+			}
+	if(evictIndex==numBlocks)
+		return false;
+	
+	/* Release the block's data, if any: */
+	delete[] blocks[evictIndex].data;
+	blocks[evictIndex].data=0;
+	blocks[evictIndex].state=Absent;
+	--numBlocksInMemory;
+	return true;
+	}
+
+void* ParallelHttpFile::fetcherThreadMethod(void)
+	{
+	PipePtr pipe; // This fetcher's persistent server connection
+	
+	while(true)
+		{
+		/* Wait for the next block request: */
+		unsigned int blockIndex;
+		bool cached;
+		{
+		Threads::MutexCond::Lock blockLock(blockCond);
+		while(!shutdown&&requests.empty())
+			blockCond.wait(blockLock);
+		if(shutdown)
+			break;
+		blockIndex=requests.front();
+		requests.pop_front();
+		blocks[blockIndex].state=Loading;
+		
+		/* Check whether the block is already in the cache while the flags are protected: */
+		cached=cacheDataFd>=0&&cachedBlocks[blockIndex];
+		}
+		
+		Offset blockStart=Offset(blockIndex)*Offset(blockSize);
+		size_t blockDataSize=blockIndex<numBlocks-1?blockSize:size_t(fileSize-blockStart);
+		Byte* data=new Byte[blockDataSize];
+		bool ok=false;
+		std::string error;
+		
+		/* Read the block from the cache if it is there: */
+		if(cached)
+			ok=readAll(cacheDataFd,data,blockDataSize,off_t(blockStart));
+		
+		/* Fetch the block from the server, reconnecting once if a persistent connection went stale: */
+		for(int attempt=0;!ok&&attempt<2;++attempt)
+			{
+			try
+				{
+				if(pipe==0)
+					pipe=new TCPPipe(urlParts.serverName.c_str(),urlParts.portNumber);
+				
+				/* Request the block's byte range: */
+				sendRangeRequest(*pipe,urlParts,blockStart,blockStart+Offset(blockDataSize)-1);
+				ReplyHeader header;
+				readReplyHeader(*pipe,urlParts,header);
+				if(header.statusCode!=206||!header.haveContentLength||header.contentLength!=Offset(blockDataSize)||header.contentEncoded)
+					Misc::throwStdErr("HTTP status %u on range request",header.statusCode);
+				
+				/* Read the block's data: */
+				pipe->readRaw(data,blockDataSize);
+				ok=true;
+				
+				/* Drop the connection if the server is going to close it: */
+				if(header.closeConnection)
+					pipe=0;
+				}
+			catch(std::runtime_error err)
+				{
+				/* Drop the connection and retry: */
+				pipe=0;
+				error=err.what();
+				}
+			}
+		
+		/* Store newly fetched blocks in the cache, writing the block's data before its index flag: */
+		if(ok&&cacheDataFd>=0&&!cached)
+			{
+			char flag=1;
+			if(writeAll(cacheDataFd,data,blockDataSize,off_t(blockStart)))
+				writeAll(cacheIndexFd,&flag,1,cacheIndexHeaderSize+off_t(blockIndex));
+			}
+		
+		/* Hand the block to the reader: */
+		{
+		Threads::MutexCond::Lock blockLock(blockCond);
+		Block& block=blocks[blockIndex];
+		if(ok)
+			{
+			if(cacheDataFd>=0)
+				cachedBlocks[blockIndex]=true;
+			block.data=data;
+			block.state=Ready;
+			}
+		else
+			{
+			delete[] data;
+			block.state=Failed;
+			fetchError=error;
+			}
+		blockCond.broadcast();
+		}
+		}
+	
+	return 0;
+	}
+
+ParallelHttpFile::ParallelHttpFile(const char* fileUrl)
+	:IO::SeekableFile(ReadOnly),
+	 urlParts(HttpFile::splitUrl(fileUrl)),
+	 fileSize(0),blockSize(defaultBlockSize>0?defaultBlockSize:1),numBlocks(0),
+	 numReadAheadBlocks(0),maxNumBlocks(0),
+	 cacheDataFd(-1),cacheIndexFd(-1),cacheIndexHeaderSize(0),
+	 numBlocksInMemory(0),useCounter(0),lastBlockIndex(0),shutdown(false),
+	 numFetchers(defaultNumConnections>0?defaultNumConnections:1),fetchers(0)
+	{
+	init(fileUrl,defaultCacheDirectory.c_str());
+	}
+
+ParallelHttpFile::ParallelHttpFile(const char* fileUrl,unsigned int sNumConnections,size_t sBlockSize,const char* cacheDirectory)
+	:IO::SeekableFile(ReadOnly),
+	 urlParts(HttpFile::splitUrl(fileUrl)),
+	 fileSize(0),blockSize(sBlockSize>0?sBlockSize:1),numBlocks(0),
+	 numReadAheadBlocks(0),maxNumBlocks(0),
+	 cacheDataFd(-1),cacheIndexFd(-1),cacheIndexHeaderSize(0),
+	 numBlocksInMemory(0),useCounter(0),lastBlockIndex(0),shutdown(false),
+	 numFetchers(sNumConnections>0?sNumConnections:1),fetchers(0)
+	{
+	init(fileUrl,cacheDirectory);
+	}
+
+void ParallelHttpFile::init(const char* fileUrl,const char* cacheDirectory)
+	{
+	/*********************************************************************
+	Probe the server with a single-byte range request, which at the same
+	time checks for range support, and retrieves the resource's total size
+	and its validators. A server that ignores the range and returns the
+	entire resource cannot be used.
+	*********************************************************************/
+	
+	{
+	TCPPipe probe(urlParts.serverName.c_str(),urlParts.portNumber);
+	ReplyHeader header;
+	try
+		{
+		sendRangeRequest(probe,urlParts,0,0);
+		readReplyHeader(probe,urlParts,header);
+		}
+	catch(std::runtime_error err)
+		{
+		throw OpenError(err.what());
+		}
+	if(header.statusCode==200)
+		throw OpenError(Misc::printStdErrMsg("Comm::ParallelHttpFile: Server \"%s\" on port %d does not support range requests",urlParts.serverName.c_str(),urlParts.portNumber));
+	if(header.statusCode!=206)
+		throw OpenError(Misc::printStdErrMsg("Comm::ParallelHttpFile: HTTP error %u while opening resource \"%s\" on server \"%s\" on port %d",header.statusCode,urlParts.resourcePath.c_str(),urlParts.serverName.c_str(),urlParts.portNumber));
+	if(header.totalSize<0||header.contentEncoded)
+		throw OpenError(Misc::printStdErrMsg("Comm::ParallelHttpFile: Unsupported reply to range request from server \"%s\" on port %d",urlParts.serverName.c_str(),urlParts.portNumber));
+	fileSize=header.totalSize;
+	entityTag=header.entityTag;
+	lastModified=header.lastModified;
+	}
+	
+	/* Split the remote file into blocks: */
+	numBlocks=(unsigned int)((fileSize+Offset(blockSize)-1)/Offset(blockSize));
+	blocks.resize(numBlocks);
+	numReadAheadBlocks=numFetchers*2;
+	maxNumBlocks=numReadAheadBlocks+numFetchers+1;
+	
+	/* Open the on-disk cache: */
+	if(cacheDirectory!=0&&cacheDirectory[0]!='\0')
+		openCache(cacheDirectory,fileUrl);
+	
+	/* Start the fetcher threads: */
+	fetchers=new Threads::Thread[numFetchers];
+	for(unsigned int i=0;i<numFetchers;++i)
+		fetchers[i].start(this,&ParallelHttpFile::fetcherThreadMethod);
+	}
+
+ParallelHttpFile::~ParallelHttpFile(void)
+	{
+	/* Shut down the fetcher threads: */
+	{
+	Threads::MutexCond::Lock blockLock(blockCond);
+	shutdown=true;
+	blockCond.broadcast();
+	}
+	for(unsigned int i=0;i<numFetchers;++i)
+		fetchers[i].join();
+	delete[] fetchers;
+	
+	/* Release all blocks: */
+	for(std::vector<Block>::iterator bIt=blocks.begin();bIt!=blocks.end();++bIt)
+		delete[] bIt->data;
+	
+	/* Close the on-disk cache: */
+	if(cacheIndexFd>=0)
+		close(cacheIndexFd);
+	if(cacheDataFd>=0)
+		close(cacheDataFd);
+	}
+
+ParallelHttpFile::Offset ParallelHttpFile::getSize(void) const
+	{
+	return fileSize;
+	}
+
+void ParallelHttpFile::setDefaultNumConnections(unsigned int newDefaultNumConnections)
+	{
+	defaultNumConnections=newDefaultNumConnections;
+	}
+
+void ParallelHttpFile::setDefaultBlockSize(size_t newDefaultBlockSize)
+	{
+	defaultBlockSize=newDefaultBlockSize;
+	}
+
+void ParallelHttpFile::setDefaultCacheDirectory(const char* newDefaultCacheDirectory)
+	{
+	defaultCacheDirectory=newDefaultCacheDirectory!=0?newDefaultCacheDirectory:"";
+	}
+
+}
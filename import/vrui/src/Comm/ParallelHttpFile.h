@@ -0,0 +1,131 @@
+/***********************************************************************
+ParallelHttpFile - Class for high-performance reading from remote files
+using HTTP/1.1 range requests over several parallel server connections,
+with read-ahead, seeking, and an optional validated on-disk cache.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Portable Communications Library (Comm).
+
+The Portable Communications Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Portable Communications Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Communications Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef COMM_PARALLELHTTPFILE_INCLUDED
+#define COMM_PARALLELHTTPFILE_INCLUDED
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <IO/SeekableFile.h>
+#include <Comm/HttpFile.h>
+
+namespace Comm {
+
+class ParallelHttpFile:public IO::SeekableFile
+	{
+	/* Embedded classes: */
+	public:
+	typedef HttpFile::URLParts URLParts;
+	
+	private:
+	enum BlockState // Enumerated type for states of file blocks
+		{
+		Absent,Queued,Loading,Ready,Failed
+		};
+	
+	struct Block // Structure holding a block of the remote file
+		{
+		/* Elements: */
+		public:
+		BlockState state; // Current state of the block
+		Byte* data; // Block's data if the block is ready
+		unsigned int lastUse; // Value of the use counter when the block was last read
+		
+		/* Constructors and destructors: */
+		Block(void)
+			:state(Absent),data(0),lastUse(0)
+			{
+			}
+		};
+	
+	/* Elements: */
+	static unsigned int defaultNumConnections; // Default number of parallel server connections
+	static size_t defaultBlockSize; // Default size of file blocks fetched by a single range request
+	static std::string defaultCacheDirectory; // Default directory for the on-disk cache; empty to disable caching
+	
+	URLParts urlParts; // Components of the remote file's URL
+	Offset fileSize; // Total size of the remote file
+	size_t blockSize; // Size of file blocks fetched by a single range request
+	unsigned int numBlocks; // Number of blocks in the remote file
+	unsigned int numReadAheadBlocks; // Number of blocks requested ahead of the current read position
+	unsigned int maxNumBlocks; // Maximum number of blocks held in memory at any time
+	std::string entityTag; // The remote file's entity tag, or empty
+	std::string lastModified; // The remote file's last modification date, or empty
+	int cacheDataFd; // File descriptor of the cache data file, or -1 if caching is disabled
+	int cacheIndexFd; // File descriptor of the cache index file, or -1 if caching is disabled
+	off_t cacheIndexHeaderSize; // Size of the cache index file's header preceding the per-block flags
+	std::vector<bool> cachedBlocks; // Flags whether blocks are already stored in the cache data file
+	
+	Threads::MutexCond blockCond; // Condition variable protecting the block array and request queue, and signaling new requests and finished blocks
+	std::vector<Block> blocks; // Array of all blocks of the remote file
+	std::deque<unsigned int> requests; // Queue of indices of blocks to be fetched
+	unsigned int numBlocksInMemory; // Number of blocks currently loading or held in memory
+	unsigned int useCounter; // Counter to determine least-recently used blocks
+	unsigned int lastBlockIndex; // Index of the most recently read block, to detect sequential access
+	std::string fetchError; // Error message of the most recent failed fetch
+	bool shutdown; // Flag telling the fetcher threads to exit
+	unsigned int numFetchers; // Number of fetcher threads
+	Threads::Thread* fetchers; // Array of fetcher threads, each maintaining its own server connection
+	
+	/* Protected methods from IO::File: */
+	protected:
+	virtual size_t readData(Byte* buffer,size_t bufferSize);
+	
+	/* Private methods: */
+	private:
+	void init(const char* fileUrl,const char* cacheDirectory); // Probes the remote file, opens the cache, and starts the fetcher threads
+	void openCache(const std::string& cacheDirectory,const char* fileUrl); // Opens or creates the on-disk cache for the remote file
+	void requestBlock(unsigned int blockIndex,unsigned int windowStart,unsigned int windowEnd); // Queues the given block if it is absent and memory is available after evicting blocks outside the given window; must be called with the block mutex locked
+	bool evictBlock(unsigned int windowStart,unsigned int windowEnd); // Evicts a failed block or the least-recently used ready block outside the given window; returns false if no block could be evicted
+	void* fetcherThreadMethod(void); // Thread method fetching requested blocks over a private server connection
+	
+	/* Constructors and destructors: */
+	public:
+	ParallelHttpFile(const char* fileUrl); // Opens file of the given URL with the default settings
+	ParallelHttpFile(const char* fileUrl,unsigned int sNumConnections,size_t sBlockSize,const char* cacheDirectory); // Opens file of the given URL with the given number of connections and block size, and cache directory (0 or empty to disable caching)
+	virtual ~ParallelHttpFile(void);
+	
+	/* Methods from IO::SeekableFile: */
+	virtual Offset getSize(void) const;
+	
+	/* New methods: */
+	static void setDefaultNumConnections(unsigned int newDefaultNumConnections); // Sets the default number of parallel server connections
+	static void setDefaultBlockSize(size_t newDefaultBlockSize); // Sets the default size of file blocks
+	static void setDefaultCacheDirectory(const char* newDefaultCacheDirectory); // Sets the default on-disk cache directory; 0 or empty disables caching
+	const std::string& getEntityTag(void) const // Returns the remote file's entity tag
+		{
+		return entityTag;
+		}
+	const std::string& getLastModified(void) const // Returns the remote file's last modification date
+		{
+		return lastModified;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+/***********************************************************************
+CSVBenchmark - Program to measure the throughput of parsing synthetic
+earthquake catalogs in comma-separated value format, sequentially field
+by field and in parallel chunks of records.
+Copyright (c) 2014 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <Threads/Mutex.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/CSVSource.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct CatalogDigest // Structure summarizing the parsed contents of a catalog independent of parsing order
+	{
+	/* Elements: */
+	public:
+	size_t numRecords; // Number of parsed records
+	Misc::UInt64 valueBits; // Sum of the bit patterns of all parsed numeric values
+	size_t stringSize; // Total length of all parsed string values
+	
+	/* Constructors and destructors: */
+	CatalogDigest(void)
+		:numRecords(0),valueBits(0),stringSize(0)
+		{
+		}
+	
+	/* Methods: */
+	void addValue(double value)
+		{
+		Misc::UInt64 bits;
+		memcpy(&bits,&value,sizeof(double));
+		valueBits+=bits;
+		}
+	void addString(const std::string& value)
+		{
+		stringSize+=value.size();
+		}
+	CatalogDigest& operator+=(const CatalogDigest& other)
+		{
+		numRecords+=other.numRecords;
+		valueBits+=other.valueBits;
+		stringSize+=other.stringSize;
+		return *this;
+		}
+	bool operator==(const CatalogDigest& other) const
+		{
+		return numRecords==other.numRecords&&valueBits==other.valueBits&&stringSize==other.stringSize;
+		}
+	};
+
+class CatalogParser:public IO::CSVSource::ChunkProcessor // Class to parse chunks of catalog records in parallel
+	{
+	/* Elements: */
+	private:
+	Threads::Mutex digestMutex; // Mutex serializing access to the per-chunk digests
+	std::vector<CatalogDigest> chunkDigests; // Digests of all processed chunks
+	
+	/* Methods from IO::CSVSource::ChunkProcessor: */
+	public:
+	virtual void processChunk(unsigned int chunkIndex,IO::CSVSource& chunkSource);
+	
+	/* New methods: */
+	static void parseRecord(IO::CSVSource& source,CatalogDigest& digest); // Parses one catalog record
+	CatalogDigest getDigest(void) const; // Returns the combined digest of all processed chunks
+	};
+
+void CatalogParser::processChunk(unsigned int chunkIndex,IO::CSVSource& chunkSource)
+	{
+	/* Parse all records in the chunk: */
+	CatalogDigest digest;
+	while(!chunkSource.eof())
+		parseRecord(chunkSource,digest);
+	
+	/* Store the chunk's digest: */
+	Threads::Mutex::Lock digestLock(digestMutex);
+	if(chunkDigests.size()<=chunkIndex)
+		chunkDigests.resize(chunkIndex+1);
+	chunkDigests[chunkIndex]=digest;
+	}
+
+void CatalogParser::parseRecord(IO::CSVSource& source,CatalogDigest& digest)
+	{
+	/* Read the date and time as strings, the location and magnitude as numbers, and the catalog source as a string: */
+	digest.addString(source.readField<std::string>());
+	digest.addString(source.readField<std::string>());
+	for(int i=0;i<4;++i)
+		digest.addValue(source.readField<double>());
+	digest.addString(source.readField<std::string>());
+	++digest.numRecords;
+	}
+
+CatalogDigest CatalogParser::getDigest(void) const
+	{
+	CatalogDigest result;
+	for(std::vector<CatalogDigest>::const_iterator cdIt=chunkDigests.begin();cdIt!=chunkDigests.end();++cdIt)
+		result+=*cdIt;
+	return result;
+	}
+
+/****************
+Helper functions:
+****************/
+
+void writeCatalog(const char* fileName,size_t numRecords) // Writes a synthetic earthquake catalog with the given number of records
+	{
+	FILE* file=fopen(fileName,"w");
+	if(file==0)
+		throw std::runtime_error("Unable to create catalog file");
+	
+	static const char* sources[3]={"NC","\"CI, Southern California\"","\"AK \"\"Alaska\"\"\""};
+	fprintf(file,"Date,Time,Latitude,Longitude,Depth,Magnitude,Source\n");
+	srand(1);
+	for(size_t i=0;i<numRecords;++i)
+		{
+		fprintf(file,"%04d/%02d/%02d,%02d:%02d:%05.2f,",1970+rand()%45,1+rand()%12,1+rand()%28,rand()%24,rand()%60,double(rand()%6000)*0.01);
+		fprintf(file,"%.4f,%.4f,%.2f,%.2f,",double(rand())/double(RAND_MAX)*180.0-90.0,double(rand())/double(RAND_MAX)*360.0-180.0,double(rand())/double(RAND_MAX)*700.0,double(rand())/double(RAND_MAX)*9.0);
+		fprintf(file,"%s\n",sources[rand()%3]);
+		}
+	fclose(file);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numRecords=2000000;
+	unsigned int maxNumThreads=(unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+	size_t chunkSize=4*1024*1024;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-numRecords")==0&&i+1<argc)
+			numRecords=size_t(atol(argv[++i]));
+		else if(strcasecmp(argv[i],"-maxThreads")==0&&i+1<argc)
+			maxNumThreads=(unsigned int)atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-chunkSize")==0&&i+1<argc)
+			chunkSize=size_t(atof(argv[++i])*1024.0*1024.0);
+		else
+			{
+			std::cerr<<"Usage: "<<argv[0]<<" [-numRecords <number of records>] [-maxThreads <number of threads>] [-chunkSize <MB>]"<<std::endl;
+			return 1;
+			}
+		}
+	if(maxNumThreads<1)
+		maxNumThreads=1;
+	
+	/* Write a synthetic catalog into a temporary file: */
+	char catalogFileName[]="/tmp/CSVBenchmarkXXXXXX";
+	int catalogFd=mkstemp(catalogFileName);
+	if(catalogFd<0)
+		{
+		std::cerr<<"Unable to create temporary catalog file"<<std::endl;
+		return 1;
+		}
+	close(catalogFd);
+	
+	bool allIdentical=true;
+	try
+		{
+		writeCatalog(catalogFileName,numRecords);
+		struct stat catalogStats;
+		stat(catalogFileName,&catalogStats);
+		double megabytes=double(catalogStats.st_size)/(1024.0*1024.0);
+		std::cout<<"Catalog of "<<numRecords<<" records, "<<megabytes<<" MB"<<std::endl;
+		
+		/* Parse the catalog field by field: */
+		CatalogDigest reference;
+		{
+		Misc::Timer timer;
+		IO::CSVSource source(IO::openFile(catalogFileName));
+		source.skipRecord();
+		while(!source.eof())
+			CatalogParser::parseRecord(source,reference);
+		timer.elapse();
+		std::cout<<"Field by field      : "<<megabytes/timer.getTime()<<" MB/s"<<std::endl;
+		}
+		
+		/* Parse the catalog in parallel chunks: */
+		for(unsigned int numThreads=1;numThreads<=maxNumThreads;numThreads*=2)
+			{
+			Misc::Timer timer;
+			IO::CSVSource source(IO::openFile(catalogFileName));
+			source.skipRecord();
+			CatalogParser parser;
+			source.processChunks(parser,numThreads,chunkSize);
+			timer.elapse();
+			bool identical=parser.getDigest()==reference;
+			allIdentical=allIdentical&&identical;
+			std::cout<<"Chunks on "<<numThreads<<(numThreads==1?" thread : ":" threads: ")<<megabytes/timer.getTime()<<" MB/s";
+			if(!identical)
+				std::cout<<", RESULTS DIFFER FROM FIELD BY FIELD PARSING";
+			std::cout<<std::endl;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Benchmark failed due to exception "<<err.what()<<std::endl;
+		allIdentical=false;
+		}
+	
+	/* Clean up: */
+	unlink(catalogFileName);
+	
+	return allIdentical?0:1;
+	}
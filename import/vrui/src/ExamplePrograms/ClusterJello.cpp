@@ -339,6 +339,11 @@ ClusterJello::ClusterJello(int& argc,char**& argv)
 		{
 		/* Initialize the simulated Jell-O crystal: */
 		crystal=new JelloCrystal(JelloCrystal::Index(4,4,8));
+		
+		/* Number of simulation threads is (optional) second command line parameter: */
+		if(argc>=3)
+			crystal->setNumThreads(atoi(argv[2]));
+		
 		currentSimulationParameters.atomMass=crystal->getAtomMass();
 		currentSimulationParameters.attenuation=crystal->getAttenuation();
 		currentSimulationParameters.gravity=crystal->getGravity();
@@ -1,7 +1,7 @@
 /***********************************************************************
 EarthquakeSet - Class to represent and render sets of earthquakes with
 3D locations, magnitude and event time.
-Copyright (c) 2006-2013 Oliver Kreylos
+Copyright (c) 2006-2014 Oliver Kreylos
 
 This program is free software; you can redistribute it and/or modify it
 under the terms of the GNU General Public License as published by the
@@ -30,7 +30,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <algorithm>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/FileNameExtensions.h>
+#include <Threads/Mutex.h>
 #include <IO/ValueSource.h>
+#include <IO/CSVSource.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/Vector.h>
@@ -123,6 +125,219 @@ inline double parseDateTime(const char* date,const char* time)
 	return double(mktime(&dateTime));
 	}
 
+inline std::string trimSpace(const std::string& s) // Returns the given string without leading and trailing whitespace
+	{
+	std::string::size_type begin=0;
+	while(begin<s.size()&&isspace(s[begin]))
+		++begin;
+	std::string::size_type end=s.size();
+	while(end>begin&&isspace(s[end-1]))
+		--end;
+	return std::string(s,begin,end-begin);
+	}
+
+struct ColumnLayout // Structure to identify the columns of an earthquake event file from the file's header line
+	{
+	/* Embedded classes: */
+	public:
+	enum RadiusMode // Enumerated types for radius coordinate modes
+		{
+		RADIUS,DEPTH,NEGDEPTH
+		};
+	
+	/* Elements: */
+	int latIndex; // Index of latitude column
+	int lngIndex; // Index of longitude column
+	int radiusIndex; // Index of radius/depth column
+	RadiusMode radiusMode; // Interpretation of radius/depth column
+	int dateIndex; // Index of date column
+	int timeIndex; // Index of time column
+	int magIndex; // Index of magnitude column
+	
+	/* Constructors and destructors: */
+	ColumnLayout(void)
+		:latIndex(-1),lngIndex(-1),
+		 radiusIndex(-1),radiusMode(RADIUS),
+		 dateIndex(-1),timeIndex(-1),magIndex(-1)
+		{
+		}
+	
+	/* Methods: */
+	void parseHeader(const std::string& header,int column) // Assigns the given column index based on the column's header
+		{
+		if(strequal(header,"Latitude")||strequal(header,"Lat"))
+			latIndex=column;
+		else if(strequal(header,"Longitude")||strequal(header,"Long")||strequal(header,"Lon"))
+			lngIndex=column;
+		else if(strequal(header,"Radius"))
+			{
+			radiusIndex=column;
+			radiusMode=RADIUS;
+			}
+		else if(strequal(header,"Depth"))
+			{
+			radiusIndex=column;
+			radiusMode=DEPTH;
+			}
+		else if(strequal(header,"Negative Depth")||strequal(header,"Neg Depth")||strequal(header,"NegDepth"))
+			{
+			radiusIndex=column;
+			radiusMode=NEGDEPTH;
+			}
+		else if(strequal(header,"Date"))
+			dateIndex=column;
+		else if(strequal(header,"Time"))
+			timeIndex=column;
+		else if(strequal(header,"Magnitude")||strequal(header,"Mag"))
+			magIndex=column;
+		}
+	void check(void) const // Throws an exception if any required column was not found
+		{
+		if(latIndex<0)
+			throw std::runtime_error("Missing latitude field");
+		if(lngIndex<0)
+			throw std::runtime_error("Missing longitude field");
+		if(radiusIndex<0)
+			throw std::runtime_error("Missing radius/depth/negative depth field");
+		if(dateIndex<0)
+			throw std::runtime_error("Missing date field");
+		if(timeIndex<0)
+			throw std::runtime_error("Missing time field");
+		if(magIndex<0)
+			throw std::runtime_error("Missing magnitude field");
+		}
+	int getMaxIndex(void) const // Returns the largest index of any required column
+		{
+		int maxIndex=latIndex;
+		if(maxIndex<lngIndex)
+			maxIndex=lngIndex;
+		if(maxIndex<radiusIndex)
+			maxIndex=radiusIndex;
+		if(maxIndex<dateIndex)
+			maxIndex=dateIndex;
+		if(maxIndex<timeIndex)
+			maxIndex=timeIndex;
+		if(maxIndex<magIndex)
+			maxIndex=magIndex;
+		return maxIndex;
+		}
+	};
+
+EarthquakeSet::Event createEvent(Geometry::Geoid<double>::Point geodeticPosition,const std::string& date,const std::string& time,float magnitude,ColumnLayout::RadiusMode radiusMode,const Geometry::Geoid<double>& referenceEllipsoid,const Geometry::Vector<double,3>& offset,double scaleFactor) // Creates an earthquake event from values read from an earthquake event file
+	{
+	/* Create an event: */
+	EarthquakeSet::Event e;
+	
+	/* Convert the read spherical coordinates to Cartesian coordinates: */
+	Geometry::Geoid<double>::Point cartesianPosition;
+	if(radiusMode==ColumnLayout::RADIUS)
+		{
+		/* Use a simple formula with a squished sphere: */
+		double xy=Math::cos(geodeticPosition[1])*geodeticPosition[2];
+		cartesianPosition[0]=xy*Math::cos(geodeticPosition[0]);
+		cartesianPosition[1]=xy*Math::sin(geodeticPosition[0]);
+		cartesianPosition[2]=Math::sin(geodeticPosition[1])*geodeticPosition[2]*(1.0-referenceEllipsoid.getFlatteningFactor());
+		}
+	else
+		{
+		if(radiusMode==ColumnLayout::DEPTH)
+			geodeticPosition[2]=-geodeticPosition[2];
+		cartesianPosition=referenceEllipsoid.geodeticToCartesian(geodeticPosition);
+		}
+	for(int i=0;i<3;++i)
+		e.position[i]=float((cartesianPosition[i]+offset[i])*scaleFactor);
+	
+	/* Calculate the event time: */
+	e.time=parseDateTime(date.c_str(),time.c_str());
+	
+	/* Store the event magnitude: */
+	e.magnitude=magnitude;
+	
+	return e;
+	}
+
+class CSVEventLoader:public IO::CSVSource::ChunkProcessor // Class to load chunks of earthquake events from comma-separated files in parallel
+	{
+	/* Elements: */
+	private:
+	const ColumnLayout& layout; // Column layout of the earthquake event file
+	const Geometry::Geoid<double>& referenceEllipsoid; // Reference ellipsoid to convert geodetic to Cartesian coordinates
+	const Geometry::Vector<double,3>& offset; // Offset applied to Cartesian coordinates
+	double scaleFactor; // Scale factor applied to offset Cartesian coordinates
+	Threads::Mutex chunkEventsMutex; // Mutex serializing access to the per-chunk event lists
+	std::vector<std::vector<EarthquakeSet::Event> > chunkEvents; // Lists of events loaded from each chunk
+	
+	/* Constructors and destructors: */
+	public:
+	CSVEventLoader(const ColumnLayout& sLayout,const Geometry::Geoid<double>& sReferenceEllipsoid,const Geometry::Vector<double,3>& sOffset,double sScaleFactor)
+		:layout(sLayout),referenceEllipsoid(sReferenceEllipsoid),offset(sOffset),scaleFactor(sScaleFactor)
+		{
+		}
+	
+	/* Methods from IO::CSVSource::ChunkProcessor: */
+	virtual void processChunk(unsigned int chunkIndex,IO::CSVSource& chunkSource)
+		{
+		/* Read all records in the chunk: */
+		std::vector<EarthquakeSet::Event> events;
+		int maxIndex=layout.getMaxIndex();
+		while(!chunkSource.eof())
+			{
+			Geometry::Geoid<double>::Point geodeticPosition=Geometry::Geoid<double>::Point::origin; // Only initializing to shut up compiler
+			std::string date,time;
+			float magnitude=0.0f;
+			int column=0;
+			try
+				{
+				do
+					{
+					/* Read the next field: */
+					if(column==layout.latIndex)
+						geodeticPosition[1]=Math::rad(chunkSource.readField<double>());
+					else if(column==layout.lngIndex)
+						geodeticPosition[0]=Math::rad(chunkSource.readField<double>());
+					else if(column==layout.radiusIndex)
+						geodeticPosition[2]=chunkSource.readField<double>()*1000.0;
+					else if(column==layout.dateIndex)
+						date=trimSpace(chunkSource.readField<std::string>());
+					else if(column==layout.timeIndex)
+						time=trimSpace(chunkSource.readField<std::string>());
+					else if(column==layout.magIndex)
+						magnitude=chunkSource.readField<float>();
+					else
+						chunkSource.skipField();
+					
+					++column;
+					}
+				while(!chunkSource.eor());
+				}
+			catch(IO::CSVSource::ConversionError err)
+				{
+				/* Ignore the error and the malformed event: */
+				if(!chunkSource.eor())
+					chunkSource.skipRecord();
+				column=0;
+				}
+			
+			/* Check if all fields were read: */
+			if(column>maxIndex)
+				events.push_back(createEvent(geodeticPosition,date,time,magnitude,layout.radiusMode,referenceEllipsoid,offset,scaleFactor));
+			}
+		
+		/* Store the chunk's events: */
+		Threads::Mutex::Lock chunkEventsLock(chunkEventsMutex);
+		if(chunkEvents.size()<=chunkIndex)
+			chunkEvents.resize(chunkIndex+1);
+		chunkEvents[chunkIndex].swap(events);
+		}
+	
+	/* New methods: */
+	void appendEvents(std::vector<EarthquakeSet::Event>& events) const // Appends all loaded events to the given list in file order
+		{
+		for(std::vector<std::vector<EarthquakeSet::Event> >::const_iterator ceIt=chunkEvents.begin();ceIt!=chunkEvents.end();++ceIt)
+			events.insert(events.end(),ceIt->begin(),ceIt->end());
+		}
+	};
+
 }
 
 /****************************************
@@ -269,16 +484,7 @@ void EarthquakeSet::loadCSVFile(IO::FilePtr earthquakeFile,const Geometry::Geoid
 	*********************************************************************/
 	
 	/* Remember the column indices of important columns: */
-	int latIndex=-1;
-	int lngIndex=-1;
-	int radiusIndex=-1;
-	enum RadiusMode // Enumerated types for radius coordinate modes
-		{
-		RADIUS,DEPTH,NEGDEPTH
-		} radiusMode=RADIUS;
-	int dateIndex=-1;
-	int timeIndex=-1;
-	int magIndex=-1;
+	ColumnLayout layout;
 	
 	/* Read the header line's columns: */
 	int column=0;
@@ -288,31 +494,7 @@ void EarthquakeSet::loadCSVFile(IO::FilePtr earthquakeFile,const Geometry::Geoid
 		std::string header=!source.eof()&&source.peekc()!='\n'&&source.peekc()!=','?source.readString():"";
 		
 		/* Parse the column header: */
-		if(strequal(header,"Latitude")||strequal(header,"Lat"))
-			latIndex=column;
-		else if(strequal(header,"Longitude")||strequal(header,"Long")||strequal(header,"Lon"))
-			lngIndex=column;
-		else if(strequal(header,"Radius"))
-			{
-			radiusIndex=column;
-			radiusMode=RADIUS;
-			}
-		else if(strequal(header,"Depth"))
-			{
-			radiusIndex=column;
-			radiusMode=DEPTH;
-			}
-		else if(strequal(header,"Negative Depth")||strequal(header,"Neg Depth")||strequal(header,"NegDepth"))
-			{
-			radiusIndex=column;
-			radiusMode=NEGDEPTH;
-			}
-		else if(strequal(header,"Date"))
-			dateIndex=column;
-		else if(strequal(header,"Time"))
-			timeIndex=column;
-		else if(strequal(header,"Magnitude")||strequal(header,"Mag"))
-			magIndex=column;
+		layout.parseHeader(header,column);
 		
 		++column;
 		
@@ -326,35 +508,14 @@ void EarthquakeSet::loadCSVFile(IO::FilePtr earthquakeFile,const Geometry::Geoid
 		}
 	
 	/* Determine the number of fields: */
-	int maxIndex=latIndex;
-	if(maxIndex<lngIndex)
-		maxIndex=lngIndex;
-	if(maxIndex<radiusIndex)
-		maxIndex=radiusIndex;
-	if(maxIndex<dateIndex)
-		maxIndex=dateIndex;
-	if(maxIndex<timeIndex)
-		maxIndex=timeIndex;
-	if(maxIndex<magIndex)
-		maxIndex=magIndex;
+	int maxIndex=layout.getMaxIndex();
 	
 	/* Skip the newline: */
 	source.skipLine();
 	source.skipWs();
 	
 	/* Check if all required portions have been detected: */
-	if(latIndex<0)
-		throw std::runtime_error("Missing latitude field");
-	if(lngIndex<0)
-		throw std::runtime_error("Missing longitude field");
-	if(radiusIndex<0)
-		throw std::runtime_error("Missing radius/depth/negative depth field");
-	if(dateIndex<0)
-		throw std::runtime_error("Missing date field");
-	if(timeIndex<0)
-		throw std::runtime_error("Missing time field");
-	if(magIndex<0)
-		throw std::runtime_error("Missing magnitude field");
+	layout.check();
 	
 	/* Read lines from the file: */
 	int lineNumber=2;
@@ -371,17 +532,17 @@ void EarthquakeSet::loadCSVFile(IO::FilePtr earthquakeFile,const Geometry::Geoid
 				/* Read the next field: */
 				if(!source.eof()&&source.peekc()!='\n'&&source.peekc()!=',')
 					{
-					if(column==latIndex)
+					if(column==layout.latIndex)
 						geodeticPosition[1]=Math::rad(source.readNumber());
-					else if(column==lngIndex)
+					else if(column==layout.lngIndex)
 						geodeticPosition[0]=Math::rad(source.readNumber());
-					else if(column==radiusIndex)
+					else if(column==layout.radiusIndex)
 						geodeticPosition[2]=source.readNumber()*1000.0;
-					else if(column==dateIndex)
+					else if(column==layout.dateIndex)
 						date=source.readString();
-					else if(column==timeIndex)
+					else if(column==layout.timeIndex)
 						time=source.readString();
-					else if(column==magIndex)
+					else if(column==layout.magIndex)
 						magnitude=float(source.readNumber());
 					else
 						source.skipString();
@@ -410,42 +571,36 @@ void EarthquakeSet::loadCSVFile(IO::FilePtr earthquakeFile,const Geometry::Geoid
 		/* Check if all fields were read: */
 		if(column>maxIndex)
 			{
-			/* Create an event: */
-			Event e;
-			
-			/* Convert the read spherical coordinates to Cartesian coordinates: */
-			Geometry::Geoid<double>::Point cartesianPosition;
-			if(radiusMode==RADIUS)
-				{
-				/* Use a simple formula with a squished sphere: */
-				double xy=Math::cos(geodeticPosition[1])*geodeticPosition[2];
-				cartesianPosition[0]=xy*Math::cos(geodeticPosition[0]);
-				cartesianPosition[1]=xy*Math::sin(geodeticPosition[0]);
-				cartesianPosition[2]=Math::sin(geodeticPosition[1])*geodeticPosition[2]*(1.0-referenceEllipsoid.getFlatteningFactor());
-				}
-			else
-				{
-				if(radiusMode==DEPTH)
-					geodeticPosition[2]=-geodeticPosition[2];
-				cartesianPosition=referenceEllipsoid.geodeticToCartesian(geodeticPosition);
-				}
-			for(int i=0;i<3;++i)
-				e.position[i]=float((cartesianPosition[i]+offset[i])*scaleFactor);
-			
-			/* Calculate the event time: */
-			e.time=parseDateTime(date.c_str(),time.c_str());
-			
-			/* Store the event magnitude: */
-			e.magnitude=magnitude;
-			
 			/* Append the event to the earthquake set: */
-			events.push_back(e);
+			events.push_back(createEvent(geodeticPosition,date,time,magnitude,layout.radiusMode,referenceEllipsoid,offset,scaleFactor));
 			}
 		
 		++lineNumber;
 		}
 	}
 
+void EarthquakeSet::loadCommaSeparatedFile(IO::FilePtr earthquakeFile,const Geometry::Geoid<double>& referenceEllipsoid,const Geometry::Vector<double,3>& offset,double scaleFactor)
+	{
+	/* Wrap a CSV source around the input file: */
+	IO::CSVSource source(earthquakeFile);
+	
+	/* Parse the file's header line: */
+	ColumnLayout layout;
+	int column=0;
+	do
+		{
+		layout.parseHeader(trimSpace(source.readField<std::string>()),column);
+		++column;
+		}
+	while(!source.eor());
+	layout.check();
+	
+	/* Load events from the rest of the file in parallel: */
+	CSVEventLoader loader(layout,referenceEllipsoid,offset,scaleFactor);
+	source.processChunks(loader);
+	loader.appendEvents(events);
+	}
+
 #if EARTHQUAKESET_EXPLICIT_RECURSION
 
 void EarthquakeSet::drawBackToFront(const Point& eyePos,GLuint* bufferPtr) const
@@ -764,6 +919,11 @@ EarthquakeSet::EarthquakeSet(IO::DirectoryPtr directory,const char* earthquakeFi
 			/* Read an earthquake database snapshot in "readable" ANSS format: */
 			loadANSSFile(earthquakeFile,referenceEllipsoid,offset,scaleFactor);
 			}
+		else if(Misc::hasCaseExtension(earthquakeFileName,".csv"))
+			{
+			/* Read an earthquake event file in strict comma-separated format: */
+			loadCommaSeparatedFile(earthquakeFile,referenceEllipsoid,offset,scaleFactor);
+			}
 		else
 			{
 			/* Read an earthquake event file in space- or comma-separated format: */
@@ -0,0 +1,159 @@
+/***********************************************************************
+GLContextDataBenchmark - Vrui application to measure the cost of looking
+up per-context data items, comparing GLContextData's slot-indexed data
+item arrays against the hash table lookups it used to perform.
+Copyright (c) 2014 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <iostream>
+#include <Misc/HashTable.h>
+#include <Misc/Timer.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <GL/GLContextData.h>
+#include <Vrui/Vrui.h>
+#include <Vrui/Application.h>
+
+class GLContextDataBenchmark:public Vrui::Application
+	{
+	/* Embedded classes: */
+	private:
+	class Thing:public GLObject // Dummy OpenGL object with a minimal data item
+		{
+		/* Embedded classes: */
+		public:
+		struct DataItem:public GLObject::DataItem
+			{
+			/* Elements: */
+			public:
+			unsigned int value; // Dummy value to keep lookups from being optimized away
+			
+			/* Constructors and destructors: */
+			DataItem(unsigned int sValue)
+				:value(sValue)
+				{
+				}
+			};
+		
+		/* Elements: */
+		unsigned int value; // Value to store in the data item
+		
+		/* Constructors and destructors: */
+		Thing(unsigned int sValue)
+			:value(sValue)
+			{
+			}
+		
+		/* Methods from GLObject: */
+		virtual void initContext(GLContextData& contextData) const
+			{
+			contextData.addDataItem(this,new DataItem(value));
+			}
+		};
+	
+	typedef Misc::HashTable<const GLObject*,GLObject::DataItem*> ItemHash; // Hash table type formerly used by GLContextData
+	
+	/* Elements: */
+	std::vector<Thing*> things; // List of dummy objects
+	unsigned int numRounds; // Number of times to look up each object's data item
+	mutable bool measured; // Flag whether the benchmark has already run
+	
+	/* Constructors and destructors: */
+	public:
+	GLContextDataBenchmark(int& argc,char**& argv);
+	virtual ~GLContextDataBenchmark(void);
+	
+	/* Methods from Vrui::Application: */
+	virtual void display(GLContextData& contextData) const;
+	};
+
+/***************************************
+Methods of class GLContextDataBenchmark:
+***************************************/
+
+GLContextDataBenchmark::GLContextDataBenchmark(int& argc,char**& argv)
+	:Vrui::Application(argc,argv),
+	 numRounds(1000),
+	 measured(false)
+	{
+	/* Parse the command line: */
+	unsigned int numThings=1000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"numThings")==0)
+				{
+				++i;
+				numThings=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"numRounds")==0)
+				{
+				++i;
+				numRounds=atoi(argv[i]);
+				}
+			}
+		}
+	
+	/* Create the dummy objects: */
+	for(unsigned int i=0;i<numThings;++i)
+		things.push_back(new Thing(i));
+	}
+
+GLContextDataBenchmark::~GLContextDataBenchmark(void)
+	{
+	for(std::vector<Thing*>::iterator tIt=things.begin();tIt!=things.end();++tIt)
+		delete *tIt;
+	}
+
+void GLContextDataBenchmark::display(GLContextData& contextData) const
+	{
+	if(measured)
+		return;
+	measured=true;
+	
+	/* Populate a hash table with the same data items the context holds: */
+	ItemHash itemHash(17);
+	for(std::vector<Thing*>::const_iterator tIt=things.begin();tIt!=things.end();++tIt)
+		itemHash.setEntry(ItemHash::Entry(*tIt,contextData.retrieveDataItem<Thing::DataItem>(*tIt)));
+	
+	/* Time lookups through the context's slot-indexed data item array: */
+	unsigned int sum1=0;
+	Misc::Timer t1;
+	for(unsigned int round=0;round<numRounds;++round)
+		for(std::vector<Thing*>::const_iterator tIt=things.begin();tIt!=things.end();++tIt)
+			sum1+=contextData.retrieveDataItem<Thing::DataItem>(*tIt)->value;
+	t1.elapse();
+	
+	/* Time lookups through the hash table followed by a dynamic cast: */
+	unsigned int sum2=0;
+	Misc::Timer t2;
+	for(unsigned int round=0;round<numRounds;++round)
+		for(std::vector<Thing*>::const_iterator tIt=things.begin();tIt!=things.end();++tIt)
+			sum2+=dynamic_cast<Thing::DataItem*>(itemHash.getEntry(*tIt).getDest())->value;
+	t2.elapse();
+	
+	double numLookups=double(numRounds)*double(things.size());
+	std::cout<<"Slot array lookup: "<<t1.getTime()*1.0e9/numLookups<<" ns per lookup (checksum "<<sum1<<")"<<std::endl;
+	std::cout<<"Hash table lookup: "<<t2.getTime()*1.0e9/numLookups<<" ns per lookup (checksum "<<sum2<<")"<<std::endl;
+	}
+
+/* Create and execute an application object: */
+VRUI_APPLICATION_RUN(GLContextDataBenchmark)
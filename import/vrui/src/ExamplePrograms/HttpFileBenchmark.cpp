@@ -0,0 +1,343 @@
+/***********************************************************************
+HttpFileBenchmark - Program to measure the throughput of reading remote
+files through a single streaming HTTP connection, and through parallel
+range requests with and without an on-disk cache. Runs a local HTTP
+test server with configurable per-request latency and per-connection
+bandwidth.
+Copyright (c) 2014 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <Misc/Timer.h>
+#include <Comm/ListeningTCPSocket.h>
+#include <Comm/TCPPipe.h>
+#include <Comm/HttpFile.h>
+#include <Comm/ParallelHttpFile.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned char patternByte(size_t offset) // Returns the test file's byte at the given offset
+	{
+	return (unsigned char)((offset*2654435761U)>>24);
+	}
+
+std::string readRequestLine(Comm::Pipe& pipe) // Reads a CR/LF-terminated request line
+	{
+	std::string result;
+	int c;
+	while((c=pipe.getChar())!='\n')
+		{
+		if(c<0)
+			throw std::runtime_error("Connection closed");
+		if(c!='\r')
+			result.push_back(char(c));
+		}
+	return result;
+	}
+
+void serveConnection(Comm::TCPPipe& pipe,const unsigned char* file,size_t fileSize,bool supportRanges,unsigned int latency,double bandwidth) // Serves GET requests on a persistent connection until the client disconnects
+	{
+	while(true)
+		{
+		/* Read the request line and all header fields: */
+		std::string requestLine=readRequestLine(pipe);
+		size_t first=0,last=fileSize-1;
+		bool ranged=false;
+		while(true)
+			{
+			std::string line=readRequestLine(pipe);
+			if(line.empty())
+				break;
+			unsigned long long a,b;
+			if(supportRanges&&sscanf(line.c_str(),"Range: bytes=%llu-%llu",&a,&b)==2&&a<=b&&a<fileSize)
+				{
+				ranged=true;
+				first=size_t(a);
+				last=b<fileSize?size_t(b):fileSize-1;
+				}
+			}
+		
+		/* Simulate the round-trip latency of a remote server: */
+		if(latency>0)
+			usleep(latency*1000);
+		
+		/* Send the reply header and body: */
+		char header[512];
+		int headerSize;
+		if(ranged)
+			headerSize=snprintf(header,sizeof(header),"HTTP/1.1 206 Partial Content\r\nContent-Length: %llu\r\nContent-Range: bytes %llu-%llu/%llu\r\nETag: \"bench-%llu\"\r\nLast-Modified: Mon, 01 Sep 2014 00:00:00 GMT\r\n\r\n",(unsigned long long)(last+1-first),(unsigned long long)first,(unsigned long long)last,(unsigned long long)fileSize,(unsigned long long)fileSize);
+		else
+			headerSize=snprintf(header,sizeof(header),"HTTP/1.1 200 OK\r\nContent-Length: %llu\r\n\r\n",(unsigned long long)fileSize);
+		pipe.writeRaw(header,headerSize);
+		
+		/* Send the body in pieces to simulate the limited bandwidth of a single remote connection: */
+		const size_t pieceSize=65536;
+		for(size_t offset=first;offset<=last;offset+=pieceSize)
+			{
+			size_t writeSize=last+1-offset;
+			if(writeSize>pieceSize)
+				writeSize=pieceSize;
+			pipe.writeRaw(file+offset,writeSize);
+			if(bandwidth>0.0)
+				{
+				pipe.flush();
+				usleep((unsigned int)(double(writeSize)*1.0e6/(bandwidth*1024.0*1024.0)));
+				}
+			}
+		pipe.flush();
+		}
+	}
+
+pid_t startServer(Comm::ListeningTCPSocket& socket,const unsigned char* file,size_t fileSize,bool supportRanges,unsigned int latency,double bandwidth) // Forks a server process handling each connection in its own child process
+	{
+	pid_t serverPid=fork();
+	if(serverPid!=0)
+		return serverPid;
+	
+	/* Let the kernel reap finished connection processes: */
+	signal(SIGCHLD,SIG_IGN);
+	while(true)
+		{
+		Comm::TCPPipe* pipe=new Comm::TCPPipe(socket);
+		if(fork()==0)
+			{
+			try
+				{
+				serveConnection(*pipe,file,fileSize,supportRanges,latency,bandwidth);
+				}
+			catch(std::runtime_error err)
+				{
+				/* Client closed the connection: */
+				}
+			_exit(0);
+			}
+		delete pipe;
+		}
+	}
+
+void reportResult(const char* name,size_t dataSize,double time,size_t numErrors)
+	{
+	std::cout<<name<<": "<<double(dataSize)/(1024.0*1024.0)/time<<" MB/s, "<<numErrors<<" corrupted bytes"<<std::endl;
+	}
+
+size_t readSequential(IO::File& file,size_t fileSize) // Reads the entire file sequentially and returns the number of corrupted bytes
+	{
+	size_t numErrors=0;
+	size_t offset=0;
+	while(offset<fileSize)
+		{
+		void* buffer;
+		size_t readSize=file.readInBuffer(buffer);
+		if(readSize==0)
+			{
+			numErrors+=fileSize-offset;
+			break;
+			}
+		const unsigned char* bPtr=static_cast<const unsigned char*>(buffer);
+		for(size_t i=0;i<readSize;++i,++offset)
+			if(bPtr[i]!=patternByte(offset))
+				++numErrors;
+		}
+	return numErrors;
+	}
+
+size_t readRandom(IO::SeekableFile& file,size_t fileSize,unsigned int numReads,size_t readSize) // Reads from random positions and returns the number of corrupted bytes
+	{
+	size_t numErrors=0;
+	unsigned char* buffer=new unsigned char[readSize];
+	srand(1);
+	for(unsigned int i=0;i<numReads;++i)
+		{
+		size_t offset=size_t(double(rand())/double(RAND_MAX)*double(fileSize-readSize));
+		file.setReadPosAbs(offset);
+		file.read(buffer,readSize);
+		for(size_t j=0;j<readSize;++j)
+			if(buffer[j]!=patternByte(offset+j))
+				++numErrors;
+		}
+	delete[] buffer;
+	return numErrors;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t fileSize=64*1024*1024;
+	unsigned int latency=2;
+	double bandwidth=32.0;
+	unsigned int numConnections=4;
+	size_t blockSize=1024*1024;
+	const char* cacheDirectory=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			fileSize=size_t(atof(argv[++i])*1024.0*1024.0);
+		else if(strcasecmp(argv[i],"-latency")==0&&i+1<argc)
+			latency=(unsigned int)atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-bandwidth")==0&&i+1<argc)
+			bandwidth=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-connections")==0&&i+1<argc)
+			numConnections=(unsigned int)atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-blockSize")==0&&i+1<argc)
+			blockSize=size_t(atof(argv[++i])*1024.0);
+		else if(strcasecmp(argv[i],"-cache")==0&&i+1<argc)
+			cacheDirectory=argv[++i];
+		else
+			{
+			std::cerr<<"Usage: "<<argv[0]<<" [-size <MB>] [-latency <ms>] [-bandwidth <MB/s per connection>] [-connections <number>] [-blockSize <KB>] [-cache <directory>]"<<std::endl;
+			return 1;
+			}
+		}
+	if(fileSize<65536)
+		fileSize=65536;
+	
+	/* Create a temporary cache directory if none was given: */
+	char tempCacheDirectory[]="/tmp/HttpFileBenchmarkXXXXXX";
+	bool removeCache=false;
+	if(cacheDirectory==0)
+		{
+		if(mkdtemp(tempCacheDirectory)==0)
+			{
+			std::cerr<<"Unable to create temporary cache directory"<<std::endl;
+			return 1;
+			}
+		cacheDirectory=tempCacheDirectory;
+		removeCache=true;
+		}
+	
+	/* Create the test file: */
+	unsigned char* file=new unsigned char[fileSize];
+	for(size_t i=0;i<fileSize;++i)
+		file[i]=patternByte(i);
+	
+	/* Start test servers with and without range support on random ports: */
+	Comm::ListeningTCPSocket rangeSocket(-1,16);
+	Comm::ListeningTCPSocket plainSocket(-1,16);
+	pid_t rangeServer=startServer(rangeSocket,file,fileSize,true,latency,bandwidth);
+	pid_t plainServer=startServer(plainSocket,file,fileSize,false,latency,bandwidth);
+	char rangeUrl[256],plainUrl[256];
+	snprintf(rangeUrl,sizeof(rangeUrl),"http://localhost:%d/benchmark.dat",rangeSocket.getPortId());
+	snprintf(plainUrl,sizeof(plainUrl),"http://localhost:%d/benchmark.dat",plainSocket.getPortId());
+	
+	std::cout<<"Reading "<<double(fileSize)/(1024.0*1024.0)<<" MB with "<<latency<<" ms server latency and "<<bandwidth<<" MB/s per connection"<<std::endl;
+	
+	int result=0;
+	try
+		{
+		/* Read the file through a single streaming connection: */
+		{
+		Misc::Timer timer;
+		Comm::HttpFile httpFile(rangeUrl);
+		size_t numErrors=readSequential(httpFile,fileSize);
+		timer.elapse();
+		reportResult("HttpFile, sequential",fileSize,timer.getTime(),numErrors);
+		}
+		
+		/* Read the file through parallel range requests without cache: */
+		{
+		Misc::Timer timer;
+		Comm::ParallelHttpFile file(rangeUrl,numConnections,blockSize,0);
+		size_t numErrors=readSequential(file,fileSize);
+		timer.elapse();
+		reportResult("ParallelHttpFile, sequential",fileSize,timer.getTime(),numErrors);
+		}
+		
+		/* Read random chunks through parallel range requests without cache: */
+		size_t randomReadSize=65536;
+		unsigned int numRandomReads=256;
+		{
+		Misc::Timer timer;
+		Comm::ParallelHttpFile file(rangeUrl,numConnections,blockSize,0);
+		size_t numErrors=readRandom(file,fileSize,numRandomReads,randomReadSize);
+		timer.elapse();
+		reportResult("ParallelHttpFile, random",randomReadSize*numRandomReads,timer.getTime(),numErrors);
+		}
+		
+		/* Read the file twice through the on-disk cache: */
+		for(int pass=0;pass<2;++pass)
+			{
+			Misc::Timer timer;
+			Comm::ParallelHttpFile file(rangeUrl,numConnections,blockSize,cacheDirectory);
+			size_t numErrors=readSequential(file,fileSize);
+			timer.elapse();
+			reportResult(pass==0?"ParallelHttpFile, cold cache":"ParallelHttpFile, warm cache",fileSize,timer.getTime(),numErrors);
+			}
+		
+		/* Check that servers without range support are rejected: */
+		try
+			{
+			Comm::ParallelHttpFile file(plainUrl,numConnections,blockSize,0);
+			std::cerr<<"Server without range support was not detected"<<std::endl;
+			result=1;
+			}
+		catch(IO::File::OpenError err)
+			{
+			std::cout<<"Server without range support rejected as expected"<<std::endl;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Benchmark terminated with exception "<<err.what()<<std::endl;
+		result=1;
+		}
+	
+	/* Shut down the test servers: */
+	kill(rangeServer,SIGTERM);
+	kill(plainServer,SIGTERM);
+	waitpid(rangeServer,0,0);
+	waitpid(plainServer,0,0);
+	delete[] file;
+	
+	/* Remove the temporary cache directory: */
+	if(removeCache)
+		{
+		DIR* dir=opendir(cacheDirectory);
+		if(dir!=0)
+			{
+			struct dirent* entry;
+			while((entry=readdir(dir))!=0)
+				if(entry->d_name[0]!='.')
+					{
+					std::string entryName=cacheDirectory;
+					entryName.push_back('/');
+					entryName.append(entry->d_name);
+					unlink(entryName.c_str());
+					}
+			closedir(dir);
+			}
+		rmdir(cacheDirectory);
+		}
+	
+	return result;
+	}
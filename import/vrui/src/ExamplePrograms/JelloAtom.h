@@ -31,6 +31,8 @@ class GLContextData;
 
 class JelloAtom
 	{
+	friend class JelloCrystal; // A class to simulate Jell-O crystals using the atoms' force field parameters
+	
 	/* Embedded classes: */
 	public:
 	typedef double Scalar; // Scalar type
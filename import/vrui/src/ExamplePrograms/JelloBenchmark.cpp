@@ -0,0 +1,144 @@
+/***********************************************************************
+JelloBenchmark - Program to measure the simulation throughput of Jell-O
+crystals of growing sizes on growing numbers of threads, and to check
+that multithreaded simulation produces the same results as simulation on
+a single thread.
+Copyright (c) 2014 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <iostream>
+#include <Misc/Timer.h>
+
+#include "JelloCrystal.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class StateRecorder // Class to record the states of all atoms of a Jell-O crystal through its typed pipe interface
+	{
+	/* Elements: */
+	public:
+	std::vector<JelloCrystal::Scalar> values; // Recorded atom state components
+	
+	/* Methods: */
+	void write(const JelloCrystal::Scalar* data,size_t numItems) // Appends the given atom state components
+		{
+		values.insert(values.end(),data,data+numItems);
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+std::vector<JelloCrystal::Scalar> runSimulation(const JelloCrystal::Index& numAtoms,unsigned int numThreads,int numSteps,double& atomStepsPerSecond)
+	{
+	/* Create a crystal and a repeatable disturbance by dragging one of its corner atoms: */
+	JelloCrystal crystal(numAtoms);
+	crystal.setNumThreads(numThreads);
+	JelloCrystal::AtomID draggedAtom=crystal.pickAtom(crystal.getAtomPosition(JelloCrystal::Index(numAtoms[0]-1,numAtoms[1]-1,numAtoms[2]-1)));
+	crystal.lockAtom(draggedAtom);
+	
+	/* Run the simulation: */
+	const JelloCrystal::Scalar timeStep=0.01;
+	Misc::Timer timer;
+	for(int step=0;step<numSteps;++step)
+		{
+		if(step<numSteps/4)
+			{
+			/* Drag the locked atom: */
+			JelloCrystal::ONTransform atomState=crystal.getAtomState(draggedAtom);
+			atomState.leftMultiply(JelloCrystal::ONTransform::translate(JelloCrystal::Vector(-0.1,-0.05,-0.2)));
+			atomState.leftMultiply(JelloCrystal::ONTransform::rotate(JelloCrystal::Rotation::rotateX(0.02)));
+			crystal.setAtomState(draggedAtom,atomState);
+			}
+		else if(step==numSteps/4)
+			crystal.unlockAtom(draggedAtom);
+		
+		crystal.simulate(timeStep);
+		}
+	timer.elapse();
+	
+	int totalNumAtoms=numAtoms[0]*numAtoms[1]*numAtoms[2];
+	atomStepsPerSecond=double(totalNumAtoms)*double(numSteps)/timer.getTime();
+	
+	/* Return the final crystal state: */
+	StateRecorder recorder;
+	crystal.writeAtomStates(recorder);
+	return recorder.values;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int maxSize=32;
+	int numSteps=200;
+	unsigned int maxNumThreads=(unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-maxSize")==0&&i+1<argc)
+			maxSize=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-numSteps")==0&&i+1<argc)
+			numSteps=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-maxThreads")==0&&i+1<argc)
+			maxNumThreads=(unsigned int)atoi(argv[++i]);
+		else
+			{
+			std::cerr<<"Usage: "<<argv[0]<<" [-maxSize <atoms along longest axis>] [-numSteps <simulation steps>] [-maxThreads <number of threads>]"<<std::endl;
+			return 1;
+			}
+		}
+	if(maxNumThreads<1)
+		maxNumThreads=1;
+	
+	/* Simulate crystals of the default Jell-O proportions at growing sizes: */
+	bool allIdentical=true;
+	for(int size=8;size<=maxSize;size*=2)
+		{
+		JelloCrystal::Index numAtoms(size/2,size/2,size);
+		std::cout<<"Crystal "<<numAtoms[0]<<"x"<<numAtoms[1]<<"x"<<numAtoms[2]<<":"<<std::endl;
+		
+		/* Run the single-threaded reference simulation: */
+		double referenceRate;
+		std::vector<JelloCrystal::Scalar> reference=runSimulation(numAtoms,1,numSteps,referenceRate);
+		std::cout<<"   1 thread : "<<referenceRate*1.0e-6<<" M atom-steps/s"<<std::endl;
+		
+		/* Run multithreaded simulations and compare their results to the reference: */
+		for(unsigned int numThreads=2;numThreads<=maxNumThreads;numThreads*=2)
+			{
+			double rate;
+			std::vector<JelloCrystal::Scalar> result=runSimulation(numAtoms,numThreads,numSteps,rate);
+			bool identical=result==reference;
+			allIdentical=allIdentical&&identical;
+			std::cout<<"   "<<numThreads<<" threads: "<<rate*1.0e-6<<" M atom-steps/s, speedup "<<rate/referenceRate;
+			if(!identical)
+				std::cout<<", RESULTS DIFFER FROM SINGLE-THREADED SIMULATION";
+			std::cout<<std::endl;
+			}
+		}
+	
+	return allIdentical?0:1;
+	}
@@ -1,8 +1,9 @@
 /***********************************************************************
 JelloCrystal - Class to simulate the behavior of crystals of Jell-O
 atoms using a real-time ODE solver based on a fourth-order Runge-Kutta-
-Nystrom method.
-Copyright (c) 2007 Oliver Kreylos
+Nystrom method. Atom states are stored in structure-of-arrays layout,
+and each integration stage is evaluated by a pool of worker threads.
+Copyright (c) 2007-2014 Oliver Kreylos
 
 This file is part of the Virtual Jell-O interactive VR demonstration.
 
@@ -21,6 +22,8 @@ with Virtual Jell-O; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+
+#include <unistd.h>
 #include <Math/Math.h>
 #include <Math/Random.h>
 #include <Math/Constants.h>
@@ -28,16 +31,330 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include "JelloCrystal.h"
 
+/*************************************
+Methods of class JelloCrystal::Worker:
+*************************************/
+
+void* JelloCrystal::Worker::threadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next simulation step: */
+		crystal->startBarrier.synchronize();
+		if(crystal->shutdown)
+			break;
+		
+		/* Simulate this worker's share of the crystal: */
+		crystal->simulateRows(threadIndex);
+		}
+	
+	return 0;
+	}
+
 /*****************************
 Methods of class JelloCrystal:
 *****************************/
 
+void JelloCrystal::calcVertexAxes(int atomBegin,int atomEnd)
+	{
+	/* Transform the positive bond vertex offsets along all three crystal axes by each atom's orientation: */
+	for(int atom=atomBegin;atom<atomEnd;++atom)
+		{
+		Rotation orientation(orientations[0][atom],orientations[1][atom],orientations[2][atom],orientations[3][atom]);
+		for(int axis=0;axis<3;++axis)
+			{
+			Vector va=orientation.transform(JelloAtom::vertexOffsets[2*axis+1]);
+			for(int i=0;i<3;++i)
+				vertexAxes[axis][i][atom]=va[i];
+			}
+		}
+	}
+
+void JelloCrystal::accumulateBondForces(int stage,int atomBegin,int atomEnd,int neighbourOffset,int axis,JelloCrystal::Scalar sign)
+	{
+	/* Get the force field parameters: */
+	Scalar centralForceRadius=JelloAtom::centralForceRadius;
+	Scalar centralForceRadius2=JelloAtom::centralForceRadius2;
+	Scalar centralForceStrength=JelloAtom::centralForceStrength;
+	Scalar centralForceMass=JelloAtom::centralForceRadius2*JelloAtom::mass;
+	Scalar vertexForceFactor=JelloAtom::vertexForceStrength/(JelloAtom::vertexForceRadius*JelloAtom::mass);
+	Scalar torqueFactor=JelloAtom::mass/JelloAtom::inertia;
+	
+	/* Access the component arrays: */
+	const Scalar* px=positions[0];
+	const Scalar* py=positions[1];
+	const Scalar* pz=positions[2];
+	const Scalar* vx=vertexAxes[axis][0];
+	const Scalar* vy=vertexAxes[axis][1];
+	const Scalar* vz=vertexAxes[axis][2];
+	Scalar* lax=linearAccelerations[stage][0];
+	Scalar* lay=linearAccelerations[stage][1];
+	Scalar* laz=linearAccelerations[stage][2];
+	Scalar* aax=angularAccelerations[stage][0];
+	Scalar* aay=angularAccelerations[stage][1];
+	Scalar* aaz=angularAccelerations[stage][2];
+	
+	/*********************************************************************
+	Each atom's bond vertex along the given axis is bonded to the opposite
+	bond vertex of its neighbour. Both vertex offsets are the atoms'
+	positive vertex offsets, flipped by the bond direction. The loop has
+	no data-dependent control flow so it can be vectorized.
+	*********************************************************************/
+	
+	for(int atom=atomBegin;atom<atomEnd;++atom)
+		{
+		int neighbour=atom+neighbourOffset;
+		
+		/* Calculate the repelling force between the atoms' centers: */
+		Scalar cdx=px[neighbour]-px[atom];
+		Scalar cdy=py[neighbour]-py[atom];
+		Scalar cdz=pz[neighbour]-pz[atom];
+		Scalar cdistLen2=cdx*cdx+cdy*cdy+cdz*cdz;
+		Scalar central=cdistLen2<centralForceRadius2?centralForceStrength*(Math::sqrt(cdistLen2)-centralForceRadius)/centralForceMass:Scalar(0);
+		Scalar lx=cdx*central;
+		Scalar ly=cdy*central;
+		Scalar lz=cdz*central;
+		
+		/* Calculate the vertex attracting force: */
+		Scalar o1x=vx[atom]*sign;
+		Scalar o1y=vy[atom]*sign;
+		Scalar o1z=vz[atom]*sign;
+		Scalar dx=((cdx-vx[neighbour]*sign)-o1x)*vertexForceFactor;
+		Scalar dy=((cdy-vy[neighbour]*sign)-o1y)*vertexForceFactor;
+		Scalar dz=((cdz-vz[neighbour]*sign)-o1z)*vertexForceFactor;
+		
+		/* Apply linear and angular acceleration: */
+		lax[atom]=(lax[atom]+lx)+dx;
+		lay[atom]=(lay[atom]+ly)+dy;
+		laz[atom]=(laz[atom]+lz)+dz;
+		aax[atom]+=(o1y*dz-o1z*dy)*torqueFactor;
+		aay[atom]+=(o1z*dx-o1x*dz)*torqueFactor;
+		aaz[atom]+=(o1x*dy-o1y*dx)*torqueFactor;
+		}
+	}
+
+void JelloCrystal::calcAccelerations(int stage,int rowBegin,int rowEnd)
+	{
+	int rowSize=numAtoms[2];
+	int planeSize=numAtoms[1]*numAtoms[2];
+	for(int row=rowBegin;row<rowEnd;++row)
+		{
+		int rowIndex[2];
+		rowIndex[0]=row/numAtoms[1];
+		rowIndex[1]=row%numAtoms[1];
+		int rowStart=row*rowSize;
+		int rowStop=rowStart+rowSize;
+		
+		/* Reset accelerations: */
+		for(int i=0;i<3;++i)
+			for(int atom=rowStart;atom<rowStop;++atom)
+				{
+				linearAccelerations[stage][i][atom]=Scalar(0);
+				angularAccelerations[stage][i][atom]=Scalar(0);
+				}
+		
+		/* Calculate forces exerted by bonds, in the order of the atoms' bond vertices: */
+		if(rowIndex[0]>0)
+			accumulateBondForces(stage,rowStart,rowStop,-planeSize,0,Scalar(-1));
+		if(rowIndex[0]<numAtoms[0]-1)
+			accumulateBondForces(stage,rowStart,rowStop,planeSize,0,Scalar(1));
+		if(rowIndex[1]>0)
+			accumulateBondForces(stage,rowStart,rowStop,-rowSize,1,Scalar(-1));
+		if(rowIndex[1]<numAtoms[1]-1)
+			accumulateBondForces(stage,rowStart,rowStop,rowSize,1,Scalar(1));
+		accumulateBondForces(stage,rowStart+1,rowStop,-1,2,Scalar(-1));
+		accumulateBondForces(stage,rowStart,rowStop-1,1,2,Scalar(1));
+		
+		for(int atom=rowStart;atom<rowStop;++atom)
+			{
+			/* Locked atoms do not react to bond forces: */
+			if(lockedAtoms[atom])
+				{
+				for(int i=0;i<3;++i)
+					{
+					linearAccelerations[stage][i][atom]=Scalar(0);
+					angularAccelerations[stage][i][atom]=Scalar(0);
+					}
+				}
+			
+			/* Add gravity: */
+			if(positions[2][atom]>domain.min[2])
+				linearAccelerations[stage][2][atom]-=gravity;
+			}
+		}
+	}
+
+void JelloCrystal::simulateRows(unsigned int threadIndex)
+	{
+	/* Determine this thread's share of the crystal: */
+	int rowBegin=int((long(numRows)*long(threadIndex))/long(numThreads));
+	int rowEnd=int((long(numRows)*long(threadIndex+1))/long(numThreads));
+	int atomBegin=rowBegin*numAtoms[2];
+	int atomEnd=rowEnd*numAtoms[2];
+	Scalar timeStep=stepTimeStep;
+	
+	/* Calculate the effective velocity attenuation for this time step: */
+	Scalar att=Math::pow(attenuation,timeStep);
+	
+	/***********************************************************
+	Perform a fourth-order Runge-Kutta-Nystrom integration step:
+	***********************************************************/
+	
+	Scalar f1,f2;
+	
+	/* Save initial atom states: */
+	for(int i=0;i<3;++i)
+		for(int atom=atomBegin;atom<atomEnd;++atom)
+			savedPositions[i][atom]=positions[i][atom];
+	for(int i=0;i<4;++i)
+		for(int atom=atomBegin;atom<atomEnd;++atom)
+			savedOrientations[i][atom]=orientations[i][atom];
+	calcVertexAxes(atomBegin,atomEnd);
+	synchronize();
+	
+	/* Calculate accelerations on all atoms: */
+	calcAccelerations(0,rowBegin,rowEnd);
+	synchronize();
+	
+	/* Move all atoms to the first evaluation position: */
+	f1=timeStep*Scalar(0.5);
+	f2=timeStep*timeStep*Scalar(0.125);
+	for(int atom=atomBegin;atom<atomEnd;++atom)
+		{
+		/* Update the atom's position and orientation: */
+		for(int i=0;i<3;++i)
+			positions[i][atom]+=linearVelocities[i][atom]*f1+linearAccelerations[0][i][atom]*f2;
+		Vector dO;
+		for(int i=0;i<3;++i)
+			dO[i]=angularVelocities[i][atom]*f1+angularAccelerations[0][i][atom]*f2;
+		Rotation orientation(orientations[0][atom],orientations[1][atom],orientations[2][atom],orientations[3][atom]);
+		orientation.leftMultiply(Rotation(dO));
+		for(int i=0;i<4;++i)
+			orientations[i][atom]=orientation.getQuaternion()[i];
+		}
+	calcVertexAxes(atomBegin,atomEnd);
+	synchronize();
+	
+	/* Calculate accelerations on all atoms: */
+	calcAccelerations(1,rowBegin,rowEnd);
+	synchronize();
+	
+	/* Move all atoms to the second evaluation position: */
+	f1=timeStep;
+	f2=timeStep*timeStep*Scalar(0.5);
+	for(int atom=atomBegin;atom<atomEnd;++atom)
+		{
+		/* Update the atom's position and orientation: */
+		for(int i=0;i<3;++i)
+			positions[i][atom]=savedPositions[i][atom]+(linearVelocities[i][atom]*f1+linearAccelerations[1][i][atom]*f2);
+		Vector dO;
+		for(int i=0;i<3;++i)
+			dO[i]=angularVelocities[i][atom]*f1+angularAccelerations[0][i][atom]*f2;
+		Rotation orientation(savedOrientations[0][atom],savedOrientations[1][atom],savedOrientations[2][atom],savedOrientations[3][atom]);
+		orientation.leftMultiply(Rotation(dO));
+		for(int i=0;i<4;++i)
+			orientations[i][atom]=orientation.getQuaternion()[i];
+		}
+	calcVertexAxes(atomBegin,atomEnd);
+	synchronize();
+	
+	/* Calculate accelerations on all atoms: */
+	calcAccelerations(2,rowBegin,rowEnd);
+	synchronize();
+	
+	/* Move all atoms to the end of the time step: */
+	f1=timeStep;
+	f2=timeStep*timeStep/Scalar(6);
+	Scalar f3=timeStep/Scalar(6);
+	for(int atom=atomBegin;atom<atomEnd;++atom)
+		{
+		/* Update the atom's position and orientation: */
+		for(int i=0;i<3;++i)
+			positions[i][atom]=savedPositions[i][atom]+(linearVelocities[i][atom]*f1+(linearAccelerations[0][i][atom]+linearAccelerations[1][i][atom]*Scalar(2))*f2);
+		Vector dO;
+		for(int i=0;i<3;++i)
+			dO[i]=angularVelocities[i][atom]*f1+(angularAccelerations[0][i][atom]+angularAccelerations[1][i][atom]*Scalar(2))*f2;
+		Rotation orientation(savedOrientations[0][atom],savedOrientations[1][atom],savedOrientations[2][atom],savedOrientations[3][atom]);
+		orientation.leftMultiply(Rotation(dO));
+		orientation.renormalize();
+		for(int i=0;i<4;++i)
+			orientations[i][atom]=orientation.getQuaternion()[i];
+		
+		/* Update the atom's linear and angular velocities: */
+		for(int i=0;i<3;++i)
+			{
+			linearVelocities[i][atom]+=(linearAccelerations[0][i][atom]+linearAccelerations[1][i][atom]*Scalar(4)+linearAccelerations[2][i][atom])*f3;
+			angularVelocities[i][atom]+=(angularAccelerations[0][i][atom]+angularAccelerations[1][i][atom]*Scalar(4)+angularAccelerations[2][i][atom])*f3;
+			}
+		
+		/* Limit the atom to the domain box: */
+		for(int i=0;i<3;++i)
+			{
+			if(positions[i][atom]<domain.min[i])
+				{
+				positions[i][atom]=Scalar(2)*domain.min[i]-positions[i][atom];
+				linearVelocities[i][atom]=-linearVelocities[i][atom];
+				}
+			else if(positions[i][atom]>domain.max[i])
+				{
+				positions[i][atom]=Scalar(2)*domain.max[i]-positions[i][atom];
+				linearVelocities[i][atom]=-linearVelocities[i][atom];
+				}
+			}
+		
+		/* Attenuate the atom's velocities: */
+		for(int i=0;i<3;++i)
+			{
+			linearVelocities[i][atom]*=att;
+			angularVelocities[i][atom]*=att;
+			}
+		}
+	
+	/* Wait until all threads have finished the step: */
+	synchronize();
+	}
+
+void JelloCrystal::startThreads(void)
+	{
+	/* Start the worker threads in addition to the calling thread: */
+	shutdown=false;
+	startBarrier.setNumSynchronizingThreads(numThreads);
+	stageBarrier.setNumSynchronizingThreads(numThreads);
+	if(numThreads>1)
+		{
+		workers=new Worker[numThreads-1];
+		for(unsigned int i=0;i<numThreads-1;++i)
+			{
+			workers[i].crystal=this;
+			workers[i].threadIndex=i+1;
+			workers[i].thread.start(&workers[i],&JelloCrystal::Worker::threadMethod);
+			}
+		}
+	}
+
+void JelloCrystal::stopThreads(void)
+	{
+	if(workers!=0)
+		{
+		/* Wake up the worker threads and tell them to exit: */
+		shutdown=true;
+		startBarrier.synchronize();
+		for(unsigned int i=0;i<numThreads-1;++i)
+			workers[i].thread.join();
+		delete[] workers;
+		workers=0;
+		}
+	}
+
 JelloCrystal::JelloCrystal(void)
 	:atomMass(1.0),
 	 attenuation(0.5),
 	 gravity(20.0),
+	 numAtoms(0,0,0),numRows(0),totalNumAtoms(0),
 	 domain(Point(-60.0,-36.0,0.0),Point(60.0,60.0,96.0)),
-	 atomStates(0)
+	 atomData(0),lockedAtoms(0),
+	 numThreads(1),workers(0),
+	 shutdown(false),stepTimeStep(0)
 	{
 	/* Initialize the Jell-O crystal: */
 	JelloAtom::initClass();
@@ -48,9 +365,11 @@ JelloCrystal::JelloCrystal(const JelloCrystal::Index& numAtoms)
 	:atomMass(1.0),
 	 attenuation(0.5),
 	 gravity(20.0),
-	 crystal(numAtoms),
+	 numAtoms(0,0,0),numRows(0),totalNumAtoms(0),
 	 domain(Point(-60.0,-36.0,0.0),Point(60.0,60.0,96.0)),
-	 atomStates(0)
+	 atomData(0),lockedAtoms(0),
+	 numThreads(1),workers(0),
+	 shutdown(false),stepTimeStep(0)
 	{
 	/* Initialize the Jell-O crystal: */
 	JelloAtom::initClass();
@@ -60,52 +379,86 @@ JelloCrystal::JelloCrystal(const JelloCrystal::Index& numAtoms)
 
 JelloCrystal::~JelloCrystal(void)
 	{
-	delete[] atomStates;
+	stopThreads();
+	delete[] atomData;
+	delete[] lockedAtoms;
 	}
 
 void JelloCrystal::setNumAtoms(const JelloCrystal::Index& newNumAtoms)
 	{
-	/* Initialize the Jell-O crystal: */
-	crystal.resize(newNumAtoms);
+	/* Allocate the per-atom component arrays: */
+	numAtoms=newNumAtoms;
+	numRows=numAtoms[0]*numAtoms[1];
+	totalNumAtoms=numRows*numAtoms[2];
+	delete[] atomData;
+	delete[] lockedAtoms;
+	atomData=new Scalar[47*size_t(totalNumAtoms)];
+	lockedAtoms=new bool[totalNumAtoms];
+	Scalar* arrayPtr=atomData;
+	for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+		positions[i]=arrayPtr;
+	for(int i=0;i<4;++i,arrayPtr+=totalNumAtoms)
+		orientations[i]=arrayPtr;
+	for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+		linearVelocities[i]=arrayPtr;
+	for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+		angularVelocities[i]=arrayPtr;
+	for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+		savedPositions[i]=arrayPtr;
+	for(int i=0;i<4;++i,arrayPtr+=totalNumAtoms)
+		savedOrientations[i]=arrayPtr;
+	for(int axis=0;axis<3;++axis)
+		for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+			vertexAxes[axis][i]=arrayPtr;
+	for(int stage=0;stage<3;++stage)
+		for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+			linearAccelerations[stage][i]=arrayPtr;
+	for(int stage=0;stage<3;++stage)
+		for(int i=0;i<3;++i,arrayPtr+=totalNumAtoms)
+			angularAccelerations[stage][i]=arrayPtr;
 	
 	/* Determine the position of the crystal: */
 	Scalar atomDist=JelloAtom::getRadius()*Scalar(2);
 	Point crystalCenter;
 	for(int i=0;i<2;++i)
 		crystalCenter[i]=Math::mid(domain.min[i],domain.max[i]);
-	crystalCenter[2]=Scalar(crystal.getSize(2)-1)*atomDist*Scalar(0.5)+domain.min[2];
+	crystalCenter[2]=Scalar(numAtoms[2]-1)*atomDist*Scalar(0.5)+domain.min[2];
 	
-	/* Initialize the positions of all atoms and create all bonds: */
-	for(Crystal::Index index=crystal.beginIndex();index!=crystal.endIndex();crystal.preInc(index))
+	/* Initialize the states of all atoms; bonds between neighbouring atoms are implied by the crystal structure: */
+	for(Index index(0,0,0);index[0]<numAtoms[0];index.preInc(numAtoms))
 		{
+		int atom=numAtoms.calcOffset(index);
+		
 		/* Set the atom's position and orientation: */
 		for(int i=0;i<3;++i)
-			{
-			crystal(index).position[i]=crystalCenter[i]+Scalar(index[i])*atomDist-Scalar(newNumAtoms[i]-1)*atomDist*Scalar(0.5);
-			// crystal(index).position[i]+=Scalar(Math::randUniformCC(-atomDist*0.4,atomDist*0.4));
-			}
-		crystal(index).orientation=Rotation::identity;
+			positions[i][atom]=crystalCenter[i]+Scalar(index[i])*atomDist-Scalar(numAtoms[i]-1)*atomDist*Scalar(0.5);
+		for(int i=0;i<3;++i)
+			orientations[i][atom]=Scalar(0);
+		orientations[3][atom]=Scalar(1);
 		
-		/* Bond the atom to its neighbours: */
+		/* Reset the atom's velocities: */
 		for(int i=0;i<3;++i)
 			{
-			if(index[i]>0)
-				{
-				Crystal::Index ni=index;
-				--ni[i];
-				bondAtoms(crystal(index),2*i+0,crystal(ni),2*i+1);
-				}
-			if(index[i]<newNumAtoms[i]-1)
-				{
-				Crystal::Index ni=index;
-				++ni[i];
-				bondAtoms(crystal(index),2*i+1,crystal(ni),2*i+0);
-				}
+			linearVelocities[i][atom]=Scalar(0);
+			angularVelocities[i][atom]=Scalar(0);
 			}
+		lockedAtoms[atom]=false;
+		}
+	}
+
+void JelloCrystal::setNumThreads(unsigned int newNumThreads)
+	{
+	/* Use one thread per CPU if no number is given: */
+	if(newNumThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		newNumThreads=numCpus>0?(unsigned int)(numCpus):1U;
 		}
 	
-	/* Initialize the simulation state: */
-	atomStates=new AtomState[crystal.getNumElements()];
+	/* Restart the thread pool: */
+	stopThreads();
+	numThreads=newNumThreads;
+	startThreads();
 	}
 
 void JelloCrystal::setAtomMass(JelloCrystal::Scalar newAtomMass)
@@ -126,17 +479,17 @@ void JelloCrystal::setGravity(JelloCrystal::Scalar newGravity)
 
 JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Point& p) const
 	{
-	AtomID result=crystal.end();
+	AtomID result=-1;
 	
 	/* Compare the picking position against each unlocked atom in the crystal: */
 	Scalar minDist2=Math::sqr(JelloAtom::getRadius()*Scalar(1.5));
-	for(Crystal::const_iterator cIt=crystal.begin();cIt!=crystal.end();++cIt)
-		if(!cIt->locked) // No, you can't pick this atom -- not yours!
+	for(int atom=0;atom<totalNumAtoms;++atom)
+		if(!lockedAtoms[atom]) // No, you can't pick this atom -- not yours!
 			{
-			Scalar dist2=Geometry::sqrDist(p,cIt->position);
+			Scalar dist2=Math::sqr(p[0]-positions[0][atom])+Math::sqr(p[1]-positions[1][atom])+Math::sqr(p[2]-positions[2][atom]);
 			if(minDist2>dist2)
 				{
-				result=cIt;
+				result=atom;
 				minDist2=dist2;
 				}
 			}
@@ -146,16 +499,16 @@ JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Point& p) const
 
 JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Ray& r) const
 	{
-	AtomID result=crystal.end();
+	AtomID result=-1;
 	Scalar minLambda=Math::Constants<Scalar>::max;
 	
 	/* Intersect the ray with a sphere around each unlocked atom in the crystal: */
 	Geometry::Sphere<Scalar,3> sphere(Point::origin,JelloAtom::getRadius()*Scalar(1.5));
-	for(Crystal::const_iterator cIt=crystal.begin();cIt!=crystal.end();++cIt)
-		if(!cIt->locked) // No, you can't pick this atom -- not yours!
+	for(int atom=0;atom<totalNumAtoms;++atom)
+		if(!lockedAtoms[atom]) // No, you can't pick this atom -- not yours!
 			{
 			/* Move the test sphere to the atom's position: */
-			sphere.setCenter(cIt->position);
+			sphere.setCenter(Point(positions[0][atom],positions[1][atom],positions[2][atom]));
 			
 			/* Intersect it with the picking ray: */
 			Geometry::Sphere<Scalar,3>::HitResult hr=sphere.intersectRay(r);
@@ -163,7 +516,7 @@ JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Ray& r) const
 			/* Check if this is the closest valid intersection: */
 			if(hr.isValid()&&hr.getParameter()<minLambda)
 				{
-				result=cIt;
+				result=atom;
 				minLambda=hr.getParameter();
 				}
 			}
@@ -174,10 +527,10 @@ JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Ray& r) const
 bool JelloCrystal::lockAtom(JelloCrystal::AtomID atom)
 	{
 	/* Check if the atom is valid and not yet locked: */
-	if(atom!=crystal.end()&&!atom->locked)
+	if(atom>=0&&!lockedAtoms[atom])
 		{
 		/* Lock the atom: */
-		const_cast<Crystal::iterator>(atom)->locked=true;
+		lockedAtoms[atom]=true;
 		
 		return true;
 		}
@@ -187,155 +540,29 @@ bool JelloCrystal::lockAtom(JelloCrystal::AtomID atom)
 
 void JelloCrystal::setAtomState(JelloCrystal::AtomID atom,const JelloCrystal::ONTransform& newAtomState)
 	{
-	Crystal::iterator cIt=const_cast<Crystal::iterator>(atom);
-	cIt->position=newAtomState.getOrigin();
-	cIt->orientation=newAtomState.getRotation();
-	cIt->linearVelocity=Vector::zero;
-	cIt->angularVelocity=Vector::zero;
-	cIt->linearAcceleration=Vector::zero;
-	cIt->angularAcceleration=Vector::zero;
+	for(int i=0;i<3;++i)
+		{
+		positions[i][atom]=newAtomState.getOrigin()[i];
+		linearVelocities[i][atom]=Scalar(0);
+		angularVelocities[i][atom]=Scalar(0);
+		}
+	for(int i=0;i<4;++i)
+		orientations[i][atom]=newAtomState.getRotation().getQuaternion()[i];
 	}
 
 void JelloCrystal::unlockAtom(JelloCrystal::AtomID atom)
 	{
-	const_cast<Crystal::iterator>(atom)->locked=false;
+	lockedAtoms[atom]=false;
 	}
 
 void JelloCrystal::simulate(JelloCrystal::Scalar timeStep)
 	{
-	/* Calculate the effective velocity attenuation for this time step: */
-	Scalar att=Math::pow(attenuation,timeStep);
-	
-	/***********************************************************
-	Perform a fourth-order Runge-Kutta-Nystrom integration step:
-	***********************************************************/
-	
-	AtomState* asPtr;
-	Scalar f1,f2;
+	if(totalNumAtoms==0)
+		return;
 	
-	/* Save initial atom states and calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Save initial atom state: */
-		asPtr->position=aIt->position;
-		asPtr->orientation=aIt->orientation;
-		
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[0]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[0]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the first evaluation position: */
-	f1=timeStep*Scalar(0.5);
-	f2=timeStep*timeStep*Scalar(0.125);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=asPtr->linearAcceleration[0]*f2;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=asPtr->angularAcceleration[0]*f2;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		}
-	
-	/* Calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[1]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[1]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the second evaluation position: */
-	f1=timeStep;
-	f2=timeStep*timeStep*Scalar(0.5);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=asPtr->linearAcceleration[1]*f2;
-		aIt->position=asPtr->position;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=asPtr->angularAcceleration[0]*f2;
-		aIt->orientation=asPtr->orientation;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		}
-	
-	/* Calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[2]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[2]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the end of the time step: */
-	f1=timeStep;
-	f2=timeStep*timeStep/Scalar(6);
-	Scalar f3=timeStep/Scalar(6);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=(asPtr->linearAcceleration[0]+asPtr->linearAcceleration[1]*Scalar(2))*f2;
-		aIt->position=asPtr->position;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=(asPtr->angularAcceleration[0]+asPtr->angularAcceleration[1]*Scalar(2))*f2;
-		aIt->orientation=asPtr->orientation;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		aIt->orientation.renormalize();
-		
-		/* Update the atom's linear and angular velocities: */
-		aIt->linearVelocity+=(asPtr->linearAcceleration[0]+asPtr->linearAcceleration[1]*Scalar(4)+asPtr->linearAcceleration[2])*f3;
-		aIt->angularVelocity+=(asPtr->angularAcceleration[0]+asPtr->angularAcceleration[1]*Scalar(4)+asPtr->angularAcceleration[2])*f3;
-		
-		/* Limit the atom to the domain box: */
-		for(int i=0;i<3;++i)
-			{
-			if(aIt->position[i]<domain.min[i])
-				{
-				aIt->position[i]=Scalar(2)*domain.min[i]-aIt->position[i];
-				aIt->linearVelocity[i]=-aIt->linearVelocity[i];
-				}
-			else if(aIt->position[i]>domain.max[i])
-				{
-				aIt->position[i]=Scalar(2)*domain.max[i]-aIt->position[i];
-				aIt->linearVelocity[i]=-aIt->linearVelocity[i];
-				}
-			}
-		
-		/* Attenuate the atom's velocities: */
-		aIt->linearVelocity*=att;
-		aIt->angularVelocity*=att;
-		}
+	/* Start the simulation step on all worker threads and simulate the calling thread's share: */
+	stepTimeStep=timeStep;
+	if(workers!=0)
+		startBarrier.synchronize();
+	simulateRows(0);
 	}
@@ -1,8 +1,9 @@
 /***********************************************************************
 JelloCrystal - Class to simulate the behavior of crystals of Jell-O
 atoms using a real-time ODE solver based on a fourth-order Runge-Kutta-
-Nystrom method.
-Copyright (c) 2007 Oliver Kreylos
+Nystrom method. Atom states are stored in structure-of-arrays layout,
+and each integration stage is evaluated by a pool of worker threads.
+Copyright (c) 2007-2014 Oliver Kreylos
 
 This file is part of the Virtual Jell-O interactive VR demonstration.
 
@@ -24,7 +25,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef JELLOCRYSTAL_INCLUDED
 #define JELLOCRYSTAL_INCLUDED
 
-#include <Misc/Array.h>
+#include <Misc/ArrayIndex.h>
+#include <Threads/Thread.h>
+#include <Threads/Barrier.h>
 #include <Geometry/Ray.h>
 #include <Geometry/Box.h>
 #include <Geometry/OrthonormalTransformation.h>
@@ -47,37 +50,82 @@ class JelloCrystal
 	typedef Geometry::Ray<Scalar,3> Ray; // Type for rays
 	typedef Geometry::Box<Scalar,3> Box; // Type for axis-aligned bounding boxes
 	typedef Geometry::OrthonormalTransformation<Scalar,3> ONTransform; // Type for atom positions/orientations
-	typedef Misc::Array<JelloAtom,3> Crystal; // Type to represent "Jell-O crystals" as 3D arrays of Jell-O atoms
-	typedef Crystal::Index Index; // Type for indices into 3D arrays and array sizes
-	typedef Crystal::const_iterator AtomID; // Atom handle type used by class clients
+	typedef Misc::ArrayIndex<3> Index; // Type for indices into 3D arrays and array sizes
+	typedef int AtomID; // Atom handle type used by class clients; linear index of an atom, or -1 for invalid atoms
 	
 	private:
-	struct AtomState // Structure to buffer the state of an atom during Runge-Kutta-Nystrom integration
+	struct Worker // Structure describing a simulation worker thread
 		{
 		/* Elements: */
 		public:
-		Point position;
-		Rotation orientation;
-		Vector linearAcceleration[3];
-		Vector angularAcceleration[3];
+		JelloCrystal* crystal; // Pointer to the simulated crystal
+		unsigned int threadIndex; // Index of this worker in the crystal's thread pool
+		Threads::Thread thread; // The worker thread
+		
+		/* Methods: */
+		void* threadMethod(void); // Thread method executing this worker's share of each simulation step
 		};
 	
 	/* Elements: */
 	Scalar atomMass; // Mass of a single Jell-O atom
 	Scalar attenuation; // The velocity attenuation factor
 	Scalar gravity; // The gravity acceleration constant
-	Crystal crystal; // The virtual Jell-O crystal
+	Index numAtoms; // Size of the Jell-O crystal
+	int numRows; // Number of rows of atoms along the crystal's last axis
+	int totalNumAtoms; // Total number of atoms in the Jell-O crystal
 	Box domain; // The box containing the Jell-O crystal
-	AtomState* atomStates; // Buffer of atom states for Runge-Kutta-Nystrom integration
+	
+	/* Atom states as arrays of individual components: */
+	Scalar* atomData; // Memory block holding all per-atom component arrays
+	Scalar* positions[3]; // Atom positions
+	Scalar* orientations[4]; // Atom orientations as unit quaternions
+	Scalar* linearVelocities[3]; // Atom linear velocities
+	Scalar* angularVelocities[3]; // Atom angular velocities
+	Scalar* savedPositions[3]; // Atom positions at the beginning of the current Runge-Kutta-Nystrom step
+	Scalar* savedOrientations[4]; // Atom orientations at the beginning of the current Runge-Kutta-Nystrom step
+	Scalar* vertexAxes[3][3]; // Offsets of each atom's positive bond vertex along each crystal axis in global coordinates
+	Scalar* linearAccelerations[3][3]; // Atom linear accelerations at the three Runge-Kutta-Nystrom evaluation points
+	Scalar* angularAccelerations[3][3]; // Atom angular accelerations at the three Runge-Kutta-Nystrom evaluation points
+	bool* lockedAtoms; // Flags whether atoms are currently locked (by a dragger)
+	
+	/* Multithreaded simulation state: */
+	unsigned int numThreads; // Number of threads evaluating each simulation step, including the calling thread
+	Worker* workers; // Array of worker threads in addition to the calling thread
+	Threads::Barrier startBarrier; // Barrier to start a simulation step on all worker threads
+	Threads::Barrier stageBarrier; // Barrier separating the stages of a simulation step
+	bool shutdown; // Flag to shut down the worker threads
+	Scalar stepTimeStep; // Time step of the current simulation step
+	
+	/* Private methods: */
+	void calcVertexAxes(int atomBegin,int atomEnd); // Calculates the bond vertex offsets of all atoms in the given range
+	void accumulateBondForces(int stage,int atomBegin,int atomEnd,int neighbourOffset,int axis,Scalar sign); // Accumulates the forces exerted by the bonds between the given range of atoms and their neighbours at the given offset along the given crystal axis
+	void calcAccelerations(int stage,int rowBegin,int rowEnd); // Calculates accelerations on all atoms in the given range of rows for the given integration stage
+	void synchronize(void) // Waits until all threads have finished the current stage of a simulation step
+		{
+		if(numThreads>1)
+			stageBarrier.synchronize();
+		}
+	void simulateRows(unsigned int threadIndex); // Performs the given thread's share of one Runge-Kutta-Nystrom integration step, synchronizing with all other threads between stages
+	void startThreads(void); // Starts the pool of worker threads
+	void stopThreads(void); // Shuts down the pool of worker threads
 	
 	/* Constructors and destructors: */
 	public:
 	JelloCrystal(void); // Creates invalid Jell-O crystal
 	JelloCrystal(const Index& numAtoms); // Creates a Jell-O crystal of the given size
+	private:
+	JelloCrystal(const JelloCrystal& source); // Prohibit copy constructor
+	JelloCrystal& operator=(const JelloCrystal& source); // Prohibit assignment operator
+	public:
 	~JelloCrystal(void);
 	
 	/* Methods: */
 	void setNumAtoms(const Index& newNumAtoms); // Changes the size of an existing Jell-O crystal
+	unsigned int getNumThreads(void) const // Returns the number of threads used to simulate the Jell-O crystal
+		{
+		return numThreads;
+		};
+	void setNumThreads(unsigned int newNumThreads); // Sets the number of threads used to simulate the Jell-O crystal; 0 uses one thread per CPU
 	Scalar getAtomMass(void) const // Returns the current Jell-O atom mass
 		{
 		return atomMass;
@@ -92,12 +140,17 @@ class JelloCrystal
 		};
 	const Index& getNumAtoms(void) const // Returns the size of the Jell-O crystal
 		{
-		return crystal.getSize();
+		return numAtoms;
 		};
 	const Box& getDomain(void) const // Returns the domain box of the Jell-O simulation
 		{
 		return domain;
 		};
+	Point getAtomPosition(const Index& atomIndex) const // Returns the current position of the atom of the given index
+		{
+		int atom=numAtoms.calcOffset(atomIndex);
+		return Point(positions[0][atom],positions[1][atom],positions[2][atom]);
+		};
 	void setAtomMass(Scalar newAtomMass); // Sets the atom mass
 	void setAttenuation(Scalar newAttenuation); // Sets the attenuation
 	void setGravity(Scalar newGravity); // Sets the gravity
@@ -105,12 +158,12 @@ class JelloCrystal
 	AtomID pickAtom(const Ray& r) const; // Picks a Jell-O atom based on a 3D ray
 	bool isValid(AtomID atom) const // Checks if an atom ID is valid
 		{
-		return atom!=crystal.end();
+		return atom>=0;
 		};
 	bool lockAtom(AtomID atom); // Tries locking the given atom; returns true if the atom is valid and was locked
 	ONTransform getAtomState(AtomID atom) const // Returns the position and orientation of the given atom; atom must be locked by caller (fails on invalid atom)
 		{
-		return ONTransform(atom->position-Point::origin,atom->orientation);
+		return ONTransform(Vector(positions[0][atom],positions[1][atom],positions[2][atom]),Rotation(orientations[0][atom],orientations[1][atom],orientations[2][atom],orientations[3][atom]));
 		};
 	void setAtomState(AtomID atom,const ONTransform& newAtomState); // Sets the state of an atom; atom must be locked by caller (fails on invalid atom)
 	void unlockAtom(AtomID atom); // Unlocks an atom; atom must be locked by caller (fails on invalid atom)
@@ -119,23 +172,32 @@ class JelloCrystal
 	void writeAtomStates(PipeParam& pipe) const // Writes the states of all atoms to a pipe that supports typed writes
 		{
 		/* Write the positions of all atoms: */
-		for(Crystal::const_iterator aIt=crystal.begin();aIt!=crystal.end();++aIt)
-			pipe.write(aIt->position.getComponents(),3);
+		for(int atom=0;atom<totalNumAtoms;++atom)
+			{
+			Scalar position[3];
+			for(int i=0;i<3;++i)
+				position[i]=positions[i][atom];
+			pipe.write(position,3);
+			}
 		};
 	template <class PipeParam>
 	void readAtomStates(PipeParam& pipe) // Reads the states of all atoms from a pipe that supports typed reads
 		{
 		/* Read the positions of all atoms: */
-		for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt)
-			pipe.read(aIt->position.getComponents(),3);
+		for(int atom=0;atom<totalNumAtoms;++atom)
+			{
+			Scalar position[3];
+			pipe.read(position,3);
+			for(int i=0;i<3;++i)
+				positions[i][atom]=position[i];
+			}
 		};
 	void copyAtomStates(const JelloCrystal& source) // Reads the states of all atoms from another Jell-O crystal of the same size
 		{
 		/* Copy the positions of all atoms: */
-		Crystal::const_iterator scIt;
-		Crystal::iterator dcIt;
-		for(scIt=source.crystal.begin(),dcIt=crystal.begin();scIt!=source.crystal.end();++scIt,++dcIt)
-			dcIt->position=scIt->position;
+		for(int i=0;i<3;++i)
+			for(int atom=0;atom<totalNumAtoms;++atom)
+				positions[i][atom]=source.positions[i][atom];
 		};
 	};
 
@@ -79,7 +79,7 @@ void JelloRenderer::createFacePatches(void)
 		/* Calculate the spline patch's layout: */
 		SplinePatch::Size degree(surfaceDegree,surfaceDegree);
 		int majorAxis=face>>1;
-		SplinePatch::Size numPoints(crystal->crystal.getSize((majorAxis+1)%3),crystal->crystal.getSize((majorAxis+2)%3));
+		SplinePatch::Size numPoints(crystal->getNumAtoms()[(majorAxis+1)%3],crystal->getNumAtoms()[(majorAxis+2)%3]);
 		
 		/* Calculate the spline patch's knot vectors: */
 		SplinePatch::Size numKnots(numPoints[0]+degree[0]-1,numPoints[1]+degree[1]-1);
@@ -232,7 +232,7 @@ void JelloRenderer::setActive(bool newActive)
 
 void JelloRenderer::update(void)
 	{
-	const JelloCrystal::Crystal& c=crystal->crystal;
+	const Index& numAtoms=crystal->getNumAtoms();
 	
 	/* Update the face spline patches: */
 	for(int face=0;face<6;++face)
@@ -245,7 +245,7 @@ void JelloRenderer::update(void)
 			{
 			/* Copy the atom positions in direct crystal order: */
 			Index ai;
-			ai[majorAxis]=c.getSize(majorAxis)-1;
+			ai[majorAxis]=numAtoms[majorAxis]-1;
 			SplinePatch::Index i;
 			for(i[1]=0;i[1]<sp->getNumPoints()[1];++i[1])
 				for(i[0]=0;i[0]<sp->getNumPoints()[0];++i[0])
@@ -253,7 +253,7 @@ void JelloRenderer::update(void)
 					/* Calculate the crystal index of this control point: */
 					ai[dim0]=i[0];
 					ai[dim1]=i[1];
-					sp->setPoint(i,c(ai).position);
+					sp->setPoint(i,crystal->getAtomPosition(ai));
 					}
 			}
 		else
@@ -266,9 +266,9 @@ void JelloRenderer::update(void)
 				for(i[0]=0;i[0]<sp->getNumPoints()[0];++i[0])
 					{
 					/* Calculate the crystal index of this control point: */
-					ai[dim0]=c.getSize(dim0)-1-i[0];
+					ai[dim0]=numAtoms[dim0]-1-i[0];
 					ai[dim1]=i[1];
-					sp->setPoint(i,c(ai).position);
+					sp->setPoint(i,crystal->getAtomPosition(ai));
 					}
 			}
 		
@@ -0,0 +1,228 @@
+/***********************************************************************
+MulticastBenchmark - Program to measure throughput and stall times of
+intra-cluster multicast pipes under injected packet loss, comparing
+plain retransmission against forward error correction. Runs a master
+and a single slave on the loopback interface.
+Copyright (c) 2014 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdexcept>
+#include <iostream>
+#include <Misc/Timer.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct BenchmarkSettings // Structure holding the parameters of a benchmark run
+	{
+	/* Elements: */
+	public:
+	size_t dataSize; // Number of bytes to stream from the master to the slave
+	size_t chunkSize; // Number of 32-bit words sent and received per pipe access
+	double packetLoss; // Probability with which the slave drops received stream packets
+	unsigned int fecGroupSize; // Forward error correction parity group size; 0 disables forward error correction
+	int masterPort,slavePort; // UDP port numbers for the master and the slave
+	};
+
+/****************
+Helper functions:
+****************/
+
+void runMaster(const BenchmarkSettings& bs)
+	{
+	/* Create the master side of the multiplexer: */
+	Cluster::Multiplexer multiplexer(1,0,"localhost",bs.masterPort,"127.0.0.1",bs.slavePort);
+	multiplexer.setReceiveWaitTimeout(0.01);
+	multiplexer.setBarrierWaitTimeout(0.01);
+	multiplexer.setSendBufferSize(16);
+	multiplexer.setFecGroupSize(bs.fecGroupSize);
+	multiplexer.waitForConnection();
+	
+	{
+	Cluster::MulticastPipe pipe(&multiplexer);
+	
+	/* Stream a sequence of consecutive integers to the slave: */
+	unsigned int* chunk=new unsigned int[bs.chunkSize];
+	unsigned int next=0;
+	size_t numChunks=bs.dataSize/(bs.chunkSize*sizeof(unsigned int));
+	for(size_t i=0;i<numChunks;++i)
+		{
+		for(size_t j=0;j<bs.chunkSize;++j,++next)
+			chunk[j]=next;
+		pipe.write(chunk,bs.chunkSize);
+		}
+	pipe.flush();
+	delete[] chunk;
+	
+	/* Wait for the slave to receive everything: */
+	pipe.barrier();
+	}
+	}
+
+void runSlave(const BenchmarkSettings& bs)
+	{
+	/* Create the slave side of the multiplexer: */
+	Cluster::Multiplexer multiplexer(1,1,"localhost",bs.masterPort,"127.0.0.1",bs.slavePort);
+	multiplexer.setReceiveWaitTimeout(0.01);
+	multiplexer.setBarrierWaitTimeout(0.01);
+	multiplexer.setFecGroupSize(bs.fecGroupSize);
+	multiplexer.setSimulatedPacketLoss(bs.packetLoss);
+	multiplexer.waitForConnection();
+	
+	{
+	Cluster::MulticastPipe pipe(&multiplexer);
+	
+	/* Receive and verify the stream of consecutive integers, and measure the longest wait for a chunk: */
+	unsigned int* chunk=new unsigned int[bs.chunkSize];
+	unsigned int next=0;
+	size_t numChunks=bs.dataSize/(bs.chunkSize*sizeof(unsigned int));
+	size_t numErrors=0;
+	double maxStall=0.0;
+	size_t numStalls=0;
+	Misc::Timer totalTimer;
+	Misc::Timer chunkTimer;
+	for(size_t i=0;i<numChunks;++i)
+		{
+		pipe.read(chunk,bs.chunkSize);
+		chunkTimer.elapse();
+		if(i>0)
+			{
+			if(maxStall<chunkTimer.getTime())
+				maxStall=chunkTimer.getTime();
+			if(chunkTimer.getTime()>=0.001)
+				++numStalls;
+			}
+		for(size_t j=0;j<bs.chunkSize;++j,++next)
+			if(chunk[j]!=next)
+				++numErrors;
+		}
+	totalTimer.elapse();
+	delete[] chunk;
+	
+	pipe.barrier();
+	
+	/* Print the results: */
+	double megabytes=double(numChunks*bs.chunkSize*sizeof(unsigned int))/(1024.0*1024.0);
+	std::cout<<"FEC group size "<<bs.fecGroupSize<<": ";
+	std::cout<<megabytes/totalTimer.getTime()<<" MB/s, ";
+	std::cout<<numStalls<<" stalls over 1 ms, max stall "<<maxStall*1000.0<<" ms, ";
+	std::cout<<numErrors<<" corrupted words"<<std::endl;
+	}
+	}
+
+bool runBenchmark(const BenchmarkSettings& bs)
+	{
+	/* Run the slave in a child process so that both nodes open their pipes from their main threads: */
+	pid_t childPid=fork();
+	if(childPid<0)
+		{
+		std::cerr<<"Unable to fork slave process"<<std::endl;
+		return false;
+		}
+	if(childPid==0)
+		{
+		int result=0;
+		try
+			{
+			runSlave(bs);
+			}
+		catch(std::runtime_error err)
+			{
+			std::cerr<<"Slave terminated with exception "<<err.what()<<std::endl;
+			result=1;
+			}
+		exit(result);
+		}
+	
+	bool result=true;
+	try
+		{
+		runMaster(bs);
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Master terminated with exception "<<err.what()<<std::endl;
+		result=false;
+		}
+	
+	/* Wait for the slave to finish: */
+	int status;
+	waitpid(childPid,&status,0);
+	return result&&WIFEXITED(status)&&WEXITSTATUS(status)==0;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	BenchmarkSettings bs;
+	bs.dataSize=64*1024*1024;
+	bs.chunkSize=4096;
+	bs.packetLoss=0.01;
+	bs.fecGroupSize=8;
+	bs.masterPort=26000;
+	bs.slavePort=26001;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			bs.dataSize=size_t(atof(argv[++i])*1024.0*1024.0);
+		else if(strcasecmp(argv[i],"-loss")==0&&i+1<argc)
+			bs.packetLoss=atof(argv[++i]);
+		else if(strcasecmp(argv[i],"-fec")==0&&i+1<argc)
+			bs.fecGroupSize=(unsigned int)atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-port")==0&&i+1<argc)
+			{
+			bs.masterPort=atoi(argv[++i]);
+			bs.slavePort=bs.masterPort+1;
+			}
+		else
+			{
+			std::cerr<<"Usage: "<<argv[0]<<" [-size <MB>] [-loss <probability>] [-fec <group size>] [-port <port number>]"<<std::endl;
+			return 1;
+			}
+		}
+	
+	std::cout<<"Streaming "<<double(bs.dataSize)/(1024.0*1024.0)<<" MB with "<<bs.packetLoss*100.0<<"% packet loss"<<std::endl;
+	
+	/* Run the benchmark with retransmission only: */
+	BenchmarkSettings plain=bs;
+	plain.fecGroupSize=0;
+	if(!runBenchmark(plain))
+		return 1;
+	
+	/* Run the benchmark with forward error correction on fresh ports: */
+	if(bs.fecGroupSize>0)
+		{
+		bs.masterPort+=2;
+		bs.slavePort+=2;
+		if(!runBenchmark(bs))
+			return 1;
+		}
+	
+	return 0;
+	}
@@ -156,7 +156,7 @@ void* SharedJelloServer::clientCommunicationThreadMethod(SharedJelloServer::Clie
 						SharedJelloProtocol::read(su.draggerStates[draggerIndex].transform,pipe);
 						su.draggerStates[draggerIndex].active=pipe.read<Byte>()!=0;
 						}
-
+					
 					/* Mark the client update slot as most recent: */
 					clientState->stateUpdates.postNewValue();
 					break;
@@ -216,12 +216,15 @@ void* SharedJelloServer::clientCommunicationThreadMethod(SharedJelloServer::Clie
 	return 0;
 	}
 
-SharedJelloServer::SharedJelloServer(const SharedJelloServer::Index& numAtoms,int listenPortID)
+SharedJelloServer::SharedJelloServer(const SharedJelloServer::Index& numAtoms,int listenPortID,unsigned int numThreads)
 	:newParameterVersion(1),
 	 crystal(numAtoms),
 	 parameterVersion(1),
 	 listenSocket(listenPortID,0)
 	{
+	/* Distribute the simulation across the requested number of threads: */
+	crystal.setNumThreads(numThreads);
+	
 	/* Start listening thread: */
 	listenThread.start(this,&SharedJelloServer::listenThreadMethod);
 	}
@@ -387,6 +390,7 @@ int main(int argc,char* argv[])
 	SharedJelloServer::Index numAtoms(4,4,8);
 	int listenPortID=-1; // Assign any free port
 	double updateTime=0.02; // Aim for 50 updates/sec
+	unsigned int numThreads=1; // Simulate on a single thread by default
 	for(int i=1;i<argc;++i)
 		{
 		if(argv[i][0]=='-')
@@ -412,6 +416,13 @@ int main(int argc,char* argv[])
 				if(i<argc)
 					updateTime=atof(argv[i]);
 				}
+			else if(strcasecmp(argv[i]+1,"numThreads")==0)
+				{
+				/* Read the number of simulation threads: */
+				++i;
+				if(i<argc)
+					numThreads=atoi(argv[i]);
+				}
 			}
 		}
 	
@@ -423,7 +434,7 @@ int main(int argc,char* argv[])
 	sigaction(SIGPIPE,&sigPipeAction,0);
 	
 	/* Create a shared Jell-O server: */
-	SharedJelloServer sjs(numAtoms,listenPortID);
+	SharedJelloServer sjs(numAtoms,listenPortID,numThreads);
 	std::cout<<"SharedJelloServer::main: Created Jell-O server listening on port "<<sjs.getListenPortID()<<std::endl<<std::flush;
 	
 	/* Run the simulation loop full speed: */
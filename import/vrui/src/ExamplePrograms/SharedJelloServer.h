@@ -134,7 +134,7 @@ class SharedJelloServer:private SharedJelloProtocol
 	
 	/* Constructors and destructors: */
 	public:
-	SharedJelloServer(const Index& numAtoms,int listenPortID); // Creates a shared Jell-O server with the given crystal size and listen port ID (assigns dynamic port if port ID is negative)
+	SharedJelloServer(const Index& numAtoms,int listenPortID,unsigned int numThreads =1); // Creates a shared Jell-O server with the given crystal size, listen port ID (assigns dynamic port if port ID is negative), and number of simulation threads (0 uses one thread per CPU)
 	~SharedJelloServer(void); // Destroys the shared Jell-O server
 	
 	/* Methods: */
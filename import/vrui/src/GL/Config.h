@@ -24,5 +24,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #define GLSUPPORT_CONFIG_USE_TLS 0
 #define GLSUPPORT_CONFIG_HAVE_BUILTIN_TLS 1
+#define GLSUPPORT_CONFIG_CHECK_DATAITEM_TYPES 0
 
 #endif
@@ -38,23 +38,69 @@ Methods of class GLContextData:
 ******************************/
 
 GLContextData::GLContextData(int sTableSize,float sWaterMark,float sGrowRate)
-	:context(sTableSize,sWaterMark,sGrowRate),
-	 lightTracker(new GLLightTracker),
+	:lightTracker(new GLLightTracker),
 	 clipPlaneTracker(new GLClipPlaneTracker)
 	{
+	/* Prepare the data item array: */
+	context.reserve(sTableSize);
 	}
 
 GLContextData::~GLContextData(void)
 	{
 	/* Delete all data items in this context: */
-	for(ItemHash::Iterator it=context.begin();!it.isFinished();++it)
-		delete it->getDest();
+	for(ItemArray::iterator cIt=context.begin();cIt!=context.end();++cIt)
+		delete *cIt;
 	
 	/* Delete the state trackers: */
 	delete lightTracker;
 	delete clipPlaneTracker;
 	}
 
+unsigned int GLContextData::allocateSlot(void)
+	{
+	return GLThingManager::theThingManager.allocateSlot();
+	}
+
+void GLContextData::cancelPreparation(const GLObject* thing)
+	{
+	GLThingManager::theThingManager.cancelPreparation(thing);
+	}
+
+void GLContextData::deferThing(const GLObject* thing,unsigned int slot,double cost,bool prepare,const std::vector<unsigned int>& dependencySlots)
+	{
+	/* Ignore the thing if it is already queued: */
+	for(std::vector<DeferredThing>::iterator dtIt=deferredThings.begin();dtIt!=deferredThings.end();++dtIt)
+		if(dtIt->slot==slot)
+			return;
+	
+	/* Append the thing to the queue: */
+	DeferredThing dt;
+	dt.thing=thing;
+	dt.slot=slot;
+	dt.cost=cost;
+	dt.prepare=prepare;
+	dt.dependencySlots=dependencySlots;
+	deferredThings.push_back(dt);
+	}
+
+void GLContextData::cancelDeferredThing(unsigned int slot)
+	{
+	for(std::vector<DeferredThing>::iterator dtIt=deferredThings.begin();dtIt!=deferredThings.end();++dtIt)
+		if(dtIt->slot==slot)
+			{
+			deferredThings.erase(dtIt);
+			break;
+			}
+	}
+
+bool GLContextData::isThingDeferred(unsigned int slot) const
+	{
+	for(std::vector<DeferredThing>::const_iterator dtIt=deferredThings.begin();dtIt!=deferredThings.end();++dtIt)
+		if(dtIt->slot==slot)
+			return true;
+	return false;
+	}
+
 void GLContextData::initThing(const GLObject* thing)
 	{
 	GLThingManager::theThingManager.initThing(thing);
@@ -80,6 +126,16 @@ void GLContextData::shutdownThingManager(void)
 	GLThingManager::theThingManager.shutdown();
 	}
 
+void GLContextData::setInitTimeBudget(double newInitTimeBudget)
+	{
+	GLThingManager::theThingManager.initTimeBudget=newInitTimeBudget;
+	}
+
+double GLContextData::getInitTimeBudget(void)
+	{
+	return GLThingManager::theThingManager.initTimeBudget;
+	}
+
 void GLContextData::updateThings(void)
 	{
 	GLThingManager::theThingManager.updateThings(*this);
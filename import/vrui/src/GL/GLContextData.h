@@ -23,18 +23,23 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLCONTEXTDATA_INCLUDED
 #define GLCONTEXTDATA_INCLUDED
 
-#include <Misc/HashTable.h>
+#include <vector>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
+#include <GL/Config.h>
 #include <GL/TLSHelper.h>
 #include <GL/GLObject.h>
 
 /* Forward declarations: */
 class GLLightTracker;
 class GLClipPlaneTracker;
+class GLThingManager;
 
 class GLContextData
 	{
+	friend class GLObject;
+	friend class GLThingManager;
+	
 	/* Embedded classes: */
 	public:
 	struct CurrentContextDataChangedCallbackData:public Misc::CallbackData
@@ -52,18 +57,46 @@ class GLContextData
 		};
 	
 	private:
-	typedef Misc::HashTable<const GLObject*,GLObject::DataItem*> ItemHash; // Class for hash table mapping pointers to data items
+	typedef std::vector<GLObject::DataItem*> ItemArray; // Class for dense arrays mapping GLObject context data slots to data items
+	
+	struct DeferredThing // Structure for things whose context initialization is pending in this context
+		{
+		/* Elements: */
+		public:
+		const GLObject* thing; // The thing
+		unsigned int slot; // The thing's context data slot
+		double cost; // Estimated context initialization time of the thing in seconds
+		bool prepare; // Flag whether the thing's preparation must be finished before its context initialization
+		std::vector<unsigned int> dependencySlots; // Context data slots of things that must be initialized before this thing
+		};
 	
 	/* Elements: */
 	static Misc::CallbackList currentContextDataChangedCallbacks; // List of callbacks called whenever the current context data object changes
 	static GL_THREAD_LOCAL(GLContextData*) currentContextData; // Pointer to the current context data object (associated with the current OpenGL context)
-	ItemHash context; // A hash table for the context
+	ItemArray context; // Array of data items for the context, indexed by GLObject context data slot; unused slots are null
+	std::vector<DeferredThing> deferredThings; // Queue of things whose context initialization is pending, in initialization order
 	GLLightTracker* lightTracker; // An object to track the OpenGL context's lighting state
 	GLClipPlaneTracker* clipPlaneTracker; // An object to track the OpenGL context's clipping plane state
 	
+	/* Private methods: */
+	static unsigned int allocateSlot(void); // Returns a context data slot for a newly created GLObject
+	static void cancelPreparation(const GLObject* thing); // Removes the given thing from the preparation queue, or waits for its preparation to finish
+	void deferThing(const GLObject* thing,unsigned int slot,double cost,bool prepare,const std::vector<unsigned int>& dependencySlots); // Adds a thing to the incremental initialization queue
+	void cancelDeferredThing(unsigned int slot); // Removes the thing in the given context data slot from the incremental initialization queue
+	bool isThingDeferred(unsigned int slot) const; // Returns true if the thing in the given context data slot is in the incremental initialization queue
+	void removeDataItem(unsigned int slot) // Deletes the data item in the given context data slot
+		{
+		if(slot<context.size())
+			{
+			/* Delete the data item (hopefully freeing all resources): */
+			delete context[slot];
+			context[slot]=0;
+			}
+		}
+	
 	/* Constructors and destructors: */
 	public:
-	GLContextData(int sTableSize,float sWaterMark =0.9f,float sGrowRate =1.7312543); // Constructs an empty context
+	GLContextData(int sTableSize,float sWaterMark =0.9f,float sGrowRate =1.7312543); // Constructs an empty context with room for the given number of data items; water mark and grow rate are ignored
 	~GLContextData(void);
 	
 	/* Methods to manage object initializations and clean-ups: */
@@ -72,7 +105,13 @@ class GLContextData
 	static void orderThings(const GLObject* thing1,const GLObject* thing2); // Asks thing manager to always initialize thing1 before thing2
 	static void resetThingManager(void); // Resets the thing manager
 	static void shutdownThingManager(void); // Shuts down the thing manager
+	static void setInitTimeBudget(double newInitTimeBudget); // Sets the maximum time to spend on initializing things with non-zero context initialization cost per context and call to updateThings in seconds; 0 disables the limit
+	static double getInitTimeBudget(void); // Returns the current per-context initialization time budget
 	void updateThings(void); // Initializes or deletes all marked things
+	bool hasPendingThings(void) const // Returns true if there are things whose context initialization was deferred to later calls to updateThings
+		{
+		return !deferredThings.empty();
+		}
 	
 	/* Methods to manage the current context: */
 	static Misc::CallbackList& getCurrentContextDataChangedCallbacks(void) // Returns the list of callbacks called whenever the current context data object changes
@@ -88,37 +127,36 @@ class GLContextData
 	/* Methods to store/retrieve context data items: */
 	bool isRealized(const GLObject* thing) const
 		{
-		return context.isEntry(thing);
+		unsigned int slot=thing->getContextDataSlot();
+		return slot<context.size()&&context[slot]!=0;
 		}
 	void addDataItem(const GLObject* thing,GLObject::DataItem* dataItem)
 		{
-		context.setEntry(ItemHash::Entry(thing,dataItem));
+		/* Grow the data item array to hold the thing's slot: */
+		unsigned int slot=thing->getContextDataSlot();
+		if(slot>=context.size())
+			context.resize(slot+1,0);
+		
+		context[slot]=dataItem;
 		}
 	template <class DataItemParam>
 	DataItemParam* retrieveDataItem(const GLObject* thing)
 		{
 		/* Find the data item associated with the given thing: */
-		ItemHash::Iterator dataIt=context.findEntry(thing);
-		if(dataIt.isFinished())
+		unsigned int slot=thing->getContextDataSlot();
+		if(slot>=context.size())
 			return 0;
-		else
-			{
-			/* Cast the data item's pointer to the requested type and return it: */
-			return dynamic_cast<DataItemParam*>(dataIt->getDest());
-			}
+		
+		/* Cast the data item's pointer to the requested type and return it: */
+		#if GLSUPPORT_CONFIG_CHECK_DATAITEM_TYPES
+		return dynamic_cast<DataItemParam*>(context[slot]);
+		#else
+		return static_cast<DataItemParam*>(context[slot]);
+		#endif
 		}
 	void removeDataItem(const GLObject* thing)
 		{
-		/* Find the data item associated with the given thing: */
-		ItemHash::Iterator dataIt=context.findEntry(thing);
-		if(!dataIt.isFinished())
-			{
-			/* Delete the data item (hopefully freeing all resources): */
-			delete dataIt->getDest();
-			
-			/* Remove the data item from the hash table: */
-			context.removeEntry(dataIt);
-			}
+		removeDataItem(thing->getContextDataSlot());
 		}
 	
 	/* Methods to retrieve other context-related state: */
@@ -40,7 +40,14 @@ void GLObject::init(void)
 	GLContextData::initThing(this);
 	}
 
+void GLObject::cancelPreparation(void) const
+	{
+	/* Ask the thing manager to stop preparing this object: */
+	GLContextData::cancelPreparation(this);
+	}
+
 GLObject::GLObject(bool autoInit)
+	:contextDataSlot(GLContextData::allocateSlot())
 	{
 	if(autoInit)
 		{
@@ -49,8 +56,16 @@ GLObject::GLObject(bool autoInit)
 		}
 	}
 
+GLObject::GLObject(const GLObject& source)
+	:contextDataSlot(GLContextData::allocateSlot())
+	{
+	}
+
 GLObject::~GLObject(void)
 	{
+	/* Make sure the object is not being prepared anymore: */
+	GLContextData::cancelPreparation(this);
+	
 	/* Mark the object's context data item for destruction: */
 	GLContextData::destroyThing(this);
 	}
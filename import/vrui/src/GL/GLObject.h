@@ -39,17 +39,42 @@ class GLObject
 			}
 		};
 	
+	/* Elements: */
+	private:
+	unsigned int contextDataSlot; // Index of this object's data items in the per-context data item arrays
+	
 	/* Protected methods: */
 	protected:
 	void dependsOn(const GLObject* thing) const; // Method declaring that this GLObject depends on another GLObject being initialized before it in every context
 	void init(void); // Marks the object for context initialization if not done automatically in the GLObject constructor
+	void cancelPreparation(void) const; // Removes the object from the context preparation queue, or waits until a running prepareContext call finishes; must be called first thing in the destructor of classes implementing prepareContext
 	
 	/* Constructors and destructors: */
 	public:
 	GLObject(bool autoInit =true); // Marks the object for context initialization if the given flag is true; otherwise, init() method must be called at some later point
+	GLObject(const GLObject& source); // Copy constructor; copy receives its own context data slot and is not marked for context initialization
+	GLObject& operator=(const GLObject& source) // Assignment operator; does not change the object's context data slot
+		{
+		return *this;
+		}
 	virtual ~GLObject(void); // Destroys the object and its associated context data item
 	
 	/* Methods: */
+	unsigned int getContextDataSlot(void) const // Returns the index of this object's data items in the per-context data item arrays
+		{
+		return contextDataSlot;
+		}
+	virtual double getContextInitCost(void) const // Returns an estimate of the time initContext takes in seconds; objects with non-zero cost are initialized incrementally within a per-frame time budget, and must render without a data item until then
+		{
+		return 0.0;
+		}
+	virtual bool hasContextPreparation(void) const // Returns true if prepareContext must be called before initContext is called in any OpenGL context
+		{
+		return false;
+		}
+	virtual void prepareContext(void) const // Performs context-independent preparations for initContext, such as reading or converting data; called once from a background thread
+		{
+		}
 	virtual void initContext(GLContextData& contextData) const =0; // Method called before a GL object is rendered for the first time in the given OpenGL context
 	};
 
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GL/Internal/GLThingManager.h>
 
+#include <Misc/Timer.h>
 #include <GL/GLObject.h>
 #include <GL/GLContextData.h>
 
@@ -38,12 +39,19 @@ Methods of class GLThingManager:
 GLThingManager::GLThingManager(void)
 	:active(true),
 	 firstNewAction(0),lastNewAction(0),
-	 firstProcessAction(0)
+	 firstProcessAction(0),
+	 numSlots(0),
+	 initTimeBudget(0.0),
+	 stopPreparationThread(false),
+	 preparationThread(0)
 	{
 	}
 
 GLThingManager::~GLThingManager(void)
 	{
+	/* Stop preparing things: */
+	stopPreparation();
+	
 	/* Delete all actions: */
 	while(firstProcessAction!=0)
 		{
@@ -65,6 +73,9 @@ GLThingManager::~GLThingManager(void)
 
 void GLThingManager::shutdown(void)
 	{
+	/* Stop preparing things: */
+	stopPreparation();
+	
 	/* Delete all pending actions: */
 	while(firstProcessAction!=0)
 		{
@@ -86,6 +97,85 @@ void GLThingManager::shutdown(void)
 	}
 	}
 
+void* GLThingManager::preparationThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next preparation request: */
+		PreparationRequest request;
+		{
+		Threads::MutexCond::Lock preparationLock(preparationCond);
+		while(!stopPreparationThread&&preparationQueue.empty())
+			preparationCond.wait(preparationLock);
+		if(stopPreparationThread)
+			break;
+		request=preparationQueue.front();
+		preparationQueue.pop_front();
+		preparationStates[request.slot]=PREPARING;
+		}
+		
+		/* Prepare the thing: */
+		try
+			{
+			request.thing->prepareContext();
+			}
+		catch(...)
+			{
+			/* Ignore the error; the thing will have to deal with incomplete preparation in initContext */
+			}
+		
+		/* Mark the thing as prepared and wake up anybody waiting for it: */
+		{
+		Threads::MutexCond::Lock preparationLock(preparationCond);
+		preparationStates[request.slot]=PREPARED;
+		preparationCond.broadcast();
+		}
+		}
+	
+	return 0;
+	}
+
+void GLThingManager::stopPreparation(void)
+	{
+	/* Tell the preparation thread to shut down and discard all pending requests: */
+	{
+	Threads::MutexCond::Lock preparationLock(preparationCond);
+	stopPreparationThread=true;
+	preparationQueue.clear();
+	preparationCond.broadcast();
+	}
+	
+	/* Wait for the preparation thread to finish its current request: */
+	if(preparationThread!=0)
+		{
+		preparationThread->join();
+		delete preparationThread;
+		preparationThread=0;
+		}
+	}
+
+bool GLThingManager::isPrepared(unsigned int slot) const
+	{
+	Threads::MutexCond::Lock preparationLock(preparationCond);
+	return slot>=preparationStates.size()||preparationStates[slot]==PREPARED;
+	}
+
+unsigned int GLThingManager::allocateSlot(void)
+	{
+	Threads::Mutex::Lock slotLock(slotMutex);
+	
+	/* Reuse a released slot if there is one: */
+	if(!freeSlots.empty())
+		{
+		unsigned int result=freeSlots.back();
+		freeSlots.pop_back();
+		return result;
+		}
+	
+	/* Hand out a new slot: */
+	return numSlots++;
+	}
+
 void GLThingManager::initThing(const GLObject* thing)
 	{
 	{
@@ -95,7 +185,10 @@ void GLThingManager::initThing(const GLObject* thing)
 		/* Append the new thing action to the new action list: */
 		ThingAction* newAction=new ThingAction;
 		newAction->thing=thing;
+		newAction->slot=thing->getContextDataSlot();
 		newAction->action=ThingAction::INIT;
+		newAction->cost=0.0;
+		newAction->prepare=false;
 		newAction->succ=0;
 		if(lastNewAction!=0)
 			lastNewAction->succ=newAction;
@@ -129,19 +222,48 @@ void GLThingManager::destroyThing(const GLObject* thing)
 				lastNewAction=taPtr1;
 			delete taPtr2;
 			}
+		
+		/*******************************************************************
+		Always append a destruction action to the list, even if the thing
+		was never initialized, so that the thing's context data slot is
+		only released once all contexts are guaranteed to have let go of it:
+		*******************************************************************/
+		
+		ThingAction* newAction=new ThingAction;
+		newAction->thing=thing;
+		newAction->slot=thing->getContextDataSlot();
+		newAction->action=ThingAction::DESTROY;
+		newAction->cost=0.0;
+		newAction->prepare=false;
+		newAction->succ=0;
+		if(lastNewAction!=0)
+			lastNewAction->succ=newAction;
 		else
+			firstNewAction=newAction;
+		lastNewAction=newAction;
+		}
+	}
+
+void GLThingManager::cancelPreparation(const GLObject* thing)
+	{
+	Threads::MutexCond::Lock preparationLock(preparationCond);
+	unsigned int slot=thing->getContextDataSlot();
+	if(slot<preparationStates.size()&&preparationStates[slot]!=PREPARED)
+		{
+		/* Remove the thing's pending preparation requests: */
+		std::deque<PreparationRequest>::iterator prIt=preparationQueue.begin();
+		while(prIt!=preparationQueue.end())
 			{
-			/* Append a destruction action to the list: */
-			ThingAction* newAction=new ThingAction;
-			newAction->thing=thing;
-			newAction->action=ThingAction::DESTROY;
-			newAction->succ=0;
-			if(lastNewAction!=0)
-				lastNewAction->succ=newAction;
+			if(prIt->slot==slot)
+				prIt=preparationQueue.erase(prIt);
 			else
-				firstNewAction=newAction;
-			lastNewAction=newAction;
+				++prIt;
 			}
+		
+		/* Wait until a running preparation finishes: */
+		while(preparationStates[slot]==PREPARING)
+			preparationCond.wait(preparationLock);
+		preparationStates[slot]=PREPARED;
 		}
 	}
 
@@ -166,6 +288,11 @@ void GLThingManager::orderThings(const GLObject* thing1,const GLObject* thing2)
 				thing2Ptr=ta2Ptr;
 				}
 		
+		/* Remember the dependency in thing2's initialization action, so that thing2 is deferred along with thing1: */
+		for(ThingAction* taPtr=firstNewAction;taPtr!=0;taPtr=taPtr->succ)
+			if(taPtr->thing==thing2&&taPtr->action==ThingAction::INIT)
+				taPtr->dependencySlots.push_back(thing1->getContextDataSlot());
+		
 		/* Check if the things are out of order: */
 		if(thing2Ptr!=0&&ta2Ptr!=0)
 			{
@@ -185,13 +312,18 @@ void GLThingManager::orderThings(const GLObject* thing1,const GLObject* thing2)
 
 void GLThingManager::processActions(void)
 	{
-	/* Delete the old process list: */
+	/* Delete the old process list and release the slots of all destroyed things, which have now been removed from all contexts: */
+	{
+	Threads::Mutex::Lock slotLock(slotMutex);
 	while(firstProcessAction!=0)
 		{
+		if(firstProcessAction->action==ThingAction::DESTROY)
+			freeSlots.push_back(firstProcessAction->slot);
 		ThingAction* succ=firstProcessAction->succ;
 		delete firstProcessAction;
 		firstProcessAction=succ;
 		}
+	}
 	
 	/* Move the new action list to the process list: */
 	{
@@ -200,6 +332,37 @@ void GLThingManager::processActions(void)
 	firstNewAction=0;
 	lastNewAction=0;
 	}
+	
+	/* Query the context initialization costs of all new things, and queue those needing preparation: */
+	for(ThingAction* taPtr=firstProcessAction;taPtr!=0;taPtr=taPtr->succ)
+		if(taPtr->action==ThingAction::INIT)
+			{
+			taPtr->cost=taPtr->thing->getContextInitCost();
+			taPtr->prepare=taPtr->thing->hasContextPreparation();
+			if(taPtr->prepare)
+				{
+				Threads::MutexCond::Lock preparationLock(preparationCond);
+				if(!stopPreparationThread)
+					{
+					/* Queue a preparation request: */
+					if(taPtr->slot>=preparationStates.size())
+						preparationStates.resize(taPtr->slot+1,PREPARED);
+					preparationStates[taPtr->slot]=PREPARATION_PENDING;
+					PreparationRequest request;
+					request.thing=taPtr->thing;
+					request.slot=taPtr->slot;
+					preparationQueue.push_back(request);
+					
+					/* Start the preparation thread on first use: */
+					if(preparationThread==0)
+						{
+						preparationThread=new Threads::Thread;
+						preparationThread->start(this,&GLThingManager::preparationThreadMethod);
+						}
+					preparationCond.broadcast();
+					}
+				}
+			}
 	}
 
 void GLThingManager::updateThings(GLContextData& contextData) const
@@ -209,13 +372,62 @@ void GLThingManager::updateThings(GLContextData& contextData) const
 		{
 		if(taPtr->action==ThingAction::INIT)
 			{
-			/* Call the thing's context initialization routine: */
-			taPtr->thing->initContext(contextData);
+			/* Check if any of the things this thing depends on are still waiting for initialization: */
+			bool dependencyDeferred=false;
+			for(std::vector<unsigned int>::const_iterator dIt=taPtr->dependencySlots.begin();dIt!=taPtr->dependencySlots.end()&&!dependencyDeferred;++dIt)
+				dependencyDeferred=contextData.isThingDeferred(*dIt);
+			
+			if(taPtr->cost>0.0||taPtr->prepare||dependencyDeferred)
+				{
+				/* Defer the thing's context initialization to the incremental initialization queue: */
+				contextData.deferThing(taPtr->thing,taPtr->slot,taPtr->cost,taPtr->prepare,taPtr->dependencySlots);
+				}
+			else
+				{
+				/* Call the thing's context initialization routine: */
+				taPtr->thing->initContext(contextData);
+				}
 			}
 		else
 			{
-			/* Delete the context data item associated with the thing: */
-			contextData.removeDataItem(taPtr->thing);
+			/* Delete the context data item associated with the thing and remove it from the incremental initialization queue: */
+			contextData.cancelDeferredThing(taPtr->slot);
+			contextData.removeDataItem(taPtr->slot);
+			}
+		}
+	
+	if(!contextData.deferredThings.empty())
+		{
+		/*******************************************************************
+		Initialize deferred things in queue order until the time budget is
+		used up. Things still waiting for preparation are skipped along with
+		all things depending on them, and at least one thing is initialized
+		per call to guarantee progress:
+		*******************************************************************/
+		
+		Misc::Timer timer;
+		double initTime=0.0;
+		bool budgetExhausted=false;
+		std::vector<GLContextData::DeferredThing> remainingThings;
+		for(std::vector<GLContextData::DeferredThing>::iterator dtIt=contextData.deferredThings.begin();dtIt!=contextData.deferredThings.end();++dtIt)
+			{
+			if(!budgetExhausted&&initTimeBudget>0.0&&initTime>0.0&&initTime+dtIt->cost>initTimeBudget)
+				budgetExhausted=true;
+			
+			/* Check if any of the things this thing depends on were skipped: */
+			bool dependencySkipped=false;
+			for(std::vector<unsigned int>::const_iterator dIt=dtIt->dependencySlots.begin();dIt!=dtIt->dependencySlots.end()&&!dependencySkipped;++dIt)
+				for(std::vector<GLContextData::DeferredThing>::const_iterator rtIt=remainingThings.begin();rtIt!=remainingThings.end()&&!dependencySkipped;++rtIt)
+					dependencySkipped=rtIt->slot==*dIt;
+			
+			if(!budgetExhausted&&!dependencySkipped&&(!dtIt->prepare||isPrepared(dtIt->slot)))
+				{
+				dtIt->thing->initContext(contextData);
+				initTime=timer.peekTime();
+				}
+			else
+				remainingThings.push_back(*dtIt);
 			}
+		contextData.deferredThings.swap(remainingThings);
 		}
 	}
@@ -23,7 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLTHINGMANAGER_INCLUDED
 #define GLTHINGMANAGER_INCLUDED
 
+#include <vector>
+#include <deque>
 #include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
 
 /* Forward declarations: */
 class GLObject;
@@ -46,10 +50,27 @@ class GLThingManager
 		
 		/* Elements: */
 		const GLObject* thing; // Thing this action relates to
+		unsigned int slot; // Context data slot of the thing, which remains valid after the thing itself was destroyed
 		Action action; // The action
+		double cost; // Estimated context initialization time of the thing in seconds, queried when the action is processed
+		bool prepare; // Flag whether the thing must be prepared before its context initialization
+		std::vector<unsigned int> dependencySlots; // Context data slots of things that must be initialized before this thing
 		ThingAction* succ; // Pointer to the next action in the chain
 		};
 	
+	enum PreparationState // Enumerated type for preparation states of context data slots
+		{
+		PREPARED=0,PREPARATION_PENDING,PREPARING
+		};
+	
+	struct PreparationRequest // Structure for queued thing preparations
+		{
+		/* Elements: */
+		public:
+		const GLObject* thing; // Thing to prepare
+		unsigned int slot; // Context data slot of the thing
+		};
+	
 	/* Elements: */
 	private:
 	static GLThingManager theThingManager; // Static thing manager
@@ -58,6 +79,20 @@ class GLThingManager
 	ThingAction* firstNewAction; // List of actions added to by users
 	ThingAction* lastNewAction; // Pointer to last element in new action list
 	ThingAction* firstProcessAction; // List of actions initialized in the current render cycle
+	Threads::Mutex slotMutex; // Mutex protecting the context data slot allocator
+	unsigned int numSlots; // Number of context data slots handed out so far
+	std::vector<unsigned int> freeSlots; // Stack of context data slots released by destroyed things
+	double initTimeBudget; // Maximum time to spend on incremental context initialization per context and render cycle in seconds; 0 disables the limit
+	mutable Threads::MutexCond preparationCond; // Condition variable protecting the preparation queue and states, signaled when preparation requests are queued or finished
+	std::deque<PreparationRequest> preparationQueue; // Queue of things waiting for preparation
+	std::vector<unsigned char> preparationStates; // Preparation states of things, indexed by context data slot
+	bool stopPreparationThread; // Flag to shut down the preparation thread
+	Threads::Thread* preparationThread; // Background thread calling things' prepareContext methods; created on first use, as the thing manager is a static object
+	
+	/* Private methods: */
+	void* preparationThreadMethod(void); // Thread method preparing queued things
+	void stopPreparation(void); // Stops the preparation thread and discards all queued preparation requests
+	bool isPrepared(unsigned int slot) const; // Returns true if the thing in the given context data slot is ready for context initialization
 	
 	/* Constructors and destructors: */
 	public:
@@ -66,8 +101,10 @@ class GLThingManager
 	
 	/* Methods: */
 	void shutdown(void); // Shuts down the thing manager
+	unsigned int allocateSlot(void); // Returns a context data slot for a newly created thing
 	void initThing(const GLObject* thing); // Marks the given thing for initialization
 	void destroyThing(const GLObject* thing); // Marks the given thing for destruction
+	void cancelPreparation(const GLObject* thing); // Removes the given thing from the preparation queue, or waits until it is prepared if its preparation is already running
 	void orderThings(const GLObject* thing1,const GLObject* thing2); // Orders process list such that thing1 is initialized before thing2; assumes both things exist and have not been initialized yet
 	void processActions(void); // Moves all new actions to the process list
 	void updateThings(GLContextData& contextData) const; // Performs all actions for the current render cycle
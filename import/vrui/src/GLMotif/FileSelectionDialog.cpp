@@ -1,6 +1,6 @@
 /***********************************************************************
 FileSelectionDialog - A popup window to select a file name.
-Copyright (c) 2008-2012 Oliver Kreylos
+Copyright (c) 2008-2014 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
 
@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
 #include <iostream>
+#include <stdexcept>
 #include <ctype.h>
 #include <string.h>
 #include <stdio.h>
@@ -30,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/FileNameExtensions.h>
 #include <Misc/GetCurrentDirectory.h>
 #include <Misc/FileTests.h>
+#include <Misc/TimerEventScheduler.h>
 #include <IO/Directory.h>
 #include <IO/SeekableFilter.h>
 #include <IO/ZipArchive.h>
@@ -54,26 +56,25 @@ class StringCompare // Class to compare strings according to case-insensitive le
 	{
 	/* Methods: */
 	public:
-	bool operator()(const std::string& s1,const std::string& s2) const
+	bool operator()(const char* s1,const char* s2) const
 		{
 		/* Find the first different character in the common prefix of both strings: */
 		int cmp=0;
 		int caseCmp=0;
-		std::string::const_iterator s1It,s2It;
-		for(s1It=s1.begin(),s2It=s2.begin();s1It!=s1.end()&&s2It!=s2.end()&&cmp==0;++s1It,++s2It)
+		for(;*s1!='\0'&&*s2!='\0'&&cmp==0;++s1,++s2)
 			{
-			cmp=toupper(*s1It)-toupper(*s2It);
+			cmp=toupper(*s1)-toupper(*s2);
 			if(caseCmp==0)
-				caseCmp=*s1It-*s2It;
+				caseCmp=*s1-*s2;
 			}
 		
 		/* Check if the common prefix is identical: */
 		if(cmp==0)
 			{
 			/* Check if the first string is shorter: */
-			if(s2It!=s2.end())
+			if(*s2!='\0')
 				cmp=-1;
-			else if(s1It!=s1.end())
+			else if(*s1!='\0')
 				cmp=1;
 			}
 		
@@ -83,86 +84,307 @@ class StringCompare // Class to compare strings according to case-insensitive le
 		
 		return cmp<0;
 		}
+	bool operator()(const std::string& s1,const std::string& s2) const
+		{
+		return operator()(s1.c_str(),s2.c_str());
+		}
 	};
 
 }
 
-/************************************
-Methods of class FileSelectionDialog:
-************************************/
+/******************************************************
+Methods of class FileSelectionDialog::DirectoryListing:
+******************************************************/
 
-void FileSelectionDialog::readDirectory(void)
+FileSelectionDialog::DirectoryListing::DirectoryListing(const std::string& sKey,IO::DirectoryPtr sDirectory,double sCreationTime)
+	:key(sKey),directory(sDirectory),creationTime(sCreationTime),
+	 finished(false),numConsumed(0)
 	{
-	/* Read all directory entries: */
-	std::vector<std::string> directories;
-	std::vector<std::string> files;
-	currentDirectory->rewind();
-	while(currentDirectory->readNextEntry())
+	/* Start the listing thread: */
+	listingThread.start(this,&FileSelectionDialog::DirectoryListing::listingThreadMethod);
+	}
+
+FileSelectionDialog::DirectoryListing::~DirectoryListing(void)
+	{
+	/* Join the listing thread, which has already read the entire directory: */
+	listingThread.join();
+	}
+
+void* FileSelectionDialog::DirectoryListing::listingThreadMethod(void)
+	{
+	try
 		{
-		/* Check for hidden entries: */
-		const char* entryName=currentDirectory->getEntryName();
-		if(entryName[0]!='.')
+		/* Read all directory entries: */
+		directory->rewind();
+		while(directory->readNextEntry())
 			{
+			/* Check for hidden entries: */
+			const char* entryName=directory->getEntryName();
+			if(entryName[0]=='.')
+				continue;
+			
 			/* Determine the type of the directory entry: */
-			Misc::PathType pt=currentDirectory->getEntryType();
-			if(pt==Misc::PATHTYPE_DIRECTORY)
+			ListingEntry entry;
+			Misc::PathType pt=directory->getEntryType();
+			if(pt==Misc::PATHTYPE_DIRECTORY||(pt==Misc::PATHTYPE_FILE&&Misc::hasCaseExtension(entryName,".zip")))
 				{
-				/* Store a directory name: */
-				std::string dirName(entryName);
-				dirName.push_back('/');
-				directories.push_back(dirName);
+				/* Store a directory name; zip archives are shown as directories: */
+				entry.name=entryName;
+				entry.name.push_back('/');
+				entry.isDirectory=true;
 				}
 			else if(pt==Misc::PATHTYPE_FILE)
 				{
-				/* Check for zip archives: */
-				if(Misc::hasCaseExtension(entryName,".zip"))
-					{
-					/* Add the zip archive as a directory: */
-					std::string dirName(entryName);
-					dirName.push_back('/');
-					directories.push_back(dirName);
-					}
-				else
-					{
-					/* Check if the file name matches any of the supplied extensions: */
-					bool passesFilters=true;
-					if(fileNameFilters!=0)
-						{
-						/* Find the file name's extension: */
-						const char* extPtr="";
-						for(const char* enPtr=entryName;*enPtr!='\0';++enPtr)
-							if(*enPtr=='.')
-								extPtr=enPtr;
-						
-						/* Match against the list of allowed extensions: */
-						passesFilters=false;
-						const char* filterPtr=fileNameFilters;
-						while(*filterPtr!='\0'&&!passesFilters)
-							{
-							/* Extract the next extension: */
-							const char* extStart=filterPtr;
-							for(;*filterPtr!='\0'&&*filterPtr!=';';++filterPtr)
-								;
-							
-							/* See if it matches: */
-							passesFilters=int(strlen(extPtr))==filterPtr-extStart&&memcmp(extPtr,extStart,filterPtr-extStart)==0;
-							
-							/* Skip the separator: */
-							if(*filterPtr==';')
-								++filterPtr;
-							}
-						}
-					
-					if(passesFilters)
-						{
-						/* Store a file name: */
-						files.push_back(entryName);
-						}
-					}
+				/* Store a file name: */
+				entry.name=entryName;
+				entry.isDirectory=false;
+				}
+			else
+				continue;
+			
+			/* Append the entry to the listing and wake up a waiting main thread: */
+			Threads::Mutex::Lock entriesLock(entriesMutex);
+			entries.push_back(entry);
+			entriesCond.signal();
+			}
+		}
+	catch(std::runtime_error)
+		{
+		/* Treat the directory as ending at the error: */
+		}
+	
+	/* Mark the listing as finished: */
+	{
+	Threads::Mutex::Lock entriesLock(entriesMutex);
+	finished=true;
+	entriesCond.signal();
+	}
+	
+	return 0;
+	}
+
+bool FileSelectionDialog::DirectoryListing::isFinished(void)
+	{
+	Threads::Mutex::Lock entriesLock(entriesMutex);
+	return finished;
+	}
+
+/************************************
+Methods of class FileSelectionDialog:
+************************************/
+
+void FileSelectionDialog::reapListingsCallback(Misc::CallbackData* cbData,void* userData)
+	{
+	Misc::TimerEventScheduler::CallbackData* myCbData=static_cast<Misc::TimerEventScheduler::CallbackData*>(cbData);
+	ListingReaper* reaper=static_cast<ListingReaper*>(userData);
+	
+	/* Delete all abandoned listings whose listing threads have finished: */
+	for(std::vector<DirectoryListing*>::iterator lIt=reaper->listings.begin();lIt!=reaper->listings.end();)
+		{
+		if((*lIt)->isFinished())
+			{
+			delete *lIt;
+			lIt=reaper->listings.erase(lIt);
+			}
+		else
+			++lIt;
+		}
+	
+	/* Check the remaining listings again later: */
+	if(reaper->listings.empty())
+		delete reaper;
+	else
+		reaper->timerEventScheduler->scheduleEvent(myCbData->time+0.5,&FileSelectionDialog::reapListingsCallback,reaper);
+	}
+
+void FileSelectionDialog::abandonListings(const std::vector<FileSelectionDialog::DirectoryListing*>& listings)
+	{
+	/* Delete finished listings right away, and collect the others: */
+	Misc::TimerEventScheduler* tes=getManager()->getTimerEventScheduler();
+	ListingReaper* reaper=0;
+	for(std::vector<DirectoryListing*>::const_iterator lIt=listings.begin();lIt!=listings.end();++lIt)
+		{
+		/* Without a timer event scheduler, all listings were read completely by readDirectory: */
+		if(tes==0||(*lIt)->isFinished())
+			delete *lIt;
+		else
+			{
+			if(reaper==0)
+				{
+				reaper=new ListingReaper;
+				reaper->timerEventScheduler=tes;
 				}
+			reaper->listings.push_back(*lIt);
 			}
 		}
 	
+	/* Poll the unfinished listings from the timer event scheduler instead of joining their listing threads: */
+	if(reaper!=0)
+		tes->scheduleEvent(tes->getCurrentTime()+0.5,&FileSelectionDialog::reapListingsCallback,reaper);
+	}
+
+std::string FileSelectionDialog::getPathKey(int pathButtonIndex)
+	{
+	/* Concatenate the labels of all path buttons up to the given one; this tells apart zip archives and regular directories: */
+	std::string result;
+	for(int i=0;i<=pathButtonIndex;++i)
+		{
+		result.push_back('/');
+		result.append(static_cast<Button*>(pathButtonBox->getChild(i))->getString());
+		}
+	
+	return result;
+	}
+
+bool FileSelectionDialog::passesFilters(const FileSelectionDialog::ListingEntry& entry) const
+	{
+	/* Directories and zip archives are always shown: */
+	if(entry.isDirectory||fileNameFilters==0)
+		return true;
+	
+	/* Find the file name's extension: */
+	const char* extPtr="";
+	for(const char* enPtr=entry.name.c_str();*enPtr!='\0';++enPtr)
+		if(*enPtr=='.')
+			extPtr=enPtr;
+	
+	/* Match against the list of allowed extensions: */
+	bool result=false;
+	const char* filterPtr=fileNameFilters;
+	while(*filterPtr!='\0'&&!result)
+		{
+		/* Extract the next extension: */
+		const char* extStart=filterPtr;
+		for(;*filterPtr!='\0'&&*filterPtr!=';';++filterPtr)
+			;
+		
+		/* See if it matches: */
+		result=int(strlen(extPtr))==filterPtr-extStart&&memcmp(extPtr,extStart,filterPtr-extStart)==0;
+		
+		/* Skip the separator: */
+		if(*filterPtr==';')
+			++filterPtr;
+		}
+	
+	return result;
+	}
+
+void FileSelectionDialog::insertListEntry(const FileSelectionDialog::ListingEntry& entry)
+	{
+	/* Find the insertion position by binary search inside the directory or file range of the sorted file list: */
+	ListBox* listBox=fileList->getListBox();
+	int l=entry.isDirectory?0:numListedDirectories;
+	int r=entry.isDirectory?numListedDirectories:listBox->getNumItems();
+	StringCompare sc;
+	while(l<r)
+		{
+		int m=(l+r)>>1;
+		if(sc(listBox->getItem(m),entry.name.c_str()))
+			l=m+1;
+		else
+			r=m;
+		}
+	
+	/* Insert the entry: */
+	listBox->insertItem(l,entry.name.c_str());
+	if(entry.isDirectory)
+		++numListedDirectories;
+	}
+
+bool FileSelectionDialog::readListingBatch(void)
+	{
+	/* Take the next batch of entries from the current listing: */
+	std::vector<ListingEntry> batch;
+	bool complete;
+	{
+	DirectoryListing& l=*currentListing;
+	Threads::Mutex::Lock entriesLock(l.entriesMutex);
+	
+	/* Wait until a full batch has been read, so that all nodes in a cluster populate their file lists in lock-step; batches are small to bound the time a frame can wait on the file system: */
+	size_t batchEnd=l.numConsumed+16;
+	while(!l.finished&&l.entries.size()<batchEnd)
+		l.entriesCond.wait(l.entriesMutex);
+	if(batchEnd>l.entries.size())
+		batchEnd=l.entries.size();
+	batch.insert(batch.end(),l.entries.begin()+l.numConsumed,l.entries.begin()+batchEnd);
+	l.numConsumed=batchEnd;
+	complete=l.finished&&l.numConsumed==l.entries.size();
+	}
+	
+	/* Insert the batch's entries into the file list: */
+	for(std::vector<ListingEntry>::const_iterator bIt=batch.begin();bIt!=batch.end();++bIt)
+		if(passesFilters(*bIt))
+			insertListEntry(*bIt);
+	
+	return complete;
+	}
+
+void FileSelectionDialog::listingTimerEventCallback(Misc::TimerEventScheduler::CallbackData* cbData)
+	{
+	/* Add the next batch of entries, and schedule another event if the listing is not complete yet: */
+	if(!readListingBatch())
+		getManager()->getTimerEventScheduler()->scheduleEvent(cbData->time+0.02,this,&FileSelectionDialog::listingTimerEventCallback);
+	}
+
+void FileSelectionDialog::readDirectory(void)
+	{
+	/* Stop populating the file list from the previous listing; the previous listing keeps reading in the background for the cache: */
+	Misc::TimerEventScheduler* tes=getManager()->getTimerEventScheduler();
+	if(tes!=0)
+		tes->removeAllEvents(this,&FileSelectionDialog::listingTimerEventCallback);
+	
+	/* Look for a cached listing of the selected directory, and discard expired listings: */
+	std::string key=getPathKey(selectedPathButton);
+	double time=getManager()->getTime();
+	currentListing=0;
+	std::vector<DirectoryListing*> discardedListings;
+	for(std::vector<DirectoryListing*>::iterator lcIt=listingCache.begin();lcIt!=listingCache.end();)
+		{
+		if(time-(*lcIt)->creationTime>=10.0)
+			{
+			discardedListings.push_back(*lcIt);
+			lcIt=listingCache.erase(lcIt);
+			}
+		else
+			{
+			if((*lcIt)->key==key)
+				currentListing=*lcIt;
+			++lcIt;
+			}
+		}
+	
+	if(currentListing==0)
+		{
+		/* Discard the oldest listing if the cache is full: */
+		if(listingCache.size()>=8)
+			{
+			discardedListings.push_back(listingCache.front());
+			listingCache.erase(listingCache.begin());
+			}
+		
+		/* Start reading the selected directory in the background: */
+		currentListing=new DirectoryListing(key,currentDirectory,time);
+		listingCache.push_back(currentListing);
+		}
+	
+	/* Delete the discarded listings once their listing threads have finished: */
+	abandonListings(discardedListings);
+	
+	/* Collect all entries that were already shown the last time the directory was displayed: */
+	std::vector<std::string> directories;
+	std::vector<std::string> files;
+	bool complete;
+	{
+	Threads::Mutex::Lock entriesLock(currentListing->entriesMutex);
+	for(size_t i=0;i<currentListing->numConsumed;++i)
+		{
+		const ListingEntry& entry=currentListing->entries[i];
+		if(passesFilters(entry))
+			(entry.isDirectory?directories:files).push_back(entry.name);
+		}
+	complete=currentListing->finished&&currentListing->numConsumed==currentListing->entries.size();
+	}
+	
 	/* Sort the directory and file names separately: */
 	StringCompare sc;
 	std::sort(directories.begin(),directories.end(),sc);
@@ -174,6 +396,22 @@ void FileSelectionDialog::readDirectory(void)
 		fileList->getListBox()->addItem(dIt->c_str());
 	for(std::vector<std::string>::const_iterator fIt=files.begin();fIt!=files.end();++fIt)
 		fileList->getListBox()->addItem(fIt->c_str());
+	numListedDirectories=int(directories.size());
+	
+	if(!complete)
+		{
+		if(tes!=0)
+			{
+			/* Populate the file list incrementally from timer events: */
+			tes->scheduleEvent(tes->getCurrentTime(),this,&FileSelectionDialog::listingTimerEventCallback);
+			}
+		else
+			{
+			/* Read the entire listing immediately: */
+			while(!readListingBatch())
+				;
+			}
+		}
 	}
 
 void FileSelectionDialog::setSelectedPathButton(int newSelectedPathButton)
@@ -512,7 +750,8 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 	 canSelectDirectory(false),
 	 canCreateFile(false),fileNameField(0),
 	 pathButtonBox(0),selectedPathButton(-1),
-	 fileList(0),filterList(0)
+	 fileList(0),filterList(0),
+	 currentListing(0),numListedDirectories(0)
 	{
 	/* Create the dialog: */
 	createDialog(sFileNameFilters);
@@ -525,7 +764,8 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 	 canSelectDirectory(false),
 	 canCreateFile(true),fileNameField(0),
 	 pathButtonBox(0),selectedPathButton(-1),
-	 fileList(0),filterList(0)
+	 fileList(0),filterList(0),
+	 currentListing(0),numListedDirectories(0)
 	{
 	/* Create the dialog: */
 	createDialog(sFileNameFilters);
@@ -548,6 +788,13 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 
 FileSelectionDialog::~FileSelectionDialog(void)
 	{
+	/* Stop populating the file list: */
+	Misc::TimerEventScheduler* tes=getManager()->getTimerEventScheduler();
+	if(tes!=0)
+		tes->removeAllEvents(this,&FileSelectionDialog::listingTimerEventCallback);
+	
+	/* Delete all cached directory listings once their listing threads have finished: */
+	abandonListings(listingCache);
 	}
 
 void FileSelectionDialog::addFileNameFilters(const char* newFileNameFilters)
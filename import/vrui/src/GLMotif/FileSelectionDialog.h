@@ -1,6 +1,6 @@
 /***********************************************************************
 FileSelectionDialog - A popup window to select a file name.
-Copyright (c) 2008-2012 Oliver Kreylos
+Copyright (c) 2008-2014 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
 
@@ -22,9 +22,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLMOTIF_FILESELECTIONDIALOG_INCLUDED
 #define GLMOTIF_FILESELECTIONDIALOG_INCLUDED
 
+#include <stddef.h>
 #include <string>
+#include <vector>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
+#include <Misc/TimerEventScheduler.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
+#include <Threads/Thread.h>
 #include <IO/Directory.h>
 #include <GLMotif/TextField.h>
 #include <GLMotif/Button.h>
@@ -90,8 +96,51 @@ class FileSelectionDialog:public PopupWindow
 			}
 		};
 	
-	/* Elements: */
 	private:
+	struct ListingEntry // Structure for directory entries that can be shown in the file list
+		{
+		/* Elements: */
+		public:
+		std::string name; // Name of the entry; names of directories and zip archives end with a slash
+		bool isDirectory; // Flag whether the entry is a directory or zip archive
+		};
+	
+	struct DirectoryListing // Structure for directory listings read by a background thread and cached by path
+		{
+		/* Elements: */
+		public:
+		std::string key; // Path of the listed directory as spelled out by the path buttons
+		IO::DirectoryPtr directory; // The listed directory; only accessed by the listing thread while it is running
+		double creationTime; // Widget manager time at which the listing was started
+		Threads::Mutex entriesMutex; // Mutex serializing access to the entry list and the finished flag
+		Threads::Cond entriesCond; // Condition variable signalled whenever the listing thread reads a new entry or finishes
+		std::vector<ListingEntry> entries; // Entries read so far, in directory order
+		bool finished; // Flag set by the listing thread once it has read the entire directory
+		size_t numConsumed; // Number of entries already added to the file list; only accessed by the main thread
+		Threads::Thread listingThread; // Thread reading the directory
+		
+		/* Constructors and destructors: */
+		DirectoryListing(const std::string& sKey,IO::DirectoryPtr sDirectory,double sCreationTime); // Starts reading the given directory in the background
+		private:
+		DirectoryListing(const DirectoryListing& source); // Prohibit copy constructor
+		DirectoryListing& operator=(const DirectoryListing& source); // Prohibit assignment operator
+		public:
+		~DirectoryListing(void); // Joins the listing thread; must only be called once the listing is finished
+		
+		/* Methods: */
+		void* listingThreadMethod(void); // Method reading all entries of the directory
+		bool isFinished(void); // Returns true if the listing thread has read the entire directory; does not block
+		};
+	
+	struct ListingReaper // Structure holding abandoned directory listings until their listing threads have finished
+		{
+		/* Elements: */
+		public:
+		Misc::TimerEventScheduler* timerEventScheduler; // Scheduler polling the abandoned listings; outlives the dialog
+		std::vector<DirectoryListing*> listings; // Abandoned listings whose listing threads are still running
+		};
+	
+	/* Elements: */
 	IO::DirectoryPtr currentDirectory; // The currently-displayed directory
 	const char* fileNameFilters; // Current filter expression for file names; semicolon-separated list of allowed extensions
 	bool canSelectDirectory; // Flag whether the caller allows to select a directory by opening the directory and then pressing OK
@@ -102,11 +151,21 @@ class FileSelectionDialog:public PopupWindow
 	int selectedPathButton; // Index of the currently selected path button; determines the displayed directory
 	ScrolledListBox* fileList; // Scrolled list box containing all directories and matching files in the current directory
 	DropdownBox* filterList; // Drop down box containing the selectable file name filters
+	std::vector<DirectoryListing*> listingCache; // Recently started directory listings in order of creation, including the current one
+	DirectoryListing* currentListing; // Listing of the currently displayed directory
+	int numListedDirectories; // Number of directories at the beginning of the file list
 	Misc::CallbackList okCallbacks; // Callbacks to be called when the OK button is selected, or a file name is double-clicked
 	Misc::CallbackList cancelCallbacks; // Callbacks to be called when the cancel button is selected
 	
 	/* Private methods: */
-	void readDirectory(void); // Reads all directories and files from the selected directory into the list box
+	static void reapListingsCallback(Misc::CallbackData* cbData,void* userData); // Timer callback deleting abandoned listings once their listing threads have finished
+	void abandonListings(const std::vector<DirectoryListing*>& listings); // Deletes the given listings once their listing threads have finished, without blocking
+	std::string getPathKey(int pathButtonIndex); // Returns the cache key for the directory of the given path button
+	bool passesFilters(const ListingEntry& entry) const; // Returns true if the given entry is to be shown in the file list
+	void insertListEntry(const ListingEntry& entry); // Inserts the given entry into the sorted file list
+	bool readListingBatch(void); // Adds the next batch of entries from the current listing to the file list; returns true if the listing is complete
+	void listingTimerEventCallback(Misc::TimerEventScheduler::CallbackData* cbData); // Callback to incrementally populate the file list
+	void readDirectory(void); // Starts reading all directories and files from the selected directory into the list box
 	void setSelectedPathButton(int newSelectedPathButton); // Changes the selected path button
 	void pathButtonSelectedCallback(Button::SelectCallbackData* cbData); // Callback called when one of the path buttons is selected
 	void fileNameFieldValueChangedCallback(TextField::ValueChangedCallbackData* cbData); // Callback called when the file name text field changes value
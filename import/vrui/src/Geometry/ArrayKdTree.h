@@ -25,12 +25,18 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef GEOMETRY_ARRAYKDTREE_INCLUDED
 #define GEOMETRY_ARRAYKDTREE_INCLUDED
 
+#include <IO/File.h>
 #include <Geometry/Point.h>
 #include <Geometry/Box.h>
 #include <Geometry/ClosePointSet.h>
 
 #define GEOMETRY_ARRAYKDTREE_TRAVERSAL_EXPLICIT_RECURSION 1
 
+/* Forward declarations: */
+namespace IO {
+class MemMappedFile;
+}
+
 namespace Geometry {
 
 template <class StoredPointParam>
@@ -65,8 +71,16 @@ class ArrayKdTree
 	private:
 	int numNodes; // Total number of nodes in kd-tree
 	StoredPoint* nodes; // Array of nodes
+	IO::FilePtr nodeFile; // Memory-mapped file containing the node array if the tree was mapped from a file; node array is owned by the tree otherwise
 	
 	/* Private methods: */
+	void releaseNodes(void) // Releases the current node array
+		{
+		if(nodeFile!=0)
+			nodeFile=0;
+		else
+			delete[] nodes;
+		}
 	void createTree(int left,int right,int splitDimension); // Creates sub-kd-tree
 	void* createTreeThreaded(const CreateSubTreeArgs* args); // Creates sub-kd-tree using multiple threads
 	void checkTree(int left,int right,int splitDimension,Scalar bbMin[],Scalar bbMax[]) const; // Checks if kd-tree has correct structure
@@ -107,7 +121,7 @@ class ArrayKdTree
 	ArrayKdTree(int sNumNodes,const StoredPoint sNodes[]); // Creates balanced kd-tree from point array
 	~ArrayKdTree(void)
 		{
-		delete[] nodes;
+		releaseNodes();
 		}
 	
 	/* Methods: */
@@ -139,13 +153,10 @@ class ArrayKdTree
 	void setPoints(int newNumNodes,const StoredPoint newNodes[],int numThreads); // Ditto, but uses multiple threads
 	void donatePoints(int newNumNodes,StoredPoint* newNodes); // Creates balanced kd-tree from point array; adopts point array as own
 	void donatePoints(int newNumNodes,StoredPoint* newNodes,int numThreads); // Ditto, but uses multiple threads
-	StoredPoint* detachPoints(void) // Returns a pointer to the tree's point array and detaches it from the tree
-		{
-		StoredPoint* result=nodes;
-		numNodes=0;
-		nodes=0;
-		return result;
-		}
+	StoredPoint* detachPoints(void); // Returns a pointer to the tree's point array and detaches it from the tree
+	void writeTree(IO::File& file) const; // Writes the balanced node array to the given binary file in host byte order; stored points must be plain data
+	void readTree(IO::File& file,int expectedNumNodes =-1); // Reads a balanced node array written by writeTree from the given file; throws if expected number of nodes is non-negative and does not match
+	void mapTree(IO::MemMappedFile& file,int expectedNumNodes =-1); // Uses a balanced node array written by writeTree at the given file's current read position in-place; file must be reference-counted, and mapped points must not be modified; throws if expected number of nodes is non-negative and does not match
 	const StoredPoint& getNode(int nodeIndex) const // Returns one of the octree's nodes
 		{
 		return nodes[nodeIndex];
@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2014 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,9 +23,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/CSVSource.h>
 
 #include <ctype.h>
-#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <string>
+#include <deque>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
 #include <Misc/ThrowStdErr.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <IO/ValueSource.h>
 
 namespace IO {
 
@@ -101,149 +109,94 @@ class TypeName<std::string>
 		}
 	};
 
-}
-
-/***************************************
-Methods of class CSVSource::FormatError:
-***************************************/
+/**************************************************
+Helper function to find separators in source data:
+**************************************************/
 
-CSVSource::FormatError::FormatError(unsigned int fieldIndex,size_t recordIndex)
-	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Format error in field %u of record %u",fieldIndex,(unsigned int)recordIndex))
+inline Misc::UInt64 flagZeroBytes(Misc::UInt64 word) // Returns a word with the high bits of exactly those bytes set that are zero in the given word
 	{
+	const Misc::UInt64 lowBits=~Misc::UInt64(0)/Misc::UInt64(255)*Misc::UInt64(0x7f);
+	return ~(((word&lowBits)+lowBits)|word|lowBits);
 	}
 
-/*******************************************
-Methods of class CSVSource::ConversionError:
-*******************************************/
-
-CSVSource::ConversionError::ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName)
-	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Could not convert field %u of record %u to type %s",fieldIndex,(unsigned int)recordIndex,dataTypeName))
-	{
-	}
-
-/**************************
-Methods of class CSVSource:
-**************************/
-
-bool CSVSource::skipRestOfField(bool quoted,int nextChar)
+inline const char* findSeparator(const char* ptr,const char* end,int c0,int c1,int c2) // Returns a pointer to the first of any of the given three characters in the given range, or the end of the range
 	{
-	/* Keep track if any characters were actually skipped: */
-	bool skippedAny=false;
+	/*********************************************************************
+	Compare eight characters at a time by XORing a word of source data
+	with each character replicated into all bytes, and flagging the zero
+	bytes of the results.
+	*********************************************************************/
 	
-	if(quoted)
-		{
-		/*******************
-		Skip a quoted field:
-		*******************/
-		
-		/* Skip characters until unquote: */
-		while(true)
-			{
-			/* Skip characters until the next quote character or eof: */
-			while(nextChar!=quote&&nextChar>=0)
-				{
-				skippedAny=true;
-				nextChar=source->getChar();
-				}
-			
-			/* Eof inside quote is a format error: */
-			if(nextChar<0)
-				throw FormatError(fieldIndex,recordIndex);
-			
-			/* Check for quoted quotes: */
-			nextChar=source->getChar();
-			if(nextChar==quote)
-				{
-				skippedAny=true;
-				nextChar=source->getChar();
-				}
-			else
-				break;
-			}
-		}
-	else
+	typedef Misc::UInt64 Word;
+	const Word ones=~Word(0)/Word(255);
+	const Word m0=ones*Word(c0&0xff);
+	const Word m1=ones*Word(c1&0xff);
+	const Word m2=ones*Word(c2&0xff);
+	while(size_t(end-ptr)>=sizeof(Word))
 		{
-		/**********************
-		Skip an unquoted field:
-		**********************/
-		
-		/* Skip characters until the next field separator, record separator, eof, or quote: */
-		while(nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0&&nextChar!=quote)
+		Word w;
+		memcpy(&w,ptr,sizeof(Word));
+		Word matches=flagZeroBytes(w^m0)|flagZeroBytes(w^m1)|flagZeroBytes(w^m2);
+		if(matches!=0)
 			{
-			skippedAny=true;
-			nextChar=source->getChar();
+			#if defined(__GNUC__)&&__BYTE_ORDER==__LITTLE_ENDIAN
+			/* The lowest flagged byte is the first match: */
+			return ptr+(__builtin_ctzll(matches)>>3);
+			#else
+			break;
+			#endif
 			}
+		ptr+=sizeof(Word);
 		}
 	
-	/* Check the next character: */
-	if(nextChar==fieldSeparator)
-		{
-		/* Start a new field: */
-		++fieldIndex;
-		}
-	else if(nextChar==recordSeparator||nextChar<0)
+	/* Find the exact separator position: */
+	for(;ptr!=end;++ptr)
 		{
-		/* Record separator or eof start a new record: */
-		fieldIndex=0;
-		++recordIndex;
-		}
-	else
-		{
-		/* Signal a format error in the CSV source: */
-		throw FormatError(fieldIndex,recordIndex);
+		int c=(unsigned char)(*ptr);
+		if(c==c0||c==c1||c==c2)
+			break;
 		}
 	
-	return skippedAny;
+	return ptr;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,unsigned int& value)
+/*******************************************************************
+Helper functions to convert field contents to values; each function
+returns a pointer after the converted characters, or null if the
+characters do not start with a number of the function's type:
+*******************************************************************/
+
+inline const char* convertNumber(const char* ptr,const char* end,unsigned int& value)
 	{
-	/* Signal a conversion error if the next character is not a digit: */
-	if(nextChar<'0'||nextChar>'9')
-		return false;
-	
-	/* Read the first digit: */
-	value=(unsigned int)(nextChar-'0');
-	nextChar=source->getChar();
+	/* Signal a conversion error if the field does not start with a digit: */
+	if(ptr==end||*ptr<'0'||*ptr>'9')
+		return 0;
 	
-	/* Read all following digits: */
-	while(nextChar>='0'&&nextChar<='9')
-		{
-		value=value*10+(unsigned int)(nextChar-'0');
-		nextChar=source->getChar();
-		}
+	/* Read all digits: */
+	value=0U;
+	for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr)
+		value=value*10+(unsigned int)(*ptr-'0');
 	
-	return true;
+	return ptr;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,int& value)
+inline const char* convertNumber(const char* ptr,const char* end,int& value)
 	{
 	/* Check for optional sign: */
 	bool negated=false;
-	if(nextChar=='-')
+	if(ptr!=end&&*ptr=='-')
 		{
 		negated=true;
-		nextChar=source->getChar();
+		++ptr;
 		}
-	else if(nextChar=='+')
-		nextChar=source->getChar();
-	
-	/* Signal a conversion error if the next character is not a digit: */
-	if(nextChar<'0'||nextChar>'9')
-		return false;
-	
-	/* Read the first digit: */
-	unsigned int tempValue=(unsigned int)(nextChar-'0');
-	nextChar=source->getChar();
+	else if(ptr!=end&&*ptr=='+')
+		++ptr;
 	
-	/* Read all following digits: */
-	while(nextChar>='0'&&nextChar<='9')
-		{
-		tempValue=tempValue*10+(unsigned int)(nextChar-'0');
-		nextChar=source->getChar();
-		}
+	/* Read the absolute value: */
+	unsigned int tempValue;
+	ptr=convertNumber(ptr,end,tempValue);
+	if(ptr==0)
+		return 0;
 	
 	/* Calculate the final value: */
 	if(negated)
@@ -251,115 +204,477 @@ bool CSVSource::convertNumber(int& nextChar,int& value)
 	else
 		value=int(tempValue);
 	
-	return true;
+	return ptr;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,double& value)
+const char* convertNumber(const char* ptr,const char* end,double& value)
 	{
+	/* Powers of ten that are exactly representable as doubles: */
+	static const double exactPowersOfTen[23]=
+		{
+		1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,
+		1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,
+		1.0e20,1.0e21,1.0e22
+		};
+	
+	const char* numberBegin=ptr;
+	
 	/* Check for optional sign: */
 	bool negated=false;
-	if(nextChar=='-')
+	if(ptr!=end&&*ptr=='-')
 		{
 		negated=true;
-		nextChar=source->getChar();
+		++ptr;
 		}
-	else if(nextChar=='+')
-		nextChar=source->getChar();
+	else if(ptr!=end&&*ptr=='+')
+		++ptr;
+	
+	/*********************************************************************
+	Accumulate up to 19 significant decimal digits into a 64-bit integer
+	mantissa, and track the decimal exponent separately.
+	*********************************************************************/
 	
-	/* Keep track if any digits have been read: */
+	Misc::UInt64 mantissa=0;
+	int numMantissaDigits=0;
+	int exponent=0;
+	bool truncated=false;
 	bool haveDigit=false;
 	
 	/* Read an integral number part: */
-	value=0.0;
-	while(nextChar>='0'&&nextChar<='9')
+	for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr)
 		{
 		haveDigit=true;
-		value=value*10.0+double(nextChar-'0');
-		nextChar=source->getChar();
+		if(numMantissaDigits<19)
+			{
+			mantissa=mantissa*10U+Misc::UInt64(*ptr-'0');
+			if(mantissa!=0)
+				++numMantissaDigits;
+			}
+		else
+			{
+			++exponent;
+			if(*ptr!='0')
+				truncated=true;
+			}
 		}
 	
 	/* Check for a period: */
-	if(nextChar=='.')
+	if(ptr!=end&&*ptr=='.')
 		{
-		nextChar=source->getChar();
+		++ptr;
 		
 		/* Read a fractional number part: */
-		double fraction=0.0;
-		double fractionBase=1.0;
-		while(nextChar>='0'&&nextChar<='9')
+		for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr)
 			{
 			haveDigit=true;
-			fraction=fraction*10.0+double(nextChar-'0');
-			fractionBase*=10.0;
-			nextChar=source->getChar();
+			if(numMantissaDigits<19)
+				{
+				mantissa=mantissa*10U+Misc::UInt64(*ptr-'0');
+				if(mantissa!=0)
+					++numMantissaDigits;
+				--exponent;
+				}
+			else if(*ptr!='0')
+				truncated=true;
 			}
-		
-		value+=fraction/fractionBase;
 		}
 	
 	/* Signal a conversion error if no digits were read in the integral or fractional part: */
 	if(!haveDigit)
-		return false;
-	
-	/* Negate the result if a minus sign was read: */
-	if(negated)
-		value=-value;
+		return 0;
 	
 	/* Check for an exponent indicator: */
-	if(nextChar=='e'||nextChar=='E')
+	if(ptr!=end&&(*ptr=='e'||*ptr=='E'))
 		{
-		nextChar=source->getChar();
+		++ptr;
 		
 		/* Read a plus or minus sign: */
 		bool exponentNegated=false;
-		if(nextChar=='-')
+		if(ptr!=end&&*ptr=='-')
 			{
 			exponentNegated=true;
-			nextChar=source->getChar();
+			++ptr;
 			}
-		else if(nextChar=='+')
-			nextChar=source->getChar();
+		else if(ptr!=end&&*ptr=='+')
+			++ptr;
 		
 		/* Signal a conversion error if the next character is not a digit: */
-		if(nextChar<'0'||nextChar>'9')
-			return false;
+		if(ptr==end||*ptr<'0'||*ptr>'9')
+			return 0;
 		
-		/* Read the first exponent digit: */
-		double exponent=double(nextChar-'0');
-		nextChar=source->getChar();
+		/* Read the exponent digits, clamping the exponent to a range that cannot overflow: */
+		int explicitExponent=0;
+		for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr)
+			if(explicitExponent<100000)
+				explicitExponent=explicitExponent*10+(*ptr-'0');
 		
-		/* Read the rest of the exponent digits: */
-		while(nextChar>='0'&&nextChar<='9')
+		if(exponentNegated)
+			exponent-=explicitExponent;
+		else
+			exponent+=explicitExponent;
+		}
+	
+	if(mantissa==0)
+		value=0.0;
+	else if(!truncated&&mantissa<=(Misc::UInt64(1)<<53)&&exponent>=-22&&exponent<=22)
+		{
+		/* Both the mantissa and the power of ten are exact, so a single multiplication or division rounds correctly: */
+		value=double(mantissa);
+		if(exponent>=0)
+			value*=exactPowersOfTen[exponent];
+		else
+			value/=exactPowersOfTen[-exponent];
+		}
+	else
+		{
+		/* Fall back to the standard library for the rare numbers that need extended precision: */
+		char numberBuffer[64];
+		size_t numberLength=ptr-numberBegin;
+		if(numberLength<sizeof(numberBuffer))
 			{
-			exponent=exponent*10.0+double(nextChar-'0');
-			nextChar=source->getChar();
+			memcpy(numberBuffer,numberBegin,numberLength);
+			numberBuffer[numberLength]='\0';
+			value=strtod(numberBuffer,0);
 			}
-		
-		/* Multiply the mantissa with the exponent: */
-		if(exponentNegated)
-			exponent=-exponent;
-		value*=pow(10.0,exponent);
+		else
+			{
+			std::string number(numberBegin,ptr);
+			value=strtod(number.c_str(),0);
+			}
+		return ptr;
 		}
 	
-	return true;
+	/* Negate the result if a minus sign was read: */
+	if(negated)
+		value=-value;
+	
+	return ptr;
 	}
 
-template <>
-bool CSVSource::convertNumber(int& nextChar,float& value)
+inline const char* convertNumber(const char* ptr,const char* end,float& value)
 	{
 	/* Use the double conversion method internally: */
 	double tempValue;
-	if(!convertNumber<double>(nextChar,tempValue))
+	ptr=convertNumber(ptr,end,tempValue);
+	if(ptr!=0)
+		value=float(tempValue);
+	return ptr;
+	}
+
+}
+
+/***************************************
+Methods of class CSVSource::FormatError:
+***************************************/
+
+CSVSource::FormatError::FormatError(unsigned int fieldIndex,size_t recordIndex)
+	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Format error in field %u of record %u",fieldIndex,(unsigned int)recordIndex))
+	{
+	}
+
+/*******************************************
+Methods of class CSVSource::ConversionError:
+*******************************************/
+
+CSVSource::ConversionError::ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName)
+	:std::runtime_error(Misc::printStdErrMsg("IO::CSVSource::read: Could not convert field %u of record %u to type %s",fieldIndex,(unsigned int)recordIndex,dataTypeName))
+	{
+	}
+
+/******************************************
+Methods of class CSVSource::ChunkProcessor:
+******************************************/
+
+CSVSource::ChunkProcessor::~ChunkProcessor(void)
+	{
+	}
+
+/*******************************************
+Declaration of struct CSVSource::ChunkQueue:
+*******************************************/
+
+struct CSVSource::ChunkQueue
+	{
+	/* Embedded classes: */
+	public:
+	class Error // Abstract base class for copies of exceptions thrown while processing chunks
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~Error(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual void rethrow(void) const =0; // Throws a copy of the original exception
+		};
+	
+	template <class ExceptionParam>
+	class TypedError:public Error // Class for copies of exceptions of a specific type
+		{
+		/* Elements: */
+		private:
+		ExceptionParam exception; // Copy of the original exception
+		
+		/* Constructors and destructors: */
+		public:
+		TypedError(const ExceptionParam& sException)
+			:exception(sException)
+			{
+			}
+		
+		/* Methods: */
+		virtual void rethrow(void) const
+			{
+			throw exception;
+			}
+		};
+	
+	struct Chunk // Structure describing a chunk of complete records
+		{
+		/* Elements: */
+		public:
+		char* data; // Chunk's source data, owned by the chunk
+		size_t dataSize; // Size of chunk's source data
+		unsigned int chunkIndex; // Index of the chunk in source order
+		size_t firstRecordIndex; // Index of the chunk's first record in the entire source
+		};
+	
+	/* Elements: */
+	const CSVSource& parent; // CSV source whose records are split into chunks
+	ChunkProcessor& processor; // Processor for chunks
+	Threads::MutexCond queueCond; // Condition variable protecting the queue, signaling new chunks and room in the queue
+	std::deque<Chunk> chunks; // Queue of chunks waiting to be processed
+	size_t maxQueueSize; // Maximum number of queued chunks
+	bool finished; // Flag whether all chunks have been queued
+	bool failed; // Flag whether processing any chunk threw an exception
+	unsigned int errorChunkIndex; // Index of the earliest chunk whose processing threw an exception
+	Error* error; // Copy of the exception thrown by the earliest failed chunk
+	
+	/* Constructors and destructors: */
+	ChunkQueue(const CSVSource& sParent,ChunkProcessor& sProcessor,size_t sMaxQueueSize)
+		:parent(sParent),processor(sProcessor),
+		 maxQueueSize(sMaxQueueSize),
+		 finished(false),failed(false),errorChunkIndex(0),error(0)
+		{
+		}
+	~ChunkQueue(void)
+		{
+		delete error;
+		}
+	
+	/* Methods: */
+	void setError(unsigned int chunkIndex,Error* newError) // Remembers the given exception if it was thrown by the earliest failed chunk so far
+		{
+		Threads::MutexCond::Lock queueLock(queueCond);
+		if(!failed||errorChunkIndex>chunkIndex)
+			{
+			delete error;
+			errorChunkIndex=chunkIndex;
+			error=newError;
+			}
+		else
+			delete newError;
+		failed=true;
+		queueCond.broadcast();
+		}
+	void processChunk(const Chunk& chunk) // Processes the given chunk and records any exceptions
+		{
+		try
+			{
+			/* Create a CSV source for the chunk with the parent's settings: */
+			CSVSource chunkSource(chunk.data,chunk.dataSize);
+			chunkSource.fieldSeparator=parent.fieldSeparator;
+			chunkSource.recordSeparator=parent.recordSeparator;
+			chunkSource.quote=parent.quote;
+			chunkSource.recordIndex=chunk.firstRecordIndex;
+			
+			processor.processChunk(chunk.chunkIndex,chunkSource);
+			}
+		catch(CSVSource::FormatError err)
+			{
+			setError(chunk.chunkIndex,new TypedError<CSVSource::FormatError>(err));
+			}
+		catch(CSVSource::ConversionError err)
+			{
+			setError(chunk.chunkIndex,new TypedError<CSVSource::ConversionError>(err));
+			}
+		catch(ValueSource::NumberError err)
+			{
+			setError(chunk.chunkIndex,new TypedError<ValueSource::NumberError>(err));
+			}
+		catch(std::runtime_error err)
+			{
+			setError(chunk.chunkIndex,new TypedError<std::runtime_error>(err));
+			}
+		}
+	void* workerThreadMethod(void) // Thread method processing chunks from the queue until all chunks are processed
+		{
+		while(true)
+			{
+			/* Get the next chunk from the queue: */
+			Chunk chunk;
+			bool skip;
+			{
+			Threads::MutexCond::Lock queueLock(queueCond);
+			while(chunks.empty()&&!finished)
+				queueCond.wait(queueLock);
+			if(chunks.empty())
+				break;
+			chunk=chunks.front();
+			chunks.pop_front();
+			
+			/* Skip chunks following a failed chunk, but process earlier ones that might fail first: */
+			skip=failed&&chunk.chunkIndex>errorChunkIndex;
+			
+			/* Wake up the reader if it is waiting for room in the queue: */
+			queueCond.broadcast();
+			}
+			
+			/* Process the chunk unless an earlier chunk already failed: */
+			if(!skip)
+				processChunk(chunk);
+			delete[] chunk.data;
+			}
+		
+		return 0;
+		}
+	};
+
+/**************************
+Methods of class CSVSource:
+**************************/
+
+bool CSVSource::readRawFieldFast(void)
+	{
+	const char* ptr=blockPtr;
+	if(ptr==blockEnd)
 		return false;
-	value=float(tempValue);
+	
+	if((unsigned char)(*ptr)==quote)
+		{
+		/* Find the closing quote, skipping any quoted quotes: */
+		const char* quotePtr=ptr+1;
+		while(true)
+			{
+			quotePtr=static_cast<const char*>(memchr(quotePtr,quote,blockEnd-quotePtr));
+			
+			/* Bail out if the closing quote or the following character are not in the current block: */
+			if(quotePtr==0||quotePtr+1==blockEnd)
+				return false;
+			
+			if((unsigned char)(quotePtr[1])!=quote)
+				break;
+			quotePtr+=2;
+			}
+		
+		/* Return the quoted field contents: */
+		fieldBegin=ptr+1;
+		fieldEnd=quotePtr;
+		fieldQuoted=true;
+		blockPtr=quotePtr+2;
+		finishField((unsigned char)(quotePtr[1]));
+		}
+	else
+		{
+		/* Find the end of the unquoted field: */
+		const char* separatorPtr=findSeparator(ptr,blockEnd,fieldSeparator,recordSeparator,quote);
+		
+		/* Bail out if the field's terminator is not in the current block: */
+		if(separatorPtr==blockEnd)
+			return false;
+		
+		/* Return the unquoted field contents: */
+		fieldBegin=ptr;
+		fieldEnd=separatorPtr;
+		fieldQuoted=false;
+		blockPtr=separatorPtr+1;
+		finishField((unsigned char)(*separatorPtr));
+		}
+	
 	return true;
 	}
 
+void CSVSource::readRawFieldSlow(void)
+	{
+	/* Assemble the field in the field buffer: */
+	fieldBuffer.clear();
+	
+	/* Read the first character: */
+	int nextChar=getChar();
+	if(nextChar==quote)
+		{
+		/*******************
+		Read a quoted field:
+		*******************/
+		
+		fieldQuoted=true;
+		
+		/* Skip the opening quote: */
+		nextChar=getChar();
+		
+		/* Read characters until unquote: */
+		while(true)
+			{
+			/* Read characters until the next quote character or eof: */
+			while(nextChar!=quote&&nextChar>=0)
+				{
+				fieldBuffer.push_back(char(nextChar));
+				nextChar=getChar();
+				}
+			
+			/* Eof inside quote is a format error: */
+			if(nextChar<0)
+				throw FormatError(fieldIndex,recordIndex);
+			
+			/* Check for quoted quotes, and keep them quoted in the raw field: */
+			nextChar=getChar();
+			if(nextChar==quote)
+				{
+				fieldBuffer.push_back(char(quote));
+				fieldBuffer.push_back(char(quote));
+				nextChar=getChar();
+				}
+			else
+				break;
+			}
+		}
+	else
+		{
+		/**********************
+		Read an unquoted field:
+		**********************/
+		
+		fieldQuoted=false;
+		
+		/* Read characters until the next field separator, record separator, eof, or quote: */
+		while(nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0&&nextChar!=quote)
+			{
+			fieldBuffer.push_back(char(nextChar));
+			nextChar=getChar();
+			}
+		}
+	
+	/* Return the assembled field contents: */
+	fieldBegin=fieldBuffer.empty()?0:&fieldBuffer[0];
+	fieldEnd=fieldBegin+fieldBuffer.size();
+	finishField(nextChar);
+	}
+
 CSVSource::CSVSource(FilePtr sSource)
 	:source(sSource),
 	 fieldSeparator(','),recordSeparator('\n'),quote('\"'),
-	 recordIndex(0),fieldIndex(0)
+	 recordIndex(0),fieldIndex(0),
+	 blockPtr(0),blockEnd(0),
+	 fieldBegin(0),fieldEnd(0),fieldQuoted(false)
+	{
+	}
+
+CSVSource::CSVSource(const void* data,size_t dataSize)
+	:fieldSeparator(','),recordSeparator('\n'),quote('\"'),
+	 recordIndex(0),fieldIndex(0),
+	 blockPtr(static_cast<const char*>(data)),blockEnd(blockPtr+dataSize),
+	 fieldBegin(0),fieldEnd(0),fieldQuoted(false)
 	{
 	}
 
@@ -385,36 +700,40 @@ void CSVSource::setQuote(int newQuote)
 template <class ValueParam>
 ValueParam CSVSource::readField(void)
 	{
-	/* Read the field's first character: */
-	int nextChar=source->getChar();
+	ValueParam result(0);
 	
-	/* Check for quote: */
-	bool quoted=false;
-	if(nextChar==quote)
+	/* Try converting a number directly from the current block of source data if it is followed by a separator: */
+	const char* numberEnd=convertNumber(blockPtr,blockEnd,result);
+	if(numberEnd!=0&&numberEnd!=blockEnd)
 		{
-		quoted=true;
-		nextChar=source->getChar();
+		int terminator=(unsigned char)(*numberEnd);
+		if(terminator==fieldSeparator||terminator==recordSeparator)
+			{
+			blockPtr=numberEnd+1;
+			finishField(terminator);
+			return result;
+			}
 		}
 	
-	/* Skip whitespace: */
-	while(isspace(nextChar)&&nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0)
-		nextChar=source->getChar();
+	/* Remember the field's position for error reporting: */
+	unsigned int rawFieldIndex=fieldIndex;
+	size_t rawRecordIndex=recordIndex;
 	
-	/* Read the numeric value: */
-	ValueParam result(0);
-	bool success=convertNumber(nextChar,result);
+	/* Read the raw field: */
+	readRawField();
 	
-	/* Skip whitespace: */
-	while(isspace(nextChar)&&nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0)
-		nextChar=source->getChar();
+	/* Skip leading and trailing whitespace: */
+	const char* begin=fieldBegin;
+	const char* end=fieldEnd;
+	while(begin!=end&&isSpace((unsigned char)(*begin)))
+		++begin;
+	while(end!=begin&&isSpace((unsigned char)(end[-1])))
+		--end;
 	
-	/* Read until the end of the field, and invalidate the result if any further characters are encountered: */
-	if(skipRestOfField(quoted,nextChar))
-			success=false;
-	
-	/* Check for conversion errors: */
-	if(!success)
-		throw ConversionError(fieldIndex,recordIndex,TypeName<ValueParam>::getName());
+	/* Convert the entire field to a numeric value: */
+	numberEnd=convertNumber(begin,end,result);
+	if(numberEnd==0||numberEnd!=end)
+		throw ConversionError(rawFieldIndex,rawRecordIndex,TypeName<ValueParam>::getName());
 	
 	/* Return the result: */
 	return result;
@@ -423,77 +742,200 @@ ValueParam CSVSource::readField(void)
 template <>
 std::string CSVSource::readField(void)
 	{
-	/* Read the field's first character: */
-	int nextChar=source->getChar();
+	/* Read the raw field: */
+	readRawField();
+	
+	if(!fieldQuoted)
+		return std::string(fieldBegin,fieldEnd);
 	
+	/* Unquote quoted quotes: */
 	std::string result;
-	if(nextChar==quote)
+	const char* ptr=fieldBegin;
+	while(true)
 		{
-		/* Skip the opening quote: */
-		nextChar=source->getChar();
-		
-		/********************
-		Read a quoted string:
-		********************/
+		const char* quotePtr=static_cast<const char*>(memchr(ptr,quote,fieldEnd-ptr));
+		if(quotePtr==0)
+			break;
+		result.append(ptr,quotePtr+1);
+		ptr=quotePtr+2;
+		}
+	result.append(ptr,fieldEnd);
+	
+	return result;
+	}
+
+void CSVSource::processChunks(CSVSource::ChunkProcessor& processor,unsigned int numThreads,size_t chunkSize)
+	{
+	/* Chunks must start at record boundaries: */
+	if(fieldIndex!=0)
+		Misc::throwStdErr("IO::CSVSource::processChunks: Not at beginning of record");
+	
+	/* Determine the number of processing threads: */
+	if(numThreads==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads=numCpus>0?(unsigned int)numCpus:1U;
+		}
+	if(chunkSize<1024)
+		chunkSize=1024;
+	
+	/* Start the worker threads if processing is parallel: */
+	ChunkQueue queue(*this,processor,numThreads*2);
+	Threads::Thread* workers=0;
+	if(numThreads>1)
+		{
+		workers=new Threads::Thread[numThreads];
+		for(unsigned int i=0;i<numThreads;++i)
+			workers[i].start(&queue,&ChunkQueue::workerThreadMethod);
+		}
+	
+	try
+		{
+		/* Start the first chunk with the unread part of the current block of source data: */
+		std::vector<char> carry(blockPtr,blockEnd);
+		blockPtr=blockEnd;
 		
-		/* Read characters until unquote: */
-		while(true)
+		unsigned int chunkIndex=0;
+		bool haveEof=false;
+		while(!haveEof)
 			{
-			/* Skip characters until the next quote character or eof: */
-			while(nextChar!=quote&&nextChar>=0)
+			/* Create a new chunk buffer and copy the previous chunk's incomplete record into it: */
+			size_t bufferSize=chunkSize;
+			if(bufferSize<carry.size()*2)
+				bufferSize=carry.size()*2;
+			char* buffer=new char[bufferSize];
+			size_t dataSize=carry.size();
+			if(!carry.empty())
+				memcpy(buffer,&carry[0],dataSize);
+			
+			/* Fill the buffer until it contains at least one complete record: */
+			size_t scanPos=0;
+			bool inQuote=false;
+			size_t cut=0;
+			size_t numRecords=0;
+			while(true)
 				{
-				result.push_back(nextChar);
-				nextChar=source->getChar();
+				/* Read source data into the rest of the buffer: */
+				while(dataSize<bufferSize)
+					{
+					size_t readSize=source!=0?source->readUpTo(buffer+dataSize,bufferSize-dataSize):0;
+					if(readSize==0)
+						{
+						haveEof=true;
+						break;
+						}
+					dataSize+=readSize;
+					}
+				
+				/* Find record separators outside of quoted fields: */
+				const char* ptr=buffer+scanPos;
+				const char* end=buffer+dataSize;
+				while((ptr=findSeparator(ptr,end,quote,recordSeparator,recordSeparator))!=end)
+					{
+					if((unsigned char)(*ptr)==quote)
+						inQuote=!inQuote;
+					else if(!inQuote)
+						{
+						++numRecords;
+						cut=(ptr+1)-buffer;
+						}
+					++ptr;
+					}
+				scanPos=dataSize;
+				
+				if(cut>0||haveEof)
+					break;
+				
+				/* Grow the buffer to fit the incomplete record: */
+				bufferSize*=2;
+				char* newBuffer=new char[bufferSize];
+				memcpy(newBuffer,buffer,dataSize);
+				delete[] buffer;
+				buffer=newBuffer;
 				}
 			
-			/* Eof inside quote is a format error: */
-			if(nextChar<0)
-				throw FormatError(fieldIndex,recordIndex);
+			/* At the end of the source, the chunk includes a final record without terminating separator: */
+			if(haveEof&&cut<dataSize)
+				{
+				++numRecords;
+				cut=dataSize;
+				}
 			
-			/* Check for quoted quotes: */
-			nextChar=source->getChar();
-			if(nextChar==quote)
+			/* Carry the incomplete record over into the next chunk: */
+			carry.assign(buffer+cut,buffer+dataSize);
+			
+			if(cut==0)
 				{
-				result.push_back(nextChar);
-				nextChar=source->getChar();
+				delete[] buffer;
+				continue;
+				}
+			
+			ChunkQueue::Chunk chunk;
+			chunk.data=buffer;
+			chunk.dataSize=cut;
+			chunk.chunkIndex=chunkIndex;
+			chunk.firstRecordIndex=recordIndex;
+			++chunkIndex;
+			recordIndex+=numRecords;
+			
+			if(workers!=0)
+				{
+				/* Wait for room in the queue and hand the chunk to the worker threads: */
+				Threads::MutexCond::Lock queueLock(queue.queueCond);
+				while(queue.chunks.size()>=queue.maxQueueSize&&!queue.failed)
+					queue.queueCond.wait(queueLock);
+				if(queue.failed)
+					{
+					delete[] chunk.data;
+					break;
+					}
+				queue.chunks.push_back(chunk);
+				queue.queueCond.broadcast();
 				}
 			else
-				break;
+				{
+				/* Process the chunk immediately: */
+				queue.processChunk(chunk);
+				delete[] chunk.data;
+				if(queue.failed)
+					break;
+				}
 			}
 		}
-	else
+	catch(...)
 		{
-		/***********************
-		Read an unquoted string:
-		***********************/
-		
-		/* Skip characters until the next field separator, record separator, eof, or quote: */
-		while(nextChar!=fieldSeparator&&nextChar!=recordSeparator&&nextChar>=0&&nextChar!=quote)
+		/* Shut down the worker threads and re-throw the error: */
+		if(workers!=0)
 			{
-			result.push_back(nextChar);
-			nextChar=source->getChar();
+			{
+			Threads::MutexCond::Lock queueLock(queue.queueCond);
+			queue.finished=true;
+			queue.failed=true;
+			queue.queueCond.broadcast();
+			}
+			for(unsigned int i=0;i<numThreads;++i)
+				workers[i].join();
+			delete[] workers;
 			}
+		throw;
 		}
 	
-	/* Check the next character: */
-	if(nextChar==fieldSeparator)
+	/* Wait for the worker threads to process all queued chunks: */
+	if(workers!=0)
 		{
-		/* Start a new field: */
-		++fieldIndex;
-		}
-	else if(nextChar==recordSeparator||nextChar<0)
 		{
-		/* Record separator or eof start a new record: */
-		fieldIndex=0;
-		++recordIndex;
+		Threads::MutexCond::Lock queueLock(queue.queueCond);
+		queue.finished=true;
+		queue.queueCond.broadcast();
 		}
-	else
-		{
-		/* Signal a format error in the CSV source: */
-		throw FormatError(fieldIndex,recordIndex);
+		for(unsigned int i=0;i<numThreads;++i)
+			workers[i].join();
+		delete[] workers;
 		}
 	
-	return result;
+	/* Re-throw the exception of the earliest failed chunk with its original type: */
+	if(queue.failed)
+		queue.error->rethrow();
 	}
 
 /************************************************************************
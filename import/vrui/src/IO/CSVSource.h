@@ -1,7 +1,7 @@
 /***********************************************************************
 CSVSource - Class to read tabular data from input streams in generalized
 comma-separated value (CSV) format.
-Copyright (c) 2010-2011 Oliver Kreylos
+Copyright (c) 2010-2014 Oliver Kreylos
 
 This file is part of the I/O Support Library (IO).
 
@@ -23,6 +23,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IO_CSVSOURCE_INCLUDED
 #define IO_CSVSOURCE_INCLUDED
 
+#include <stddef.h>
+#include <ctype.h>
+#include <vector>
 #include <stdexcept>
 #include <IO/File.h>
 
@@ -46,23 +49,93 @@ class CSVSource
 		ConversionError(unsigned int fieldIndex,size_t recordIndex,const char* dataTypeName);
 		};
 	
-	/* Elements: */
+	class ChunkProcessor // Abstract base class for objects processing chunks of complete records in parallel
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~ChunkProcessor(void);
+		
+		/* Methods: */
+		virtual void processChunk(unsigned int chunkIndex,CSVSource& chunkSource) =0; // Reads all records from the given CSV source covering the chunk of the given index; called concurrently for different chunks from multiple threads
+		};
+	
 	private:
-	FilePtr source; // Data source for CSV source
+	struct ChunkQueue; // Structure holding state shared between the reader and the worker threads of parallel chunk processing
+	
+	/* Elements: */
+	FilePtr source; // Data source for CSV source, or null if the CSV source reads from a memory block
 	int fieldSeparator; // Character used to separate fields in a record; comma by default
 	int recordSeparator; // Character used to separate records; newline by default
 	int quote; // Character used to quote field contents; double quote by default
 	size_t recordIndex; // Zero-based index of the currently read record; increments before field read on the last field in a record returns
 	unsigned int fieldIndex; // Zero-based index of the currently read field; increments before field read returns; resets to zero before field read on the last field in a record returns
+	const char* blockPtr; // Pointer to the next unread character in the current block of source data
+	const char* blockEnd; // Pointer to the end of the current block of source data
+	std::vector<char> fieldBuffer; // Buffer to assemble fields that straddle the boundary between two blocks of source data
+	const char* fieldBegin; // Pointer to the first character of the most recently read raw field, excluding any enclosing quotes
+	const char* fieldEnd; // Pointer after the last character of the most recently read raw field, excluding any enclosing quotes
+	bool fieldQuoted; // Flag whether the most recently read raw field was enclosed in quotes
 	
 	/* Private methods: */
-	bool skipRestOfField(bool quoted,int nextChar); // Skips the rest of the current field starting with the given character; returns true if any characters were skipped; throws format error if the end of the field cannot be determined reliably
-	template <class ValueParam>
-	bool convertNumber(int& nextChar,ValueParam& value); // Converts characters in a field into a numeric value of the given type; returns false on conversion error
+	bool fillBlock(void) // Retrieves the next block of source data; returns false at the end of the source
+		{
+		if(source==0)
+			return false;
+		void* block;
+		size_t blockSize=source->readInBuffer(block);
+		blockPtr=static_cast<const char*>(block);
+		blockEnd=blockPtr+blockSize;
+		return blockSize!=0;
+		}
+	int getChar(void) // Returns the next character from the source data, or EOF (-1) at the end of the source
+		{
+		if(blockPtr==blockEnd&&!fillBlock())
+			return -1;
+		return (unsigned char)(*(blockPtr++));
+		}
+	bool isSpace(int c) const // Returns true if the given character is whitespace and not a separator
+		{
+		return isspace(c)&&c!=fieldSeparator&&c!=recordSeparator;
+		}
+	void finishField(int terminator) // Advances the field and record indices based on the character terminating the most recently read field; throws exception if the character is not a separator
+		{
+		if(terminator==fieldSeparator)
+			{
+			/* Start a new field: */
+			++fieldIndex;
+			}
+		else if(terminator==recordSeparator||terminator<0)
+			{
+			/* Record separator or eof start a new record: */
+			fieldIndex=0;
+			++recordIndex;
+			}
+		else
+			{
+			/* Signal a format error in the CSV source: */
+			throw FormatError(fieldIndex,recordIndex);
+			}
+		}
+	void readRawFieldSlow(void); // Reads the next raw field character by character into the field buffer
+	void readRawField(void) // Reads the next raw field and advances the field and record indices; throws exception if the end of the field cannot be determined reliably
+		{
+		/* Try reading the field directly from the current block of source data: */
+		if(!readRawFieldFast())
+			{
+			/* Fall back to assembling the field in the field buffer: */
+			readRawFieldSlow();
+			}
+		}
+	bool readRawFieldFast(void); // Reads the next raw field if it is entirely contained in the current block of source data; returns false without reading anything otherwise
 	
 	/* Constructors and destructors: */
 	public:
-	CSVSource(FilePtr sSource); // Creates a default CSV source for the given character source
+	CSVSource(FilePtr sSource); // Creates a default CSV source for the given character source; the CSV source reads from the character source in blocks
+	CSVSource(const void* data,size_t dataSize); // Creates a default CSV source reading from the given memory block, which must remain valid while the CSV source is in use
+	private:
+	CSVSource(const CSVSource& source); // Prohibit copy constructor
+	CSVSource& operator=(const CSVSource& source); // Prohibit assignment operator
+	public:
 	~CSVSource(void); // Destroys the CSV source
 	
 	/* Methods: */
@@ -92,7 +165,7 @@ class CSVSource
 		}
 	bool eof(void) const // Returns true when the entire character source was read
 		{
-		return source->eof();
+		return blockPtr==blockEnd&&(source==0||source->eof());
 		}
 	bool eor(void) const // Returns true when the last read field terminated a record; returns true before the first field is read
 		{
@@ -102,33 +175,23 @@ class CSVSource
 	/* Field reading methods: */
 	bool skipField(void) // Skips the current field; returns true if the field was non-empty after unquoting; throws exception if the end of the field cannot be determined reliably
 		{
-		/* Read the first character: */
-		int nextChar=source->getChar();
-		if(nextChar==quote)
-			{
-			/* Skip the opening quote: */
-			nextChar=source->getChar();
-			
-			/* Skip a quoted field: */
-			return skipRestOfField(true,nextChar);
-			}
-		else
-			{
-			/* Skip an unquoted field: */
-			return skipRestOfField(false,nextChar);
-			}
+		readRawField();
+		return fieldBegin!=fieldEnd;
 		}
 	void skipRecord(void) // Skips the rest of the current record
 		{
 		/* Simply skip fields until the field index resets to zero: */
 		do
 			{
-			skipField();
+			readRawField();
 			}
 		while(fieldIndex!=0);
 		}
 	template <class ValueParam>
 	ValueParam readField(void); // Reads the next field as the given data type; throws exception if the field contents cannot be fully converted, or the end of the field cannot be determined reliably
+	
+	/* Parallel record processing methods: */
+	void processChunks(ChunkProcessor& processor,unsigned int numThreads =0,size_t chunkSize =4*1024*1024); // Splits all remaining records into chunks of approximately the given size and processes them in parallel on the given number of threads (0: one thread per CPU); must be called at the beginning of a record; re-throws the exception thrown by the chunk processor for the earliest failing chunk, keeping CSVSource, ValueSource, and std::runtime_error exception types
 	};
 
 /**********************************************
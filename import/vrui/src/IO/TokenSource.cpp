@@ -23,9 +23,95 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <ctype.h>
 #include <string.h>
+#include <stdlib.h>
+#include <Misc/SizedTypes.h>
 
 namespace IO {
 
+namespace {
+
+/*************************************************************
+Helper function to convert decimal numbers without rounding:
+*************************************************************/
+
+const double exactPowersOfTen[23]=
+	{
+	1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,1.0e10,1.0e11,
+	1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,1.0e20,1.0e21,1.0e22
+	};
+
+bool convertExactDecimal(const char* token,const char* tokenEnd,double& value) // Converts a decimal number whose mantissa and power of ten are exactly representable as doubles; returns false if the token needs to be converted by strtod
+	{
+	const char* tPtr=token;
+	
+	/* Read a plus or minus sign: */
+	bool negate=*tPtr=='-';
+	if(*tPtr=='-'||*tPtr=='+')
+		++tPtr;
+	
+	/* Read the integral and fractional number parts into a single integer mantissa: */
+	Misc::UInt64 mantissa=0;
+	int numDigits=0;
+	int exponent=0;
+	bool haveDigit=false;
+	for(;*tPtr>='0'&&*tPtr<='9';++tPtr)
+		{
+		haveDigit=true;
+		mantissa=mantissa*10U+Misc::UInt64(*tPtr-'0');
+		if(mantissa!=0U&&++numDigits>15)
+			return false;
+		}
+	if(*tPtr=='.')
+		{
+		for(++tPtr;*tPtr>='0'&&*tPtr<='9';++tPtr)
+			{
+			haveDigit=true;
+			mantissa=mantissa*10U+Misc::UInt64(*tPtr-'0');
+			if(mantissa!=0U&&++numDigits>15)
+				return false;
+			--exponent;
+			}
+		}
+	if(!haveDigit)
+		return false;
+	
+	/* Read an optional exponent: */
+	if(*tPtr=='e'||*tPtr=='E')
+		{
+		++tPtr;
+		bool negateExponent=*tPtr=='-';
+		if(*tPtr=='-'||*tPtr=='+')
+			++tPtr;
+		if(!(*tPtr>='0'&&*tPtr<='9'))
+			return false;
+		int explicitExponent=0;
+		for(;*tPtr>='0'&&*tPtr<='9';++tPtr)
+			{
+			explicitExponent=explicitExponent*10+(*tPtr-'0');
+			if(explicitExponent>1000)
+				return false;
+			}
+		exponent+=negateExponent?-explicitExponent:explicitExponent;
+		}
+	
+	/* Bail out if the token has trailing characters or the power of ten is not exact: */
+	if(tPtr!=tokenEnd||exponent<-22||exponent>22)
+		return false;
+	
+	/* Scale the mantissa; with at most 15 digits, a single multiplication or division rounds correctly: */
+	value=double(mantissa);
+	if(exponent<0)
+		value/=exactPowersOfTen[-exponent];
+	else
+		value*=exactPowersOfTen[exponent];
+	if(negate)
+		value=-value;
+	
+	return true;
+	}
+
+}
+
 /****************************
 Methods of class TokenSource:
 ****************************/
@@ -258,6 +344,77 @@ const char* TokenSource::readNextToken(void)
 	return tokenBuffer;
 	}
 
+void TokenSource::readUnquotedToken(void)
+	{
+	/* Read a non-quoted token: */
+	tokenSize=0;
+	while(cc[lastChar]&TOKEN)
+		{
+		if(tokenSize>=tokenBufferSize)
+			resizeTokenBuffer();
+		tokenBuffer[tokenSize++]=lastChar;
+		lastChar=source->getChar();
+		}
+	
+	/* Terminate the token: */
+	tokenBuffer[tokenSize]='\0';
+	
+	/* Skip whitespace: */
+	while(cc[lastChar]&WHITESPACE)
+		lastChar=source->getChar();
+	}
+
+bool TokenSource::readInteger(long& value)
+	{
+	/* Punctuation and quoted strings are never integers: */
+	if(cc[lastChar]&(PUNCTUATION|QUOTE))
+		{
+		readNextToken();
+		return false;
+		}
+	
+	readUnquotedToken();
+	
+	/* Convert short decimal integers directly: */
+	const char* tPtr=tokenBuffer;
+	bool negate=*tPtr=='-';
+	if(*tPtr=='-'||*tPtr=='+')
+		++tPtr;
+	const char* digitsBegin=tPtr;
+	long result=0;
+	for(;*tPtr>='0'&&*tPtr<='9'&&tPtr-digitsBegin<9;++tPtr)
+		result=result*10+long(*tPtr-'0');
+	if(tPtr!=digitsBegin&&*tPtr=='\0')
+		{
+		value=negate?-result:result;
+		return true;
+		}
+	
+	/* Fall back to the standard library: */
+	char* endPtr=0;
+	value=strtol(tokenBuffer,&endPtr,10);
+	return tokenSize>0&&endPtr==tokenBuffer+tokenSize;
+	}
+
+bool TokenSource::readNumber(double& value)
+	{
+	/* Punctuation and quoted strings are never numbers: */
+	if(cc[lastChar]&(PUNCTUATION|QUOTE))
+		{
+		readNextToken();
+		return false;
+		}
+	
+	readUnquotedToken();
+	
+	/* Convert the token directly if possible, and fall back to the standard library otherwise: */
+	if(convertExactDecimal(tokenBuffer,tokenBuffer+tokenSize,value))
+		return true;
+	char* endPtr=0;
+	value=strtod(tokenBuffer,&endPtr);
+	return tokenSize>0&&endPtr==tokenBuffer+tokenSize;
+	}
+
 bool TokenSource::isToken(const char* token) const
 	{
 	return strcmp(tokenBuffer,token)==0;
@@ -53,6 +53,7 @@ class TokenSource
 	/* Private methods: */
 	void initCharacterClasses(void); // Initializes the character classes array
 	void resizeTokenBuffer(void); // Creates additional room in the token buffer
+	void readUnquotedToken(void); // Reads a sequence of non-whitespace and non-punctuation characters into the token buffer, then skips whitespace
 	
 	/* Constructors and destructors: */
 	public:
@@ -85,6 +86,8 @@ class TokenSource
 		{
 		return tokenBuffer;
 		}
+	bool readInteger(long& value); // Reads the next token and converts it to a decimal integer; returns false if the token is not an integer
+	bool readNumber(double& value); // Reads the next token and converts it to a floating-point number; returns false if the token is not a number
 	bool isToken(const char* token) const; // Returns true if the most recently read token matches the given string
 	bool isCaseToken(const char* token) const; // Returns true if the most recently read token matches the given string up to case
 	};
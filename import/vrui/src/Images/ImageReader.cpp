@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageReader - Abstract base class to read images from files in a variety
 of image file formats.
-Copyright (c) 2012-2013 Oliver Kreylos
+Copyright (c) 2012-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -22,8 +22,106 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Images/ImageReader.h>
 
+#include <string.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+
 namespace Images {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int convertChannelValue(unsigned int value,unsigned int numValueBits) // Converts a channel value of the given number of bits to 8 bits
+	{
+	if(numValueBits>=8U)
+		return value>>(numValueBits-8U);
+	else
+		return (value*255U)/((1U<<numValueBits)-1U);
+	}
+
+template <class ChannelParam,class ColorParam>
+inline
+void
+convertImage(
+	const ImageReader::ImageSpec& imageSpec,
+	const ChannelParam* buffer,
+	ColorParam* pixels)
+	{
+	/* Map the image's channels to the result's color channels: */
+	unsigned int numChannels=imageSpec.numChannels;
+	unsigned int colorChannels[3];
+	for(int i=0;i<3;++i)
+		colorChannels[i]=imageSpec.colorSpace==ImageReader::RGB?i:0;
+	
+	/* Convert all pixels: */
+	const ChannelParam* sPtr=buffer;
+	ColorParam* dPtr=pixels;
+	for(size_t i=size_t(imageSpec.size[0])*size_t(imageSpec.size[1]);i>0;--i,sPtr+=numChannels,++dPtr)
+		{
+		for(int j=0;j<3;++j)
+			(*dPtr)[j]=typename ColorParam::Scalar(convertChannelValue(sPtr[colorChannels[j]],imageSpec.channelSpecs[colorChannels[j]].numValueBits));
+		if(ColorParam::numComponents==4)
+			(*dPtr)[3]=imageSpec.hasAlpha?typename ColorParam::Scalar(convertChannelValue(sPtr[numChannels-1],imageSpec.channelSpecs[numChannels-1].numValueBits)):typename ColorParam::Scalar(255);
+		}
+	}
+
+template <class ImageParam>
+inline
+ImageParam
+readImage8(
+	ImageReader& reader,
+	const char* functionName)
+	{
+	/* Check that all image channels are unsigned integers in 8-bit or 16-bit fields: */
+	const ImageReader::ImageSpec& imageSpec=reader.getImageSpec();
+	unsigned int numFieldBits=imageSpec.channelSpecs[0].numFieldBits;
+	if(numFieldBits!=8U&&numFieldBits!=16U)
+		Misc::throwStdErr("Images::ImageReader::%s: Unsupported image channel format",functionName);
+	for(unsigned int i=0;i<imageSpec.numChannels;++i)
+		if(imageSpec.channelSpecs[i].valueType!=ImageReader::UnsignedInt||imageSpec.channelSpecs[i].numFieldBits!=numFieldBits)
+			Misc::throwStdErr("Images::ImageReader::%s: Unsupported image channel format",functionName);
+	
+	/* Create the result image: */
+	ImageParam result(imageSpec.size[0],imageSpec.size[1]);
+	
+	/* Read the image into an interleaved temporary buffer: */
+	size_t fieldSize=numFieldBits/8U;
+	size_t pixelSize=fieldSize*imageSpec.numChannels;
+	Misc::UInt8* buffer=new Misc::UInt8[size_t(imageSpec.size[0])*size_t(imageSpec.size[1])*pixelSize];
+	ImageReader::ImagePlane planes[4];
+	for(unsigned int i=0;i<imageSpec.numChannels;++i)
+		{
+		planes[i].basePtr=buffer+i*fieldSize;
+		planes[i].pixelStride=pixelSize;
+		planes[i].rowStride=imageSpec.size[0]*pixelSize;
+		}
+	try
+		{
+		reader.readNative(planes);
+		
+		/* Convert the temporary buffer to the result image: */
+		if(fieldSize==1)
+			convertImage(imageSpec,buffer,result.modifyPixels());
+		else
+			convertImage(imageSpec,reinterpret_cast<const Misc::UInt16*>(buffer),result.modifyPixels());
+		}
+	catch(...)
+		{
+		/* Clean up and re-throw the exception: */
+		delete[] buffer;
+		throw;
+		}
+	
+	/* Clean up and return the result image: */
+	delete[] buffer;
+	return result;
+	}
+
+}
+
 /****************************
 Methods of class ImageReader:
 ****************************/
@@ -49,4 +147,80 @@ ImageReader::~ImageReader(void)
 	delete[] imageSpec.channelSpecs;
 	}
 
+void ImageReader::setImageSpec(ImageReader::ColorSpace newColorSpace,bool newHasAlpha,unsigned int newNumChannels,ImageReader::ChannelValueType newValueType,unsigned int newNumFieldBits,unsigned int newNumValueBits)
+	{
+	imageSpec.colorSpace=newColorSpace;
+	imageSpec.hasAlpha=newHasAlpha;
+	
+	/* Re-create the channel specifications: */
+	if(imageSpec.numChannels!=newNumChannels)
+		{
+		delete[] imageSpec.channelSpecs;
+		imageSpec.channelSpecs=0;
+		imageSpec.numChannels=newNumChannels;
+		imageSpec.channelSpecs=new ChannelSpec[newNumChannels];
+		}
+	for(unsigned int i=0;i<newNumChannels;++i)
+		{
+		imageSpec.channelSpecs[i].valueType=newValueType;
+		imageSpec.channelSpecs[i].numFieldBits=newNumFieldBits;
+		imageSpec.channelSpecs[i].numValueBits=newNumValueBits;
+		}
+	}
+
+void ImageReader::copyRow(const void* row,unsigned int y,const ImageReader::ImagePlane imagePlanes[]) const
+	{
+	const Misc::UInt8* sPtr=static_cast<const Misc::UInt8*>(row);
+	
+	/* Calculate the interleaved pixel size: */
+	size_t pixelSize=0;
+	for(unsigned int i=0;i<imageSpec.numChannels;++i)
+		pixelSize+=getChannelFieldSize(i);
+	
+	/* Copy each channel separately: */
+	for(unsigned int i=0;i<imageSpec.numChannels;++i)
+		{
+		Misc::UInt8* dPtr=static_cast<Misc::UInt8*>(imagePlanes[i].basePtr)+ptrdiff_t(y)*imagePlanes[i].rowStride;
+		ptrdiff_t pixelStride=imagePlanes[i].pixelStride;
+		const Misc::UInt8* rPtr=sPtr;
+		switch(getChannelFieldSize(i))
+			{
+			case 1:
+				for(unsigned int x=imageSpec.size[0];x>0;--x,rPtr+=pixelSize,dPtr+=pixelStride)
+					*dPtr=*rPtr;
+				break;
+			
+			case 2:
+				for(unsigned int x=imageSpec.size[0];x>0;--x,rPtr+=pixelSize,dPtr+=pixelStride)
+					memcpy(dPtr,rPtr,2);
+				break;
+			
+			case 4:
+				for(unsigned int x=imageSpec.size[0];x>0;--x,rPtr+=pixelSize,dPtr+=pixelStride)
+					memcpy(dPtr,rPtr,4);
+				break;
+			
+			default:
+				{
+				size_t fieldSize=getChannelFieldSize(i);
+				for(unsigned int x=imageSpec.size[0];x>0;--x,rPtr+=pixelSize,dPtr+=pixelStride)
+					memcpy(dPtr,rPtr,fieldSize);
+				}
+			}
+		
+		/* Go to the next channel in the interleaved row: */
+		sPtr+=getChannelFieldSize(i);
+		}
+	}
+
+RGBImage ImageReader::readRGB8(void)
+	{
+	return readImage8<RGBImage>(*this,"readRGB8");
+	}
+
+RGBAImage ImageReader::readRGBA8(void)
+	{
+	return readImage8<RGBAImage>(*this,"readRGBA8");
+	}
+
 }
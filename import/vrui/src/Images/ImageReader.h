@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageReader - Abstract base class to read images from files in a variety
 of image file formats.
-Copyright (c) 2012-2013 Oliver Kreylos
+Copyright (c) 2012-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -85,8 +85,8 @@ class ImageReader
 	ImageSpec imageSpec; // Specification structure for the next image to be read from the file
 	
 	/* Protected methods: */
-	virtual ImagePlane* readSubImagePlanes(void) =0; // Reads an image and returns an array of one image plane descriptor per image component
-	virtual void releaseSubImagePlanes(ImagePlane* planes) =0; // Releases the image's planes after copying
+	void setImageSpec(ColorSpace newColorSpace,bool newHasAlpha,unsigned int newNumChannels,ChannelValueType newValueType,unsigned int newNumFieldBits,unsigned int newNumValueBits); // Sets the color layout of the next image to the given number of channels of identical format
+	void copyRow(const void* row,unsigned int y,const ImagePlane imagePlanes[]) const; // Copies a row of interleaved byte-aligned channel values into the given image planes at the given row index, counted from the bottom
 	
 	/* Constructors and destructors: */
 	public:
@@ -109,7 +109,11 @@ class ImageReader
 		{
 		return imageSpec;
 		}
-	virtual void readNative(const ImagePlane imagePlanes[]) =0; // Reads an image in its native format into caller-allocated image planes; planes must be of types and sizes compatible with native image format
+	size_t getChannelFieldSize(unsigned int channel) const // Returns the size of a value field in the given channel of the next image in bytes, rounded up to whole bytes
+		{
+		return (imageSpec.channelSpecs[channel].numFieldBits+7)/8;
+		}
+	virtual void readNative(const ImagePlane imagePlanes[]) =0; // Reads an image in its native format into caller-allocated image planes, one per image channel; planes must be of types and sizes compatible with native image format; value fields are stored in host byte order
 	RGBImage readRGB8(void); // Reads the image as an 8-bit RGB image
 	RGBAImage readRGBA8(void); // Reads the image as an 8-bit RGB with alpha image
 	};
@@ -0,0 +1,216 @@
+/***********************************************************************
+ImageReaderPNG - Class to read images from files in PNG format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImageReaderPNG.h>
+
+#include <Images/Config.h>
+
+#if IMAGES_CONFIG_HAVE_PNG
+
+#include <png.h>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace Images {
+
+namespace {
+
+/***************************************************************
+Helper functions to redirect PNG I/O to an IO::File data source:
+***************************************************************/
+
+void pngReadDataFunction(png_structp pngReadStruct,png_bytep buffer,png_size_t size)
+	{
+	/* Get the pointer to the IO::File object: */
+	IO::File* source=static_cast<IO::File*>(png_get_io_ptr(pngReadStruct));
+	
+	/* Read the requested number of bytes from the source, and let the source handle errors: */
+	source->read(buffer,size);
+	}
+
+void pngErrorFunction(png_structp pngReadStruct,png_const_charp errorMsg)
+	{
+	/* Throw an exception: */
+	throw std::runtime_error(errorMsg);
+	}
+
+void pngWarningFunction(png_structp pngReadStruct,png_const_charp warningMsg)
+	{
+	/* Ignore warnings */
+	}
+
+}
+
+/*******************************
+Methods of class ImageReaderPNG:
+*******************************/
+
+ImageReaderPNG::ImageReaderPNG(IO::FilePtr sFile)
+	:ImageReader(sFile),
+	 pngReadStruct(0),pngInfoStruct(0),
+	 numPasses(1),done(false)
+	{
+	/* Check for PNG file signature: */
+	unsigned char pngSignature[8];
+	file->read(pngSignature,8);
+	if(png_sig_cmp(pngSignature,0,8))
+		Misc::throwStdErr("Images::ImageReaderPNG: Illegal PNG file signature");
+	
+	/* Allocate the PNG library data structures: */
+	pngReadStruct=png_create_read_struct(PNG_LIBPNG_VER_STRING,0,pngErrorFunction,pngWarningFunction);
+	if(pngReadStruct==0)
+		Misc::throwStdErr("Images::ImageReaderPNG: Internal error in PNG library");
+	pngInfoStruct=png_create_info_struct(pngReadStruct);
+	if(pngInfoStruct==0)
+		{
+		png_destroy_read_struct(&pngReadStruct,0,0);
+		Misc::throwStdErr("Images::ImageReaderPNG: Internal error in PNG library");
+		}
+	
+	/* Initialize PNG I/O to read from the supplied data source: */
+	png_set_read_fn(pngReadStruct,file.getPointer(),pngReadDataFunction);
+	
+	try
+		{
+		/* Read PNG image header: */
+		png_set_sig_bytes(pngReadStruct,8);
+		png_read_info(pngReadStruct,pngInfoStruct);
+		png_uint_32 imageSize[2];
+		int elementSize;
+		int colorType;
+		png_get_IHDR(pngReadStruct,pngInfoStruct,&imageSize[0],&imageSize[1],&elementSize,&colorType,0,0,0);
+		
+		/* Expand palette images to RGB and packed greyscale images to 8 bits, but otherwise keep the native pixel format: */
+		if(colorType==PNG_COLOR_TYPE_PALETTE)
+			png_set_palette_to_rgb(pngReadStruct);
+		else if(colorType==PNG_COLOR_TYPE_GRAY&&elementSize<8)
+			png_set_expand_gray_1_2_4_to_8(pngReadStruct);
+		if(png_get_valid(pngReadStruct,pngInfoStruct,PNG_INFO_tRNS))
+			png_set_tRNS_to_alpha(pngReadStruct);
+		
+		#if __BYTE_ORDER==__LITTLE_ENDIAN
+		/* PNG files store 16-bit values in big endian order: */
+		if(elementSize==16)
+			png_set_swap(pngReadStruct);
+		#endif
+		
+		/* Let the PNG library de-interlace the image: */
+		numPasses=png_set_interlace_handling(pngReadStruct);
+		png_read_update_info(pngReadStruct,pngInfoStruct);
+		
+		/* Fill in the image specification: */
+		canvasSize[0]=imageSpec.size[0]=imageSize[0];
+		canvasSize[1]=imageSpec.size[1]=imageSize[1];
+		unsigned int numChannels=png_get_channels(pngReadStruct,pngInfoStruct);
+		unsigned int numBits=png_get_bit_depth(pngReadStruct,pngInfoStruct);
+		setImageSpec(numChannels>=3?RGB:Grayscale,numChannels==2||numChannels==4,numChannels,UnsignedInt,numBits,numBits);
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		png_destroy_read_struct(&pngReadStruct,&pngInfoStruct,0);
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::ImageReaderPNG: Caught exception \"%s\" while reading image header",err.what());
+		}
+	}
+
+ImageReaderPNG::~ImageReaderPNG(void)
+	{
+	/* Destroy the PNG library structures: */
+	png_destroy_read_struct(&pngReadStruct,&pngInfoStruct,0);
+	}
+
+bool ImageReaderPNG::eof(void) const
+	{
+	return done;
+	}
+
+void ImageReaderPNG::readNative(const ImageReader::ImagePlane imagePlanes[])
+	{
+	/* Check if the image can be read directly into the first image plane: */
+	size_t fieldSize=getChannelFieldSize(0);
+	bool direct=imageSpec.numChannels==1&&imagePlanes[0].pixelStride==ptrdiff_t(fieldSize)&&numPasses==1;
+	
+	/* Allocate a buffer for rows, or for the entire image in case of interlaced images: */
+	size_t rowSize=png_get_rowbytes(pngReadStruct,pngInfoStruct);
+	Misc::UInt8* buffer=0;
+	if(!direct)
+		buffer=new Misc::UInt8[numPasses>1?rowSize*imageSpec.size[1]:rowSize];
+	png_bytep* rowPointers=0;
+	
+	try
+		{
+		if(direct)
+			{
+			/* Read the image straight into the image plane, flipping it vertically: */
+			Misc::UInt8* rowPtr=static_cast<Misc::UInt8*>(imagePlanes[0].basePtr)+ptrdiff_t(imageSpec.size[1]-1)*imagePlanes[0].rowStride;
+			for(unsigned int y=0;y<imageSpec.size[1];++y,rowPtr-=imagePlanes[0].rowStride)
+				png_read_row(pngReadStruct,rowPtr,0);
+			}
+		else if(numPasses==1)
+			{
+			/* Read the image row by row and distribute each row into the image planes, flipping the image vertically: */
+			for(unsigned int y=imageSpec.size[1];y>0;--y)
+				{
+				png_read_row(pngReadStruct,buffer,0);
+				copyRow(buffer,y-1,imagePlanes);
+				}
+			}
+		else
+			{
+			/* Read the entire interlaced image: */
+			rowPointers=new png_bytep[imageSpec.size[1]];
+			for(unsigned int y=0;y<imageSpec.size[1];++y)
+				rowPointers[y]=buffer+y*rowSize;
+			png_read_image(pngReadStruct,rowPointers);
+			
+			/* Distribute the image's rows into the image planes, flipping the image vertically: */
+			for(unsigned int y=0;y<imageSpec.size[1];++y)
+				copyRow(rowPointers[y],imageSpec.size[1]-1-y,imagePlanes);
+			}
+		
+		/* Finish reading the image: */
+		png_read_end(pngReadStruct,0);
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		delete[] rowPointers;
+		delete[] buffer;
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::ImageReaderPNG::readNative: Caught exception \"%s\" while reading image",err.what());
+		}
+	
+	/* Clean up: */
+	delete[] rowPointers;
+	delete[] buffer;
+	
+	/* There can be only one image in a PNG file: */
+	done=true;
+	}
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/***********************************************************************
+ImageReaderPNG - Class to read images from files in PNG format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEREADERPNG_INCLUDED
+#define IMAGES_IMAGEREADERPNG_INCLUDED
+
+#include <Images/Config.h>
+
+#if IMAGES_CONFIG_HAVE_PNG
+
+#include <Images/ImageReader.h>
+
+/* Forward declarations: */
+struct png_struct_def;
+struct png_info_def;
+
+namespace Images {
+
+class ImageReaderPNG:public ImageReader
+	{
+	/* Elements: */
+	private:
+	png_struct_def* pngReadStruct; // Structure representing the state of the PNG image file inside the PNG library
+	png_info_def* pngInfoStruct; // Structure containing information about the image in the PNG image file
+	unsigned int numPasses; // Number of passes required to read an interlaced image
+	bool done; // Flag set after the only image in the image file has been read
+	
+	/* Constructors and destructors: */
+	public:
+	ImageReaderPNG(IO::FilePtr sFile); // Creates a PNG image reader for the given file
+	private:
+	ImageReaderPNG(const ImageReaderPNG& source); // Prohibit copy constructor
+	ImageReaderPNG& operator=(const ImageReaderPNG& source); // Prohibit assignment operator
+	public:
+	virtual ~ImageReaderPNG(void);
+	
+	/* Methods from ImageReader: */
+	virtual bool eof(void) const;
+	virtual void readNative(const ImageReader::ImagePlane imagePlanes[]);
+	};
+
+}
+
+#endif
+
+#endif
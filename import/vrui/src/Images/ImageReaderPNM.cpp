@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageReaderPNM - Class to read images from files in Portable aNyMap
 format.
-Copyright (c) 2013 Oliver Kreylos
+Copyright (c) 2013-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -50,9 +50,14 @@ inline
 void
 readASCII(
 	IO::ValueSource& source,
+	unsigned int maxValue,
 	const ImageReader::ImageSpec& imageSpec,
 	const ImageReader::ImagePlane imagePlanes[])
 	{
+	/* Check whether pixel values have to be stretched to the full range of the image's value bits: */
+	unsigned int rangeMax=(1U<<imageSpec.channelSpecs[0].numValueBits)-1U;
+	bool stretch=maxValue!=rangeMax;
+	
 	/* Convert image strides to multiples of pixel channel type: */
 	ptrdiff_t pixelStrides[3],rowStrides[3];
 	PixelChannelParam* rowPtrs[3];
@@ -79,7 +84,10 @@ readASCII(
 				{
 				/* Read the next pixel channel value from the ASCII file: */
 				skipComments(source);
-				*(pPtrs[i])=source.readUnsignedInteger();
+				unsigned int value=source.readUnsignedInteger();
+				if(stretch)
+					value=value<maxValue?(value*rangeMax)/maxValue:rangeMax;
+				*(pPtrs[i])=PixelChannelParam(value);
 				
 				/* Go to the next pixel in this channel: */
 				pPtrs[i]+=pixelStrides[i];
@@ -97,9 +105,14 @@ inline
 void
 readBinary(
 	IO::FilePtr file,
+	unsigned int maxValue,
 	const ImageReader::ImageSpec& imageSpec,
 	const ImageReader::ImagePlane imagePlanes[])
 	{
+	/* Check whether pixel values have to be stretched to the full range of the image's value bits: */
+	unsigned int rangeMax=(1U<<imageSpec.channelSpecs[0].numValueBits)-1U;
+	bool stretch=maxValue!=rangeMax;
+	
 	/* Convert image strides to multiples of pixel channel type: */
 	ptrdiff_t pixelStrides[3],rowStrides[3];
 	PixelChannelParam* rowPtrs[3];
@@ -128,6 +141,8 @@ readBinary(
 				{
 				/* Read the next pixel channel value from the binary file: */
 				*(pPtrs[i])=file->read<PixelChannelParam>();
+				if(stretch)
+					*(pPtrs[i])=PixelChannelParam(*(pPtrs[i])<maxValue?((unsigned int)(*(pPtrs[i]))*rangeMax)/maxValue:rangeMax);
 				
 				/* Go to the next pixel in this channel: */
 				pPtrs[i]+=pixelStrides[i];
@@ -179,11 +194,18 @@ ImageReaderPNM::ImageReaderPNM(IO::FilePtr sFile)
 		skipComments(header);
 		header.setWhitespace(""); // Disable all whitespace to read the last header field
 		maxValue=header.readUnsignedInteger();
+		if(maxValue==0U||maxValue>65535U)
+			Misc::throwStdErr("Images::ImageReaderPNM: Invalid maximal pixel value %u",maxValue);
 		}
 	
 	/* Read the single (whitespace) character separating the header from the image data: */
 	header.getChar();
 	
+	/* Calculate the number of bits needed to represent the maximal pixel component value: */
+	unsigned int numValueBits=1U;
+	while(numValueBits<16U&&(1U<<numValueBits)<=maxValue)
+		++numValueBits;
+	
 	/* Fill in the rest of the image specification: */
 	for(int i=0;i<2;++i)
 		canvasSize[i]=imageSpec.size[i];
@@ -212,14 +234,13 @@ ImageReaderPNM::ImageReaderPNM(IO::FilePtr sFile)
 				{
 				/* 8-bit channel width: */
 				imageSpec.channelSpecs[0].numFieldBits=8U;
-				imageSpec.channelSpecs[0].numValueBits=8U;
 				}
 			else
 				{
 				/* 16-bit channel width: */
 				imageSpec.channelSpecs[0].numFieldBits=16U;
-				imageSpec.channelSpecs[0].numValueBits=16U;
 				}
+			imageSpec.channelSpecs[0].numValueBits=numValueBits;
 			break;
 		
 		case '3': // ASCII RGB image
@@ -236,14 +257,13 @@ ImageReaderPNM::ImageReaderPNM(IO::FilePtr sFile)
 					{
 					/* 8-bit channel width: */
 					imageSpec.channelSpecs[i].numFieldBits=8U;
-					imageSpec.channelSpecs[i].numValueBits=8U;
 					}
 				else
 					{
 					/* 16-bit channel width: */
 					imageSpec.channelSpecs[i].numFieldBits=16U;
-					imageSpec.channelSpecs[i].numValueBits=16U;
 					}
+				imageSpec.channelSpecs[i].numValueBits=numValueBits;
 				}
 			break;
 			}
@@ -255,7 +275,7 @@ bool ImageReaderPNM::eof(void) const
 	return done;
 	}
 
-void ImageReaderPNM::readNative(ImageReader::ImagePlane imagePlanes[])
+void ImageReaderPNM::readNative(const ImageReader::ImagePlane imagePlanes[])
 	{
 	switch(imageType)
 		{
@@ -289,12 +309,12 @@ void ImageReaderPNM::readNative(ImageReader::ImagePlane imagePlanes[])
 			if(maxValue<256U)
 				{
 				/* Read 8-bit pixels: */
-				readASCII<Misc::UInt8>(image,imageSpec,imagePlanes);
+				readASCII<Misc::UInt8>(image,maxValue,imageSpec,imagePlanes);
 				}
 			else
 				{
 				/* Read 16-bit pixels: */
-				readASCII<Misc::UInt16>(image,imageSpec,imagePlanes);
+				readASCII<Misc::UInt16>(image,maxValue,imageSpec,imagePlanes);
 				}
 			break;
 			}
@@ -316,16 +336,19 @@ void ImageReaderPNM::readNative(ImageReader::ImagePlane imagePlanes[])
 		case '5': // Binary grayscale image
 		case '6': // Binary RGB image
 			{
+			/* Binary PNM files store multi-byte values in big endian order: */
+			file->setEndianness(Misc::BigEndian);
+			
 			/* Determine the native pixel size: */
 			if(maxValue<256U)
 				{
 				/* Read 8-bit pixels: */
-				readBinary<Misc::UInt8>(file,imageSpec,imagePlanes);
+				readBinary<Misc::UInt8>(file,maxValue,imageSpec,imagePlanes);
 				}
 			else
 				{
 				/* Read 16-bit pixels: */
-				readBinary<Misc::UInt16>(file,imageSpec,imagePlanes);
+				readBinary<Misc::UInt16>(file,maxValue,imageSpec,imagePlanes);
 				}
 			break;
 			}
@@ -1,7 +1,7 @@
 /***********************************************************************
 ImageReaderPNM - Class to read images from files in Portable aNyMap
 format.
-Copyright (c) 2013 Oliver Kreylos
+Copyright (c) 2013-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -41,7 +41,7 @@ class ImageReaderPNM:public ImageReader
 	
 	/* Methods from ImageReader: */
 	virtual bool eof(void) const;
-	virtual void readNative(ImageReader::ImagePlane imagePlanes[]);
+	virtual void readNative(const ImageReader::ImagePlane imagePlanes[]);
 	};
 
 }
@@ -0,0 +1,329 @@
+/***********************************************************************
+ImageReaderTIFF - Class to read images from files in TIFF format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImageReaderTIFF.h>
+
+#include <Images/Config.h>
+
+#if IMAGES_CONFIG_HAVE_TIFF
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <tiffio.h>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/ThrowStdErr.h>
+#include <IO/SeekableFilter.h>
+
+namespace Images {
+
+namespace {
+
+/*************************************************************
+Helper functions to read TIFF images from an IO::SeekableFile:
+*************************************************************/
+
+void tiffErrorFunction(const char* module,const char* fmt,va_list ap)
+	{
+	/* Throw an exception with the error message: */
+	char msg[1024];
+	vsnprintf(msg,sizeof(msg),fmt,ap);
+	throw std::runtime_error(msg);
+	}
+
+void tiffWarningFunction(const char* module,const char* fmt,va_list ap)
+	{
+	/* Ignore warnings */
+	}
+
+tsize_t tiffReadFunction(thandle_t handle,tdata_t buffer,tsize_t size)
+	{
+	IO::SeekableFile* source=static_cast<IO::SeekableFile*>(handle);
+	
+	/* Libtiff expects to always get the amount of data it wants: */
+	source->readRaw(buffer,size);
+	return size;
+	}
+
+tsize_t tiffWriteFunction(thandle_t handle,tdata_t buffer,tsize_t size)
+	{
+	/* Ignore silently */
+	return size;
+	}
+
+toff_t tiffSeekFunction(thandle_t handle,toff_t offset,int whence)
+	{
+	IO::SeekableFile* source=static_cast<IO::SeekableFile*>(handle);
+	
+	/* Seek to the requested position: */
+	switch(whence)
+		{
+		case SEEK_SET:
+			source->setReadPosAbs(offset);
+			break;
+		
+		case SEEK_CUR:
+			source->setReadPosRel(offset);
+			break;
+		
+		case SEEK_END:
+			source->setReadPosAbs(source->getSize()-offset);
+			break;
+		}
+	
+	return source->getReadPos();
+	}
+
+int tiffCloseFunction(thandle_t handle)
+	{
+	/* Ignore silently */
+	return 0;
+	}
+
+toff_t tiffSizeFunction(thandle_t handle)
+	{
+	IO::SeekableFile* source=static_cast<IO::SeekableFile*>(handle);
+	
+	return source->getSize();
+	}
+
+int tiffMapFileFunction(thandle_t handle,tdata_t* buffer,toff_t* size)
+	{
+	/* Ignore silently */
+	return -1;
+	}
+
+void tiffUnmapFileFunction(thandle_t handle,tdata_t buffer,toff_t size)
+	{
+	/* Ignore silently */
+	}
+
+/****************
+Helper functions:
+****************/
+
+inline void invertRow(Misc::UInt8* row,unsigned int width,size_t pixelSize,size_t fieldSize) // Inverts the first channel of each pixel in a row of interleaved unsigned integer values
+	{
+	for(unsigned int x=width;x>0;--x,row+=pixelSize)
+		for(size_t i=0;i<fieldSize;++i)
+			row[i]=~row[i];
+	}
+
+}
+
+/********************************
+Methods of class ImageReaderTIFF:
+********************************/
+
+void ImageReaderTIFF::readImageSpec(void)
+	{
+	/* Get the image size: */
+	uint32 width,height;
+	TIFFGetField(tiffFile,TIFFTAG_IMAGEWIDTH,&width);
+	TIFFGetField(tiffFile,TIFFTAG_IMAGELENGTH,&height);
+	canvasSize[0]=imageSpec.size[0]=width;
+	canvasSize[1]=imageSpec.size[1]=height;
+	
+	/* Get the image's pixel format: */
+	uint16 numBits,numSamples,sampleFormat,planarConfig,photometric;
+	TIFFGetFieldDefaulted(tiffFile,TIFFTAG_BITSPERSAMPLE,&numBits);
+	TIFFGetFieldDefaulted(tiffFile,TIFFTAG_SAMPLESPERPIXEL,&numSamples);
+	TIFFGetFieldDefaulted(tiffFile,TIFFTAG_SAMPLEFORMAT,&sampleFormat);
+	TIFFGetFieldDefaulted(tiffFile,TIFFTAG_PLANARCONFIG,&planarConfig);
+	if(!TIFFGetField(tiffFile,TIFFTAG_PHOTOMETRIC,&photometric))
+		photometric=numSamples>=3?PHOTOMETRIC_RGB:PHOTOMETRIC_MINISBLACK;
+	
+	/* Check if the image's pixel format can be represented natively: */
+	if(TIFFIsTiled(tiffFile))
+		Misc::throwStdErr("Images::ImageReaderTIFF: Tiled images are not supported");
+	if(numBits%8!=0||numBits>64)
+		Misc::throwStdErr("Images::ImageReaderTIFF: Unsupported number of bits per sample %u",(unsigned int)numBits);
+	ColorSpace colorSpace;
+	unsigned int numColorSamples;
+	if(photometric==PHOTOMETRIC_MINISBLACK||photometric==PHOTOMETRIC_MINISWHITE)
+		{
+		colorSpace=Grayscale;
+		numColorSamples=1;
+		}
+	else if(photometric==PHOTOMETRIC_RGB)
+		{
+		colorSpace=RGB;
+		numColorSamples=3;
+		}
+	else
+		Misc::throwStdErr("Images::ImageReaderTIFF: Unsupported photometric interpretation %u",(unsigned int)photometric);
+	if(numSamples<numColorSamples||numSamples>numColorSamples+1)
+		Misc::throwStdErr("Images::ImageReaderTIFF: Unsupported number of samples per pixel %u",(unsigned int)numSamples);
+	ChannelValueType valueType;
+	switch(sampleFormat)
+		{
+		case SAMPLEFORMAT_INT:
+			valueType=SignedInt;
+			break;
+		
+		case SAMPLEFORMAT_IEEEFP:
+			valueType=Float;
+			break;
+		
+		default:
+			valueType=UnsignedInt;
+		}
+	
+	/* Fill in the image specification: */
+	setImageSpec(colorSpace,numSamples>numColorSamples,numSamples,valueType,numBits,numBits);
+	planar=planarConfig==PLANARCONFIG_SEPARATE&&numSamples>1;
+	invert=photometric==PHOTOMETRIC_MINISWHITE&&valueType==UnsignedInt;
+	}
+
+ImageReaderTIFF::ImageReaderTIFF(IO::FilePtr sFile)
+	:ImageReader(sFile),
+	 seekableFile(file),
+	 tiffFile(0),
+	 planar(false),invert(false),done(false)
+	{
+	/* Check if the source file is seekable: */
+	if(seekableFile==0)
+		{
+		/* Create a seekable filter for the source file: */
+		seekableFile=new IO::SeekableFilter(file);
+		}
+	
+	/* Set the TIFF error handler: */
+	TIFFSetErrorHandler(tiffErrorFunction);
+	TIFFSetWarningHandler(tiffWarningFunction);
+	
+	try
+		{
+		/* Pretend to open the TIFF file and register the hook functions: */
+		tiffFile=TIFFClientOpen("TIFF image","rm",seekableFile.getPointer(),tiffReadFunction,tiffWriteFunction,tiffSeekFunction,tiffCloseFunction,tiffSizeFunction,tiffMapFileFunction,tiffUnmapFileFunction);
+		if(tiffFile==0)
+			throw std::runtime_error("Error while opening image");
+		
+		/* Read the specification of the first image: */
+		readImageSpec();
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		if(tiffFile!=0)
+			TIFFClose(tiffFile);
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::ImageReaderTIFF: Caught exception \"%s\" while reading image header",err.what());
+		}
+	}
+
+ImageReaderTIFF::~ImageReaderTIFF(void)
+	{
+	/* Close the TIFF file: */
+	TIFFClose(tiffFile);
+	}
+
+bool ImageReaderTIFF::eof(void) const
+	{
+	return done;
+	}
+
+void ImageReaderTIFF::readNative(const ImageReader::ImagePlane imagePlanes[])
+	{
+	unsigned int width=imageSpec.size[0];
+	unsigned int height=imageSpec.size[1];
+	size_t fieldSize=getChannelFieldSize(0);
+	size_t pixelSize=planar?fieldSize:fieldSize*imageSpec.numChannels;
+	
+	/* Check if the image can be read directly into the first image plane: */
+	bool direct=imageSpec.numChannels==1&&imagePlanes[0].pixelStride==ptrdiff_t(fieldSize);
+	
+	/* Allocate a row buffer: */
+	Misc::UInt8* buffer=direct?0:new Misc::UInt8[TIFFScanlineSize(tiffFile)];
+	
+	try
+		{
+		if(direct)
+			{
+			/* Read the image straight into the image plane, flipping it vertically: */
+			Misc::UInt8* rowPtr=static_cast<Misc::UInt8*>(imagePlanes[0].basePtr)+ptrdiff_t(height-1)*imagePlanes[0].rowStride;
+			for(unsigned int y=0;y<height;++y,rowPtr-=imagePlanes[0].rowStride)
+				{
+				if(TIFFReadScanline(tiffFile,rowPtr,y,0)<0)
+					throw std::runtime_error("Error while reading image");
+				if(invert)
+					invertRow(rowPtr,width,pixelSize,fieldSize);
+				}
+			}
+		else if(planar)
+			{
+			/* Read each image channel from its own plane, flipping the image vertically: */
+			for(unsigned int channel=0;channel<imageSpec.numChannels;++channel)
+				{
+				const ImagePlane& plane=imagePlanes[channel];
+				Misc::UInt8* rowPtr=static_cast<Misc::UInt8*>(plane.basePtr)+ptrdiff_t(height-1)*plane.rowStride;
+				for(unsigned int y=0;y<height;++y,rowPtr-=plane.rowStride)
+					{
+					if(TIFFReadScanline(tiffFile,buffer,y,channel)<0)
+						throw std::runtime_error("Error while reading image");
+					if(invert&&channel==0)
+						invertRow(buffer,width,pixelSize,fieldSize);
+					
+					/* Copy the channel row into the image plane: */
+					const Misc::UInt8* sPtr=buffer;
+					Misc::UInt8* dPtr=rowPtr;
+					for(unsigned int x=width;x>0;--x,sPtr+=fieldSize,dPtr+=plane.pixelStride)
+						memcpy(dPtr,sPtr,fieldSize);
+					}
+				}
+			}
+		else
+			{
+			/* Read the image row by row and distribute each row into the image planes, flipping the image vertically: */
+			for(unsigned int y=0;y<height;++y)
+				{
+				if(TIFFReadScanline(tiffFile,buffer,y,0)<0)
+					throw std::runtime_error("Error while reading image");
+				if(invert)
+					invertRow(buffer,width,pixelSize,fieldSize);
+				copyRow(buffer,height-1-y,imagePlanes);
+				}
+			}
+		
+		/* Advance to the next image in the file: */
+		if(TIFFReadDirectory(tiffFile))
+			readImageSpec();
+		else
+			done=true;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		delete[] buffer;
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::ImageReaderTIFF::readNative: Caught exception \"%s\" while reading image",err.what());
+		}
+	
+	/* Clean up: */
+	delete[] buffer;
+	}
+
+}
+
+#endif
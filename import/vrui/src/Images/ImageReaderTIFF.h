@@ -0,0 +1,68 @@
+/***********************************************************************
+ImageReaderTIFF - Class to read images from files in TIFF format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEREADERTIFF_INCLUDED
+#define IMAGES_IMAGEREADERTIFF_INCLUDED
+
+#include <Images/Config.h>
+
+#if IMAGES_CONFIG_HAVE_TIFF
+
+#include <IO/SeekableFile.h>
+#include <Images/ImageReader.h>
+
+/* Forward declarations: */
+struct tiff;
+
+namespace Images {
+
+class ImageReaderTIFF:public ImageReader
+	{
+	/* Elements: */
+	private:
+	IO::SeekableFilePtr seekableFile; // Seekable version of the image file required by the TIFF library
+	struct tiff* tiffFile; // Structure representing the state of the TIFF image file inside the TIFF library
+	bool planar; // Flag whether the next image stores each channel in a separate plane
+	bool invert; // Flag whether the next image's greyscale values need to be inverted
+	bool done; // Flag set after the last image in the image file has been read
+	
+	/* Private methods: */
+	void readImageSpec(void); // Reads the specification of the current image from the TIFF file
+	
+	/* Constructors and destructors: */
+	public:
+	ImageReaderTIFF(IO::FilePtr sFile); // Creates a TIFF image reader for the given file
+	private:
+	ImageReaderTIFF(const ImageReaderTIFF& source); // Prohibit copy constructor
+	ImageReaderTIFF& operator=(const ImageReaderTIFF& source); // Prohibit assignment operator
+	public:
+	virtual ~ImageReaderTIFF(void);
+	
+	/* Methods from ImageReader: */
+	virtual bool eof(void) const;
+	virtual void readNative(const ImageReader::ImagePlane imagePlanes[]);
+	};
+
+}
+
+#endif
+
+#endif
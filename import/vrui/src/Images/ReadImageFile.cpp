@@ -1,7 +1,7 @@
 /***********************************************************************
 ReadImageFile - Functions to read RGB images from a variety of file
 formats.
-Copyright (c) 2005-2011 Oliver Kreylos
+Copyright (c) 2005-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -35,6 +35,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Images/ReadPNGImage.h>
 #include <Images/ReadJPEGImage.h>
 #include <Images/ReadTIFFImage.h>
+#include <Images/ImageReaderPNM.h>
+#include <Images/ImageReaderPNG.h>
+#include <Images/ImageReaderTIFF.h>
 
 namespace Images {
 
@@ -206,6 +209,97 @@ RGBAImage readTransparentImageFile(const char* imageFileName)
 	return readTransparentImageFile(imageFileName,file);
 	}
 
+/***************************************************************
+Functions to create image readers for several supported formats:
+***************************************************************/
+
+bool canOpenImageReader(const char* imageFileName)
+	{
+	/* Try to determine image file format from file name extension: */
+	const char* ext=Misc::getExtension(imageFileName);
+	int extLen=strlen(ext);
+	if(strcasecmp(ext,".gz")==0)
+		{
+		/* Strip the gzip extension and try again: */
+		const char* gzExt=ext;
+		ext=Misc::getExtension(imageFileName,gzExt);
+		extLen=gzExt-ext;
+		}
+	
+	if(extLen==4
+	   &&ext[0]=='.'
+	   &&tolower(ext[1])=='p'
+	   &&(tolower(ext[2])=='g'
+	      ||tolower(ext[2])=='n'
+	      ||tolower(ext[2])=='p')
+	   &&tolower(ext[3])=='m') // It's a Portable AnyMap image
+		return true;
+	#if IMAGES_CONFIG_HAVE_PNG
+	else if(extLen==4&&strncasecmp(ext,".png",extLen)==0) // It's a PNG image
+		return true;
+	#endif
+	#if IMAGES_CONFIG_HAVE_TIFF
+	else if((extLen==4&&strncasecmp(ext,".tif",extLen)==0)||(extLen==5&&strncasecmp(ext,".tiff",extLen)==0)) // It's a TIFF image
+		return true;
+	#endif
+	else
+		return false;
+	}
+
+ImageReader* openImageReader(const char* imageFileName,IO::FilePtr file)
+	{
+	/* Try to determine image file format from file name extension: */
+	const char* ext=Misc::getExtension(imageFileName);
+	int extLen=strlen(ext);
+	if(strcasecmp(ext,".gz")==0)
+		{
+		/* Strip the gzip extension and try again: */
+		const char* gzExt=ext;
+		ext=Misc::getExtension(imageFileName,gzExt);
+		extLen=gzExt-ext;
+		}
+	
+	if(extLen==4
+	   &&ext[0]=='.'
+	   &&tolower(ext[1])=='p'
+	   &&(tolower(ext[2])=='g'
+	      ||tolower(ext[2])=='n'
+	      ||tolower(ext[2])=='p')
+	   &&tolower(ext[3])=='m') // It's a Portable AnyMap image
+		{
+		/* Create a PNM image reader for the given file: */
+		return new ImageReaderPNM(file);
+		}
+	#if IMAGES_CONFIG_HAVE_PNG
+	else if(extLen==4&&strncasecmp(ext,".png",extLen)==0) // It's a PNG image
+		{
+		/* Create a PNG image reader for the given file: */
+		return new ImageReaderPNG(file);
+		}
+	#endif
+	#if IMAGES_CONFIG_HAVE_TIFF
+	else if((extLen==4&&strncasecmp(ext,".tif",extLen)==0)||(extLen==5&&strncasecmp(ext,".tiff",extLen)==0)) // It's a TIFF image
+		{
+		/* Create a TIFF image reader for the given file: */
+		return new ImageReaderTIFF(file);
+		}
+	#endif
+	else
+		Misc::throwStdErr("Images::openImageReader: Unsupported image file type in image file name \"%s\"",imageFileName);
+	
+	/* Never reached; just to make compiler happy: */
+	return 0;
+	}
+
+ImageReader* openImageReader(const char* imageFileName)
+	{
+	/* Open the image file: */
+	IO::FilePtr file(IO::openFile(imageFileName));
+	
+	/* Call the general function: */
+	return openImageReader(imageFileName,file);
+	}
+
 namespace {
 
 /********************************************
@@ -1,7 +1,7 @@
 /***********************************************************************
 ReadImageFile - Functions to read RGB images from a variety of file
 formats.
-Copyright (c) 2005-2011 Oliver Kreylos
+Copyright (c) 2005-2014 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
 
@@ -27,6 +27,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Images/RGBImage.h>
 #include <Images/RGBAImage.h>
 
+/* Forward declarations: */
+namespace Images {
+class ImageReader;
+}
+
 namespace Images {
 
 bool canReadImageFileType(const char* imageFileName); // Returns true if the image reader supports the image's file type
@@ -37,6 +42,10 @@ RGBImage readImageFile(const char* imageFileName); // Ditto, but opens the given
 RGBAImage readTransparentImageFile(const char* imageFileName,IO::FilePtr file); // Reads an RGB image with alpha layer from an already-open file; auto-detects file format
 RGBAImage readTransparentImageFile(const char* imageFileName); // Ditto, but opens the given file itself
 
+bool canOpenImageReader(const char* imageFileName); // Returns true if the image's file type can be read in its native pixel format through an image reader
+ImageReader* openImageReader(const char* imageFileName,IO::FilePtr file); // Returns a new image reader reading images in their native pixel format from an already-open file; auto-detects file format
+ImageReader* openImageReader(const char* imageFileName); // Ditto, but opens the given file itself
+
 RGBAImage readCursorFile(const char* cursorFileName,IO::FilePtr file,unsigned int nominalSize,unsigned int* hotspot =0); // Reads an RGBA image from a cursor file in Xcursor format
 RGBAImage readCursorFile(const char* cursorFileName,unsigned int nominalSize,unsigned int* hotspot =0); // Reads an RGBA image from a cursor file in Xcursor format
 
@@ -55,6 +55,7 @@ void InlineNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		/* Load the external VRML file: */
 		std::string externalFileName=vrmlFile.getFullUrl(url.getValue(0));
 		SceneGraph::VRMLFile externalVrmlFile(externalFileName,Cluster::openFile(vrmlFile.getMultiplexer(),externalFileName.c_str()),vrmlFile.getNodeCreator(),vrmlFile.getMultiplexer());
+		externalVrmlFile.setUseCache(vrmlFile.getUseCache());
 		externalVrmlFile.parse(this);
 		}
 	else
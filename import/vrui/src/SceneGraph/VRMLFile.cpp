@@ -23,8 +23,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/VRMLFile.h>
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/StringPrintf.h>
+#include <Misc/StringMarshaller.h>
 #include <Misc/ThrowStdErr.h>
+#include <IO/OpenFile.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+#include <Cluster/OpenFile.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -38,14 +48,11 @@ namespace SceneGraph {
 namespace {
 
 /*************************************************************************
-Helper function to parse route statements (will move into VRMLFile class):
+Helper functions to parse route statements (will move into VRMLFile class):
 *************************************************************************/
 
-void parseRoute(VRMLFile& vrmlFile)
+void createRoute(VRMLFile& vrmlFile,const char* source,const char* sink)
 	{
-	/* Read the event source name: */
-	const char* source=vrmlFile.readNextToken();
-	
 	/* Split the event source into node name and field name: */
 	const char* periodPtr=0;
 	for(const char* sPtr=source;*sPtr!='\0';++sPtr)
@@ -70,14 +77,6 @@ void parseRoute(VRMLFile& vrmlFile)
 		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("unknown field \"%s\" in event source",periodPtr+1));
 		}
 	
-	/* Check the TO keyword: */
-	vrmlFile.readNextToken();
-	if(!vrmlFile.isToken("TO"))
-		throw VRMLFile::ParseError(vrmlFile,"missing TO keyword in route definition");
-		
-	/* Read the event sink name: */
-	const char* sink=vrmlFile.readNextToken();
-	
 	/* Split the event sink into node name and field name: */
 	periodPtr=0;
 	for(const char* sPtr=sink;*sPtr!='\0';++sPtr)
@@ -117,6 +116,55 @@ void parseRoute(VRMLFile& vrmlFile)
 	delete route;
 	}
 
+void parseRoute(VRMLFile& vrmlFile)
+	{
+	/* Read the event source name: */
+	std::string source=vrmlFile.readNextToken();
+	
+	/* Check the TO keyword: */
+	vrmlFile.readNextToken();
+	if(!vrmlFile.isToken("TO"))
+		throw VRMLFile::ParseError(vrmlFile,"missing TO keyword in route definition");
+	
+	/* Read the event sink name: */
+	std::string sink=vrmlFile.readNextToken();
+	
+	/* Create the route: */
+	createRoute(vrmlFile,source.c_str(),sink.c_str());
+	
+	/* Record the route in the binary cache: */
+	IO::File* cacheWriter=vrmlFile.getCacheWriter();
+	if(cacheWriter!=0)
+		{
+		vrmlFile.writeCacheTag(VRMLFile::CACHE_ROUTE);
+		Misc::writeCppString(source,*cacheWriter);
+		Misc::writeCppString(sink,*cacheWriter);
+		}
+	}
+
+std::string readCachedString(VRMLFile& vrmlFile)
+	{
+	/* Read the string's length and guard against corrupted caches: */
+	IO::File& cacheReader=*vrmlFile.getCacheReader();
+	unsigned int length=cacheReader.read<unsigned int>();
+	if(length>=1024U*1024U)
+		throw VRMLFile::ParseError(vrmlFile,"corrupted scene graph cache");
+	
+	/* Read the string's characters: */
+	std::string result(length,' ');
+	if(length>0U)
+		cacheReader.read<char>(&result[0],length);
+	return result;
+	}
+
+void readCachedRoute(VRMLFile& vrmlFile)
+	{
+	/* Read the event source and sink names and create the route: */
+	std::string source=readCachedString(vrmlFile);
+	std::string sink=readCachedString(vrmlFile);
+	createRoute(vrmlFile,source.c_str(),sink.c_str());
+	}
+
 /********************************************************************
 Helper functions to parse floating-point values and component arrays:
 ********************************************************************/
@@ -127,18 +175,8 @@ ScalarParam
 parseFloatingPoint(
 	VRMLFile& vrmlFile)
 	{
-	/* Read the next token: */
-	const char* token=vrmlFile.readNextToken();
-	
-	/* Convert it to floating-point: */
-	char* endPtr=0;
-	ScalarParam result=ScalarParam(strtod(token,&endPtr));
-	
-	/* Ensure that the entire token was converted: */
-	if(endPtr!=token+vrmlFile.getTokenSize())
-		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid floating-point value",token));
-	
-	return result;
+	/* Convert the next token to floating-point: */
+	return ScalarParam(vrmlFile.readNumber());
 	}
 
 template <class ComponentArrayParam>
@@ -148,20 +186,9 @@ parseComponentArray(
 	ComponentArrayParam& value,
 	VRMLFile& vrmlFile)
 	{
-	/* Parse the components of the given component array: */
+	/* Parse the components of the given component array directly into the array: */
 	for(int i=0;i<ComponentArrayParam::dimension;++i)
-		{
-		/* Read the next token: */
-		const char* token=vrmlFile.readNextToken();
-		
-		/* Convert it to floating-point: */
-		char* endPtr=0;
-		value[i]=typename ComponentArrayParam::Scalar(strtod(token,&endPtr));
-		
-		/* Ensure that the entire token was converted: */
-		if(endPtr!=token+vrmlFile.getTokenSize())
-			throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid floating-point value",token));
-		}
+		value[i]=typename ComponentArrayParam::Scalar(vrmlFile.readNumber());
 	}
 
 /***********************************************************
@@ -169,7 +196,7 @@ Templatized helper class to parse values from token sources:
 ***********************************************************/
 
 template <class ValueParam>
-class ValueParser // Generic class to parse values from token sources
+class ValueParser // Generic class to parse values from token sources directly into value objects
 	{
 	};
 
@@ -178,16 +205,16 @@ class ValueParser<bool>
 	{
 	/* Methods: */
 	public:
-	static bool parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,bool& value)
 		{
 		/* Read the next token: */
 		vrmlFile.readNextToken();
 		
 		/* Parse the token's value: */
 		if(vrmlFile.isToken("TRUE"))
-			return true;
+			value=true;
 		else if(vrmlFile.isToken("FALSE"))
-			return false;
+			value=false;
 		else
 			throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid boolean value",vrmlFile.getToken()));
 		}
@@ -198,10 +225,10 @@ class ValueParser<std::string>
 	{
 	/* Methods: */
 	public:
-	static std::string parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,std::string& value)
 		{
 		/* Return the next token: */
-		return std::string(vrmlFile.readNextToken());
+		value=vrmlFile.readNextToken();
 		}
 	};
 
@@ -210,20 +237,10 @@ class ValueParser<int>
 	{
 	/* Methods: */
 	public:
-	static int parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,int& value)
 		{
-		/* Read the next token: */
-		const char* token=vrmlFile.readNextToken();
-		
-		/* Convert it to integer: */
-		char* endPtr=0;
-		int result=int(strtol(token,&endPtr,10));
-		
-		/* Ensure that the entire token was converted: */
-		if(endPtr!=token+vrmlFile.getTokenSize())
-			throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("%s is not a valid integer value",token));
-		
-		return result;
+		/* Convert the next token to integer: */
+		value=vrmlFile.readInteger();
 		}
 	};
 
@@ -232,9 +249,9 @@ class ValueParser<Scalar>
 	{
 	/* Methods: */
 	public:
-	static Scalar parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,Scalar& value)
 		{
-		return parseFloatingPoint<Scalar>(vrmlFile);
+		value=parseFloatingPoint<Scalar>(vrmlFile);
 		}
 	};
 
@@ -243,9 +260,9 @@ class ValueParser<double>
 	{
 	/* Methods: */
 	public:
-	static double parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,double& value)
 		{
-		return parseFloatingPoint<double>(vrmlFile);
+		value=parseFloatingPoint<double>(vrmlFile);
 		}
 	};
 
@@ -254,11 +271,9 @@ class ValueParser<Size>
 	{
 	/* Methods: */
 	public:
-	static Size parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,Size& value)
 		{
-		Size result;
-		parseComponentArray(result,vrmlFile);
-		return result;
+		parseComponentArray(value,vrmlFile);
 		}
 	};
 
@@ -267,11 +282,9 @@ class ValueParser<Geometry::Point<ScalarParam,3> >
 	{
 	/* Methods: */
 	public:
-	static Geometry::Point<ScalarParam,3> parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,Geometry::Point<ScalarParam,3>& value)
 		{
-		Geometry::Point<ScalarParam,3> result;
-		parseComponentArray(result,vrmlFile);
-		return result;
+		parseComponentArray(value,vrmlFile);
 		}
 	};
 
@@ -280,11 +293,9 @@ class ValueParser<Geometry::Vector<ScalarParam,3> >
 	{
 	/* Methods: */
 	public:
-	static Geometry::Vector<ScalarParam,3> parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,Geometry::Vector<ScalarParam,3>& value)
 		{
-		Geometry::Vector<ScalarParam,3> result;
-		parseComponentArray(result,vrmlFile);
-		return result;
+		parseComponentArray(value,vrmlFile);
 		}
 	};
 
@@ -293,7 +304,7 @@ class ValueParser<Rotation>
 	{
 	/* Methods: */
 	public:
-	static Rotation parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,Rotation& value)
 		{
 		/* Parse the rotation axis: */
 		Rotation::Vector axis;
@@ -303,7 +314,7 @@ class ValueParser<Rotation>
 		Rotation::Scalar angle=parseFloatingPoint<Rotation::Scalar>(vrmlFile);
 		
 		/* Return the rotation: */
-		return Rotation::rotateAxis(axis,angle);
+		value=Rotation::rotateAxis(axis,angle);
 		}
 	};
 
@@ -312,14 +323,11 @@ class ValueParser<GLColor<ScalarParam,numComponentsParam> >
 	{
 	/* Methods: */
 	public:
-	static GLColor<ScalarParam,numComponentsParam> parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,GLColor<ScalarParam,numComponentsParam>& value)
 		{
 		/* Parse the color's components: */
-		GLColor<ScalarParam,numComponentsParam> result;
 		for(int i=0;i<numComponentsParam;++i)
-			result[i]=parseFloatingPoint<ScalarParam>(vrmlFile);
-		
-		return result;
+			value[i]=parseFloatingPoint<ScalarParam>(vrmlFile);
 		}
 	};
 
@@ -328,22 +336,129 @@ class ValueParser<TexCoord>
 	{
 	/* Methods: */
 	public:
-	static TexCoord parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,TexCoord& value)
 		{
-		TexCoord result;
-		parseComponentArray(result,vrmlFile);
-		return result;
+		parseComponentArray(value,vrmlFile);
 		}
 	};
 
 template <>
 class ValueParser<NodePointer>
 	{
+	/* Private methods: */
+	private:
+	static void parseNodeFields(VRMLFile& vrmlFile,NodePointer& node) // Parses the fields of the given node from the VRML file
+		{
+		IO::File* cacheWriter=vrmlFile.getCacheWriter();
+		
+		/* Check for and skip the opening brace: */
+		vrmlFile.readNextToken();
+		if(!vrmlFile.isToken("{"))
+			throw VRMLFile::ParseError(vrmlFile,"Missing opening brace in node definition");
+		
+		while(!vrmlFile.eof()&&vrmlFile.peekc()!='}')
+			{
+			vrmlFile.readNextToken();
+			
+			if(vrmlFile.isToken("ROUTE"))
+				{
+				/* Parse a route statement: */
+				parseRoute(vrmlFile);
+				}
+			else
+				{
+				/* Record the field name in the binary cache: */
+				if(cacheWriter!=0)
+					{
+					vrmlFile.writeCacheTag(VRMLFile::CACHE_FIELD);
+					Misc::writeCppString(vrmlFile.getToken(),*cacheWriter);
+					}
+				
+				/* Parse a field value: */
+				node->parseField(vrmlFile.getToken(),vrmlFile);
+				}
+			}
+		
+		/* Check for and skip the closing brace: */
+		if(vrmlFile.eof())
+			throw VRMLFile::ParseError(vrmlFile,"Missing closing brace in node definition");
+		vrmlFile.readNextToken();
+		
+		/* Mark the end of the node's fields in the binary cache: */
+		if(cacheWriter!=0)
+			vrmlFile.writeCacheTag(VRMLFile::CACHE_END);
+		}
+	static void readCachedNodeFields(VRMLFile& vrmlFile,NodePointer& node) // Reads the fields of the given node from the binary cache
+		{
+		while(true)
+			{
+			int tag=vrmlFile.readCacheTag();
+			if(tag==VRMLFile::CACHE_END)
+				break;
+			else if(tag==VRMLFile::CACHE_ROUTE)
+				readCachedRoute(vrmlFile);
+			else if(tag==VRMLFile::CACHE_FIELD)
+				{
+				/* Read the field value: */
+				std::string fieldName=readCachedString(vrmlFile);
+				node->parseField(fieldName.c_str(),vrmlFile);
+				}
+			else
+				throw VRMLFile::ParseError(vrmlFile,"Corrupted scene graph cache");
+			}
+		}
+	static void readCachedNode(VRMLFile& vrmlFile,NodePointer& value) // Reads a node or route record from the binary cache
+		{
+		int tag=vrmlFile.readCacheTag();
+		if(tag==VRMLFile::CACHE_ROUTE)
+			{
+			/* Read a route statement: */
+			readCachedRoute(vrmlFile);
+			}
+		else if(tag==VRMLFile::CACHE_USE)
+			{
+			/* Retrieve a named node from the VRML file: */
+			value=vrmlFile.useNode(readCachedString(vrmlFile).c_str());
+			}
+		else if(tag==VRMLFile::CACHE_NODE)
+			{
+			/* Read the optional node name and the node type name: */
+			std::string defName=readCachedString(vrmlFile);
+			std::string typeName=readCachedString(vrmlFile);
+			
+			if(typeName!="NULL")
+				{
+				/* Create the result node: */
+				if((value=vrmlFile.createNode(typeName.c_str()))==0)
+					throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("Unknown node type %s",typeName.c_str()));
+				
+				/* Read the node's fields and finalize the node: */
+				readCachedNodeFields(vrmlFile,value);
+				value->update();
+				}
+			
+			if(!defName.empty())
+				{
+				/* Store the named node in the VRML file: */
+				vrmlFile.defineNode(defName.c_str(),value);
+				}
+			}
+		else
+			throw VRMLFile::ParseError(vrmlFile,"Corrupted scene graph cache");
+		}
+	
 	/* Methods: */
 	public:
-	static NodePointer parseValue(VRMLFile& vrmlFile)
+	static void parseValue(VRMLFile& vrmlFile,NodePointer& value)
 		{
-		NodePointer result;
+		/* Read the node from the binary cache if there is one: */
+		if(vrmlFile.getCacheReader()!=0)
+			{
+			readCachedNode(vrmlFile,value);
+			return;
+			}
+		
+		IO::File* cacheWriter=vrmlFile.getCacheWriter();
 		
 		/* Read the node type name: */
 		vrmlFile.readNextToken();
@@ -355,7 +470,14 @@ class ValueParser<NodePointer>
 		else if(vrmlFile.isToken("USE"))
 			{
 			/* Retrieve a named node from the VRML file: */
-			result=vrmlFile.useNode(vrmlFile.readNextToken());
+			value=vrmlFile.useNode(vrmlFile.readNextToken());
+			
+			/* Record the node reference in the binary cache: */
+			if(cacheWriter!=0)
+				{
+				vrmlFile.writeCacheTag(VRMLFile::CACHE_USE);
+				Misc::writeCppString(vrmlFile.getToken(),*cacheWriter);
+				}
 			}
 		else
 			{
@@ -370,50 +492,185 @@ class ValueParser<NodePointer>
 				vrmlFile.readNextToken();
 				}
 			
+			/* Record the node definition in the binary cache: */
+			if(cacheWriter!=0)
+				{
+				vrmlFile.writeCacheTag(VRMLFile::CACHE_NODE);
+				Misc::writeCppString(defName,*cacheWriter);
+				Misc::writeCppString(vrmlFile.getToken(),*cacheWriter);
+				}
+			
 			if(!vrmlFile.isToken("NULL"))
 				{
 				/* Create the result node: */
-				if((result=vrmlFile.createNode(vrmlFile.getToken()))==0)
+				if((value=vrmlFile.createNode(vrmlFile.getToken()))==0)
 					throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("Unknown node type %s",vrmlFile.getToken()));
 				
-				/* Check for and skip the opening brace: */
-				vrmlFile.readNextToken();
-				if(!vrmlFile.isToken("{"))
-					throw VRMLFile::ParseError(vrmlFile,"Missing opening brace in node definition");
-				
-				while(!vrmlFile.eof()&&vrmlFile.peekc()!='}')
-					{
-					vrmlFile.readNextToken();
-					
-					if(vrmlFile.isToken("ROUTE"))
-						{
-						/* Parse a route statement: */
-						parseRoute(vrmlFile);
-						}
-					else
-						{
-						/* Parse a field value: */
-						result->parseField(vrmlFile.getToken(),vrmlFile);
-						}
-					}
-				
-				/* Check for and skip the closing brace: */
-				if(vrmlFile.eof())
-					throw VRMLFile::ParseError(vrmlFile,"Missing closing brace in node definition");
-				vrmlFile.readNextToken();
+				/* Parse the node's fields: */
+				parseNodeFields(vrmlFile,value);
 				
 				/* Finalize the node: */
-				result->update();
+				value->update();
 				}
 			
 			if(!defName.empty())
 				{
 				/* Store the named node in the VRML file: */
-				vrmlFile.defineNode(defName.c_str(),result);
+				vrmlFile.defineNode(defName.c_str(),value);
 				}
 			}
-		
-		return result;
+		}
+	};
+
+/**************************************************************
+Templatized helper class to read and write values from and to
+binary scene graph caches:
+**************************************************************/
+
+template <class ValueParam>
+class CacheValue
+	{
+	};
+
+template <>
+class CacheValue<bool>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,bool& value)
+		{
+		value=file.read<unsigned char>()!=0;
+		}
+	static void write(IO::File& file,const bool& value)
+		{
+		file.write<unsigned char>(value?1:0);
+		}
+	};
+
+template <>
+class CacheValue<std::string>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,std::string& value)
+		{
+		value=Misc::readCppString(file);
+		}
+	static void write(IO::File& file,const std::string& value)
+		{
+		Misc::writeCppString(value,file);
+		}
+	};
+
+template <>
+class CacheValue<int>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,int& value)
+		{
+		value=int(file.read<Misc::SInt32>());
+		}
+	static void write(IO::File& file,const int& value)
+		{
+		file.write<Misc::SInt32>(Misc::SInt32(value));
+		}
+	};
+
+template <>
+class CacheValue<Scalar>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,Scalar& value)
+		{
+		file.read(value);
+		}
+	static void write(IO::File& file,const Scalar& value)
+		{
+		file.write(value);
+		}
+	};
+
+template <>
+class CacheValue<double>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,double& value)
+		{
+		file.read(value);
+		}
+	static void write(IO::File& file,const double& value)
+		{
+		file.write(value);
+		}
+	};
+
+template <class ComponentArrayParam>
+class ComponentArrayCacheValue // Helper class to read and write component arrays
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,ComponentArrayParam& value)
+		{
+		file.read(value.getComponents(),ComponentArrayParam::dimension);
+		}
+	static void write(IO::File& file,const ComponentArrayParam& value)
+		{
+		file.write(value.getComponents(),ComponentArrayParam::dimension);
+		}
+	};
+
+template <>
+class CacheValue<Size>:public ComponentArrayCacheValue<Size>
+	{
+	};
+
+template <class ScalarParam>
+class CacheValue<Geometry::Point<ScalarParam,3> >:public ComponentArrayCacheValue<Geometry::Point<ScalarParam,3> >
+	{
+	};
+
+template <class ScalarParam>
+class CacheValue<Geometry::Vector<ScalarParam,3> >:public ComponentArrayCacheValue<Geometry::Vector<ScalarParam,3> >
+	{
+	};
+
+template <>
+class CacheValue<TexCoord>:public ComponentArrayCacheValue<TexCoord>
+	{
+	};
+
+template <>
+class CacheValue<Rotation>
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,Rotation& value)
+		{
+		Rotation::Scalar q[4];
+		file.read(q,4);
+		value=Rotation(q);
+		}
+	static void write(IO::File& file,const Rotation& value)
+		{
+		file.write(value.getQuaternion(),4);
+		}
+	};
+
+template <class ScalarParam,int numComponentsParam>
+class CacheValue<GLColor<ScalarParam,numComponentsParam> >
+	{
+	/* Methods: */
+	public:
+	static void read(IO::File& file,GLColor<ScalarParam,numComponentsParam>& value)
+		{
+		file.read(value.getRgba(),numComponentsParam);
+		}
+	static void write(IO::File& file,const GLColor<ScalarParam,numComponentsParam>& value)
+		{
+		file.write(value.getRgba(),numComponentsParam);
 		}
 	};
 
@@ -437,8 +694,34 @@ class FieldParser<SF<ValueParam> >
 	public:
 	static void parseField(SF<ValueParam>& field,VRMLFile& vrmlFile)
 		{
-		/* Just read the field's value: */
-		field.setValue(ValueParser<ValueParam>::parseValue(vrmlFile));
+		ValueParam value;
+		if(vrmlFile.getCacheReader()!=0)
+			{
+			/* Read the field's value from the binary cache: */
+			CacheValue<ValueParam>::read(*vrmlFile.getCacheReader(),value);
+			}
+		else
+			{
+			/* Just read the field's value: */
+			ValueParser<ValueParam>::parseValue(vrmlFile,value);
+			
+			/* Record the field's value in the binary cache: */
+			if(vrmlFile.getCacheWriter()!=0)
+				CacheValue<ValueParam>::write(*vrmlFile.getCacheWriter(),value);
+			}
+		field.setValue(value);
+		}
+	};
+
+template <>
+class FieldParser<SF<NodePointer> >
+	{
+	/* Methods: */
+	public:
+	static void parseField(SF<NodePointer>& field,VRMLFile& vrmlFile)
+		{
+		/* Node fields are read and recorded node by node: */
+		vrmlFile.parseSFNode(field);
 		}
 	};
 
@@ -455,6 +738,22 @@ class FieldParser<MF<ValueParam> >
 		{
 		/* Clear the field: */
 		field.clearValues();
+		std::vector<ValueParam>& values=field.getValues();
+		
+		if(vrmlFile.getCacheReader()!=0)
+			{
+			/* Read the list of values from the binary cache in one go: */
+			IO::File& cacheReader=*vrmlFile.getCacheReader();
+			Misc::UInt32 numValues=cacheReader.read<Misc::UInt32>();
+			values.reserve(numValues);
+			for(Misc::UInt32 i=0;i<numValues;++i)
+				{
+				ValueParam value;
+				CacheValue<ValueParam>::read(cacheReader,value);
+				values.push_back(value);
+				}
+			return;
+			}
 		
 		/* Check for opening bracket: */
 		if(vrmlFile.peekc()=='[')
@@ -466,7 +765,9 @@ class FieldParser<MF<ValueParam> >
 			while(!vrmlFile.eof()&&vrmlFile.peekc()!=']')
 				{
 				/* Read a single value: */
-				field.appendValue(ValueParser<ValueParam>::parseValue(vrmlFile));
+				ValueParam value;
+				ValueParser<ValueParam>::parseValue(vrmlFile,value);
+				values.push_back(value);
 				}
 			
 			/* Skip the closing bracket: */
@@ -477,8 +778,31 @@ class FieldParser<MF<ValueParam> >
 		else
 			{
 			/* Read a single value: */
-			field.appendValue(ValueParser<ValueParam>::parseValue(vrmlFile));
+			ValueParam value;
+			ValueParser<ValueParam>::parseValue(vrmlFile,value);
+			values.push_back(value);
 			}
+		
+		/* Record the list of values in the binary cache: */
+		IO::File* cacheWriter=vrmlFile.getCacheWriter();
+		if(cacheWriter!=0)
+			{
+			cacheWriter->write<Misc::UInt32>(Misc::UInt32(values.size()));
+			for(typename std::vector<ValueParam>::const_iterator vIt=values.begin();vIt!=values.end();++vIt)
+				CacheValue<ValueParam>::write(*cacheWriter,*vIt);
+			}
+		}
+	};
+
+template <>
+class FieldParser<MF<NodePointer> >
+	{
+	/* Methods: */
+	public:
+	static void parseField(MF<NodePointer>& field,VRMLFile& vrmlFile)
+		{
+		/* Node fields are read and recorded node by node: */
+		vrmlFile.parseMFNode(field);
 		}
 	};
 
@@ -497,13 +821,137 @@ VRMLFile::ParseError::ParseError(const VRMLFile& vrmlFile,std::string error)
 Methods of class VRMLFile:
 *************************/
 
+namespace {
+
+/***************************************************
+Identifier at the beginning of binary cache files:
+***************************************************/
+
+const char* cacheMagic="SceneGraph VRML cache 1.0";
+
+bool getSourceStamp(const std::string& sourceUrl,std::string& sourceStamp) // Returns a string identifying the current version of the given VRML file; returns false if the file is not a local file
+	{
+	struct stat sourceStat;
+	if(stat(sourceUrl.c_str(),&sourceStat)!=0)
+		return false;
+	sourceStamp=Misc::stringPrintf("%llu:%lld",(unsigned long long)sourceStat.st_size,(long long)sourceStat.st_mtime);
+	return true;
+	}
+
+}
+
+std::string VRMLFile::getCacheFileName(void) const
+	{
+	return sourceUrl+".cache";
+	}
+
+bool VRMLFile::readCacheHeader(IO::File& cacheFile,std::string& sourceStamp)
+	{
+	/* Read and check the identifier, without trusting the length of a potentially foreign file: */
+	unsigned int magicLength=cacheFile.read<unsigned int>();
+	if(magicLength!=strlen(cacheMagic))
+		return false;
+	char magic[64];
+	cacheFile.read<char>(magic,magicLength);
+	if(memcmp(magic,cacheMagic,magicLength)!=0)
+		return false;
+	
+	/* Read the source file stamp: */
+	unsigned int stampLength=cacheFile.read<unsigned int>();
+	if(stampLength>=64)
+		return false;
+	char stamp[64];
+	cacheFile.read<char>(stamp,stampLength);
+	sourceStamp=std::string(stamp,stamp+stampLength);
+	
+	return true;
+	}
+
+void VRMLFile::openCache(void)
+	{
+	std::string cacheFileName=getCacheFileName();
+	
+	/* Check on the master node whether a binary cache matching the VRML file exists: */
+	bool master=multiplexer==0||multiplexer->isMaster();
+	std::string sourceStamp;
+	bool haveSourceStamp=false;
+	bool cacheValid=false;
+	if(master&&(haveSourceStamp=getSourceStamp(sourceUrl,sourceStamp)))
+		{
+		try
+			{
+			IO::FilePtr cacheFile=IO::openFile(cacheFileName.c_str());
+			cacheFile->setEndianness(Misc::LittleEndian);
+			std::string cacheStamp;
+			cacheValid=readCacheHeader(*cacheFile,cacheStamp)&&cacheStamp==sourceStamp;
+			}
+		catch(std::runtime_error)
+			{
+			/* Cache file does not exist or is truncated: */
+			cacheValid=false;
+			}
+		}
+	
+	/* Distribute the check result to all cluster nodes: */
+	if(multiplexer!=0)
+		{
+		Cluster::MulticastPipe pipe(multiplexer);
+		pipe.broadcast(cacheValid);
+		if(master)
+			pipe.flush();
+		}
+	
+	if(cacheValid)
+		{
+		/* Open the binary cache on all nodes and skip its header: */
+		cacheReader=Cluster::openFile(multiplexer,cacheFileName.c_str());
+		cacheReader->setEndianness(Misc::LittleEndian);
+		std::string cacheStamp;
+		readCacheHeader(*cacheReader,cacheStamp);
+		cacheTag=-1;
+		}
+	else if(haveSourceStamp)
+		{
+		/* Create a new binary cache on the master node; failure to do so is not an error: */
+		try
+			{
+			cacheWriter=IO::openFile((cacheFileName+".tmp").c_str(),IO::File::WriteOnly);
+			cacheWriter->setEndianness(Misc::LittleEndian);
+			Misc::writeCppString(std::string(cacheMagic),*cacheWriter);
+			Misc::writeCppString(sourceStamp,*cacheWriter);
+			}
+		catch(std::runtime_error)
+			{
+			cacheWriter=0;
+			}
+		}
+	}
+
+void VRMLFile::finishCache(void)
+	{
+	/* Mark the end of the top-level node list and close the binary cache: */
+	writeCacheTag(CACHE_END);
+	cacheWriter=0;
+	
+	/* Atomically replace any previous binary cache: */
+	std::string cacheFileName=getCacheFileName();
+	rename((cacheFileName+".tmp").c_str(),cacheFileName.c_str());
+	}
+
+void VRMLFile::throwNumberError(const char* valueType)
+	{
+	throw ParseError(*this,Misc::stringPrintf("%s is not a valid %s value",getToken(),valueType));
+	}
+
 VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer)
 	:IO::TokenSource(sSource),
 	 sourceUrl(sSourceUrl),
 	 nodeCreator(sNodeCreator),
 	 multiplexer(sMultiplexer),
 	 nodeMap(101),
-	 currentLine(1)
+	 currentLine(1),
+	 useCache(false),
+	 cacheTag(-1)
 	{
 	/* Initialize the token source: */
 	setWhitespace(',',true); // Comma is treated as whitespace
@@ -531,15 +979,48 @@ VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNode
 			urlPrefix=suIt+1;
 	}
 
+VRMLFile::~VRMLFile(void)
+	{
+	/* Remove an incomplete binary cache after a parse error: */
+	if(cacheWriter!=0)
+		{
+		cacheWriter=0;
+		unlink((getCacheFileName()+".tmp").c_str());
+		}
+	}
+
 void VRMLFile::parse(GroupNodePointer root)
 	{
-	/* Read nodes until end of file: */
-	while(!eof())
+	/* Check for an existing binary cache, or start a new one: */
+	if(useCache)
+		openCache();
+	
+	if(cacheReader!=0)
 		{
-		SF<GraphNodePointer> node;
-		parseSFNode(node);
-		if(node.getValue()!=0)
-			root->children.appendValue(node.getValue());
+		/* Read nodes until the end of the binary cache: */
+		while(peekCacheTag()!=CACHE_END)
+			{
+			SF<GraphNodePointer> node;
+			parseSFNode(node);
+			if(node.getValue()!=0)
+				root->children.appendValue(node.getValue());
+			}
+		cacheReader=0;
+		}
+	else
+		{
+		/* Read nodes until end of file: */
+		while(!eof())
+			{
+			SF<GraphNodePointer> node;
+			parseSFNode(node);
+			if(node.getValue()!=0)
+				root->children.appendValue(node.getValue());
+			}
+		
+		/* Complete the binary cache: */
+		if(cacheWriter!=0)
+			finishCache();
 		}
 	}
 
@@ -549,7 +1030,9 @@ VRMLFile::parseValue(
 	void)
 	{
 	/* Call on the templatized value parser helper class: */
-	return ValueParser<ValueParam>::parseValue(*this);
+	ValueParam result;
+	ValueParser<ValueParam>::parseValue(*this,result);
+	return result;
 	}
 
 template <class FieldParam>
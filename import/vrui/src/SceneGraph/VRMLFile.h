@@ -57,6 +57,15 @@ class VRMLFile:public IO::TokenSource
 		ParseError(const VRMLFile& vrmlFile,std::string error);
 		};
 	
+	enum CacheTag // Enumerated type for record tags in binary scene graph caches
+		{
+		CACHE_NODE=1, // Node definition, followed by optional DEF name, node type, and the node's fields
+		CACHE_USE, // Reference to a named node, followed by the node name
+		CACHE_ROUTE, // Route statement, followed by event source and event sink names
+		CACHE_FIELD, // Field value, followed by the field name and the field's value
+		CACHE_END // End of a node's fields or of a list of nodes
+		};
+	
 	friend class ParseError;
 	
 	/* Elements: */
@@ -67,6 +76,10 @@ class VRMLFile:public IO::TokenSource
 	Cluster::Multiplexer* multiplexer; // Pointer to a multicast pipe multiplexer when parsing VRML files in a cluster environment
 	NodeMap nodeMap; // Map of named nodes
 	size_t currentLine; // Number of currently processed line
+	bool useCache; // Flag whether parse() reads the scene graph from, or writes it to, a binary cache next to the VRML file
+	IO::FilePtr cacheReader; // Binary cache from which the scene graph is currently read instead of parsing the VRML file
+	IO::FilePtr cacheWriter; // Binary cache into which the scene graph is currently written while parsing the VRML file
+	int cacheTag; // Look-ahead record tag read from the cache reader, or -1
 	
 	/* Private methods: */
 	void skipExtendedWhitespace(void) // Skips over "extended" whitespace, i.e., line comments and newlines
@@ -97,9 +110,16 @@ class VRMLFile:public IO::TokenSource
 			}
 		}
 	
+	std::string getCacheFileName(void) const; // Returns the name of the binary cache file for the VRML file
+	static bool readCacheHeader(IO::File& cacheFile,std::string& sourceStamp); // Reads a binary cache file's header and the stamp of the VRML file it was created from; returns false if the file is not a binary cache
+	void openCache(void); // Opens a valid binary cache for reading, or a new one for writing
+	void finishCache(void); // Completes the binary cache currently being written
+	void throwNumberError(const char* valueType); // Throws a parse error for a token that is not a valid number
+	
 	/* Constructors and destructors: */
 	public:
 	VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer =0); // Creates a VRML parser for the given character source and node creator
+	~VRMLFile(void);
 	
 	/* Overloaded methods from IO::TokenSource: */
 	bool eof(void)
@@ -119,9 +139,58 @@ class VRMLFile:public IO::TokenSource
 		}
 	
 	/* Main method: */
+	bool getUseCache(void) const // Returns true if parse() uses a binary scene graph cache
+		{
+		return useCache;
+		}
+	void setUseCache(bool newUseCache) // Enables or disables reading and writing a binary scene graph cache in parse()
+		{
+		useCache=newUseCache;
+		}
 	void parse(GroupNodePointer root); // Adds top-level nodes from the VRML file to the given group node
 	
 	/* Methods called during parsing: */
+	int readInteger(void) // Reads the next token as a decimal integer
+		{
+		skipExtendedWhitespace();
+		long result;
+		if(!IO::TokenSource::readInteger(result))
+			throwNumberError("integer");
+		return int(result);
+		}
+	double readNumber(void) // Reads the next token as a floating-point number
+		{
+		skipExtendedWhitespace();
+		double result;
+		if(!IO::TokenSource::readNumber(result))
+			throwNumberError("floating-point");
+		return result;
+		}
+	IO::File* getCacheReader(void) // Returns the binary cache the scene graph is read from, or null if the VRML file is being parsed
+		{
+		return cacheReader.getPointer();
+		}
+	IO::File* getCacheWriter(void) // Returns the binary cache the scene graph is written to, or null
+		{
+		return cacheWriter.getPointer();
+		}
+	int peekCacheTag(void) // Returns the next record tag from the cache reader without consuming it
+		{
+		if(cacheTag<0)
+			cacheTag=cacheReader->getChar();
+		return cacheTag;
+		}
+	int readCacheTag(void) // Reads the next record tag from the cache reader
+		{
+		int result=peekCacheTag();
+		cacheTag=-1;
+		return result;
+		}
+	void writeCacheTag(CacheTag tag) // Writes a record tag to the cache writer
+		{
+		cacheWriter->putChar(tag);
+		}
+	
 	template <class ValueParam>
 	ValueParam parseValue(void); // Parses a value of the given type from the VRML file
 	template <class FieldParam>
@@ -145,8 +214,24 @@ class VRMLFile:public IO::TokenSource
 		/* Clear the field: */
 		field.clearValues();
 		
-		/* Check for opening bracket: */
-		if(peekc()=='[')
+		if(cacheReader!=0)
+			{
+			/* Read a list of nodes from the cache: */
+			while(peekCacheTag()!=CACHE_END)
+				{
+				/* Read a base-class node: */
+				NodePointer node=parseValue<NodePointer>();
+				
+				/* Check if the node type matches: */
+				if(node!=0&&dynamic_cast<typename NodePointerParam::Target*>(node.getPointer())==0)
+					throw ParseError(*this,"Mismatching node type");
+				
+				/* Set the field's node pointer: */
+				field.appendValue(node);
+				}
+			readCacheTag();
+			}
+		else if(peekc()=='[')
 			{
 			/* Skip the opening bracket: */
 			readNextToken();
@@ -182,6 +267,10 @@ class VRMLFile:public IO::TokenSource
 			/* Set the field's node pointer: */
 			field.appendValue(node);
 			}
+		
+		/* Mark the end of the node list in the cache: */
+		if(cacheWriter!=0)
+			writeCacheTag(CACHE_END);
 		}
 	NodeCreator& getNodeCreator(void) // Returns the VRML file's node creator
 		{
@@ -45,6 +45,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/MacOSX/InputDeviceAdapterHID.h>
 #endif
 #include <Vrui/Internal/InputDeviceAdapterPlayback.h>
+#include <Vrui/Internal/StartupTracer.h>
 
 #include <Vrui/InputDeviceManager.h>
 
@@ -145,6 +146,7 @@ void InputDeviceManager::initialize(const Misc::ConfigurationFileSection& config
 		
 		/* Determine input device adapter's type: */
 		std::string inputDeviceAdapterType=inputDeviceAdapterSection.retrieveString("./inputDeviceAdapterType");
+		StartupSpan adapterSpan((inputDeviceAdapterType+" input device adapter "+inputDeviceAdapterNames[i]).c_str());
 		bool typeFound=true;
 		try
 			{
@@ -1,7 +1,7 @@
 /***********************************************************************
 MultipipeDispatcher - Class to distribute input device and ancillary
 data between the nodes in a multipipe VR environment.
-Copyright (c) 2004-2013 Oliver Kreylos
+Copyright (c) 2004-2014 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,6 +23,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Internal/MultipipeDispatcher.h>
 
+#include <Misc/SizedTypes.h>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StringMarshaller.h>
 #include <Cluster/MulticastPipe.h>
@@ -35,23 +36,150 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Vrui {
 
+/**************************************************************
+Methods of class MultipipeDispatcher::InputDeviceTrackingState:
+**************************************************************/
+
+bool MultipipeDispatcher::InputDeviceTrackingState::operator!=(const MultipipeDispatcher::InputDeviceTrackingState& other) const
+	{
+	if(deviceRayDirection!=other.deviceRayDirection||deviceRayStart!=other.deviceRayStart)
+		return true;
+	if(translation!=other.translation)
+		return true;
+	for(int i=0;i<4;++i)
+		if(rotation[i]!=other.rotation[i])
+			return true;
+	return linearVelocity!=other.linearVelocity||angularVelocity!=other.angularVelocity;
+	}
+
 /************************************
 Methods of class MultipipeDispatcher:
 ************************************/
 
-MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe)
+void MultipipeDispatcher::getTrackingState(const InputDevice* device,MultipipeDispatcher::InputDeviceTrackingState& state) const
+	{
+	state.deviceRayDirection=device->getDeviceRayDirection();
+	state.deviceRayStart=device->getDeviceRayStart();
+	const TrackerState& transformation=device->getTransformation();
+	state.translation=transformation.getTranslation();
+	for(int i=0;i<4;++i)
+		state.rotation[i]=transformation.getRotation().getQuaternion()[i];
+	state.linearVelocity=device->getLinearVelocity();
+	state.angularVelocity=device->getAngularVelocity();
+	
+	if(quantizeTrackingStates)
+		{
+		/* Round all components to single precision, exactly as they will arrive on the slave nodes: */
+		for(int i=0;i<3;++i)
+			{
+			state.deviceRayDirection[i]=Scalar(float(state.deviceRayDirection[i]));
+			state.translation[i]=Scalar(float(state.translation[i]));
+			state.linearVelocity[i]=Scalar(float(state.linearVelocity[i]));
+			state.angularVelocity[i]=Scalar(float(state.angularVelocity[i]));
+			}
+		state.deviceRayStart=Scalar(float(state.deviceRayStart));
+		for(int i=0;i<4;++i)
+			state.rotation[i]=Scalar(float(state.rotation[i]));
+		}
+	}
+
+void MultipipeDispatcher::setTrackingState(InputDevice* device,const MultipipeDispatcher::InputDeviceTrackingState& state) const
+	{
+	device->setDeviceRay(state.deviceRayDirection,state.deviceRayStart);
+	TrackerState::Rotation rotation(state.rotation);
+	if(quantizeTrackingStates)
+		{
+		/* Renormalize the quantized rotation; all nodes do this identically: */
+		rotation.renormalize();
+		}
+	device->setTransformation(TrackerState(state.translation,rotation));
+	device->setLinearVelocity(state.linearVelocity);
+	device->setAngularVelocity(state.angularVelocity);
+	}
+
+void MultipipeDispatcher::writeTrackingState(const MultipipeDispatcher::InputDeviceTrackingState& state)
+	{
+	if(quantizeTrackingStates)
+		{
+		/* Write all components in single precision: */
+		float components[17];
+		float* cPtr=components;
+		for(int i=0;i<3;++i,++cPtr)
+			*cPtr=float(state.deviceRayDirection[i]);
+		*(cPtr++)=float(state.deviceRayStart);
+		for(int i=0;i<3;++i,++cPtr)
+			*cPtr=float(state.translation[i]);
+		for(int i=0;i<4;++i,++cPtr)
+			*cPtr=float(state.rotation[i]);
+		for(int i=0;i<3;++i,++cPtr)
+			*cPtr=float(state.linearVelocity[i]);
+		for(int i=0;i<3;++i,++cPtr)
+			*cPtr=float(state.angularVelocity[i]);
+		pipe->write<float>(components,17);
+		}
+	else
+		{
+		/* Write all components in full precision: */
+		pipe->write<Scalar>(state.deviceRayDirection.getComponents(),3);
+		pipe->write<Scalar>(state.deviceRayStart);
+		pipe->write<Scalar>(state.translation.getComponents(),3);
+		pipe->write<Scalar>(state.rotation,4);
+		pipe->write<Scalar>(state.linearVelocity.getComponents(),3);
+		pipe->write<Scalar>(state.angularVelocity.getComponents(),3);
+		}
+	}
+
+void MultipipeDispatcher::readTrackingState(MultipipeDispatcher::InputDeviceTrackingState& state)
+	{
+	if(quantizeTrackingStates)
+		{
+		/* Read all components in single precision: */
+		float components[17];
+		pipe->read<float>(components,17);
+		const float* cPtr=components;
+		for(int i=0;i<3;++i,++cPtr)
+			state.deviceRayDirection[i]=Scalar(*cPtr);
+		state.deviceRayStart=Scalar(*(cPtr++));
+		for(int i=0;i<3;++i,++cPtr)
+			state.translation[i]=Scalar(*cPtr);
+		for(int i=0;i<4;++i,++cPtr)
+			state.rotation[i]=Scalar(*cPtr);
+		for(int i=0;i<3;++i,++cPtr)
+			state.linearVelocity[i]=Scalar(*cPtr);
+		for(int i=0;i<3;++i,++cPtr)
+			state.angularVelocity[i]=Scalar(*cPtr);
+		}
+	else
+		{
+		/* Read all components in full precision: */
+		pipe->read<Scalar>(state.deviceRayDirection.getComponents(),3);
+		state.deviceRayStart=pipe->read<Scalar>();
+		pipe->read<Scalar>(state.translation.getComponents(),3);
+		pipe->read<Scalar>(state.rotation,4);
+		pipe->read<Scalar>(state.linearVelocity.getComponents(),3);
+		pipe->read<Scalar>(state.angularVelocity.getComponents(),3);
+		}
+	}
+
+MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe,bool sQuantizeTrackingStates)
 	:InputDeviceAdapter(sInputDeviceManager),
 	 pipe(sPipe),
 	 totalNumButtons(0),
 	 totalNumValuators(0),
+	 quantizeTrackingStates(sQuantizeTrackingStates),
 	 trackingStates(0),
 	 buttonStates(0),
-	 valuatorStates(0)
+	 valuatorStates(0),
+	 sendAllStates(true),
+	 deviceChangeMasks(0)
 	{
 	if(pipe->isMaster())
 		{
 		/* Distribute the input device configuration from the input device manager to all slave nodes: */
 		
+		/* Send the tracking state encoding: */
+		pipe->write<char>(quantizeTrackingStates?1:0);
+		
 		/* Send number of input devices: */
 		numInputDevices=inputDeviceManager->getNumInputDevices();
 		pipe->write<int>(numInputDevices);
@@ -101,6 +229,9 @@ MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager
 		
 		/* Receive the input device configuration from the master node: */
 		
+		/* Read the tracking state encoding: */
+		quantizeTrackingStates=pipe->read<char>()!=0;
+		
 		/* Read number of input devices: */
 		numInputDevices=pipe->read<int>();
 		inputDevices=new InputDevice*[numInputDevices];
@@ -151,6 +282,7 @@ MultipipeDispatcher::MultipipeDispatcher(InputDeviceManager* sInputDeviceManager
 	trackingStates=new InputDeviceTrackingState[numInputDevices];
 	buttonStates=new bool[totalNumButtons];
 	valuatorStates=new double[totalNumValuators];
+	deviceChangeMasks=new unsigned char[numInputDevices];
 	}
 
 MultipipeDispatcher::~MultipipeDispatcher(void)
@@ -165,6 +297,7 @@ MultipipeDispatcher::~MultipipeDispatcher(void)
 	delete[] trackingStates;
 	delete[] buttonStates;
 	delete[] valuatorStates;
+	delete[] deviceChangeMasks;
 	}
 
 std::string MultipipeDispatcher::getFeatureName(const InputDeviceFeature& feature) const
@@ -238,49 +371,129 @@ int MultipipeDispatcher::getFeatureIndex(InputDevice* device,const char* feature
 
 void MultipipeDispatcher::updateInputDevices(void)
 	{
+	/*********************************************************************
+	Input device states are sent as deltas against the states sent in the
+	previous frame: for each input device whose tracking, button, or
+	valuator state changed, the master sends the device's index, a bit
+	mask of changed state groups, and the new states of those groups.
+	The first update after construction sends the complete state of all
+	input devices.
+	*********************************************************************/
+	
 	if(pipe->isMaster())
 		{
-		/* Gather the current state of all input devices: */
+		/* Compare the current state of all input devices against the most recently sent states: */
+		int numChangedDevices=0;
 		bool* bsPtr=buttonStates;
 		double* vsPtr=valuatorStates;
 		for(int i=0;i<numInputDevices;++i)
 			{
-			trackingStates[i].deviceRayDirection=inputDevices[i]->getDeviceRayDirection();
-			trackingStates[i].deviceRayStart=inputDevices[i]->getDeviceRayStart();
-			trackingStates[i].transformation=inputDevices[i]->getTransformation();
-			trackingStates[i].linearVelocity=inputDevices[i]->getLinearVelocity();
-			trackingStates[i].angularVelocity=inputDevices[i]->getAngularVelocity();
-			for(int j=0;j<inputDevices[i]->getNumButtons();++j,++bsPtr)
-				*bsPtr=inputDevices[i]->getButtonState(j);
-			for(int j=0;j<inputDevices[i]->getNumValuators();++j,++vsPtr)
-				*vsPtr=inputDevices[i]->getValuator(j);
+			InputDevice* device=inputDevices[i];
+			unsigned char changeMask=0x0;
+			
+			InputDeviceTrackingState trackingState;
+			getTrackingState(device,trackingState);
+			if(sendAllStates||trackingState!=trackingStates[i])
+				{
+				trackingStates[i]=trackingState;
+				changeMask|=0x1;
+				}
+			for(int j=0;j<device->getNumButtons();++j,++bsPtr)
+				{
+				bool buttonState=device->getButtonState(j);
+				if(sendAllStates||buttonState!=*bsPtr)
+					{
+					*bsPtr=buttonState;
+					changeMask|=0x2;
+					}
+				}
+			for(int j=0;j<device->getNumValuators();++j,++vsPtr)
+				{
+				double valuatorState=device->getValuator(j);
+				if(sendAllStates||valuatorState!=*vsPtr)
+					{
+					*vsPtr=valuatorState;
+					changeMask|=0x4;
+					}
+				}
+			
+			deviceChangeMasks[i]=changeMask;
+			if(changeMask!=0x0)
+				++numChangedDevices;
+			}
+		sendAllStates=false;
+		
+		/* Send the states of all changed input devices to the slave nodes: */
+		pipe->write<Misc::UInt16>(Misc::UInt16(numChangedDevices));
+		bsPtr=buttonStates;
+		vsPtr=valuatorStates;
+		for(int i=0;i<numInputDevices;++i)
+			{
+			InputDevice* device=inputDevices[i];
+			if(deviceChangeMasks[i]!=0x0)
+				{
+				pipe->write<Misc::UInt16>(Misc::UInt16(i));
+				pipe->write<Misc::UInt8>(deviceChangeMasks[i]);
+				if(deviceChangeMasks[i]&0x1)
+					writeTrackingState(trackingStates[i]);
+				if(deviceChangeMasks[i]&0x2)
+					{
+					/* Send the device's button states packed into bytes: */
+					for(int j=0;j<device->getNumButtons();j+=8)
+						{
+						Misc::UInt8 buttonBits=0x0U;
+						for(int k=0;k<8&&j+k<device->getNumButtons();++k)
+							if(bsPtr[j+k])
+								buttonBits|=Misc::UInt8(0x1U<<k);
+						pipe->write<Misc::UInt8>(buttonBits);
+						}
+					}
+				if(deviceChangeMasks[i]&0x4)
+					pipe->write<double>(vsPtr,device->getNumValuators());
+				}
+			bsPtr+=device->getNumButtons();
+			vsPtr+=device->getNumValuators();
 			}
 		
-		/* Send the input device states to the slave nodes: */
-		pipe->write<InputDeviceTrackingState>(trackingStates,numInputDevices);
-		pipe->write<bool>(buttonStates,totalNumButtons);
-		pipe->write<double>(valuatorStates,totalNumValuators);
+		if(quantizeTrackingStates)
+			{
+			/* Apply the quantized tracking states to the master's input devices so that all nodes see identical states: */
+			for(int i=0;i<numInputDevices;++i)
+				setTrackingState(inputDevices[i],trackingStates[i]);
+			}
 		}
 	else
 		{
-		/* Receive the input device states from the master node: */
-		pipe->read<InputDeviceTrackingState>(trackingStates,numInputDevices);
-		pipe->read<bool>(buttonStates,totalNumButtons);
-		pipe->read<double>(valuatorStates,totalNumValuators);
-		
-		/* Set the state of all input devices: */
-		bool* bsPtr=buttonStates;
-		double* vsPtr=valuatorStates;
-		for(int i=0;i<numInputDevices;++i)
+		/* Receive the states of all changed input devices from the master node: */
+		int numChangedDevices=pipe->read<Misc::UInt16>();
+		for(int changeIndex=0;changeIndex<numChangedDevices;++changeIndex)
 			{
-			inputDevices[i]->setDeviceRay(trackingStates[i].deviceRayDirection,trackingStates[i].deviceRayStart);
-			inputDevices[i]->setTransformation(trackingStates[i].transformation);
-			inputDevices[i]->setLinearVelocity(trackingStates[i].linearVelocity);
-			inputDevices[i]->setAngularVelocity(trackingStates[i].angularVelocity);
-			for(int j=0;j<inputDevices[i]->getNumButtons();++j,++bsPtr)
-				inputDevices[i]->setButtonState(j,*bsPtr);
-			for(int j=0;j<inputDevices[i]->getNumValuators();++j,++vsPtr)
-				inputDevices[i]->setValuator(j,*vsPtr);
+			int i=pipe->read<Misc::UInt16>();
+			unsigned char changeMask=pipe->read<Misc::UInt8>();
+			InputDevice* device=inputDevices[i];
+			
+			if(changeMask&0x1)
+				{
+				/* Update the device's tracking state: */
+				readTrackingState(trackingStates[i]);
+				setTrackingState(device,trackingStates[i]);
+				}
+			if(changeMask&0x2)
+				{
+				/* Update the device's button states: */
+				for(int j=0;j<device->getNumButtons();j+=8)
+					{
+					Misc::UInt8 buttonBits=pipe->read<Misc::UInt8>();
+					for(int k=0;k<8&&j+k<device->getNumButtons();++k)
+						device->setButtonState(j+k,(buttonBits&(0x1U<<k))!=0x0U);
+					}
+				}
+			if(changeMask&0x4)
+				{
+				/* Update the device's valuator states: */
+				for(int j=0;j<device->getNumValuators();++j)
+					device->setValuator(j,pipe->read<double>());
+				}
 			}
 		}
 	}
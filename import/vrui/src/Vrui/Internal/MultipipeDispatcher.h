@@ -1,7 +1,7 @@
 /***********************************************************************
 MultipipeDispatcher - Class to distribute input device and ancillary
 data between the nodes in a multipipe VR environment.
-Copyright (c) 2004-2013 Oliver Kreylos
+Copyright (c) 2004-2014 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -51,9 +51,13 @@ class MultipipeDispatcher:public InputDeviceAdapter
 		public:
 		Vector deviceRayDirection;
 		Scalar deviceRayStart;
-		TrackerState transformation;
+		Vector translation; // Translation component of the input device's transformation
+		Scalar rotation[4]; // Rotation quaternion of the input device's transformation
 		Vector linearVelocity;
 		Vector angularVelocity;
+		
+		/* Methods: */
+		bool operator!=(const InputDeviceTrackingState& other) const; // Returns true if the two tracking states differ in any component
 		};
 	
 	/* Elements: */
@@ -61,19 +65,30 @@ class MultipipeDispatcher:public InputDeviceAdapter
 	Cluster::MulticastPipe* pipe; // Multicast pipe connecting the master node to all slave nodes
 	int totalNumButtons; // Total number of buttons on all dispatched input devices
 	int totalNumValuators; // Total number of valuators on all dispatched input devices
+	bool quantizeTrackingStates; // Flag whether tracking states are sent with single precision; master applies the quantized states to its own input devices to keep all nodes consistent
 	
 	/* Slave state: */
 	std::vector<std::string> buttonNames; // Array of button names for all dispatched input devices
 	std::vector<std::string> valuatorNames; // Array of button names for all dispatched input devices
 	
-	/* Transient state to marshall input device states over a multicast pipe: */
+	/* Input device states most recently sent over the multicast pipe (slaves only keep tracking states): */
 	InputDeviceTrackingState* trackingStates; // Array of input device tracking states
 	bool* buttonStates; // Array of input device button states
 	double* valuatorStates; // Array of input device valuator states
+	bool sendAllStates; // Flag whether the next update sends the complete state of all input devices instead of only changed states
+	
+	/* Transient state to encode input device state changes: */
+	unsigned char* deviceChangeMasks; // Array of bit masks of changed tracking (0x1), button (0x2), and valuator (0x4) states for each input device
+	
+	/* Private methods: */
+	void getTrackingState(const InputDevice* device,InputDeviceTrackingState& state) const; // Retrieves the given input device's tracking state, quantized if requested
+	void setTrackingState(InputDevice* device,const InputDeviceTrackingState& state) const; // Sets the given input device's tracking state
+	void writeTrackingState(const InputDeviceTrackingState& state); // Writes a tracking state to the multicast pipe
+	void readTrackingState(InputDeviceTrackingState& state); // Reads a tracking state from the multicast pipe
 	
 	/* Constructors and destructors: */
 	public:
-	MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe);
+	MultipipeDispatcher(InputDeviceManager* sInputDeviceManager,Cluster::MulticastPipe* sPipe,bool sQuantizeTrackingStates); // Creates a dispatcher; tracking state quantization flag is only used on the master node
 	virtual ~MultipipeDispatcher(void);
 	
 	/* Methods from InputDeviceAdapter: */
@@ -0,0 +1,253 @@
+/***********************************************************************
+StartupTracer - Class to record nested, timestamped spans during Vrui's
+startup procedure on all cluster nodes, and to write them into a single
+timeline file in Chrome's trace event format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/StartupTracer.h>
+
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <Misc/Time.h>
+#include <Cluster/MulticastPipe.h>
+
+namespace Vrui {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+void writeJsonString(FILE* file,const std::string& string) // Writes a string as a quoted JSON string
+	{
+	fputc('\"',file);
+	for(std::string::const_iterator sIt=string.begin();sIt!=string.end();++sIt)
+		{
+		if(*sIt=='\"'||*sIt=='\\')
+			{
+			fputc('\\',file);
+			fputc(*sIt,file);
+			}
+		else if(static_cast<unsigned char>(*sIt)<32U)
+			fprintf(file,"\\u%04x",int(static_cast<unsigned char>(*sIt)));
+		else
+			fputc(*sIt,file);
+		}
+	fputc('\"',file);
+	}
+
+std::string getNodeFileName(const char* traceFileName,int nodeIndex) // Returns the name of the temporary file holding a slave node's trace events
+	{
+	char suffix[32];
+	snprintf(suffix,sizeof(suffix),".node%d",nodeIndex);
+	std::string result=traceFileName;
+	result.append(suffix);
+	return result;
+	}
+
+}
+
+/******************************
+Methods of class StartupTracer:
+******************************/
+
+double StartupTracer::getTime(void)
+	{
+	Misc::Time now=Misc::Time::now();
+	return double(now.tv_sec)+double(now.tv_nsec)*1.0e-9;
+	}
+
+void StartupTracer::writeEvents(FILE* file,int nodeIndex,bool& firstEvent) const
+	{
+	/* Name the node's timeline after the node's index and host name: */
+	char hostName[256];
+	if(gethostname(hostName,sizeof(hostName))!=0)
+		hostName[0]='\0';
+	hostName[sizeof(hostName)-1]='\0';
+	char nodeName[320];
+	if(nodeIndex==0)
+		snprintf(nodeName,sizeof(nodeName),"Master (%s)",hostName);
+	else
+		snprintf(nodeName,sizeof(nodeName),"Slave %d (%s)",nodeIndex,hostName);
+	if(!firstEvent)
+		fprintf(file,",\n");
+	fprintf(file,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":",nodeIndex);
+	writeJsonString(file,nodeName);
+	fprintf(file,"}},\n");
+	fprintf(file,"{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"sort_index\":%d}}",nodeIndex,nodeIndex);
+	firstEvent=false;
+	
+	/* Write all events in microseconds relative to the master's timeline origin: */
+	for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+		{
+		double ts=(eIt->time+clockOffset-masterStartTime)*1.0e6;
+		if(!eIt->name.empty())
+			{
+			fprintf(file,",\n{\"name\":");
+			writeJsonString(file,eIt->name);
+			fprintf(file,",\"ph\":\"B\",\"pid\":%d,\"tid\":0,\"ts\":%.3f}",nodeIndex,ts);
+			}
+		else
+			fprintf(file,",\n{\"ph\":\"E\",\"pid\":%d,\"tid\":0,\"ts\":%.3f}",nodeIndex,ts);
+		}
+	}
+
+StartupTracer::StartupTracer(void)
+	:startTime(getTime()),
+	 active(true),
+	 spanDepth(0),
+	 clockOffset(0.0),
+	 masterStartTime(startTime)
+	{
+	}
+
+void StartupTracer::beginSpan(const char* name)
+	{
+	if(!active)
+		return;
+	
+	Event event;
+	event.name=name!=0&&name[0]!='\0'?name:"(unnamed)";
+	event.time=getTime();
+	events.push_back(event);
+	++spanDepth;
+	}
+
+void StartupTracer::endSpan(void)
+	{
+	if(!active||spanDepth==0)
+		return;
+	
+	Event event;
+	event.time=getTime();
+	events.push_back(event);
+	--spanDepth;
+	}
+
+void StartupTracer::synchronize(Cluster::MulticastPipe& pipe)
+	{
+	/*********************************************************************
+	All nodes leave a barrier at nearly the same time, so the differences
+	between the master's and each slave's clocks at that point estimate
+	the clock offsets. Use the median of several rounds to reject
+	outliers caused by scheduling hiccups.
+	*********************************************************************/
+	
+	const int numRounds=5;
+	double offsets[numRounds];
+	for(int round=0;round<numRounds;++round)
+		{
+		pipe.barrier();
+		double localTime=getTime();
+		double masterTime=localTime;
+		pipe.broadcast<double>(masterTime);
+		if(pipe.isMaster())
+			pipe.flush();
+		offsets[round]=masterTime-localTime;
+		}
+	std::sort(offsets,offsets+numRounds);
+	clockOffset=offsets[numRounds/2];
+	
+	/* Distribute the master's timeline origin: */
+	masterStartTime=startTime;
+	pipe.broadcast<double>(masterStartTime);
+	if(pipe.isMaster())
+		pipe.flush();
+	}
+
+void StartupTracer::finish(Cluster::MulticastPipe* pipe,const char* traceFileName)
+	{
+	if(!active)
+		return;
+	
+	/* Close all open spans and stop recording: */
+	while(spanDepth>0)
+		endSpan();
+	active=false;
+	
+	if(traceFileName==0||traceFileName[0]=='\0')
+		return;
+	
+	if(pipe!=0&&!pipe->isMaster())
+		{
+		/* Write this node's events to a temporary file next to the trace file for the master to collect: */
+		std::string nodeFileName=getNodeFileName(traceFileName,pipe->getNodeIndex());
+		FILE* nodeFile=fopen(nodeFileName.c_str(),"w");
+		if(nodeFile!=0)
+			{
+			bool firstEvent=true;
+			writeEvents(nodeFile,pipe->getNodeIndex(),firstEvent);
+			fclose(nodeFile);
+			}
+		else
+			std::cerr<<"Vrui: Unable to write startup trace file "<<nodeFileName<<std::endl;
+		
+		/* Signal the master that the file is complete: */
+		pipe->barrier();
+		}
+	else
+		{
+		/* Wait for all slaves to write their events: */
+		if(pipe!=0)
+			pipe->barrier();
+		
+		FILE* traceFile=fopen(traceFileName,"w");
+		if(traceFile==0)
+			{
+			std::cerr<<"Vrui: Unable to write startup trace file "<<traceFileName<<std::endl;
+			return;
+			}
+		
+		/* Write the master's events: */
+		fprintf(traceFile,"{\"traceEvents\":[\n");
+		bool firstEvent=true;
+		writeEvents(traceFile,0,firstEvent);
+		
+		if(pipe!=0)
+			{
+			/* Append the events of all slaves: */
+			for(unsigned int nodeIndex=1;nodeIndex<pipe->getNumNodes();++nodeIndex)
+				{
+				std::string nodeFileName=getNodeFileName(traceFileName,nodeIndex);
+				FILE* nodeFile=fopen(nodeFileName.c_str(),"r");
+				if(nodeFile==0)
+					{
+					std::cerr<<"Vrui: Missing startup trace of node "<<nodeIndex<<"; startup trace file must be on a file system shared by all cluster nodes"<<std::endl;
+					continue;
+					}
+				fprintf(traceFile,",\n");
+				char buffer[4096];
+				size_t readSize;
+				while((readSize=fread(buffer,1,sizeof(buffer),nodeFile))>0)
+					fwrite(buffer,1,readSize,traceFile);
+				fclose(nodeFile);
+				unlink(nodeFileName.c_str());
+				}
+			}
+		
+		fprintf(traceFile,"\n],\n\"displayTimeUnit\":\"ms\"}\n");
+		fclose(traceFile);
+		}
+	}
+
+}
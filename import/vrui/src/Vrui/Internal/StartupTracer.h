@@ -0,0 +1,95 @@
+/***********************************************************************
+StartupTracer - Class to record nested, timestamped spans during Vrui's
+startup procedure on all cluster nodes, and to write them into a single
+timeline file in Chrome's trace event format.
+Copyright (c) 2014 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_STARTUPTRACER_INCLUDED
+#define VRUI_INTERNAL_STARTUPTRACER_INCLUDED
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <Vrui/Vrui.h>
+
+/* Forward declarations: */
+namespace Cluster {
+class MulticastPipe;
+}
+
+namespace Vrui {
+
+class StartupTracer
+	{
+	/* Embedded classes: */
+	private:
+	struct Event // Structure for events beginning or ending a span
+		{
+		/* Elements: */
+		public:
+		std::string name; // Name of the span begun by the event; empty for end events
+		double time; // Wall clock time of the event in seconds on the local node's clock
+		};
+	
+	/* Elements: */
+	double startTime; // Wall clock time at which the tracer was created on the local node
+	bool active; // Flag whether the tracer is still recording events
+	int spanDepth; // Number of currently open spans
+	std::vector<Event> events; // List of recorded events
+	double clockOffset; // Offset from the local node's clock to the master node's clock in seconds
+	double masterStartTime; // Wall clock time at which the tracer was created on the master node, in the master node's clock
+	
+	/* Private methods: */
+	static double getTime(void); // Returns the current wall clock time in seconds
+	void writeEvents(FILE* file,int nodeIndex,bool& firstEvent) const; // Writes all recorded events as trace event records for the given cluster node
+	
+	/* Constructors and destructors: */
+	public:
+	StartupTracer(void); // Creates an active tracer; the tracer's creation time is the origin of the timeline
+	
+	/* Methods: */
+	bool isActive(void) const // Returns true if the tracer is still recording events
+		{
+		return active;
+		}
+	void beginSpan(const char* name); // Begins a new span nested inside the currently open span
+	void endSpan(void); // Ends the most recently begun span
+	void synchronize(Cluster::MulticastPipe& pipe); // Measures the offset from the local clock to the master's clock; must be called collectively on all cluster nodes
+	void finish(Cluster::MulticastPipe* pipe,const char* traceFileName); // Stops recording, closes all open spans, and writes the combined timeline of all cluster nodes to the given file on the master node if the file name is not empty; must be called collectively on all cluster nodes
+	};
+
+class StartupSpan // Helper class to record a span in Vrui's startup timeline covering the current scope
+	{
+	/* Constructors and destructors: */
+	public:
+	StartupSpan(const char* name)
+		{
+		beginStartupSpan(name);
+		}
+	~StartupSpan(void)
+		{
+		endStartupSpan();
+		}
+	};
+
+}
+
+#endif
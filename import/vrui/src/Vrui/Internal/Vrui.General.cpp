@@ -38,6 +38,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <unistd.h>
 #include <time.h>
 #include <iostream>
+#include <Misc/SizedTypes.h>
 #include <Misc/SelfDestructPointer.h>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StringPrintf.h>
@@ -86,6 +87,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/InputDeviceAdapterMouse.h>
 #include <Vrui/Internal/InputDeviceAdapterDeviceDaemon.h>
 #include <Vrui/Internal/MultipipeDispatcher.h>
+#include <Vrui/Internal/StartupTracer.h>
 #include <Vrui/LightsourceManager.h>
 #include <Vrui/ClipPlaneManager.h>
 #include <Vrui/Viewer.h>
@@ -442,9 +444,11 @@ VruiState::VruiState(Cluster::Multiplexer* sMultiplexer,Cluster::MulticastPipe*
 	 minimumFrameTime(0.0),nextFrameTime(0.0),
 	 synchFrameTime(0.0),synchWait(false),
 	 numRecentFrameTimes(0),recentFrameTimes(0),nextFrameTimeIndex(0),sortedFrameTimes(0),
+	 sharedStateBytes(0),sharedStateLatency(0.0),
 	 activeNavigationTool(0),
 	 mostRecentGUIInteractor(0),mostRecentHotSpot(displayCenter),
-	 updateContinuously(false)
+	 updateContinuously(false),
+	 pipelineRendering(false)
 	{
 	#if SAVESHAREDVRUISTATE
 	vruiSharedStateFile=IO::openFile("/tmp/VruiSharedState.dat",IO::File::WriteOnly);
@@ -529,6 +533,9 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		multiplexer->setPingTimeout(configFileSection.retrieveValue<double>("./multipipePingTimeout",10.0),configFileSection.retrieveValue<int>("./multipipePingRetries",3));
 		multiplexer->setReceiveWaitTimeout(configFileSection.retrieveValue<double>("./multipipeReceiveWaitTimeout",0.01));
 		multiplexer->setBarrierWaitTimeout(configFileSection.retrieveValue<double>("./multipipeBarrierWaitTimeout",0.01));
+		
+		/* Set the multiplexer's forward error correction parity group size: */
+		multiplexer->setFecGroupSize(configFileSection.retrieveValue<unsigned int>("./multipipeFecGroupSize",0));
 		}
 	
 	/* Initialize random number management: */
@@ -600,6 +607,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	inputDeviceManager=new InputDeviceManager(inputGraphManager);
 	if(master)
 		{
+		StartupSpan inputDeviceManagerSpan("InputDeviceManager::initialize");
 		inputDeviceManager->initialize(configFileSection);
 		
 		/* Check if the user wants to save input device data: */
@@ -617,7 +625,11 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	/* If in cluster mode, create a dispatcher to send input device states to the slaves: */
 	if(multiplexer!=0)
 		{
-		multipipeDispatcher=new MultipipeDispatcher(inputDeviceManager,pipe);
+		StartupSpan multipipeDispatcherSpan("Distributing input devices");
+		
+		/* Check whether input device tracking states should be sent in single precision: */
+		bool quantizeInputDeviceStates=configFileSection.retrieveValue<bool>("./quantizeInputDeviceStates",false);
+		multipipeDispatcher=new MultipipeDispatcher(inputDeviceManager,pipe,quantizeInputDeviceStates);
 		if(!master)
 			{
 			/* On slaves, multipipe dispatcher is owned by input device manager: */
@@ -656,6 +668,12 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	else
 		updateContinuously=true; // Slave nodes always run in continuous mode; they will block on updates from the master
 	
+	/* Check whether rendering should be pipelined with the next frame's update; must be the same on all nodes: */
+	pipelineRendering=configFileSection.retrieveValue<bool>("./pipelineRendering",pipelineRendering);
+	
+	/* Set the per-frame time budget for incremental initialization of expensive OpenGL objects: */
+	GLContextData::setInitTimeBudget(configFileSection.retrieveValue<double>("./glInitTimeBudget",GLContextData::getInitTimeBudget()));
+	
 	/* Initialize the light source manager: */
 	lightsourceManager=new LightsourceManager;
 	
@@ -745,7 +763,10 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	Misc::ConfigurationFileSection toolSection=configFileSection.getSection(configFileSection.retrieveString("./tools").c_str());
 	
 	/* Initialize tool manager: */
+	{
+	StartupSpan toolManagerSpan("ToolManager");
 	toolManager=new ToolManager(inputDeviceManager,toolSection);
+	}
 	
 	/* Register the tool destruction callback: */
 	toolManager->getToolDestructionCallbacks().add(this,&VruiState::toolDestructionCallback);
@@ -756,6 +777,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		Misc::ConfigurationFileSection visletSection=configFileSection.getSection(configFileSection.retrieveString("./vislets").c_str());
 		
 		/* Initialize vislet manager: */
+		StartupSpan visletManagerSpan("VisletManager");
 		visletManager=new VisletManager(visletSection);
 		}
 	catch(std::runtime_error err)
@@ -876,6 +898,8 @@ void VruiState::update(void)
 	*********************************************************************/
 	
 	double lastLastFrame=lastFrame;
+	double sharedStateStart=0.0;
+	size_t sharedStateStartBytes=0;
 	if(master)
 		{
 		/* Take an application timer snapshot: */
@@ -907,7 +931,13 @@ void VruiState::update(void)
 				}
 			}
 		if(multiplexer!=0)
+			{
+			/* Start measuring the shared state packet: */
+			sharedStateStart=appTime.peekTime();
+			sharedStateStartBytes=pipe->getNumBytes();
+			
 			pipe->write<double>(lastFrame);
+			}
 		
 		/* Update the Vrui application timer and the frame time history: */
 		recentFrameTimes[nextFrameTimeIndex]=lastFrame-lastLastFrame;
@@ -929,6 +959,10 @@ void VruiState::update(void)
 		}
 	else
 		{
+		/* Start measuring the shared state packet: */
+		sharedStateStart=appTime.peekTime();
+		sharedStateStartBytes=pipe->getNumBytes();
+		
 		/* Receive application time and current median frame time: */
 		pipe->read<double>(lastFrame);
 		pipe->read<double>(currentFrameTime);
@@ -988,7 +1022,9 @@ void VruiState::update(void)
 	if(multiplexer!=0)
 		{
 		/* Broadcast the current navigation transformation and/or display center/size: */
-		pipe->broadcast<int>(navBroadcastMask);
+		Misc::UInt8 navBroadcastBits=Misc::UInt8(navBroadcastMask);
+		pipe->broadcast<Misc::UInt8>(navBroadcastBits);
+		navBroadcastMask=navBroadcastBits;
 		if(navBroadcastMask&0x1)
 			{
 			if(master)
@@ -1034,7 +1070,12 @@ void VruiState::update(void)
 				}
 			}
 		
+		/* Send all shared state in a single packet: */
 		pipe->flush();
+		
+		/* Finish measuring the shared state packet: */
+		sharedStateBytes=pipe->getNumBytes()-sharedStateStartBytes;
+		sharedStateLatency=appTime.peekTime()-sharedStateStart;
 		}
 	
 	#if SAVESHAREDVRUISTATE
@@ -1500,6 +1541,16 @@ Cluster::MulticastPipe* getMainPipe(void)
 	return vruiState->pipe;
 	}
 
+size_t getSharedStateBytes(void)
+	{
+	return vruiState->sharedStateBytes;
+	}
+
+double getSharedStateLatency(void)
+	{
+	return vruiState->sharedStateLatency;
+	}
+
 Cluster::MulticastPipe* openPipe(void)
 	{
 	if(vruiState->multiplexer!=0)
@@ -75,6 +75,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/VisletManager.h>
 #include <Vrui/ViewSpecification.h>
 
+#include <Vrui/Internal/StartupTracer.h>
+
 #include <Vrui/Internal/Vrui.h>
 
 namespace Vrui {
@@ -122,6 +124,7 @@ VRWindow** vruiTotalWindows=0;
 Threads::Thread* vruiRenderingThreads=0;
 Threads::Barrier vruiRenderingBarrier;
 volatile bool vruiStopRenderingThreads=false;
+bool vruiPipelineRendering=false; // Flag if the rendering threads finish and swap a frame while the main thread updates the next one
 #endif
 int vruiNumSoundContexts=0;
 SoundContext** vruiSoundContexts=0;
@@ -133,6 +136,7 @@ int vruiSlaveArgc=0;
 char** vruiSlaveArgv=0;
 char** vruiSlaveArgvShadow=0;
 volatile bool vruiAsynchronousShutdown=false;
+StartupTracer vruiStartupTracer; // Tracer recording the timeline of the startup procedure
 
 /*****************************************
 Workbench-specific private Vrui functions:
@@ -435,11 +439,17 @@ void* vruiRenderingThreadFunction(VruiWindowGroupCreator group)
 		for(std::vector<VruiWindowGroupCreator::VruiWindow>::iterator wIt=group.windows.begin();wIt!=group.windows.end();++wIt)
 			vruiWindows[wIt->windowIndex]->draw();
 		
+		if(vruiPipelineRendering)
+			{
+			/* Let the main thread continue with the next frame once all drawing commands are issued: */
+			vruiRenderingBarrier.synchronize();
+			}
+		
 		/* Wait until all threads are done rendering: */
 		glFinish();
 		vruiRenderingBarrier.synchronize();
 		
-		if(vruiState->multiplexer)
+		if(vruiState->multiplexer||vruiPipelineRendering)
 			{
 			/* Wait until all other nodes are done rendering: */
 			vruiRenderingBarrier.synchronize();
@@ -469,6 +479,8 @@ Call-in functions for user program:
 
 void init(int& argc,char**& argv,char**&)
 	{
+	vruiStartupTracer.beginSpan("Vrui::init");
+	
 	/* Determine whether this node is the master or a slave: */
 	if(argc==8&&strcmp(argv[1],"-vruiMultipipeSlave")==0)
 		{
@@ -488,15 +500,24 @@ void init(int& argc,char**& argv,char**&)
 		try
 			{
 			/* Create the multicast multiplexer: */
+			vruiStartupTracer.beginSpan("Cluster connection");
 			vruiMultiplexer=new Cluster::Multiplexer(numSlaves,nodeIndex,master,masterPort,multicastGroup,multicastPort);
 			
 			/* Wait until the entire cluster is connected: */
 			vruiMultiplexer->waitForConnection();
+			vruiStartupTracer.endSpan();
 			
 			/* Open a multicast pipe: */
 			vruiPipe=new Cluster::MulticastPipe(vruiMultiplexer);
 			
+			/* Align the startup timeline with the master's clock if the master traces the startup: */
+			bool traceStartup=false;
+			vruiPipe->broadcast(traceStartup);
+			if(traceStartup)
+				vruiStartupTracer.synchronize(*vruiPipe);
+			
 			/* Read the entire configuration file and the root section name: */
+			StartupSpan configurationSpan("Receiving configuration");
 			vruiConfigFile=new Misc::ConfigurationFile(*vruiPipe);
 			char* rootSectionName=Misc::readCString(*vruiPipe);
 			
@@ -590,6 +611,9 @@ void init(int& argc,char**& argv,char**&)
 				std::cout<<"     to the given unit name and scale factor"<<std::endl;
 				std::cout<<"  -loadView <viewpoint file name>"<<std::endl;
 				std::cout<<"     Loads the initial viewing position from the given viewpoint file"<<std::endl;
+				std::cout<<"  -traceStartup <trace file name>"<<std::endl;
+				std::cout<<"     Writes a timeline of Vrui's startup procedure on all cluster nodes"<<std::endl;
+				std::cout<<"     to the given file in Chrome trace event format"<<std::endl;
 				
 				/* Remove parameter from argument list: */
 				argc-=1;
@@ -620,7 +644,9 @@ void init(int& argc,char**& argv,char**&)
 			userConfigFileName="./Vrui.cfg";
 		
 		/* Open the global and user configuration files: */
+		vruiStartupTracer.beginSpan("vruiOpenConfigurationFile");
 		vruiOpenConfigurationFile(userConfigFileName);
+		vruiStartupTracer.endSpan();
 		
 		/* Get the root section name: */
 		const char* rootSectionName=getenv("VRUI_ROOTSECTION");
@@ -630,6 +656,7 @@ void init(int& argc,char**& argv,char**&)
 			rootSectionName=getenv("HOST");
 		
 		/* Apply configuration-related arguments from the command line: */
+		const char* startupTraceFileName=0;
 		for(int i=1;i<argc;++i)
 			if(argv[i][0]=='-')
 				{
@@ -728,11 +755,36 @@ void init(int& argc,char**& argv,char**&)
 						--argc;
 						}
 					}
+				else if(strcasecmp(argv[i]+1,"traceStartup")==0)
+					{
+					/* Next parameter is name of startup trace file to write: */
+					if(i+1<argc)
+						{
+						/* Save startup trace file name: */
+						startupTraceFileName=argv[i+1];
+						
+						/* Remove parameters from argument list: */
+						argc-=2;
+						for(int j=i;j<argc;++j)
+							argv[j]=argv[j+2];
+						--i;
+						}
+					else
+						{
+						/* Ignore the traceStartup parameter: */
+						std::cerr<<"Vrui::init: No trace file name given after -traceStartup option"<<std::endl;
+						--argc;
+						}
+					}
 				}
 		
 		/* Go to the configuration's root section: */
 		vruiGoToRootSection(rootSectionName);
 		
+		/* Override the startup trace file name from the command line; the setting is distributed to the slaves with the configuration: */
+		if(startupTraceFileName!=0)
+			vruiConfigFile->storeString("./startupTraceFile",startupTraceFileName);
+		
 		/* Check if this is a multipipe environment: */
 		if(vruiConfigFile->retrieveValue<bool>("./enableMultipipe",false))
 			{
@@ -763,6 +815,7 @@ void init(int& argc,char**& argv,char**&)
 				std::string cwd=Misc::getCurrentDirectory();
 				size_t rcLen=cwd.length()+strlen(argv[0])+master.length()+multicastGroup.length()+512;
 				char* rc=new char[rcLen];
+				vruiStartupTracer.beginSpan("Spawning slave processes");
 				if(vruiVerbose)
 					std::cout<<"Vrui: Spawning slave processes..."<<std::flush;
 				for(int i=0;i<vruiNumSlaves;++i)
@@ -803,11 +856,14 @@ void init(int& argc,char**& argv,char**&)
 				
 				/* Clean up: */
 				delete[] rc;
+				vruiStartupTracer.endSpan();
 				
 				/* Wait until the entire cluster is connected: */
 				if(vruiVerbose)
 					std::cout<<"Vrui: Waiting for cluster to connect..."<<std::flush;
+				vruiStartupTracer.beginSpan("Cluster connection");
 				vruiMultiplexer->waitForConnection();
+				vruiStartupTracer.endSpan();
 				if(vruiVerbose)
 					std::cout<<" Ok"<<std::endl;
 				
@@ -817,6 +873,15 @@ void init(int& argc,char**& argv,char**&)
 				/* Open a multicast pipe: */
 				vruiPipe=new Cluster::MulticastPipe(vruiMultiplexer);
 				
+				/* Align the slaves' startup timelines with the master's clock if the startup is traced: */
+				bool traceStartup=!vruiConfigFile->retrieveString("./startupTraceFile","").empty();
+				vruiPipe->broadcast(traceStartup);
+				vruiPipe->flush();
+				if(traceStartup)
+					vruiStartupTracer.synchronize(*vruiPipe);
+				
+				StartupSpan configurationSpan("Distributing configuration");
+				
 				/* Send the entire Vrui configuration file and the root section name across the pipe: */
 				vruiConfigFile->writeToPipe(*vruiPipe);
 				Misc::writeCString(rootSectionName,*vruiPipe);
@@ -850,6 +915,7 @@ void init(int& argc,char**& argv,char**&)
 		{
 		if(vruiVerbose)
 			std::cout<<"Vrui: Initializing Vrui environment..."<<std::flush;
+		StartupSpan initializeSpan("VruiState::initialize");
 		vruiState=new VruiState(vruiMultiplexer,vruiPipe);
 		vruiState->initialize(vruiConfigFile->getCurrentSection());
 		if(vruiVerbose)
@@ -1072,6 +1138,20 @@ void init(int& argc,char**& argv,char**&)
 	vruiApplicationName=new char[cPtr-appNameStart+1];
 	memcpy(vruiApplicationName,appNameStart,cPtr-appNameStart);
 	vruiApplicationName[cPtr-appNameStart]='\0';
+	
+	/* Record the application's own initialization until it enters the main loop: */
+	vruiStartupTracer.endSpan();
+	vruiStartupTracer.beginSpan("Application initialization");
+	}
+
+void beginStartupSpan(const char* name)
+	{
+	vruiStartupTracer.beginSpan(name);
+	}
+
+void endStartupSpan(void)
+	{
+	vruiStartupTracer.endSpan();
 	}
 
 void startDisplay(void)
@@ -1079,6 +1159,8 @@ void startDisplay(void)
 	/* Synchronize threads between here and end of function body: */
 	Cluster::ThreadSynchronizer threadSynchronizer(vruiState->pipe);
 	
+	StartupSpan startDisplaySpan("startDisplay");
+	
 	/* Wait for all nodes in the multicast group to reach this point: */
 	if(vruiState->multiplexer!=0)
 		{
@@ -1192,6 +1274,14 @@ void startDisplay(void)
 			/* Initialize the rendering barrier: */
 			vruiRenderingBarrier.setNumSynchronizingThreads(vruiNumWindowGroups+1);
 			
+			/* Check if rendering is to be pipelined with the main thread: */
+			vruiPipelineRendering=vruiState->pipelineRendering;
+			if(vruiPipelineRendering)
+				{
+				/* The main thread will process X events while the rendering threads swap buffers: */
+				XInitThreads();
+				}
+			
 			/* Create one rendering thread for each window group (which will in turn create the windows in their respective groups themselves): */
 			vruiRenderingThreads=new Threads::Thread[vruiNumWindowGroups];
 			{
@@ -1230,6 +1320,8 @@ void startDisplay(void)
 				{
 				#if GLSUPPORT_CONFIG_USE_TLS
 				std::cout<<"Vrui: Rendering in parallel to "<<vruiNumWindowGroups<<" window groups"<<std::endl;
+				if(vruiPipelineRendering)
+					std::cout<<"Vrui: Pipelining rendering with application updates"<<std::endl;
 				#else
 				std::cout<<"Vrui: Rendering serially to "<<vruiNumWindowGroups<<" window groups"<<std::endl;
 				#endif
@@ -1308,6 +1400,8 @@ void startSound(void)
 	/* Synchronize threads between here and end of function body: */
 	Cluster::ThreadSynchronizer threadSynchronizer(vruiState->pipe);
 	
+	StartupSpan startSoundSpan("startSound");
+	
 	/* Wait for all nodes in the multicast group to reach this point: */
 	if(vruiState->multiplexer!=0)
 		{
@@ -1534,6 +1628,9 @@ void vruiInnerLoopMultiWindow(void)
 	{
 	bool keepRunning=true;
 	bool firstFrame=true;
+	#if GLSUPPORT_CONFIG_USE_TLS
+	bool renderingInProgress=false; // Flag if the rendering threads are still finishing the previous frame in pipelined mode
+	#endif
 	while(keepRunning)
 		{
 		/* Handle all events, blocking if there are none unless in continuous mode: */
@@ -1560,6 +1657,16 @@ void vruiInnerLoopMultiWindow(void)
 			if(vruiState->multiplexer!=0&&vruiState->master)
 				vruiState->pipe->flush();
 			
+			#if GLSUPPORT_CONFIG_USE_TLS
+			if(renderingInProgress)
+				{
+				/* Let the rendering threads finish and swap the previous frame: */
+				vruiRenderingBarrier.synchronize();
+				vruiRenderingBarrier.synchronize();
+				vruiRenderingBarrier.synchronize();
+				}
+			#endif
+			
 			/* Bail out of the inner loop: */
 			break;
 			}
@@ -1576,6 +1683,44 @@ void vruiInnerLoopMultiWindow(void)
 			vruiSoundContexts[i]->draw();
 		#endif
 		
+		#if GLSUPPORT_CONFIG_USE_TLS
+		if(vruiPipelineRendering)
+			{
+			if(renderingInProgress)
+				{
+				/* Wait until all threads are done rendering the previous frame: */
+				vruiRenderingBarrier.synchronize();
+				
+				if(vruiState->multiplexer!=0)
+					{
+					/* Synchronize with other nodes: */
+					vruiState->pipe->barrier();
+					}
+				
+				/* Notify the render threads to swap buffers: */
+				vruiRenderingBarrier.synchronize();
+				
+				/* Wait until all threads are done swapping buffers: */
+				vruiRenderingBarrier.synchronize();
+				}
+			
+			/* Reset the GL thing manager: */
+			GLContextData::resetThingManager();
+			
+			/* Start the rendering cycle by synchronizing with the render threads: */
+			vruiRenderingBarrier.synchronize();
+			
+			/* Wait until the render threads have issued all drawing commands, which read live application, tool, and device state: */
+			vruiRenderingBarrier.synchronize();
+			
+			/* Continue with the next frame while the render threads finish and swap this one: */
+			renderingInProgress=true;
+			
+			firstFrame=false;
+			continue;
+			}
+		#endif
+		
 		/* Reset the GL thing manager: */
 		GLContextData::resetThingManager();
 		
@@ -1747,6 +1892,9 @@ void mainLoop(void)
 		return;
 		}
 	
+	/* End the application's initialization span: */
+	vruiStartupTracer.endSpan();
+	
 	/* Start the display subsystem: */
 	startDisplay();
 	
@@ -1761,7 +1909,9 @@ void mainLoop(void)
 		{
 		if(vruiVerbose&&vruiState->master)
 			std::cout<<"Vrui: Waiting for cluster before preparing main loop..."<<std::flush;
+		vruiStartupTracer.beginSpan("Waiting for cluster");
 		vruiState->pipe->barrier();
+		vruiStartupTracer.endSpan();
 		if(vruiVerbose&&vruiState->master)
 			std::cout<<" Ok"<<std::endl;
 		}
@@ -1769,7 +1919,12 @@ void mainLoop(void)
 	/* Prepare Vrui state for main loop: */
 	if(vruiVerbose&&vruiState->master)
 		std::cout<<"Vrui: Preparing main loop..."<<std::flush;
+	vruiStartupTracer.beginSpan("prepareMainLoop");
 	vruiState->prepareMainLoop();
+	vruiStartupTracer.endSpan();
+	
+	/* Finish the startup timeline and write it if requested: */
+	vruiStartupTracer.finish(vruiState->pipe,vruiConfigFile->retrieveString("./startupTraceFile","").c_str());
 	
 	#if 0
 	/* Turn off the screen saver: */
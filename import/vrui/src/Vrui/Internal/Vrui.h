@@ -238,6 +238,8 @@ struct VruiState
 	int nextFrameTimeIndex; // Index at which the next frame time is stored in the array
 	double* sortedFrameTimes; // Helper array to calculate median of frame times
 	double currentFrameTime; // Current frame time average
+	size_t sharedStateBytes; // Number of bytes sent (master) or received (slaves) to distribute shared state during the last frame
+	double sharedStateLatency; // Time the master spent sending, or a slave spent waiting for, shared state during the last frame
 	
 	/* Transient dragging/moving/scaling state: */
 	const Tool* activeNavigationTool;
@@ -251,6 +253,7 @@ struct VruiState
 	
 	/* Rendering management state: */
 	bool updateContinuously; // Flag if the inner Vrui loop never blocks
+	bool pipelineRendering; // Flag if finishing and swapping a rendered frame overlaps event handling and update of the next frame
 	
 	/* Private methods: */
 	GLMotif::Popup* buildDialogsMenu(void); // Builds the dialogs submenu
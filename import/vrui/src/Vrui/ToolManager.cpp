@@ -59,6 +59,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/Internal/ToolKillZone.h>
 #include <Vrui/Internal/ToolKillZoneBox.h>
 #include <Vrui/Internal/ToolKillZoneFrustum.h>
+#include <Vrui/Internal/StartupTracer.h>
 
 #define DEBUGGING 0
 
@@ -641,6 +642,7 @@ ToolManager::ToolManager(InputDeviceManager* sInputDeviceManager,const Misc::Con
 	for(StringList::const_iterator tcnIt=toolClassNames.begin();tcnIt!=toolClassNames.end();++tcnIt)
 		{
 		/* Load tool class: */
+		StartupSpan loadClassSpan(("Loading tool class "+*tcnIt).c_str());
 		loadClass(tcnIt->c_str());
 		}
 	
@@ -2447,6 +2447,11 @@ void VRWindow::draw(void)
 	
 	/* Update things in the window's GL context data: */
 	getContextData().updateThings();
+	if(getContextData().hasPendingThings())
+		{
+		/* Keep redrawing until all deferred things are initialized: */
+		requestUpdate();
+		}
 	
 	/* Draw the window's contents: */
 	GLWindow::WindowPos windowViewport(getWindowWidth(),getWindowHeight());
@@ -122,16 +122,20 @@ SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[
 	root=new SceneGraph::GroupNode;
 	
 	/* Load all VRML files from the command line: */
+	bool useCache=false;
 	for(int i=0;i<numArguments;++i)
 		{
 		if(arguments[i][0]=='-')
 			{
 			if(strcasecmp(arguments[i]+1,"physical")==0)
 				navigational=false;
+			else if(strcasecmp(arguments[i]+1,"cache")==0)
+				useCache=true;
 			}
 		else
 			{
 			SceneGraph::VRMLFile vrmlFile(arguments[i],Vrui::openFile(arguments[i]),nodeCreator,getClusterMultiplexer());
+			vrmlFile.setUseCache(useCache);
 			vrmlFile.parse(root);
 			}
 		}
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INCLUDED
 #define VRUI_INCLUDED
 
+#include <stddef.h>
 #include <utility>
 #include <Misc/CallbackData.h>
 #include <GL/gl.h>
@@ -139,8 +140,14 @@ bool isMaster(void); // Returns true if the multipipe node the caller is running
 int getNodeIndex(void); // Returns index of the multipipe node the caller is running on (0: master node)
 int getNumNodes(void); // Returns number of multipipe nodes, including master
 Cluster::MulticastPipe* getMainPipe(void); // Returns Vrui's main frame pipe; safe to use inside frame function, user must call finishMessage() when done (returns 0 if called in a non-cluster environment)
+size_t getSharedStateBytes(void); // Returns the number of bytes the master sent, or a slave received, to distribute Vrui's shared per-frame state in the last frame (returns 0 if called in a non-cluster environment)
+double getSharedStateLatency(void); // Returns the time in seconds the master spent sending, or a slave spent waiting for, Vrui's shared per-frame state in the last frame (returns 0 if called in a non-cluster environment)
 Cluster::MulticastPipe* openPipe(void); // Opens a pipe for 1-to-n communication from master to all slaves (returns 0 if called in a non-cluster environment)
 
+/* Trace the startup procedure: */
+void beginStartupSpan(const char* name); // Begins a named span, nested inside the currently open span, in Vrui's startup timeline; must be called from the main thread; ignored after the main loop started
+void endStartupSpan(void); // Ends the most recently begun span in Vrui's startup timeline
+
 /* Manage glyph rendering: */
 GlyphRenderer* getGlyphRenderer(void); // Returns pointer to the glyph renderer
 void renderGlyph(const Glyph& glyph,const OGTransform& transformation,GLContextData& contextData); // Renders the given glyph with the given transformation
@@ -0,0 +1,39 @@
+/***********************************************************************
+ComputeBSPTreePVS - Utility to precompute the potentially visible sets
+of all leaves of a portal BSP tree and store them in the BSP tree file.
+Copyright (c) 2014 Oliver Kreylos
+***********************************************************************/
+
+#include <iostream>
+#include <stdexcept>
+
+#include "RenderBSPTree.h"
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	if(argc!=2)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <BSP tree file name>"<<std::endl;
+		return 1;
+		}
+	
+	try
+		{
+		/* Load the BSP tree's structure; the PVS computation only needs the tree's portals: */
+		RenderBSPTree::VertexList vertices;
+		RenderBSPTree bspTree(vertices);
+		bspTree.loadTree(argv[1]);
+		
+		/* Compute the potentially visible sets and append them to the BSP tree file: */
+		bspTree.computePVS();
+		bspTree.savePVS(argv[1]);
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
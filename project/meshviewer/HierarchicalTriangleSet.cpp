@@ -11,6 +11,7 @@ Copyright (c) 2009-2012 Oliver Kreylos
 
 // DEBUGGING
 #include <iostream>
+#include <algorithm>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/File.h>
 #include <Math/Math.h>
@@ -22,10 +23,77 @@ Copyright (c) 2009-2012 Oliver Kreylos
 #include <GL/GLExtensionManager.h>
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLGeometryWrappers.h>
+#include <GL/GLFrustum.h>
 
 // DEBUGGING
 #include "PhongMaterial.h"
 
+/*************************************************
+Methods of class HierarchicalTriangleSet::Quadric:
+*************************************************/
+
+template <class MeshVertexParam>
+inline
+void
+HierarchicalTriangleSet<MeshVertexParam>::Quadric::addPlane(
+	const typename HierarchicalTriangleSet<MeshVertexParam>::MVector& normal,
+	typename HierarchicalTriangleSet<MeshVertexParam>::MScalar offset,
+	double weight)
+	{
+	double n[3];
+	for(int i=0;i<3;++i)
+		n[i]=double(normal[i]);
+	double d=double(offset);
+	double* aPtr=a;
+	for(int i=0;i<3;++i)
+		for(int j=i;j<3;++j,++aPtr)
+			*aPtr+=weight*n[i]*n[j];
+	for(int i=0;i<3;++i)
+		b[i]+=weight*d*n[i];
+	c+=weight*d*d;
+	}
+
+template <class MeshVertexParam>
+inline
+typename HierarchicalTriangleSet<MeshVertexParam>::Quadric&
+HierarchicalTriangleSet<MeshVertexParam>::Quadric::operator+=(
+	const typename HierarchicalTriangleSet<MeshVertexParam>::Quadric& other)
+	{
+	for(int i=0;i<6;++i)
+		a[i]+=other.a[i];
+	for(int i=0;i<3;++i)
+		b[i]+=other.b[i];
+	c+=other.c;
+	return *this;
+	}
+
+template <class MeshVertexParam>
+inline
+bool
+HierarchicalTriangleSet<MeshVertexParam>::Quadric::minimize(
+	typename HierarchicalTriangleSet<MeshVertexParam>::MPoint& result) const
+	{
+	/* Solve the linear system A*x=-b using Cramer's rule: */
+	double m00=a[0],m01=a[1],m02=a[2],m11=a[3],m12=a[4],m22=a[5];
+	double c00=m11*m22-m12*m12;
+	double c01=m02*m12-m01*m22;
+	double c02=m01*m12-m02*m11;
+	double det=m00*c00+m01*c01+m02*c02;
+	
+	/* Reject nearly singular systems, i.e., clusters of (nearly) coplanar or colinear planes: */
+	double scale=m00+m11+m22;
+	if(Math::abs(det)<=1.0e-6*scale*scale*scale)
+		return false;
+	
+	double c11=m00*m22-m02*m02;
+	double c12=m01*m02-m00*m12;
+	double c22=m00*m11-m01*m01;
+	result[0]=MScalar(-(c00*b[0]+c01*b[1]+c02*b[2])/det);
+	result[1]=MScalar(-(c01*b[0]+c11*b[1]+c12*b[2])/det);
+	result[2]=MScalar(-(c02*b[0]+c12*b[1]+c22*b[2])/det);
+	return true;
+	}
+
 /**************************************************
 Methods of class HierarchicalTriangleSet::DataItem:
 **************************************************/
@@ -34,7 +102,8 @@ template <class MeshVertexParam>
 inline
 HierarchicalTriangleSet<MeshVertexParam>::DataItem::DataItem(
 	void)
-	:vertexBufferId(0)
+	:vertexBufferId(0),
+	 numSubmittedTriangles(0)
 	{
 	if(GLARBVertexBufferObject::isSupported())
 		{
@@ -209,11 +278,252 @@ HierarchicalTriangleSet<MeshVertexParam>::intersectSubMesh(
 	return lambdaMax;
 	}
 
+template <class MeshVertexParam>
+inline
+void
+HierarchicalTriangleSet<MeshVertexParam>::simplifySubMesh(
+	typename HierarchicalTriangleSet<MeshVertexParam>::SubMesh& subMesh,
+	unsigned int maxNumLevels)
+	{
+	subMesh.levels.clear();
+	
+	/* Don't bother simplifying small submeshes: */
+	if(subMesh.numTriangles<64)
+		return;
+	
+	/* Merge the submesh's triangle corners by position, as triangles are stored with unshared vertices: */
+	Card numCorners=subMesh.numTriangles*3;
+	std::vector<WeldCorner> weldCorners(numCorners);
+	for(Card i=0;i<numCorners;++i)
+		{
+		weldCorners[i].position=vertices[subMesh.firstTriangleVertexIndex+i].position;
+		weldCorners[i].corner=i;
+		}
+	std::sort(weldCorners.begin(),weldCorners.end());
+	std::vector<Card> cornerVertices(numCorners); // Merged vertex index for each triangle corner
+	std::vector<MPoint> positions; // Positions of merged vertices
+	for(typename std::vector<WeldCorner>::iterator wcIt=weldCorners.begin();wcIt!=weldCorners.end();++wcIt)
+		{
+		if(positions.empty()||positions.back()!=wcIt->position)
+			positions.push_back(wcIt->position);
+		cornerVertices[wcIt->corner]=positions.size()-1;
+		}
+	std::vector<WeldCorner>().swap(weldCorners);
+	Card numVertices=positions.size();
+	
+	/* Accumulate the quadric error functions and area-weighted normal vectors of all merged vertices: */
+	std::vector<Quadric> quadrics(numVertices);
+	std::vector<MVector> normals(numVertices,MVector::zero);
+	for(Card triangleIndex=0;triangleIndex<subMesh.numTriangles;++triangleIndex)
+		{
+		const Card* cvPtr=&cornerVertices[triangleIndex*3];
+		MVector normal=Geometry::cross(positions[cvPtr[1]]-positions[cvPtr[0]],positions[cvPtr[2]]-positions[cvPtr[0]]);
+		MScalar normalMag=Geometry::mag(normal);
+		if(normalMag>MScalar(0))
+			{
+			/* Add the triangle's plane to its vertices' quadrics, weighted by triangle area: */
+			MVector unitNormal=normal/normalMag;
+			MScalar offset=-(unitNormal*(positions[cvPtr[0]]-MPoint::origin));
+			Quadric q;
+			q.addPlane(unitNormal,offset,double(normalMag)*0.5);
+			for(int i=0;i<3;++i)
+				{
+				quadrics[cvPtr[i]]+=q;
+				normals[cvPtr[i]]+=normal;
+				}
+			}
+		}
+	
+	/* Calculate the bounding box and bounding sphere of the submesh's own triangles: */
+	MBox box=MBox::empty;
+	for(typename std::vector<MPoint>::const_iterator pIt=positions.begin();pIt!=positions.end();++pIt)
+		box.addPoint(*pIt);
+	subMesh.lodCenter=Geometry::mid(box.min,box.max);
+	subMesh.lodRadius=Geometry::dist(subMesh.lodCenter,box.max);
+	MScalar extent=MScalar(0);
+	for(int i=0;i<3;++i)
+		if(extent<box.getSize(i))
+			extent=box.getSize(i);
+	if(extent==MScalar(0))
+		return;
+	
+	/* Create successively coarser levels of detail by clustering vertices on successively coarser grids: */
+	std::vector<ClusterVertex> clusterVertices(numVertices);
+	std::vector<Card> vertexClusters(numVertices); // Cluster index for each merged vertex
+	Card prevNumTriangles=subMesh.numTriangles;
+	double resolution=Math::sqrt(double(subMesh.numTriangles)); // Number of grid cells along the largest bounding box edge
+	while(subMesh.levels.size()<maxNumLevels)
+		{
+		/* Halve the grid resolution for the next level: */
+		resolution*=0.5;
+		if(resolution<2.0)
+			break;
+		MScalar cellSize=extent/MScalar(resolution);
+		size_t gridSize[3];
+		for(int i=0;i<3;++i)
+			gridSize[i]=size_t(Math::floor(box.getSize(i)/cellSize))+1;
+		
+		/* Sort the merged vertices by grid cell: */
+		for(Card v=0;v<numVertices;++v)
+			{
+			size_t cellIndex[3];
+			for(int i=0;i<3;++i)
+				{
+				cellIndex[i]=size_t(Math::floor((positions[v][i]-box.min[i])/cellSize));
+				if(cellIndex[i]>=gridSize[i])
+					cellIndex[i]=gridSize[i]-1;
+				}
+			clusterVertices[v].cell=(cellIndex[0]*gridSize[1]+cellIndex[1])*gridSize[2]+cellIndex[2];
+			clusterVertices[v].vertex=v;
+			}
+		std::sort(clusterVertices.begin(),clusterVertices.end());
+		
+		/* Calculate a representative vertex for each cluster that minimizes the cluster's quadric error: */
+		std::vector<MeshVertex> clusters;
+		MScalar error=MScalar(0);
+		typename std::vector<ClusterVertex>::const_iterator cvIt=clusterVertices.begin();
+		while(cvIt!=clusterVertices.end())
+			{
+			/* Find the end of the cluster: */
+			typename std::vector<ClusterVertex>::const_iterator cEnd;
+			for(cEnd=cvIt;cEnd!=clusterVertices.end()&&cEnd->cell==cvIt->cell;++cEnd)
+				;
+			
+			/* Accumulate the cluster's quadric, normal, and centroid: */
+			Card clusterIndex=clusters.size();
+			Quadric q;
+			MVector normal=MVector::zero;
+			MVector centroid=MVector::zero;
+			MScalar numClusterVertices(0);
+			for(typename std::vector<ClusterVertex>::const_iterator vIt=cvIt;vIt!=cEnd;++vIt)
+				{
+				vertexClusters[vIt->vertex]=clusterIndex;
+				q+=quadrics[vIt->vertex];
+				normal+=normals[vIt->vertex];
+				centroid+=positions[vIt->vertex]-MPoint::origin;
+				numClusterVertices+=MScalar(1);
+				}
+			
+			/* Place the representative at the quadric's minimum if it lies inside the cluster's grid cell, and at the cluster's centroid otherwise: */
+			MeshVertex representative;
+			representative.position=MPoint::origin+centroid/numClusterVertices;
+			MPoint qMin;
+			if(q.minimize(qMin))
+				{
+				size_t cell=cvIt->cell;
+				size_t cellIndex[3];
+				for(int i=2;i>=0;--i)
+					{
+					cellIndex[i]=cell%gridSize[i];
+					cell/=gridSize[i];
+					}
+				bool inside=true;
+				for(int i=0;i<3&&inside;++i)
+					{
+					MScalar cellMin=box.min[i]+MScalar(cellIndex[i])*cellSize;
+					inside=qMin[i]>=cellMin&&qMin[i]<=cellMin+cellSize;
+					}
+				if(inside)
+					representative.position=qMin;
+				}
+			MScalar normalMag=Geometry::mag(normal);
+			representative.normal=normalMag>MScalar(0)?normal/normalMag:normal;
+			clusters.push_back(representative);
+			
+			/* Update the level's geometric error: */
+			for(typename std::vector<ClusterVertex>::const_iterator vIt=cvIt;vIt!=cEnd;++vIt)
+				{
+				MScalar dist=Geometry::dist(positions[vIt->vertex],representative.position);
+				if(error<dist)
+					error=dist;
+				}
+			
+			cvIt=cEnd;
+			}
+		
+		/* Create the simplified triangles, dropping those whose corners collapsed into the same cluster: */
+		LevelOfDetail level;
+		level.firstTriangleVertexIndex=vertices.size();
+		level.numTriangles=0;
+		level.error=error;
+		for(Card triangleIndex=0;triangleIndex<subMesh.numTriangles;++triangleIndex)
+			{
+			const Card* cvPtr=&cornerVertices[triangleIndex*3];
+			Card c[3];
+			for(int i=0;i<3;++i)
+				c[i]=vertexClusters[cvPtr[i]];
+			if(c[0]!=c[1]&&c[1]!=c[2]&&c[2]!=c[0])
+				{
+				for(int i=0;i<3;++i)
+					{
+					/* Copy the original vertex to retain its texture coordinates and tangents: */
+					MeshVertex v=vertices[subMesh.firstTriangleVertexIndex+triangleIndex*3+i];
+					v.normal=clusters[c[i]].normal;
+					v.position=clusters[c[i]].position;
+					vertices.push_back(v);
+					}
+				++level.numTriangles;
+				}
+			}
+		
+		if(level.numTriangles==0)
+			{
+			/* Nothing is left of the submesh; stop simplifying: */
+			vertices.resize(level.firstTriangleVertexIndex);
+			break;
+			}
+		else if(level.numTriangles*4>prevNumTriangles*3)
+			{
+			/* Discard the level if it didn't reduce the triangle count enough to be worth it: */
+			vertices.resize(level.firstTriangleVertexIndex);
+			}
+		else
+			{
+			subMesh.levels.push_back(level);
+			prevNumTriangles=level.numTriangles;
+			}
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+const typename HierarchicalTriangleSet<MeshVertexParam>::LevelOfDetail*
+HierarchicalTriangleSet<MeshVertexParam>::selectLevelOfDetail(
+	const typename HierarchicalTriangleSet<MeshVertexParam>::SubMesh& subMesh,
+	const typename HierarchicalTriangleSet<MeshVertexParam>::Frustum& frustum) const
+	{
+	if(subMesh.levels.empty())
+		return 0;
+	
+	/* Find the point on the submesh's bounding sphere that is closest to the eye: */
+	MPoint closest=subMesh.lodCenter;
+	const typename Frustum::HVector& eye=frustum.getEye();
+	if(eye[3]!=MScalar(0))
+		{
+		MVector toEye=eye.toPoint()-subMesh.lodCenter;
+		MScalar eyeDist=Geometry::mag(toEye);
+		if(eyeDist<=subMesh.lodRadius)
+			return 0;
+		closest+=toEye*(subMesh.lodRadius/eyeDist);
+		}
+	
+	/* Find the coarsest level of detail whose geometric error projects to less than the maximum pixel error: */
+	for(typename std::vector<LevelOfDetail>::const_reverse_iterator lIt=subMesh.levels.rbegin();lIt!=subMesh.levels.rend();++lIt)
+		{
+		MScalar projectedError=frustum.calcProjectedRadius(closest,lIt->error);
+		if(projectedError>=MScalar(0)&&projectedError<=maxPixelError)
+			return &(*lIt);
+		}
+	
+	return 0;
+	}
+
 template <class MeshVertexParam>
 inline
 HierarchicalTriangleSet<MeshVertexParam>::HierarchicalTriangleSet(
 	void)
-	:triangleKdTree(vertices),
+	:maxPixelError(0),
+	 triangleKdTree(vertices),
 	 bspTree(0)
 	{
 	/* Create the triangle set's root submesh node: */
@@ -223,6 +533,7 @@ HierarchicalTriangleSet<MeshVertexParam>::HierarchicalTriangleSet(
 	root.numTriangles=0;
 	root.firstTriangleVertexIndex=0;
 	root.boundingBox=MBox::empty;
+	root.lodRadius=MScalar(0);
 	subMeshes.push_back(root);
 	
 	/* Initialize the current sub mesh: */
@@ -230,6 +541,7 @@ HierarchicalTriangleSet<MeshVertexParam>::HierarchicalTriangleSet(
 	currentSubMesh.name="";
 	currentSubMesh.numTriangles=0;
 	currentSubMesh.firstTriangleVertexIndex=0;
+	currentSubMesh.lodRadius=MScalar(0);
 	
 	// DEBUGGING
 	lastIntersected=0;
@@ -276,6 +588,27 @@ HierarchicalTriangleSet<MeshVertexParam>::glRenderAction(
 		{
 		/* Get the context data item: */
 		DataItem* dataItem=contextData.template retrieveDataItem<DataItem>(this);
+		if(dataItem==0)
+			{
+			/* The triangle set has not been uploaded to this context yet; draw its bounding box as a placeholder: */
+			glPushAttrib(GL_ENABLE_BIT);
+			glDisable(GL_LIGHTING);
+			glDisable(GL_TEXTURE_2D);
+			glBegin(GL_LINES);
+			glColor3f(0.5f,0.5f,0.5f);
+			const MBox& box=subMeshes[0].boundingBox;
+			for(int i=0;i<8;++i)
+				for(int axisBit=1;axisBit<8;axisBit<<=1)
+					if((i&axisBit)==0)
+						{
+						glVertex(box.getVertex(i));
+						glVertex(box.getVertex(i|axisBit));
+						}
+			glEnd();
+			glPopAttrib();
+			
+			return;
+			}
 		
 		/* Install the vertex arrays: */
 		GLVertexArrayParts::enable(GLVertexArrayParts::Position|GLVertexArrayParts::Normal|GLVertexArrayParts::TexCoord);
@@ -300,7 +633,14 @@ HierarchicalTriangleSet<MeshVertexParam>::glRenderAction(
 			glVertexPointer(3,sizeof(MeshVertex),vertexPointer[0].position.getComponents());
 			}
 		
+		/* Extract the view frustum to select submeshes' levels of detail: */
+		bool useLevels=maxPixelError>MScalar(0);
+		Frustum frustum;
+		if(useLevels)
+			frustum.setFromGL();
+		
 		/* Render the triangle set: */
+		dataItem->numSubmittedTriangles=0;
 		Material* currentMaterial=0;
 		for(typename std::vector<SubMesh>::const_iterator smIt=subMeshes.begin();smIt!=subMeshes.end();++smIt)
 			{
@@ -316,8 +656,18 @@ HierarchicalTriangleSet<MeshVertexParam>::glRenderAction(
 						currentMaterial->set(contextData);
 					}
 				
-				/* Draw the sub mesh's triangles: */
-				glDrawArrays(GL_TRIANGLES,smIt->firstTriangleVertexIndex,smIt->numTriangles*3);
+				/* Draw the sub mesh's triangles, or the coarsest of its levels of detail that looks the same: */
+				const LevelOfDetail* level=useLevels?selectLevelOfDetail(*smIt,frustum):0;
+				if(level!=0)
+					{
+					glDrawArrays(GL_TRIANGLES,level->firstTriangleVertexIndex,level->numTriangles*3);
+					dataItem->numSubmittedTriangles+=level->numTriangles;
+					}
+				else
+					{
+					glDrawArrays(GL_TRIANGLES,smIt->firstTriangleVertexIndex,smIt->numTriangles*3);
+					dataItem->numSubmittedTriangles+=smIt->numTriangles;
+					}
 				}
 			}
 		if(currentMaterial!=0)
@@ -464,6 +814,36 @@ HierarchicalTriangleSet<MeshVertexParam>::loadBSPTree(
 	bspTree->finalizeTree();
 	}
 
+template <class MeshVertexParam>
+inline
+void
+HierarchicalTriangleSet<MeshVertexParam>::createLevelsOfDetail(
+	unsigned int maxNumLevels,
+	typename HierarchicalTriangleSet<MeshVertexParam>::Scalar newMaxPixelError)
+	{
+	/* Set the level of detail selection threshold: */
+	maxPixelError=MScalar(newMaxPixelError);
+	
+	/* Simplify all submeshes: */
+	size_t numOriginalVertices=vertices.size();
+	for(typename std::vector<SubMesh>::iterator smIt=subMeshes.begin();smIt!=subMeshes.end();++smIt)
+		simplifySubMesh(*smIt,maxNumLevels);
+	
+	std::cout<<"Created levels of detail with "<<(vertices.size()-numOriginalVertices)/3<<" simplified triangles for "<<numOriginalVertices/3<<" original triangles"<<std::endl;
+	}
+
+template <class MeshVertexParam>
+inline
+size_t
+HierarchicalTriangleSet<MeshVertexParam>::getNumRenderedTriangles(
+	GLContextData& contextData) const
+	{
+	/* Get the context data item: */
+	DataItem* dataItem=contextData.template retrieveDataItem<DataItem>(this);
+	
+	return dataItem!=0?dataItem->numSubmittedTriangles:0;
+	}
+
 template <class MeshVertexParam>
 inline
 void
@@ -504,11 +884,11 @@ HierarchicalTriangleSet<MeshVertexParam>::drawSubMesh(
 		glPopAttrib();
 		}
 	
-	if(myMesh!=0&&myMesh->numTriangles!=0)
+	/* Get the context data item; the triangle set might not have been uploaded to this context yet: */
+	DataItem* dataItem=contextData.template retrieveDataItem<DataItem>(this);
+	
+	if(dataItem!=0&&myMesh!=0&&myMesh->numTriangles!=0)
 		{
-		/* Get the context data item: */
-		DataItem* dataItem=contextData.template retrieveDataItem<DataItem>(this);
-		
 		/* Install the vertex arrays: */
 		GLVertexArrayParts::enable(GLVertexArrayParts::Position|GLVertexArrayParts::Normal|GLVertexArrayParts::TexCoord);
 		if(dataItem->vertexBufferId!=0)
@@ -551,6 +931,16 @@ HierarchicalTriangleSet<MeshVertexParam>::drawSubMesh(
 		}
 	}
 
+template <class MeshVertexParam>
+inline
+double
+HierarchicalTriangleSet<MeshVertexParam>::getContextInitCost(
+	void) const
+	{
+	/* Estimate the time to convert and upload the vertex buffer at roughly 500MB/s: */
+	return double(vertices.size())*double(sizeof(MScalar)*(2+3+3))/500.0e6;
+	}
+
 template <class MeshVertexParam>
 inline
 void
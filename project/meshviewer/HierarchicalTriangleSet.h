@@ -45,6 +45,15 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 	typedef Misc::HashTable<Card,void> CardSet; // Set of cardinals
 	typedef GLFrustum<MScalar> Frustum; // Type for view frusta
 	
+	struct LevelOfDetail // Structure describing a simplified version of a submesh's own triangles
+		{
+		/* Elements: */
+		public:
+		Card firstTriangleVertexIndex; // Index of first triangle vertex belonging to this level of detail
+		Card numTriangles; // Number of triangles in this level of detail
+		MScalar error; // Maximum distance from an original vertex to its simplified replacement
+		};
+	
 	class SubMesh:public HierarchicalTriangleSetBase::SubMesh // Structure for nodes in the submesh tree
 		{
 		friend class HierarchicalTriangleSet;
@@ -52,6 +61,9 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 		/* Elements: */
 		private:
 		MBox boundingBox; // Bounding box of all triangles in this submesh, and all child submeshes
+		MPoint lodCenter; // Center of bounding sphere of this submesh's own triangles, to select levels of detail
+		MScalar lodRadius; // Radius of bounding sphere of this submesh's own triangles
+		std::vector<LevelOfDetail> levels; // Simplified versions of this submesh's own triangles, ordered from finest to coarsest
 		
 		/* Methods from HierarchicalTriangleSetBase::SubMesh: */
 		virtual Box getBoundingBox(void) const
@@ -61,11 +73,67 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 		};
 	
 	private:
+	struct Quadric // Structure for quadric error functions measuring the sum of squared distances to a set of planes
+		{
+		/* Elements: */
+		public:
+		double a[6]; // Upper triangle of the symmetric quadratic coefficient matrix, in row order
+		double b[3]; // Linear coefficient vector
+		double c; // Constant coefficient
+		
+		/* Constructors and destructors: */
+		Quadric(void) // Creates a zero quadric
+			:c(0.0)
+			{
+			for(int i=0;i<6;++i)
+				a[i]=0.0;
+			for(int i=0;i<3;++i)
+				b[i]=0.0;
+			}
+		
+		/* Methods: */
+		void addPlane(const MVector& normal,MScalar offset,double weight); // Adds the squared distance to the plane normal*p+offset=0 with the given weight
+		Quadric& operator+=(const Quadric& other); // Adds another quadric
+		bool minimize(MPoint& result) const; // Stores the point minimizing the quadric in result; returns false if the minimum is not well-defined
+		};
+	
+	struct WeldCorner // Structure to merge triangle corners at identical positions by sorting
+		{
+		/* Elements: */
+		public:
+		MPoint position; // Position of the triangle corner
+		Card corner; // Index of the triangle corner relative to the submesh's first triangle vertex
+		
+		/* Methods: */
+		bool operator<(const WeldCorner& other) const // Compares positions lexicographically
+			{
+			for(int i=0;i<2;++i)
+				if(position[i]!=other.position[i])
+					return position[i]<other.position[i];
+			return position[2]<other.position[2];
+			}
+		};
+	
+	struct ClusterVertex // Structure to group vertices by simplification grid cell by sorting
+		{
+		/* Elements: */
+		public:
+		size_t cell; // Linear index of the grid cell containing the vertex
+		Card vertex; // Index of the merged vertex
+		
+		/* Methods: */
+		bool operator<(const ClusterVertex& other) const // Compares grid cell indices
+			{
+			return cell<other.cell;
+			}
+		};
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
 		public:
 		GLuint vertexBufferId; // ID of vertex buffer object for point data (or 0 if extension is not supported)
+		size_t numSubmittedTriangles; // Number of triangles submitted during the most recent rendering pass
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -76,6 +144,7 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 	std::vector<MeshVertex> vertices; // List of mesh vertices
 	std::vector<SubMesh> subMeshes; // List of mesh parts
 	SubMesh currentSubMesh; // The currently added submesh
+	MScalar maxPixelError; // Maximum projected error of a level of detail in pixels, or zero to always render full detail
 	TriangleKdTree triangleKdTree; // Kd-tree to support intersection tests
 	RenderBSPTree* bspTree; // BSP tree to support view-dependent rendering
 	
@@ -90,6 +159,8 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 	/* Private methods: */
 	bool limitRay(Point& p0,Point& p1) const; // Limits a ray to the extents of the model's bounding box; returns true if ray intersects domain
 	MScalar intersectSubMesh(Card subMeshIndex,const MRay& ray,MScalar lambdaMin,MScalar lambdaMax) const;
+	void simplifySubMesh(SubMesh& subMesh,unsigned int maxNumLevels); // Creates up to the given number of levels of detail for the given submesh
+	const LevelOfDetail* selectLevelOfDetail(const SubMesh& subMesh,const Frustum& frustum) const; // Returns the coarsest level of detail of the given submesh meeting the pixel error bound, or null for full detail
 	
 	/* Constructors and destructors: */
 	public:
@@ -102,6 +173,8 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 	virtual Point intersect(const Point& p0,const Point& p1) const;
 	virtual Scalar traceBox(const Box& box,const Vector& displacement,Vector& hitNormal) const;
 	virtual void loadBSPTree(const char* bspTreeFileName);
+	virtual void createLevelsOfDetail(unsigned int maxNumLevels,Scalar newMaxPixelError);
+	virtual size_t getNumRenderedTriangles(GLContextData& contextData) const;
 	
 	/* Methods from HierarchicalTriangleSetBase: */
 	virtual const HierarchicalTriangleSetBase::SubMesh* findSubMesh(const Point& p0,const Point& p1) const;
@@ -116,6 +189,7 @@ class HierarchicalTriangleSet:public HierarchicalTriangleSetBase,public GLObject
 	virtual void drawSubMesh(const HierarchicalTriangleSetBase::SubMesh& mesh,GLContextData& contextData) const;
 	
 	/* Methods from GLObject: */
+	virtual double getContextInitCost(void) const;
 	virtual void initContext(GLContextData& contextData) const;
 	
 	/* New Methods: */
@@ -7,6 +7,10 @@ Copyright (c) 2009 Oliver Kreylos
 #include "MaterialManager.h"
 
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <iostream>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/FileNameExtensions.h>
 #include <Misc/File.h>
@@ -16,22 +20,39 @@ Copyright (c) 2009 Oliver Kreylos
 #include <Images/PNMImageFileReader.h>
 #include <Images/TargaImageFileReader.h>
 #include <Images/ReadImageFile.h>
+#include <IO/File.h>
+#include <Threads/Thread.h>
+#include <Cluster/Multiplexer.h>
+#include <Cluster/MulticastPipe.h>
+#include <Cluster/OpenFile.h>
 
-/********************************
-Methods of class MaterialManager:
-********************************/
+namespace {
 
-MaterialManager::MaterialManager(std::string sImageNamePrefix,std::string sReplaceName)
-	:imageNamePrefix(sImageNamePrefix),
-	 replaceName(sReplaceName)
-	{
-	}
+/*************************************************************
+Identifier at the beginning of compressed texture cache files:
+*************************************************************/
 
-MaterialManager::~MaterialManager(void)
+const char cacheFileMagic[8]={'M','V','D','X','T','C','C','H'};
+
+void getSourceStamp(const std::string& imageName,Misc::UInt64 sourceStamp[2]) // Returns the size and modification time of the given image file, or zeros if the file does not exist
 	{
+	struct stat sourceStat;
+	if(stat(imageName.c_str(),&sourceStat)==0)
+		{
+		sourceStamp[0]=Misc::UInt64(sourceStat.st_size);
+		sourceStamp[1]=Misc::UInt64(sourceStat.st_mtime);
+		}
+	else
+		sourceStamp[0]=sourceStamp[1]=0;
 	}
 
-Texture MaterialManager::loadTexture(std::string imageFileName) const
+}
+
+/********************************
+Methods of class MaterialManager:
+********************************/
+
+std::string MaterialManager::translateImageName(const std::string& imageFileName) const
 	{
 	/* Remove the image name prefix from the image file name: */
 	std::string::const_iterator ifnIt=imageFileName.begin();
@@ -60,13 +81,18 @@ Texture MaterialManager::loadTexture(std::string imageFileName) const
 		imageName=imageFileName;
 		}
 	
+	return imageName;
+	}
+
+Texture MaterialManager::processImageFile(const std::string& imageName) const
+	{
 	/* Load the image file: */
 	Images::RGBImage rgbImage;
 	Images::RGBAImage rgbaImage;
 	bool haveAlpha=false;
 	const char* extPtr=Misc::getExtension(imageName.c_str());
 	if(*extPtr=='\0')
-		Misc::throwStdErr("MaterialManager::loadTexture: Image file name %s has no extension",imageFileName.c_str());
+		Misc::throwStdErr("MaterialManager::processImageFile: Image file name %s has no extension",imageName.c_str());
 	else if(strcasecmp(extPtr,".iff")==0||strcasecmp(extPtr,".col")==0||strcasecmp(extPtr,".map")==0)
 		{
 		Misc::File imageFile(imageName.c_str(),"rb");
@@ -93,17 +119,207 @@ Texture MaterialManager::loadTexture(std::string imageFileName) const
 		haveAlpha=true;
 		}
 	
-	/* Create a texture from the read image: */
+	/* Create a texture with a full mipmap pyramid from the read image: */
+	Texture result;
 	if(haveAlpha)
 		{
-		Texture result(Texture::Size(rgbaImage.getWidth(),rgbaImage.getHeight()),0x0,Texture::RGBA,0);
+		result=Texture(Texture::Size(rgbaImage.getWidth(),rgbaImage.getHeight()),0x0,Texture::RGBA);
 		result.setLevelData(0,rgbaImage.getPixels(),rgbaImage.getWidth()*rgbaImage.getHeight()*sizeof(Images::RGBAImage::Color));
-		return result;
 		}
 	else
 		{
-		Texture result(Texture::Size(rgbImage.getWidth(),rgbImage.getHeight()),0x0,Texture::RGB,0);
+		result=Texture(Texture::Size(rgbImage.getWidth(),rgbImage.getHeight()),0x0,Texture::RGB);
 		result.setLevelData(0,rgbImage.getPixels(),rgbImage.getWidth()*rgbImage.getHeight()*sizeof(Images::RGBImage::Color));
-		return result;
 		}
+	result.generateMipMaps();
+	
+	/* Compress the texture if requested: */
+	if(compressTextures)
+		result=result.compress();
+	
+	return result;
+	}
+
+void* MaterialManager::workerThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next job: */
+		TextureSlot* slot;
+		{
+		Threads::MutexCond::Lock textureLock(textureCond);
+		while(!shutdown&&jobQueue.empty())
+			textureCond.wait(textureLock);
+		if(shutdown)
+			break;
+		slot=jobQueue.front();
+		jobQueue.pop_front();
+		}
+		
+		/* Process the job's image file; all intermediate textures are destroyed before the slot is marked ready, as texture reference counts are not thread-safe: */
+		try
+			{
+			slot->texture=processImageFile(slot->imageName);
+			slot->writeCache=compressTextures&&useTextureCache;
+			}
+		catch(std::runtime_error err)
+			{
+			slot->error=err.what();
+			}
+		
+		/* Hand the texture to the waiting thread: */
+		{
+		Threads::MutexCond::Lock textureLock(textureCond);
+		slot->ready=true;
+		textureCond.broadcast();
+		}
+		}
+	
+	return 0;
+	}
+
+MaterialManager::MaterialManager(std::string sImageNamePrefix,std::string sReplaceName,unsigned int sNumWorkers,bool sCompressTextures,bool sUseTextureCache)
+	:imageNamePrefix(sImageNamePrefix),
+	 replaceName(sReplaceName),
+	 compressTextures(sCompressTextures),
+	 useTextureCache(sUseTextureCache),
+	 numWorkers(sNumWorkers),
+	 textures(17),
+	 shutdown(false),
+	 workers(0)
+	{
+	/* Create one worker thread per CPU by default: */
+	if(numWorkers==0)
+		{
+		long numCpus=sysconf(_SC_NPROCESSORS_ONLN);
+		numWorkers=numCpus>0?(unsigned int)(numCpus):1U;
+		}
+	}
+
+MaterialManager::~MaterialManager(void)
+	{
+	if(workers!=0)
+		{
+		/* Shut down the worker threads: */
+		{
+		Threads::MutexCond::Lock textureLock(textureCond);
+		shutdown=true;
+		textureCond.broadcast();
+		}
+		for(unsigned int i=0;i<numWorkers;++i)
+			workers[i].join();
+		delete[] workers;
+		}
+	
+	/* Delete all texture slots: */
+	for(TextureMap::Iterator tIt=textures.begin();!tIt.isFinished();++tIt)
+		delete tIt->getDest();
+	}
+
+void MaterialManager::prefetchTexture(std::string imageFileName,Cluster::Multiplexer* multiplexer)
+	{
+	/* Check if the texture has already been requested: */
+	std::string imageName=translateImageName(imageFileName);
+	{
+	Threads::MutexCond::Lock textureLock(textureCond);
+	if(textures.isEntry(imageName))
+		return;
+	}
+	
+	TextureSlot* slot=new TextureSlot(imageName);
+	if(compressTextures&&useTextureCache)
+		{
+		/* Stamp the image file on the master node to validate an existing cache file and to write a new one: */
+		bool master=multiplexer==0||multiplexer->isMaster();
+		if(master)
+			getSourceStamp(imageName,slot->sourceStamp);
+		
+		/* Try reading the texture from its cache file, from the calling thread to keep cluster file operations in order: */
+		try
+			{
+			IO::FilePtr cacheFile=Cluster::openFile(multiplexer,(imageName+".dxtcache").c_str());
+			cacheFile->setEndianness(Misc::LittleEndian);
+			
+			/* Check the cache file's header against the image file's current stamp: */
+			char magic[sizeof(cacheFileMagic)];
+			cacheFile->read<char>(magic,sizeof(cacheFileMagic));
+			Misc::UInt64 cacheStamp[2];
+			cacheFile->read<Misc::UInt64>(cacheStamp,2);
+			bool cacheValid=memcmp(magic,cacheFileMagic,sizeof(cacheFileMagic))==0&&slot->sourceStamp[0]!=0&&cacheStamp[0]==slot->sourceStamp[0]&&cacheStamp[1]==slot->sourceStamp[1];
+			
+			/* Distribute the master's decision to all cluster nodes: */
+			if(multiplexer!=0)
+				{
+				Cluster::MulticastPipe pipe(multiplexer);
+				pipe.broadcast(cacheValid);
+				if(master)
+					pipe.flush();
+				}
+			
+			if(cacheValid)
+				{
+				slot->texture=Texture::read(*cacheFile);
+				slot->ready=true;
+				}
+			}
+		catch(std::runtime_error)
+			{
+			/* Process the image file instead: */
+			}
+		}
+	
+	/* Add the texture slot and queue a job if the texture is not ready yet: */
+	Threads::MutexCond::Lock textureLock(textureCond);
+	textures.setEntry(TextureMap::Entry(imageName,slot));
+	if(!slot->ready)
+		{
+		/* Create the worker threads on the first job: */
+		if(workers==0)
+			{
+			workers=new Threads::Thread[numWorkers];
+			for(unsigned int i=0;i<numWorkers;++i)
+				workers[i].start(this,&MaterialManager::workerThreadMethod);
+			}
+		
+		jobQueue.push_back(slot);
+		textureCond.broadcast();
+		}
+	}
+
+Texture MaterialManager::loadTexture(std::string imageFileName,Cluster::Multiplexer* multiplexer)
+	{
+	/* Request the texture if it has not been prefetched: */
+	prefetchTexture(imageFileName,multiplexer);
+	
+	/* Wait until the texture is ready: */
+	TextureSlot* slot;
+	{
+	Threads::MutexCond::Lock textureLock(textureCond);
+	slot=textures.getEntry(translateImageName(imageFileName)).getDest();
+	while(!slot->ready)
+		textureCond.wait(textureLock);
+	}
+	
+	if(!slot->error.empty())
+		throw std::runtime_error(slot->error);
+	
+	if(slot->writeCache)
+		{
+		/* Write the processed texture to its cache file; failure to do so is not an error: */
+		slot->writeCache=false;
+		try
+			{
+			IO::FilePtr cacheFile=Cluster::openFile(multiplexer,(slot->imageName+".dxtcache").c_str(),IO::File::WriteOnly);
+			cacheFile->setEndianness(Misc::LittleEndian);
+			cacheFile->write<char>(cacheFileMagic,sizeof(cacheFileMagic));
+			cacheFile->write<Misc::UInt64>(slot->sourceStamp,2);
+			slot->texture.write(*cacheFile);
+			}
+		catch(std::runtime_error err)
+			{
+			std::cerr<<"MaterialManager::loadTexture: Unable to write texture cache file for image "<<slot->imageName<<" due to exception "<<err.what()<<std::endl;
+			}
+		}
+	
+	return slot->texture;
 	}
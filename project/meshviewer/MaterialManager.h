@@ -8,23 +8,73 @@ Copyright (c) 2009 Oliver Kreylos
 #define MATERIALMANAGER_INCLUDED
 
 #include <string>
+#include <deque>
+#include <Misc/SizedTypes.h>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/MutexCond.h>
 
 #include "Texture.h"
 
+/* Forward declarations: */
+namespace Threads {
+class Thread;
+}
+namespace Cluster {
+class Multiplexer;
+}
+
 class MaterialManager
 	{
-	/* Elements: */
+	/* Embedded classes: */
 	private:
+	struct TextureSlot // Structure holding the loading state of a requested texture
+		{
+		/* Elements: */
+		public:
+		std::string imageName; // Translated name of the texture's image file
+		bool ready; // Flag whether the texture has been loaded, or loading it failed
+		bool writeCache; // Flag whether the texture still needs to be written to its cache file
+		Misc::UInt64 sourceStamp[2]; // Size and modification time of the image file when the texture was requested; only valid on the master node
+		Texture texture; // The loaded texture; only written by worker threads while ready is false
+		std::string error; // Error message if loading the texture failed
+		
+		/* Constructors and destructors: */
+		TextureSlot(const std::string& sImageName)
+			:imageName(sImageName),
+			 ready(false),writeCache(false)
+			{
+			sourceStamp[0]=sourceStamp[1]=0;
+			}
+		};
+	
+	typedef Misc::HashTable<std::string,TextureSlot*> TextureMap; // Hash table type to map translated image names to texture slots
+	
+	/* Elements: */
 	std::string imageNamePrefix; // The prefix of image names that will be replaced with the replace name
 	std::string replaceName; // The name with which to replace the image name prefix
+	bool compressTextures; // Flag whether to compress loaded textures to DXT formats
+	bool useTextureCache; // Flag whether to read and write compressed texture cache files alongside image files
+	unsigned int numWorkers; // Number of worker threads processing image files
+	Threads::MutexCond textureCond; // Condition variable protecting the texture map and job queue; signalled when jobs are queued or finished
+	TextureMap textures; // Map of all requested textures
+	std::deque<TextureSlot*> jobQueue; // Queue of textures waiting to be processed by a worker thread
+	bool shutdown; // Flag to shut down the worker threads
+	Threads::Thread* workers; // Array of worker threads; created when the first job is queued
+	
+	/* Private methods: */
+	std::string translateImageName(const std::string& imageFileName) const; // Applies name transformations to the given image file name
+	Texture processImageFile(const std::string& imageName) const; // Reads the given image file and converts it into a mipmapped and optionally compressed texture
+	void* workerThreadMethod(void); // Thread method processing queued image files
 	
 	/* Constructors and destructors: */
 	public:
-	MaterialManager(std::string sImageNamePrefix,std::string sReplaceName); // Creates an empty material manager with the given file name translation
+	MaterialManager(std::string sImageNamePrefix,std::string sReplaceName,unsigned int sNumWorkers =0,bool sCompressTextures =true,bool sUseTextureCache =true); // Creates an empty material manager with the given file name translation and the given number of worker threads, or one per CPU if zero
 	~MaterialManager(void); // Destroys the material manager
 	
 	/* Methods: */
-	Texture loadTexture(std::string imageFileName) const; // Attempts to load a texture from the image file of the given name; applies name transformations etc.
+	void prefetchTexture(std::string imageFileName,Cluster::Multiplexer* multiplexer =0); // Starts loading a texture from the image file of the given name in the background; must be called in the same order on all cluster nodes
+	Texture loadTexture(std::string imageFileName,Cluster::Multiplexer* multiplexer =0); // Attempts to load a texture from the image file of the given name; applies name transformations etc.; must be called in the same order on all cluster nodes
 	};
 
 #endif
@@ -78,6 +78,22 @@ void MultiModel::loadBSPTree(const char* bspTreeFileName)
 		(*pIt)->loadBSPTree(bspTreeFileName);
 	}
 
+void MultiModel::createLevelsOfDetail(unsigned int maxNumLevels,MultiModel::Scalar maxPixelError)
+	{
+	/* Create levels of detail for all model parts: */
+	for(std::vector<PolygonModel*>::iterator pIt=parts.begin();pIt!=parts.end();++pIt)
+		(*pIt)->createLevelsOfDetail(maxNumLevels,maxPixelError);
+	}
+
+size_t MultiModel::getNumRenderedTriangles(GLContextData& contextData) const
+	{
+	/* Add the triangle counts of all model parts: */
+	size_t result=0;
+	for(std::vector<PolygonModel*>::const_iterator pIt=parts.begin();pIt!=parts.end();++pIt)
+		result+=(*pIt)->getNumRenderedTriangles(contextData);
+	return result;
+	}
+
 void MultiModel::addPart(PolygonModel* newPart)
 	{
 	parts.push_back(newPart);
@@ -31,6 +31,8 @@ class MultiModel:public PolygonModel
 	virtual Point intersect(const Point& p0,const Point& p1) const;
 	virtual Scalar traceBox(const Box& box,const Vector& displacement,Vector& hitNormal) const;
 	virtual void loadBSPTree(const char* bspTreeFileName);
+	virtual void createLevelsOfDetail(unsigned int maxNumLevels,Scalar maxPixelError);
+	virtual size_t getNumRenderedTriangles(GLContextData& contextData) const;
 	
 	/* New methods: */
 	void addPart(PolygonModel* newPart); // Adds the given model to the multi model
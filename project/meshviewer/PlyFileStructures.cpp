@@ -253,7 +253,7 @@ PLYProperty::Value::Value(const PLYProperty& property)
 		{
 		/* Allocate space for list size: */
 		listSize=PLYDataValueFactory::newDataValue(property.getListSizeType());
-
+		
 		/* Create one list element to get started: */
 		listElements.push_back(PLYDataValueFactory::newDataValue(property.getListElementType()));
 		}
@@ -380,6 +380,9 @@ PLYFileHeader::PLYFileHeader(IO::File& plyFile)
 	IO::ValueSource ply(&plyFile);
 	ply.skipWs();
 	
+	/* Treat newlines as separate tokens to not skip whitespace or NUL bytes at the beginning of binary data: */
+	ply.setPunctuation('\n',true);
+	
 	/* Process the PLY file header: */
 	std::vector<PLYElement>::iterator currentElement=elements.end();
 	bool isPly=false;
@@ -388,7 +391,12 @@ PLYFileHeader::PLYFileHeader(IO::File& plyFile)
 		{
 		/* Read the next tag: */
 		std::string tag=ply.readString();
-		if(tag=="ply")
+		if(tag=="\n")
+			{
+			/* Ignore empty lines: */
+			continue;
+			}
+		else if(tag=="ply")
 			isPly=true;
 		else if(tag=="format")
 			{
@@ -415,12 +423,6 @@ PLYFileHeader::PLYFileHeader(IO::File& plyFile)
 			if(version!=1.0)
 				break;
 			}
-		else if(tag=="comment")
-			{
-			/* Skip the rest of the line: */
-			ply.skipLine();
-			ply.skipWs();
-			}
 		else if(tag=="element")
 			{
 			/* Read the element type and number of elements: */
@@ -438,24 +440,18 @@ PLYFileHeader::PLYFileHeader(IO::File& plyFile)
 				/* Parse a property: */
 				currentElement->addProperty(ply);
 				}
-			else
-				{
-				/* Skip the property: */
-				ply.skipLine();
-				ply.skipWs();
-				}
 			}
 		else if(tag=="end_header")
 			{
+			/* Skip the rest of the line; the file's data starts right after: */
+			ply.skipLine();
 			haveEndHeader=true;
 			break;
 			}
-		else
-			{
-			/* Skip the unknown tag: */
-			ply.skipLine();
-			ply.skipWs();
-			}
+		
+		/* Skip the rest of the line, including comments, properties outside of elements, and unknown tags: */
+		ply.skipLine();
+		ply.skipWs();
 		}
 	
 	/* Check if the header was read completely: */
@@ -466,6 +462,15 @@ PLYFileHeader::PLYFileHeader(IO::File& plyFile)
 Global functions:
 ****************/
 
+size_t getPLYDataTypeSize(PLYDataType dataType)
+	{
+	static const size_t dataTypeSizes[]=
+		{
+		1,1,2,2,4,4,4,8
+		};
+	return dataTypeSizes[dataType];
+	}
+
 void skipElement(const PLYElement& element,IO::File& plyFile)
 	{
 	/* Check if the element has variable size: */
@@ -250,7 +250,7 @@ class PLYElement
 	bool hasListProperty(void) const // Returns true if the element has at least one list property
 		{
 		bool result=false;
-		for(PropertyList::const_iterator pIt=properties.begin();!result&&pIt!=properties.end();++pIt,++result)
+		for(PropertyList::const_iterator pIt=properties.begin();!result&&pIt!=properties.end();++pIt)
 			result=pIt->getPropertyType()==PLYProperty::LIST;
 		return result;
 		}
@@ -327,6 +327,7 @@ struct PLYFileHeader // Structure containing relevant information from a PLY fil
 Global functions:
 ****************/
 
+size_t getPLYDataTypeSize(PLYDataType dataType); // Returns the size of a value of the given data type in binary PLY files
 void skipElement(const PLYElement& element,IO::File& plyFile); // Skips all values associated with the given element in the given binary PLY file
 void skipElement(const PLYElement& element,IO::ValueSource& plyFile); // Skips all values associated with the given element in the given ASCII PLY file
 
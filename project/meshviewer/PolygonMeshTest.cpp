@@ -419,6 +419,7 @@ PolygonMeshTest::PolygonMeshTest(int& argc,char**& argv,char**& appDefaults)
 	 model(0),
 	 upVector(0,0,1),
 	 showBackfaces(false),
+	 printTriangleStats(false),nextTriangleStatsTime(0.0),
 	 subMesh(0),
 	 mainMenu(0),subMeshDialog(0)
 	{
@@ -434,11 +435,23 @@ PolygonMeshTest::PolygonMeshTest(int& argc,char**& argv,char**& appDefaults)
 	toolFactory2->setValuatorFunction(0,"Forwarded Valuator");
 	Vrui::getToolManager()->addClass(toolFactory2,Vrui::ToolManager::defaultToolFactoryDestructor);
 	
+	/* Reset the rendered triangle counters: */
+	for(int eye=0;eye<2;++eye)
+		{
+		numRenderedTriangles[eye]=0;
+		numRenderedEyes[eye]=0;
+		}
+	
 	/* Parse the command line: */
 	const char* imagePrefix="";
 	const char* imageReplace="";
 	std::vector<const char*> modelFileNames;
 	const char* bspTreeFileName=0;
+	unsigned int numLevelsOfDetail=0;
+	PolygonModel::Scalar maxPixelError(1);
+	unsigned int numTextureThreads=0;
+	bool compressTextures=true;
+	bool useTextureCache=true;
 	Geometry::LinearUnit linearUnit;
 	for(int i=1;i<argc;++i)
 		{
@@ -459,6 +472,26 @@ PolygonMeshTest::PolygonMeshTest(int& argc,char**& argv,char**& appDefaults)
 				++i;
 				bspTreeFileName=argv[i];
 				}
+			else if(strcasecmp(argv[i]+1,"lod")==0)
+				{
+				/* Create levels of detail with the given maximum number of levels and maximum projected error in pixels: */
+				++i;
+				numLevelsOfDetail=atoi(argv[i]);
+				++i;
+				maxPixelError=PolygonModel::Scalar(atof(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"textureThreads")==0)
+				{
+				/* Set the number of threads loading texture images: */
+				++i;
+				numTextureThreads=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"noTextureCompression")==0)
+				compressTextures=false;
+			else if(strcasecmp(argv[i]+1,"noTextureCache")==0)
+				useTextureCache=false;
+			else if(strcasecmp(argv[i]+1,"triangleStats")==0)
+				printTriangleStats=true;
 			else if(strcasecmp(argv[i]+1,"up")==0)
 				{
 				for(int j=0;j<3;++j)
@@ -484,7 +517,7 @@ PolygonMeshTest::PolygonMeshTest(int& argc,char**& argv,char**& appDefaults)
 		Misc::throwStdErr("PolygonMeshTest::PolygonMeshTest: No model file name given");
 	
 	/* Create a material manager: */
-	materialManager=new MaterialManager(imagePrefix,imageReplace);
+	materialManager=new MaterialManager(imagePrefix,imageReplace,numTextureThreads,compressTextures,useTextureCache);
 	
 	/* Load all model files: */
 	MultiModel* mm=0;
@@ -559,6 +592,13 @@ PolygonMeshTest::PolygonMeshTest(int& argc,char**& argv,char**& appDefaults)
 		model->loadBSPTree(bspTreeFileName);
 		}
 	
+	if(numLevelsOfDetail>0)
+		{
+		/* Create simplified versions of the model: */
+		std::cout<<"Creating up to "<<numLevelsOfDetail<<" levels of detail with maximum projected error "<<maxPixelError<<" pixels"<<std::endl;
+		model->createLevelsOfDetail(numLevelsOfDetail,maxPixelError);
+		}
+	
 	/* Print the model's bounding box: */
 	PolygonModel::Box bbox=model->calcBoundingBox();
 	std::cout<<"Model bounding box: "<<bbox.min[0]<<" "<<bbox.min[1]<<" "<<bbox.min[2]<<" "<<bbox.max[0]<<" "<<bbox.max[1]<<" "<<bbox.max[2]<<std::endl;
@@ -610,6 +650,33 @@ void PolygonMeshTest::toolCreationCallback(Vrui::ToolManager::ToolCreationCallba
 
 void PolygonMeshTest::frame(void)
 	{
+	if(printTriangleStats&&Vrui::getApplicationTime()>=nextTriangleStatsTime)
+		{
+		/* Retrieve and reset the rendered triangle counters: */
+		size_t numTriangles[2];
+		unsigned int numEyes[2];
+		{
+		Threads::Mutex::Lock triangleStatsLock(triangleStatsMutex);
+		for(int eye=0;eye<2;++eye)
+			{
+			numTriangles[eye]=numRenderedTriangles[eye];
+			numRenderedTriangles[eye]=0;
+			numEyes[eye]=numRenderedEyes[eye];
+			numRenderedEyes[eye]=0;
+			}
+		}
+		
+		/* Print the average number of triangles rendered per eye per frame: */
+		std::cout<<"Rendered triangles per frame:";
+		static const char* eyeNames[2]={"left/mono","right"};
+		for(int eye=0;eye<2;++eye)
+			if(numEyes[eye]>0)
+				std::cout<<' '<<eyeNames[eye]<<' '<<numTriangles[eye]/numEyes[eye];
+		std::cout<<std::endl;
+		
+		nextTriangleStatsTime=Vrui::getApplicationTime()+1.0;
+		}
+	
 	#if 0
 	
 	/* Trace the test box from its current position to the center of the display: */
@@ -674,6 +741,16 @@ void PolygonMeshTest::display(GLContextData& contextData) const
 		}
 	model->glRenderAction(contextData);
 	
+	if(printTriangleStats)
+		{
+		/* Add the number of triangles rendered for the current eye to its counter: */
+		int eye=Vrui::getDisplayState(contextData).eyeIndex==1?1:0;
+		size_t numTriangles=model->getNumRenderedTriangles(contextData);
+		Threads::Mutex::Lock triangleStatsLock(triangleStatsMutex);
+		numRenderedTriangles[eye]+=numTriangles;
+		++numRenderedEyes[eye];
+		}
+	
 	if(subMesh!=0)
 		{
 		/* Check if the model is a hierarchical triangle set or contains one: */
@@ -784,7 +861,7 @@ void PolygonMeshTest::updateSubMeshDialog(void)
 			subMeshDialog=createSubMeshDialog();
 			Vrui::popupPrimaryWidget(subMeshDialog);
 			}
-
+		
 		/* Update the submesh data: */
 		nameField->setString(subMesh->getName().c_str());
 		numTrianglesField->setValue((unsigned int)(subMesh->getNumTriangles()));
@@ -6,6 +6,8 @@ Copyright (c) 2009-2012 Oliver Kreylos
 #ifndef POLYGONMESHTEST_INCLUDED
 #define POLYGONMESHTEST_INCLUDED
 
+#include <stddef.h>
+#include <Threads/Mutex.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
 #include <Geometry/OrthogonalTransformation.h>
@@ -104,6 +106,11 @@ class PolygonMeshTest:public Vrui::Application
 	Vrui::Vector upVector; // Vector defining the "up" direction in model space
 	PolygonModel::Scalar epsilon; // Small fudge value to robustify collision detection inside the model
 	bool showBackfaces; // Flag whether to render back-facing polygons
+	bool printTriangleStats; // Flag whether to periodically print the number of rendered triangles per eye
+	mutable Threads::Mutex triangleStatsMutex; // Mutex serializing access to the rendered triangle counters
+	mutable size_t numRenderedTriangles[2]; // Number of triangles rendered for the left and right eyes since the last statistics report
+	mutable unsigned int numRenderedEyes[2]; // Number of times the left and right eyes were rendered since the last statistics report
+	double nextTriangleStatsTime; // Application time at which to print the next statistics report
 	const HierarchicalTriangleSetBase::SubMesh* subMesh; // Pointer to highlighted submesh
 	GLMotif::PopupMenu* mainMenu; // The application's main menu
 	GLMotif::PopupWindow* subMeshDialog;
@@ -7,6 +7,7 @@ Copyright (c) 2009-2012 Oliver Kreylos
 #ifndef POLYGONMODEL_INCLUDED
 #define POLYGONMODEL_INCLUDED
 
+#include <stddef.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
 #include <Geometry/Box.h>
@@ -42,6 +43,14 @@ class PolygonModel
 		{
 		/* Default model don't support BSP trees */
 		}
+	virtual void createLevelsOfDetail(unsigned int maxNumLevels,Scalar maxPixelError) // Creates simplified versions of the model, rendered where their projected error is below the given number of pixels
+		{
+		/* Default models don't support levels of detail */
+		}
+	virtual size_t getNumRenderedTriangles(GLContextData& contextData) const // Returns the number of triangles submitted by the most recent glRenderAction call in the given OpenGL context
+		{
+		return 0;
+		}
 	};
 
 #endif
@@ -317,7 +317,8 @@ void
 readLWOBFile(
 	IFFChunk<DataSourceParam>& formChunk,
 	MaterialManager& materialManager,
-	MyTriangleSet& triangleSet)
+	MyTriangleSet& triangleSet,
+	Cluster::Multiplexer* multiplexer)
 	{
 	/* Embedded classes: */
 	typedef IFFChunk<DataSourceParam> Chunk;
@@ -591,7 +592,7 @@ readLWOBFile(
 				try
 					{
 					/* Load the diffuse texture and create a Phong texture material: */
-					Texture diffuseMap=materialManager.loadTexture(surface.diffuseMap.imageName);
+					Texture diffuseMap=materialManager.loadTexture(surface.diffuseMap.imageName,multiplexer);
 					surfaceMaterial=new PhongTextureMaterial(material,diffuseMap);
 					}
 				catch(std::runtime_error err)
@@ -667,7 +668,8 @@ void
 readLWO2File(
 	IFFChunk<DataSourceParam>& formChunk,
 	MaterialManager& materialManager,
-	MyTriangleSet& triangleSet)
+	MyTriangleSet& triangleSet,
+	Cluster::Multiplexer* multiplexer)
 	{
 	/* Embedded classes: */
 	typedef IFFChunk<DataSourceParam> Chunk;
@@ -1038,7 +1040,7 @@ readLWO2File(
 				try
 					{
 					/* Create a Phong-illuminated surface with textured color channel: */
-					PhongTextureMaterial* phongTexMat=new PhongTextureMaterial(material,materialManager.loadTexture(tmap->imageName));
+					PhongTextureMaterial* phongTexMat=new PhongTextureMaterial(material,materialManager.loadTexture(tmap->imageName,multiplexer));
 					if(surface.flags&Surface::DOUBLE_SIDED)
 						phongTexMat->setTwoSided(true);
 					surfaceMaterial=phongTexMat;
@@ -1124,7 +1126,8 @@ void
 readLWOFile(
 	DataSourceParam& dataSource,
 	MaterialManager& materialManager,
-	MyTriangleSet& triangleSet)
+	MyTriangleSet& triangleSet,
+	Cluster::Multiplexer* multiplexer)
 	{
 	/* Read the FORM chunk: */
 	IFFChunk<DataSourceParam> formChunk(dataSource);
@@ -1138,7 +1141,7 @@ readLWOFile(
 		{
 		try
 			{
-			readLWOBFile(formChunk,materialManager,triangleSet);
+			readLWOBFile(formChunk,materialManager,triangleSet,multiplexer);
 			}
 		catch(std::runtime_error err)
 			{
@@ -1149,7 +1152,7 @@ readLWOFile(
 		{
 		try
 			{
-			readLWO2File(formChunk,materialManager,triangleSet);
+			readLWO2File(formChunk,materialManager,triangleSet,multiplexer);
 			}
 		catch(std::runtime_error err)
 			{
@@ -1177,7 +1180,7 @@ PolygonModel* readLWOFile(const char* fileName,MaterialManager& materialManager,
 	/* Read the file: */
 	try
 		{
-		readLWOFile(*lwoFile,materialManager,*result);
+		readLWOFile(*lwoFile,materialManager,*result,multiplexer);
 		}
 	catch(std::runtime_error err)
 		{
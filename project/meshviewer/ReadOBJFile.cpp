@@ -249,61 +249,78 @@ std::string trim(std::string s)
 	return result;
 	}
 
+struct MaterialDefinition // Structure to hold a material definition read from a material file
+	{
+	/* Elements: */
+	public:
+	std::string name; // Name of the material
+	GLMaterial phong; // Phong material properties
+	std::string diffuseTextureName; // Name of diffuse texture image, or empty
+	};
+
+void addMaterial(const MaterialDefinition& material,MaterialManager& materialManager,MaterialMap& materialMap,Cluster::Multiplexer* multiplexer)
+	{
+	if(materialMap.isEntry(material.name))
+		return;
+	
+	/* Add the material to the material map: */
+	GLMaterial::Color black(0.0f,0.0f,0.0f,1.0f);
+	const GLMaterial& phong=material.phong;
+	if(!material.diffuseTextureName.empty())
+		{
+		/* Load the texture map: */
+		Texture diffuseTexture=materialManager.loadTexture(material.diffuseTextureName,multiplexer);
+		
+		if(phong.ambient!=black||phong.diffuse!=black||phong.specular!=black||phong.emission!=black)
+			{
+			/* Create a Phong texture material: */
+			MaterialPointer mat=new PhongTextureMaterial(phong,diffuseTexture);
+			materialMap.setEntry(MaterialMap::Entry(material.name,mat));
+			}
+		else
+			{
+			/* Create a texture material: */
+			MaterialPointer mat=new TextureMaterial(diffuseTexture);
+			materialMap.setEntry(MaterialMap::Entry(material.name,mat));
+			}
+		}
+	else
+		{
+		/* Create a Phong material: */
+		MaterialPointer mat=new PhongMaterial(phong);
+		materialMap.setEntry(MaterialMap::Entry(material.name,mat));
+		}
+	}
+
 void readMaterialFile(const char* fileName,std::string baseDirectory,MaterialManager& materialManager,MaterialMap& materialMap,Cluster::Multiplexer* multiplexer)
 	{
 	/* Open the input file: */
 	OBJValueSource mtlFile(Cluster::openFile(multiplexer,fileName),fileName);
 	
-	/* Read the file: */
+	/* Read all material definitions, prefetching their texture images in the background: */
+	std::vector<MaterialDefinition> materials;
 	bool inMaterial=false; // Flag whether parser is currently parsing a material definition
-	std::string materialName; // Name of currently parsed material
-	GLMaterial phong; // Phong material properties of current material
-	GLMaterial::Color black(0.0f,0.0f,0.0f,1.0f);
-	std::string diffuseTextureName; // Name of diffuse texture image
+	MaterialDefinition material; // Currently parsed material
+	GLMaterial& phong=material.phong; // Phong material properties of current material
 	while(!mtlFile.eof())
 		{
 		/* Read the tag: */
 		std::string tag=mtlFile.readString();
 		if(tag=="newmtl")
 			{
-			if(inMaterial&&!materialMap.isEntry(materialName))
-				{
-				/* Add the current material to the material map: */
-				if(!diffuseTextureName.empty())
-					{
-					/* Load the texture map: */
-					Texture diffuseTexture=materialManager.loadTexture(diffuseTextureName);
-					
-					if(phong.ambient!=black||phong.diffuse!=black||phong.specular!=black||phong.emission!=black)
-						{
-						/* Create a Phong texture material: */
-						MaterialPointer mat=new PhongTextureMaterial(phong,diffuseTexture);
-						materialMap.setEntry(MaterialMap::Entry(materialName,mat));
-						}
-					else
-						{
-						/* Create a texture material: */
-						MaterialPointer mat=new TextureMaterial(diffuseTexture);
-						materialMap.setEntry(MaterialMap::Entry(materialName,mat));
-						}
-					}
-				else
-					{
-					/* Create a Phong material: */
-					MaterialPointer mat=new PhongMaterial(phong);
-					materialMap.setEntry(MaterialMap::Entry(materialName,mat));
-					}
-				}
+			/* Store the current material definition: */
+			if(inMaterial)
+				materials.push_back(material);
 			
 			/* Start a new material: */
 			inMaterial=true;
-			materialName=trim(mtlFile.readLine());
+			material.name=trim(mtlFile.readLine());
 			phong.ambient=GLMaterial::Color(0.0f,0.0f,0.0f);
 			phong.diffuse=GLMaterial::Color(0.8f,0.8f,0.8f);
 			phong.specular=GLMaterial::Color(0.4f,0.4f,0.4f);
 			phong.shininess=25.0f;
 			phong.emission=GLMaterial::Color(0.0f,0.0f,0.0f);
-			diffuseTextureName.clear();
+			material.diffuseTextureName.clear();
 			}
 		else if(tag=="Ka")
 			phong.ambient=mtlFile.readColor();
@@ -333,9 +350,10 @@ void readMaterialFile(const char* fileName,std::string baseDirectory,MaterialMan
 			}
 		else if(tag=="map_Kd")
 			{
-			/* Read the texture name: */
-			diffuseTextureName=baseDirectory;
-			diffuseTextureName.append(trim(mtlFile.readLine()));
+			/* Read the texture name and start loading the texture image: */
+			material.diffuseTextureName=baseDirectory;
+			material.diffuseTextureName.append(trim(mtlFile.readLine()));
+			materialManager.prefetchTexture(material.diffuseTextureName,multiplexer);
 			}
 		else if(tag=="illum")
 			{
@@ -368,26 +386,13 @@ void readMaterialFile(const char* fileName,std::string baseDirectory,MaterialMan
 		mtlFile.finishLine();
 		}
 	
-	/* Terminate any dangling materials: */
-	if(inMaterial&&!materialMap.isEntry(materialName))
-		{
-		/* Add the current material to the material map: */
-		if(!diffuseTextureName.empty())
-			{
-			/* Load the texture map: */
-			Texture diffuseTexture=materialManager.loadTexture(diffuseTextureName);
-			
-			/* Create a Phong texture material: */
-			MaterialPointer mat=new PhongTextureMaterial(phong,diffuseTexture);
-			materialMap.setEntry(MaterialMap::Entry(materialName,mat));
-			}
-		else
-			{
-			/* Create a Phong material: */
-			MaterialPointer mat=new PhongMaterial(phong);
-			materialMap.setEntry(MaterialMap::Entry(materialName,mat));
-			}
-		}
+	/* Store any dangling material definition: */
+	if(inMaterial)
+		materials.push_back(material);
+	
+	/* Create all materials once their texture images are loaded: */
+	for(std::vector<MaterialDefinition>::const_iterator mIt=materials.begin();mIt!=materials.end();++mIt)
+		addMaterial(*mIt,materialManager,materialMap,multiplexer);
 	}
 
 }
@@ -629,7 +634,7 @@ PolygonModel* readOBJFiles(const std::vector<const char*>& fileNames,MaterialMan
 					
 					objFile.finishLine();
 					}
-
+				
 				/* Tesselate the curve/surface: */
 				if(csType=="bspline")
 					{
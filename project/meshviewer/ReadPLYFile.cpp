@@ -6,6 +6,10 @@ Copyright (c) 2011 Oliver Kreylos
 
 #include "ReadPLYFile.h"
 
+#include <string.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Misc/Endianness.h>
 #include <Misc/SelfDestructPointer.h>
 #include <Misc/ThrowStdErr.h>
 #include <IO/File.h>
@@ -32,6 +36,273 @@ typedef PolygonMesh<MyMeshVertex> MyPolygonMesh;
 Helper functions:
 ****************/
 
+struct VertexLayout // Structure describing the fixed record layout of a vertex element in a binary PLY file
+	{
+	/* Elements: */
+	public:
+	size_t recordSize; // Size of each vertex record in bytes
+	size_t posOffset[3]; // Offsets of the x, y, and z components inside each record
+	PLYDataType posType; // Common data type of the x, y, and z components
+	};
+
+bool compileVertexLayout(const PLYElement& element,VertexLayout& layout) // Compiles the given vertex element into a fixed record layout; returns false if the element has no fixed layout
+	{
+	/* Accumulate the record size and find the position components' offsets: */
+	static const char* posNames[3]={"x","y","z"};
+	bool havePos[3]={false,false,false};
+	layout.recordSize=0;
+	for(PLYElement::PropertyList::const_iterator pIt=element.propertiesBegin();pIt!=element.propertiesEnd();++pIt)
+		{
+		/* Bail out if the element contains a list property: */
+		if(pIt->getPropertyType()!=PLYProperty::SCALAR)
+			return false;
+		
+		for(int i=0;i<3;++i)
+			if(pIt->getName()==posNames[i])
+				{
+				/* Bail out if the position components have different types: */
+				if((havePos[0]||havePos[1]||havePos[2])&&pIt->getScalarType()!=layout.posType)
+					return false;
+				layout.posOffset[i]=layout.recordSize;
+				layout.posType=pIt->getScalarType();
+				havePos[i]=true;
+				}
+		
+		layout.recordSize+=getPLYDataTypeSize(pIt->getScalarType());
+		}
+	
+	/* Check that all position components exist and have a common floating-point type: */
+	if(!havePos[0]||!havePos[1]||!havePos[2])
+		return false;
+	return layout.posType==PLY_FLOAT32||layout.posType==PLY_FLOAT64;
+	}
+
+template <class PositionScalarParam>
+inline
+void
+addVertex(
+	const unsigned char* record,
+	const VertexLayout& layout,
+	bool swapEndianness,
+	MyPolygonMesh& mesh)
+	{
+	/* Extract the vertex position from the record: */
+	MyMeshVertex vertex;
+	for(int i=0;i<3;++i)
+		{
+		PositionScalarParam value;
+		memcpy(&value,record+layout.posOffset[i],sizeof(PositionScalarParam));
+		if(swapEndianness)
+			Misc::swapEndianness(value);
+		vertex.position[i]=MyMeshVertex::Scalar(value);
+		}
+	
+	/* Add the vertex to the mesh: */
+	mesh.addVertex(vertex);
+	}
+
+template <class PositionScalarParam>
+void readVertexRecords(IO::File& ply,const VertexLayout& layout,size_t numVertices,MyPolygonMesh& mesh) // Reads vertex records directly from the file's read buffer
+	{
+	bool swapEndianness=ply.mustSwapOnRead();
+	std::vector<unsigned char> partialRecord(layout.recordSize); // Buffer to assemble records straddling read buffer boundaries
+	size_t partialSize=0;
+	size_t numLeft=numVertices;
+	while(numLeft>0)
+		{
+		/* Access the next chunk of the file's read buffer, without reading past the vertex element: */
+		void* buffer;
+		size_t bufferSize=ply.readInBuffer(buffer,numLeft*layout.recordSize-partialSize);
+		if(bufferSize==0)
+			Misc::throwStdErr("readPlyFile: Premature end of file in vertex element");
+		const unsigned char* bPtr=static_cast<const unsigned char*>(buffer);
+		const unsigned char* bEnd=bPtr+bufferSize;
+		
+		if(partialSize>0)
+			{
+			/* Complete the partial record: */
+			size_t copySize=layout.recordSize-partialSize;
+			if(copySize>bufferSize)
+				copySize=bufferSize;
+			memcpy(&partialRecord[partialSize],bPtr,copySize);
+			partialSize+=copySize;
+			bPtr+=copySize;
+			if(partialSize==layout.recordSize)
+				{
+				addVertex<PositionScalarParam>(&partialRecord[0],layout,swapEndianness,mesh);
+				--numLeft;
+				partialSize=0;
+				}
+			}
+		
+		/* Process all complete records in the buffer: */
+		for(;size_t(bEnd-bPtr)>=layout.recordSize;bPtr+=layout.recordSize,--numLeft)
+			addVertex<PositionScalarParam>(bPtr,layout,swapEndianness,mesh);
+		
+		/* Save the beginning of a straddling record: */
+		if(bPtr!=bEnd)
+			{
+			partialSize=bEnd-bPtr;
+			memcpy(&partialRecord[0],bPtr,partialSize);
+			}
+		}
+	}
+
+template <class PLYFileParam>
+void readVertexElement(const PLYElement& element,PLYFileParam& ply,MyPolygonMesh& mesh) // Reads a vertex element through the generic PLY element interface
+	{
+	/* Get the indices of all relevant vertex value components: */
+	unsigned int posIndex[3];
+	posIndex[0]=element.getPropertyIndex("x");
+	posIndex[1]=element.getPropertyIndex("y");
+	posIndex[2]=element.getPropertyIndex("z");
+	
+	/* Read the vertex element: */
+	PLYElement::Value vertexValue(element);
+	for(size_t i=0;i<element.getNumValues();++i)
+		{
+		/* Read vertex element from file: */
+		vertexValue.read(ply);
+		
+		/* Extract vertex coordinates from vertex element: */
+		MyMeshVertex vertex;
+		for(int j=0;j<3;++j)
+			vertex.position[j]=MyMeshVertex::Scalar(vertexValue.getValue(posIndex[j]).getScalar()->getDouble());
+		
+		/* Add the vertex to the mesh: */
+		mesh.addVertex(vertex);
+		}
+	}
+
+void readVertexElement(const PLYElement& element,IO::File& ply,MyPolygonMesh& mesh) // Reads a vertex element from a binary PLY file, using a fixed record layout if possible
+	{
+	VertexLayout layout;
+	if(compileVertexLayout(element,layout))
+		{
+		if(layout.posType==PLY_FLOAT32)
+			readVertexRecords<Misc::Float32>(ply,layout,element.getNumValues(),mesh);
+		else
+			readVertexRecords<Misc::Float64>(ply,layout,element.getNumValues(),mesh);
+		}
+	else
+		readVertexElement<IO::File>(element,ply,mesh);
+	}
+
+struct FaceLayout // Structure describing the record layout of a face element in a binary PLY file
+	{
+	/* Elements: */
+	public:
+	size_t preSkip; // Number of bytes of scalar properties preceding the vertex index list
+	size_t postSkip; // Number of bytes of scalar properties following the vertex index list
+	PLYDataType listSizeType; // Data type of the vertex index list's size
+	PLYDataType indexType; // Data type of vertex indices
+	};
+
+bool compileFaceLayout(const PLYElement& element,FaceLayout& layout) // Compiles the given face element into a record layout; returns false if the element has additional list properties
+	{
+	bool haveIndices=false;
+	layout.preSkip=0;
+	layout.postSkip=0;
+	for(PLYElement::PropertyList::const_iterator pIt=element.propertiesBegin();pIt!=element.propertiesEnd();++pIt)
+		{
+		if(pIt->getName()=="vertex_indices"&&pIt->getPropertyType()==PLYProperty::LIST)
+			{
+			layout.listSizeType=pIt->getListSizeType();
+			layout.indexType=pIt->getListElementType();
+			haveIndices=true;
+			}
+		else if(pIt->getPropertyType()==PLYProperty::SCALAR)
+			(haveIndices?layout.postSkip:layout.preSkip)+=getPLYDataTypeSize(pIt->getScalarType());
+		else
+			return false;
+		}
+	
+	return haveIndices;
+	}
+
+template <class ListSizeParam,class IndexParam>
+void readFaceRecords(IO::File& ply,const FaceLayout& layout,size_t numFaces,MyPolygonMesh& mesh) // Reads face records with the given list size and vertex index types
+	{
+	for(size_t i=0;i<numFaces;++i)
+		{
+		if(layout.preSkip!=0)
+			ply.skip<char>(layout.preSkip);
+		
+		/* Read the face's vertex index list directly into the mesh: */
+		size_t numFaceVertices=size_t(ply.read<ListSizeParam>());
+		mesh.startFace();
+		for(size_t j=0;j<numFaceVertices;++j)
+			mesh.addFaceVertex(MyPolygonMesh::Card(ply.read<IndexParam>()));
+		mesh.finishFace();
+		
+		if(layout.postSkip!=0)
+			ply.skip<char>(layout.postSkip);
+		}
+	}
+
+template <class ListSizeParam>
+bool readFaceRecords(IO::File& ply,const FaceLayout& layout,size_t numFaces,MyPolygonMesh& mesh) // Dispatches on the vertex index type; returns false if the type is not supported
+	{
+	switch(layout.indexType)
+		{
+		case PLY_SINT32:
+			readFaceRecords<ListSizeParam,Misc::SInt32>(ply,layout,numFaces,mesh);
+			return true;
+		
+		case PLY_UINT32:
+			readFaceRecords<ListSizeParam,Misc::UInt32>(ply,layout,numFaces,mesh);
+			return true;
+		
+		case PLY_SINT16:
+			readFaceRecords<ListSizeParam,Misc::SInt16>(ply,layout,numFaces,mesh);
+			return true;
+		
+		case PLY_UINT16:
+			readFaceRecords<ListSizeParam,Misc::UInt16>(ply,layout,numFaces,mesh);
+			return true;
+		
+		default:
+			return false;
+		}
+	}
+
+template <class PLYFileParam>
+void readFaceElement(const PLYElement& element,PLYFileParam& ply,MyPolygonMesh& mesh) // Reads a face element through the generic PLY element interface
+	{
+	/* Read all face vertex indices in the mesh file: */
+	PLYElement::Value faceValue(element);
+	unsigned int vertexIndicesIndex=element.getPropertyIndex("vertex_indices");
+	for(size_t i=0;i<element.getNumValues();++i)
+		{
+		/* Read face element from file: */
+		faceValue.read(ply);
+		
+		/* Extract vertex indices from face element: */
+		unsigned int numFaceVertices=faceValue.getValue(vertexIndicesIndex).getListSize()->getUnsignedInt();
+		mesh.startFace();
+		for(unsigned int j=0;j<numFaceVertices;++j)
+			mesh.addFaceVertex(faceValue.getValue(vertexIndicesIndex).getListElement(j)->getUnsignedInt());
+		mesh.finishFace();
+		}
+	}
+
+void readFaceElement(const PLYElement& element,IO::File& ply,MyPolygonMesh& mesh) // Reads a face element from a binary PLY file, using a specialized loop for common layouts
+	{
+	FaceLayout layout;
+	if(compileFaceLayout(element,layout))
+		{
+		bool handled=false;
+		if(layout.listSizeType==PLY_UINT8)
+			handled=readFaceRecords<Misc::UInt8>(ply,layout,element.getNumValues(),mesh);
+		else if(layout.listSizeType==PLY_SINT8)
+			handled=readFaceRecords<Misc::SInt8>(ply,layout,element.getNumValues(),mesh);
+		if(handled)
+			return;
+		}
+	
+	readFaceElement<IO::File>(element,ply,mesh);
+	}
+
 template <class PLYFileParam>
 void readPlyFileElements(const PLYFileHeader& header,PLYFileParam& ply,MyTriangleSet& triangleSet)
 	{
@@ -47,48 +318,16 @@ void readPlyFileElements(const PLYFileHeader& header,PLYFileParam& ply,MyTriangl
 		/* Check if it's the vertex or face element: */
 		if(element.isElement("vertex"))
 			{
-			/* Get the indices of all relevant vertex value components: */
-			unsigned int posIndex[3];
-			posIndex[0]=element.getPropertyIndex("x");
-			posIndex[1]=element.getPropertyIndex("y");
-			posIndex[2]=element.getPropertyIndex("z");
-			
 			/* Read the vertex element: */
-			PLYElement::Value vertexValue(element);
-			for(size_t i=0;i<element.getNumValues();++i)
-				{
-				/* Read vertex element from file: */
-				vertexValue.read(ply);
-				
-				/* Extract vertex coordinates from vertex element: */
-				MyMeshVertex vertex;
-				for(int j=0;j<3;++j)
-					vertex.position[j]=MyMeshVertex::Scalar(vertexValue.getValue(posIndex[j]).getScalar()->getDouble());
-				
-				/* Add the vertex to the mesh: */
-				mesh.addVertex(vertex);
-				}
+			readVertexElement(element,ply,mesh);
 			}
 		else if(element.isElement("face"))
 			{
 			if(mesh.getNumVertices()==0)
 				Misc::throwStdErr("readPlyFile: Face element before vertex element");
 			
-			/* Read all face vertex indices in the mesh file: */
-			PLYElement::Value faceValue(element);
-			unsigned int vertexIndicesIndex=element.getPropertyIndex("vertex_indices");
-			for(size_t i=0;i<element.getNumValues();++i)
-				{
-				/* Read face element from file: */
-				faceValue.read(ply);
-				
-				/* Extract vertex indices from face element: */
-				unsigned int numFaceVertices=faceValue.getValue(vertexIndicesIndex).getListSize()->getUnsignedInt();
-				mesh.startFace();
-				for(unsigned int j=0;j<numFaceVertices;++j)
-					mesh.addFaceVertex(faceValue.getValue(vertexIndicesIndex).getListElement(j)->getUnsignedInt());
-				mesh.finishFace();
-				}
+			/* Read the face element: */
+			readFaceElement(element,ply,mesh);
 			}
 		else
 			{
@@ -1,7 +1,7 @@
 /***********************************************************************
 RenderBSPTree - Class to render triangle meshes efficiently using a BSP
 tree and and portals.
-Copyright (c) 2009 Oliver Kreylos
+Copyright (c) 2009-2014 Oliver Kreylos
 ***********************************************************************/
 
 #include "RenderBSPTree.h"
@@ -10,6 +10,7 @@ Copyright (c) 2009 Oliver Kreylos
 #include <iostream>
 
 #include <string.h>
+#include <unistd.h>
 #include <utility>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/File.h>
@@ -22,6 +23,7 @@ Copyright (c) 2009 Oliver Kreylos
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLGeometryWrappers.h>
 #include <GL/GLTransformationWrappers.h>
+#include <GL/GLFrustum.h>
 
 namespace {
 
@@ -68,6 +70,108 @@ splitPolygon(
 		}
 	}
 
+template <class ScalarParam>
+inline
+bool
+clipPolygon(
+	const Geometry::Plane<ScalarParam,3>& plane,
+	std::vector<Geometry::Point<ScalarParam,3> >& polygon)
+	{
+	/* Split the polygon and retain the part on the plane's front side: */
+	std::vector<Geometry::Point<ScalarParam,3> > parts[2];
+	splitPolygon(plane,polygon,parts);
+	std::swap(polygon,parts[1]);
+	
+	/* Check if anything remains of the polygon: */
+	if(polygon.size()<3)
+		{
+		polygon.clear();
+		return false;
+		}
+	else
+		return true;
+	}
+
+template <class ScalarParam>
+inline
+bool
+clipToSeparators(
+	const std::vector<Geometry::Point<ScalarParam,3> >& source,
+	const std::vector<Geometry::Point<ScalarParam,3> >& pass,
+	bool flipClip,
+	ScalarParam epsilon,
+	std::vector<Geometry::Point<ScalarParam,3> >& target)
+	{
+	typedef ScalarParam Scalar;
+	typedef Geometry::Vector<Scalar,3> Vector;
+	typedef Geometry::Plane<Scalar,3> Plane;
+	
+	/* Test all planes through an edge of the source polygon and a vertex of the pass polygon: */
+	size_t numSource=source.size();
+	size_t numPass=pass.size();
+	for(size_t i=0;i<numSource;++i)
+		{
+		size_t l=(i+1)%numSource;
+		Vector v1=source[l]-source[i];
+		for(size_t j=0;j<numPass;++j)
+			{
+			/* Calculate the candidate plane: */
+			Vector normal=Geometry::cross(v1,pass[j]-source[i]);
+			Scalar normalLen=Geometry::mag(normal);
+			if(normalLen<=epsilon*epsilon)
+				continue;
+			Plane plane(normal/normalLen,pass[j]);
+			
+			/* Orient the plane such that the source polygon is on its back side: */
+			size_t k;
+			bool flip=false;
+			for(k=0;k<numSource;++k)
+				{
+				if(k==i||k==l)
+					continue;
+				Scalar d=plane.calcDistance(source[k]);
+				if(d<-epsilon)
+					break;
+				else if(d>epsilon)
+					{
+					flip=true;
+					break;
+					}
+				}
+			if(k==numSource)
+				{
+				/* The plane contains the source polygon: */
+				continue;
+				}
+			if(flip)
+				plane=Plane(-plane.getNormal(),-plane.getOffset());
+			
+			/* The plane separates the polygons if the pass polygon is entirely on its front side: */
+			size_t numFront=0;
+			for(k=0;k<numPass;++k)
+				{
+				if(k==j)
+					continue;
+				Scalar d=plane.calcDistance(pass[k]);
+				if(d<-epsilon)
+					break;
+				else if(d>epsilon)
+					++numFront;
+				}
+			if(k!=numPass||numFront==0)
+				continue;
+			
+			/* Clip the target polygon to the side of the separating plane through which it can be seen: */
+			if(flipClip)
+				plane=Plane(-plane.getNormal(),-plane.getOffset());
+			if(!clipPolygon(plane,target))
+				return false;
+			}
+		}
+	
+	return true;
+	}
+
 template <class ScalarParam>
 inline
 Geometry::HVector<ScalarParam,3>
@@ -645,6 +749,12 @@ void RenderBSPTree::finalizeNode(RenderBSPTree::Node& node)
 			std::swap(leaf.subMeshes,newSubMeshes);
 			}
 		
+		/* Calculate the bounding box of the leaf's triangles: */
+		leaf.box=Box::empty;
+		for(CardList::const_iterator tiIt=leaf.triangleIndices.begin();tiIt!=leaf.triangleIndices.end();++tiIt)
+			for(int i=0;i<3;++i)
+				leaf.box.addPoint(vertices[*tiIt+i].position);
+		
 		/* Set the starting vertex indices of all submeshes: */
 		for(Leaf::SubMeshList::iterator smIt=leaf.subMeshes.begin();smIt!=leaf.subMeshes.end();++smIt)
 			{
@@ -698,6 +808,75 @@ void RenderBSPTree::uploadNodeTriangles(const RenderBSPTree::Node& node,RenderBS
 		}
 	}
 
+void RenderBSPTree::flowPVS(RenderBSPTree::Card leafIndex,const RenderBSPTree::Polygon& source,const RenderBSPTree::Plane& sourcePlane,const RenderBSPTree::Polygon* pass,RenderBSPTree::Scalar epsilon,std::vector<bool>& visibleLeaves,std::vector<bool>& pathLeaves) const
+	{
+	/* Mark the leaf as visible and as part of the current portal sequence: */
+	visibleLeaves[leafIndex]=true;
+	pathLeaves[leafIndex]=true;
+	
+	/* Check all portals leading out of the leaf: */
+	const Leaf& leaf=leaves[leafIndex];
+	for(std::vector<Leaf::Portal>::const_iterator pIt=leaf.portals.begin();pIt!=leaf.portals.end();++pIt)
+		{
+		/* Don't loop back into the current portal sequence: */
+		if(pathLeaves[pIt->otherLeafIndex])
+			continue;
+		
+		/* Retain the part of the portal that is strictly beyond the source portal: */
+		Polygon target=pIt->portal;
+		if(!clipPolygon(sourcePlane,target))
+			continue;
+		Scalar maxDist=Scalar(0);
+		for(Polygon::const_iterator tIt=target.begin();tIt!=target.end();++tIt)
+			{
+			Scalar d=sourcePlane.calcDistance(*tIt);
+			if(maxDist<d)
+				maxDist=d;
+			}
+		if(maxDist<=epsilon)
+			continue;
+		
+		/* Retain the part of the portal that can be seen from the source portal through the pass portal: */
+		if(pass!=0)
+			{
+			if(!clipToSeparators(source,*pass,false,epsilon,target))
+				continue;
+			if(!clipToSeparators(*pass,source,true,epsilon,target))
+				continue;
+			}
+		
+		/* Continue the portal sequence through the clipped portal: */
+		flowPVS(pIt->otherLeafIndex,source,sourcePlane,&target,epsilon,visibleLeaves,pathLeaves);
+		}
+	
+	pathLeaves[leafIndex]=false;
+	}
+
+void RenderBSPTree::renderLeafTriangles(const RenderBSPTree::Leaf& leaf,GLContextData& contextData,Material*& currentMaterial) const
+	{
+	// DEBUGGING
+	++numRenderedNodes;
+	
+	for(Leaf::SubMeshList::const_iterator smIt=leaf.subMeshes.begin();smIt!=leaf.subMeshes.end();++smIt)
+		{
+		/* Install the submesh's material: */
+		if(smIt->material!=currentMaterial)
+			{
+			if(currentMaterial!=0)
+				currentMaterial->reset(contextData);
+			currentMaterial=smIt->material.getPointer();
+			if(currentMaterial!=0)
+				currentMaterial->set(contextData);
+			}
+		
+		/* Render the submesh's triangles: */
+		glDrawArrays(GL_TRIANGLES,smIt->firstVertexIndex,smIt->numTriangles*3);
+		
+		// DEBUGGING
+		numRenderedTriangles+=smIt->numTriangles;
+		}
+	}
+
 void RenderBSPTree::renderLeaf(RenderBSPTree::Card leafIndex,const RenderBSPTree::Point& traversalStart,const RenderBSPTree::PTransform& pmv,const RenderBSPTree::ScreenBox& viewport,bool renderedLeaves[],GLContextData& contextData,Material*& currentMaterial) const
 	{
 	/* Get the leaf structure: */
@@ -705,29 +884,8 @@ void RenderBSPTree::renderLeaf(RenderBSPTree::Card leafIndex,const RenderBSPTree
 	
 	if(!renderedLeaves[leafIndex])
 		{
-		// DEBUGGING
-		++numRenderedNodes;
-		
 		/* Render the leaf's triangles: */
-		for(Leaf::SubMeshList::const_iterator smIt=leaf.subMeshes.begin();smIt!=leaf.subMeshes.end();++smIt)
-			{
-			/* Install the submesh's material: */
-			if(smIt->material!=currentMaterial)
-				{
-				if(currentMaterial!=0)
-					currentMaterial->reset(contextData);
-				currentMaterial=smIt->material.getPointer();
-				if(currentMaterial!=0)
-					currentMaterial->set(contextData);
-				}
-			
-			/* Render the submesh's triangles: */
-			glDrawArrays(GL_TRIANGLES,smIt->firstVertexIndex,smIt->numTriangles*3);
-			
-			// DEBUGGING
-			numRenderedTriangles+=smIt->numTriangles;
-			}
-		
+		renderLeafTriangles(leaf,contextData,currentMaterial);
 		renderedLeaves[leafIndex]=true;
 		}
 	
@@ -797,7 +955,8 @@ void RenderBSPTree::renderLeaf(RenderBSPTree::Card leafIndex,const RenderBSPTree
 	}
 
 RenderBSPTree::RenderBSPTree(const RenderBSPTree::VertexList& sVertices)
-	:vertices(sVertices)
+	:vertices(sVertices),
+	 treeDataSize(0),havePVS(false)
 	{
 	}
 
@@ -844,6 +1003,7 @@ void RenderBSPTree::loadTree(const char* bspTreeFileName)
 		root.portals.clear();
 		}
 	leaves.clear();
+	havePVS=false;
 	
 	// DEBUGGING
 	numAddedTriangles=0;
@@ -857,6 +1017,39 @@ void RenderBSPTree::loadTree(const char* bspTreeFileName)
 		/* Create the portal polygons connecting all leaf nodes: */
 		createPortals(root);
 		}
+	treeDataSize=file.tell();
+	
+	/* Check if the file contains potentially visible sets: */
+	int nextChar=file.getc();
+	if(nextChar!=EOF)
+		{
+		file.ungetc(nextChar);
+		
+		/* Read the potentially visible sets' header: */
+		static const char* pvsHeader="BSP Tree PVS V1.0";
+		file.read(header,strlen(pvsHeader)+1);
+		if(strcmp(pvsHeader,header)!=0)
+			Misc::throwStdErr("RenderBSPTree::loadTree: File %s contains unrecognized data after the BSP tree",bspTreeFileName);
+		if(file.read<unsigned int>()!=leaves.size())
+			Misc::throwStdErr("RenderBSPTree::loadTree: Potentially visible sets in file %s do not match the BSP tree",bspTreeFileName);
+		
+		/* Read each leaf's potentially visible set: */
+		for(std::vector<Leaf>::iterator lIt=leaves.begin();lIt!=leaves.end();++lIt)
+			{
+			unsigned int numVisibleLeaves=file.read<unsigned int>();
+			if(numVisibleLeaves>leaves.size())
+				Misc::throwStdErr("RenderBSPTree::loadTree: Corrupted potentially visible sets in file %s",bspTreeFileName);
+			lIt->visibleLeaves.resize(numVisibleLeaves);
+			if(!lIt->visibleLeaves.empty())
+				file.read<Card>(&lIt->visibleLeaves[0],lIt->visibleLeaves.size());
+			
+			/* Check that all leaf indices are valid to guard against corrupted files: */
+			for(CardList::const_iterator vlIt=lIt->visibleLeaves.begin();vlIt!=lIt->visibleLeaves.end();++vlIt)
+				if(*vlIt>=leaves.size())
+					Misc::throwStdErr("RenderBSPTree::loadTree: Corrupted potentially visible sets in file %s",bspTreeFileName);
+			}
+		havePVS=true;
+		}
 	
 	// DEBUGGING
 	size_t totalNumPortals=0;
@@ -865,6 +1058,76 @@ void RenderBSPTree::loadTree(const char* bspTreeFileName)
 	std::cout<<"BSP tree contains "<<leaves.size()<<" leaves and "<<totalNumPortals<<" portal polygons"<<std::endl;
 	}
 
+void RenderBSPTree::computePVS(void)
+	{
+	/* Calculate a clipping tolerance from the extent of all portal polygons: */
+	Box portalBox=Box::empty;
+	for(std::vector<Leaf>::const_iterator lIt=leaves.begin();lIt!=leaves.end();++lIt)
+		for(std::vector<Leaf::Portal>::const_iterator pIt=lIt->portals.begin();pIt!=lIt->portals.end();++pIt)
+			for(Polygon::const_iterator vIt=pIt->portal.begin();vIt!=pIt->portal.end();++vIt)
+				portalBox.addPoint(*vIt);
+	Scalar epsilon=portalBox.isNull()?Scalar(0):Geometry::dist(portalBox.min,portalBox.max)*Scalar(1.0e-5);
+	
+	/* Calculate the potentially visible set of each leaf: */
+	Card numLeaves=leaves.size();
+	std::vector<bool> visibleLeaves(numLeaves);
+	std::vector<bool> pathLeaves(numLeaves);
+	size_t totalNumVisibleLeaves=0;
+	for(Card leafIndex=0;leafIndex<numLeaves;++leafIndex)
+		{
+		Leaf& leaf=leaves[leafIndex];
+		
+		/* Flow through all portal sequences starting at each of the leaf's portals: */
+		visibleLeaves.assign(numLeaves,false);
+		visibleLeaves[leafIndex]=true;
+		for(std::vector<Leaf::Portal>::const_iterator pIt=leaf.portals.begin();pIt!=leaf.portals.end();++pIt)
+			{
+			pathLeaves.assign(numLeaves,false);
+			pathLeaves[leafIndex]=true;
+			flowPVS(pIt->otherLeafIndex,pIt->portal,pIt->plane,0,epsilon,visibleLeaves,pathLeaves);
+			}
+		
+		/* Store the potentially visible set: */
+		leaf.visibleLeaves.clear();
+		for(Card i=0;i<numLeaves;++i)
+			if(visibleLeaves[i])
+				leaf.visibleLeaves.push_back(i);
+		totalNumVisibleLeaves+=leaf.visibleLeaves.size();
+		}
+	havePVS=true;
+	
+	// DEBUGGING
+	std::cout<<"Potentially visible sets contain "<<double(totalNumVisibleLeaves)/double(numLeaves>0?numLeaves:1)<<" leaves on average"<<std::endl;
+	}
+
+void RenderBSPTree::savePVS(const char* bspTreeFileName) const
+	{
+	if(!havePVS)
+		Misc::throwStdErr("RenderBSPTree::savePVS: BSP tree has no potentially visible sets");
+	
+	/* Open the BSP tree file and replace everything after the BSP tree structure: */
+	Misc::File file(bspTreeFileName,"r+b",Misc::File::LittleEndian);
+	file.seekSet(treeDataSize);
+	
+	/* Write the potentially visible sets' header: */
+	static const char* pvsHeader="BSP Tree PVS V1.0";
+	file.writeRaw(pvsHeader,strlen(pvsHeader)+1);
+	file.write<unsigned int>(leaves.size());
+	
+	/* Write each leaf's potentially visible set: */
+	for(std::vector<Leaf>::const_iterator lIt=leaves.begin();lIt!=leaves.end();++lIt)
+		{
+		file.write<unsigned int>(lIt->visibleLeaves.size());
+		if(!lIt->visibleLeaves.empty())
+			file.write<Card>(&lIt->visibleLeaves[0],lIt->visibleLeaves.size());
+		}
+	
+	/* Cut off any previously stored data: */
+	fflush(file.getFilePtr());
+	if(ftruncate(fileno(file.getFilePtr()),file.tell())!=0)
+		Misc::throwStdErr("RenderBSPTree::savePVS: Unable to truncate file %s",bspTreeFileName);
+	}
+
 void RenderBSPTree::addTriangles(const RenderBSPTree::CardList& triangleIndices,Material* material)
 	{
 	// DEBUGGING
@@ -920,9 +1183,6 @@ void RenderBSPTree::glRenderAction(GLContextData& contextData) const
 	while(startNode->children!=0)
 		startNode=&startNode->children[startNode->plane.calcDistance(traversalStart)>=Scalar(0)?1:0];
 	
-	/* Create the initial viewport: */
-	ScreenBox viewport(ScreenBox::Point(-1,-1),ScreenBox::Point(1,1));
-	
 	// DEBUGGING
 	//glPushAttrib(GL_LINE_BIT|GL_POLYGON_BIT);
 	//glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
@@ -935,16 +1195,37 @@ void RenderBSPTree::glRenderAction(GLContextData& contextData) const
 	/* Keep track of the current material to minimize OpenGL state changes: */
 	Material* currentMaterial=0;
 	
-	/* Create a map of already rendered leaves: */
-	unsigned int numLeaves=leaves.size();
-	bool* renderedLeaves=new bool[numLeaves];
-	for(unsigned int i=0;i<numLeaves;++i)
-		renderedLeaves[i]=false;
-	
-	/* Render the traversal start node: */
-	renderLeaf(startNode->leafIndex,traversalStart,pmv,viewport,renderedLeaves,contextData,currentMaterial);
-	
-	delete[] renderedLeaves;
+	if(havePVS)
+		{
+		/* Get the view frustum in model coordinates: */
+		GLFrustum<Scalar> frustum;
+		frustum.setFromGL();
+		
+		/* Render all leaves in the start node's potentially visible set that intersect the view frustum: */
+		const CardList& pvs=leaves[startNode->leafIndex].visibleLeaves;
+		for(CardList::const_iterator pvsIt=pvs.begin();pvsIt!=pvs.end();++pvsIt)
+			{
+			const Leaf& leaf=leaves[*pvsIt];
+			if(!leaf.box.isNull()&&frustum.doesBoxIntersect(leaf.box))
+				renderLeafTriangles(leaf,contextData,currentMaterial);
+			}
+		}
+	else
+		{
+		/* Create the initial viewport: */
+		ScreenBox viewport(ScreenBox::Point(-1,-1),ScreenBox::Point(1,1));
+		
+		/* Create a map of already rendered leaves: */
+		unsigned int numLeaves=leaves.size();
+		bool* renderedLeaves=new bool[numLeaves];
+		for(unsigned int i=0;i<numLeaves;++i)
+			renderedLeaves[i]=false;
+		
+		/* Traverse the portal graph starting from the traversal start node: */
+		renderLeaf(startNode->leafIndex,traversalStart,pmv,viewport,renderedLeaves,contextData,currentMaterial);
+		
+		delete[] renderedLeaves;
+		}
 	
 	/* Uninstall the last used material: */
 	if(currentMaterial!=0)
@@ -1,7 +1,7 @@
 /***********************************************************************
 RenderBSPTree - Class to render triangle meshes efficiently using a BSP
 tree and and portals.
-Copyright (c) 2009 Oliver Kreylos
+Copyright (c) 2009-2014 Oliver Kreylos
 ***********************************************************************/
 
 #ifndef RENDERBSPTREE_INCLUDED
@@ -103,6 +103,8 @@ class RenderBSPTree:public GLObject
 		CardList triangleIndices; // List of indices of contained triangles
 		SubMeshList subMeshes; // List of submeshes
 		std::vector<Portal> portals; // List of portals connecting to other leaf nodes
+		Box box; // Bounding box of the leaf's triangles
+		CardList visibleLeaves; // Potentially visible set; indices of all leaves that might be visible from anywhere inside this leaf
 		};
 	
 	struct DataItem:public GLObject::DataItem
@@ -122,6 +124,8 @@ class RenderBSPTree:public GLObject
 	Node root; // Root node of BSP tree
 	Card totalNumVertices; // Total number of vertices in the BSP tree nodes
 	std::vector<Leaf> leaves; // List of BSP tree leaf nodes
+	long treeDataSize; // Size of the BSP tree structure in the BSP tree file, where the potentially visible sets are stored
+	bool havePVS; // Flag whether the leaves' potentially visible sets are valid
 	
 	// DEBUGGING
 	Card numAddedTriangles;
@@ -136,6 +140,8 @@ class RenderBSPTree:public GLObject
 	void addNodeTriangles(Node& node,const CardList& triangleIndices,const TriangleFragmentList& triangleFragments,Material* material);
 	void finalizeNode(Node& node);
 	void uploadNodeTriangles(const Node& node,Scalar* vertexBuffer) const;
+	void flowPVS(Card leafIndex,const Polygon& source,const Plane& sourcePlane,const Polygon* pass,Scalar epsilon,std::vector<bool>& visibleLeaves,std::vector<bool>& pathLeaves) const;
+	void renderLeafTriangles(const Leaf& leaf,GLContextData& contextData,Material*& currentMaterial) const;
 	void renderLeaf(Card leafIndex,const Point& traversalStart,const PTransform& pmv,const ScreenBox& viewport,bool renderedLeaves[],GLContextData& contextData,Material*& currentMaterial) const;
 	
 	/* Constructors and destructors: */
@@ -149,6 +155,12 @@ class RenderBSPTree:public GLObject
 	void loadTree(const char* bspTreeFileName); // Loads the BSP tree's structure from the given file
 	void addTriangles(const CardList& triangleIndices,Material* material); // Adds the given set of triangles to the BSP tree
 	void finalizeTree(void); // Finalizes the BSP tree after all triangles have been added
+	void computePVS(void); // Computes conservative potentially visible sets for all leaves from the portal graph
+	void savePVS(const char* bspTreeFileName) const; // Stores the potentially visible sets in the given BSP tree file, which must be the file from which the tree was loaded
+	bool hasPVS(void) const // Returns true if the leaves' potentially visible sets are valid
+		{
+		return havePVS;
+		}
 	
 	void glRenderAction(GLContextData& contextData) const; // Renders the BSP tree in the given view frustum
 	};
@@ -7,7 +7,9 @@ Copyright (c) 2007-2009 Oliver Kreylos
 #include "Texture.h"
 
 #include <string.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/ThrowStdErr.h>
+#include <IO/File.h>
 #include <GL/gl.h>
 #include <GL/GLExtensionManager.h>
 #include <GL/Extensions/GLARBTextureCompression.h>
@@ -15,6 +17,33 @@ Copyright (c) 2007-2009 Oliver Kreylos
 #include <GL/Extensions/GLEXTTextureCompressionS3TC.h>
 #include <GL/Extensions/GLEXTTextureCubeMap.h>
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline unsigned int packRGB565(const unsigned int color[3]) // Packs an RGB color into 5-6-5 bit format
+	{
+	return ((color[0]>>3)<<11)|((color[1]>>2)<<5)|(color[2]>>3);
+	}
+
+inline void unpackRGB565(unsigned int packed,unsigned int color[3]) // Expands a 5-6-5 bit color to 8 bits per component
+	{
+	unsigned int r=(packed>>11)&0x1fU;
+	unsigned int g=(packed>>5)&0x3fU;
+	unsigned int b=packed&0x1fU;
+	color[0]=(r<<3)|(r>>2);
+	color[1]=(g<<2)|(g>>4);
+	color[2]=(b<<3)|(b>>2);
+	}
+
+/* Magic number and version of binary texture files: */
+const char textureFileMagic[8]={'M','V','T','E','X','T','U','R'};
+const Misc::UInt32 textureFileVersion=1U;
+
+}
+
 /************************
 Methods of class Texture:
 ************************/
@@ -30,6 +59,8 @@ bool Texture::initExtensions(void)
 	GLEXTTexture3D::initExtension();
 	GLEXTTextureCompressionS3TC::initExtension();
 	GLEXTTextureCubeMap::initExtension();
+	
+	return true;
 	}
 
 size_t Texture::calcImageSize(const Texture::Size& imageSize) const
@@ -73,6 +104,189 @@ size_t Texture::calcImageSize(const Texture::Size& imageSize) const
 	return result;
 	}
 
+size_t Texture::calcDataSize(void) const
+	{
+	/* Accumulate the byte sizes of all mipmap levels: */
+	size_t result=0;
+	Size levelSize=size;
+	for(unsigned int level=0;level<=maxMipMapLevel;++level)
+		{
+		result+=calcImageSize(levelSize)*levelSize[2];
+		
+		/* Go to the next mipmap level: */
+		int numDims=cubeMapFaces!=NO_CUBEMAP?2:3;
+		for(int i=0;i<numDims;++i)
+			levelSize[i]=(levelSize[i]+1U)>>1;
+		}
+	
+	return result;
+	}
+
+void Texture::compressBlock(const unsigned char block[16][4],bool alpha,unsigned char* blockData)
+	{
+	unsigned char* colorData=blockData;
+	if(alpha)
+		{
+		/* Find the block's alpha range: */
+		unsigned int aMin=255U;
+		unsigned int aMax=0U;
+		for(int i=0;i<16;++i)
+			{
+			if(aMin>block[i][3])
+				aMin=block[i][3];
+			if(aMax<block[i][3])
+				aMax=block[i][3];
+			}
+		
+		/* Create the eight-value alpha palette: */
+		unsigned int palette[8];
+		palette[0]=aMax;
+		palette[1]=aMin;
+		for(unsigned int i=1;i<7;++i)
+			palette[i+1]=((7U-i)*aMax+i*aMin+3U)/7U;
+		blockData[0]=(unsigned char)(aMax);
+		blockData[1]=(unsigned char)(aMin);
+		
+		/* Write the 3-bit alpha indices of all pixels: */
+		unsigned char* aPtr=blockData+2;
+		unsigned int bits=0U;
+		int numBits=0;
+		for(int i=0;i<16;++i)
+			{
+			/* Find the closest palette entry: */
+			unsigned int bestIndex=0U;
+			int bestDist=256;
+			for(unsigned int j=0;j<8;++j)
+				{
+				int dist=int(block[i][3])-int(palette[j]);
+				if(dist<0)
+					dist=-dist;
+				if(bestDist>dist)
+					{
+					bestIndex=j;
+					bestDist=dist;
+					}
+				}
+			
+			bits|=bestIndex<<numBits;
+			numBits+=3;
+			while(numBits>=8)
+				{
+				*(aPtr++)=(unsigned char)(bits&0xffU);
+				bits>>=8;
+				numBits-=8;
+				}
+			}
+		
+		colorData=blockData+8;
+		}
+	
+	/* Find the block's color bounding box: */
+	unsigned int cMin[3],cMax[3];
+	for(int j=0;j<3;++j)
+		{
+		cMin[j]=255U;
+		cMax[j]=0U;
+		}
+	for(int i=0;i<16;++i)
+		for(int j=0;j<3;++j)
+			{
+			if(cMin[j]>block[i][j])
+				cMin[j]=block[i][j];
+			if(cMax[j]<block[i][j])
+				cMax[j]=block[i][j];
+			}
+	
+	/* Inset the bounding box slightly to reduce the quantization error of the end points: */
+	for(int j=0;j<3;++j)
+		{
+		unsigned int inset=(cMax[j]-cMin[j])>>4;
+		cMin[j]+=inset;
+		cMax[j]-=inset;
+		}
+	
+	/* Flip the bounding box diagonal along red and blue if they are anti-correlated with green: */
+	int mean[3]={0,0,0};
+	for(int i=0;i<16;++i)
+		for(int j=0;j<3;++j)
+			mean[j]+=block[i][j];
+	int covRG=0,covBG=0;
+	for(int i=0;i<16;++i)
+		{
+		int dg=int(block[i][1])*16-mean[1];
+		covRG+=(int(block[i][0])*16-mean[0])*dg;
+		covBG+=(int(block[i][2])*16-mean[2])*dg;
+		}
+	if(covRG<0)
+		{
+		unsigned int t=cMin[0];
+		cMin[0]=cMax[0];
+		cMax[0]=t;
+		}
+	if(covBG<0)
+		{
+		unsigned int t=cMin[2];
+		cMin[2]=cMax[2];
+		cMax[2]=t;
+		}
+	
+	/* Pack the end points and order them to select four-color mode: */
+	unsigned int c0=packRGB565(cMax);
+	unsigned int c1=packRGB565(cMin);
+	if(c0<c1)
+		{
+		unsigned int t=c0;
+		c0=c1;
+		c1=t;
+		}
+	colorData[0]=(unsigned char)(c0&0xffU);
+	colorData[1]=(unsigned char)(c0>>8);
+	colorData[2]=(unsigned char)(c1&0xffU);
+	colorData[3]=(unsigned char)(c1>>8);
+	
+	/* Create the four-color palette from the quantized end points: */
+	unsigned int palette[4][3];
+	unpackRGB565(c0,palette[0]);
+	unpackRGB565(c1,palette[1]);
+	for(int j=0;j<3;++j)
+		{
+		palette[2][j]=(2U*palette[0][j]+palette[1][j]+1U)/3U;
+		palette[3][j]=(palette[0][j]+2U*palette[1][j]+1U)/3U;
+		}
+	
+	/* Write the 2-bit color indices of all pixels: */
+	for(int y=0;y<4;++y)
+		{
+		unsigned int rowBits=0U;
+		for(int x=0;x<4;++x)
+			{
+			/* Find the closest palette entry; all pixels use the first entry if the end points coincide: */
+			const unsigned char* pixel=block[y*4+x];
+			unsigned int bestIndex=0U;
+			if(c0!=c1)
+				{
+				int bestDist2=3*256*256;
+				for(unsigned int k=0;k<4;++k)
+					{
+					int dist2=0;
+					for(int j=0;j<3;++j)
+						{
+						int d=int(pixel[j])-int(palette[k][j]);
+						dist2+=d*d;
+						}
+					if(bestDist2>dist2)
+						{
+						bestIndex=k;
+						bestDist2=dist2;
+						}
+					}
+				}
+			rowBits|=bestIndex<<(x*2);
+			}
+		colorData[4+y]=(unsigned char)(rowBits);
+		}
+	}
+
 Texture::Texture(const Texture::Size& sSize,unsigned int sCubeMapFaces,Texture::StorageFormat sStorageFormat,unsigned int sMaxMipMapLevel)
 	:size(sSize),
 	 cubeMapFaces(sCubeMapFaces),
@@ -148,6 +362,144 @@ void Texture::setLevelData(unsigned int level,const void* levelData,size_t level
 	memcpy(lData,levelData,lDataSize);
 	}
 
+void Texture::generateMipMaps(void)
+	{
+	if(isCompressed()||size[2]!=1)
+		Misc::throwStdErr("Texture::generateMipMaps: Mipmaps can only be generated for uncompressed 2D textures");
+	
+	/* Calculate each mipmap level from the previous one: */
+	unsigned int pixelSize=storageFormat==RGBA?4U:3U;
+	Size sourceSize=size;
+	unsigned char* sourceData=data;
+	for(unsigned int level=1;level<=maxMipMapLevel;++level)
+		{
+		Size destSize((sourceSize[0]+1U)>>1,(sourceSize[1]+1U)>>1);
+		unsigned char* destData=sourceData+calcImageSize(sourceSize);
+		
+		/* Average 2x2 blocks of source pixels, replicating the last row or column of odd-sized levels: */
+		unsigned char* dPtr=destData;
+		for(GLsizei y=0;y<destSize[1];++y)
+			{
+			GLsizei y0=y*2;
+			GLsizei y1=y0+1<sourceSize[1]?y0+1:y0;
+			const unsigned char* row0=sourceData+size_t(y0)*size_t(sourceSize[0])*pixelSize;
+			const unsigned char* row1=sourceData+size_t(y1)*size_t(sourceSize[0])*pixelSize;
+			for(GLsizei x=0;x<destSize[0];++x)
+				{
+				size_t x0=size_t(x*2)*pixelSize;
+				size_t x1=x*2+1<sourceSize[0]?x0+pixelSize:x0;
+				for(unsigned int i=0;i<pixelSize;++i,++dPtr)
+					*dPtr=(unsigned char)((row0[x0+i]+row0[x1+i]+row1[x0+i]+row1[x1+i]+2U)>>2);
+				}
+			}
+		
+		/* Go to the next mipmap level: */
+		sourceSize=destSize;
+		sourceData=destData;
+		}
+	}
+
+Texture Texture::compress(void) const
+	{
+	if(isCompressed()||size[2]!=1)
+		Misc::throwStdErr("Texture::compress: Only uncompressed 2D textures can be compressed");
+	
+	/* Create the result texture: */
+	bool alpha=storageFormat==RGBA;
+	unsigned int pixelSize=alpha?4U:3U;
+	size_t blockSize=alpha?16U:8U;
+	Texture result(size,NO_CUBEMAP,alpha?DXT5:DXT1,maxMipMapLevel);
+	
+	/* Compress all mipmap levels: */
+	Size levelSize=size;
+	const unsigned char* sourceData=data;
+	unsigned char* destData=result.data;
+	for(unsigned int level=0;level<=maxMipMapLevel;++level)
+		{
+		/* Compress all 4x4 pixel blocks, replicating edge pixels to fill partial blocks: */
+		for(GLsizei by=0;by<levelSize[1];by+=4)
+			for(GLsizei bx=0;bx<levelSize[0];bx+=4)
+				{
+				unsigned char block[16][4];
+				for(GLsizei y=0;y<4;++y)
+					{
+					GLsizei sy=by+y<levelSize[1]?by+y:levelSize[1]-1;
+					for(GLsizei x=0;x<4;++x)
+						{
+						GLsizei sx=bx+x<levelSize[0]?bx+x:levelSize[0]-1;
+						const unsigned char* sPtr=sourceData+(size_t(sy)*size_t(levelSize[0])+size_t(sx))*pixelSize;
+						unsigned char* bPtr=block[y*4+x];
+						for(int i=0;i<3;++i)
+							bPtr[i]=sPtr[i];
+						bPtr[3]=alpha?sPtr[3]:255U;
+						}
+					}
+				compressBlock(block,alpha,destData);
+				destData+=blockSize;
+				}
+		
+		/* Go to the next mipmap level: */
+		sourceData+=calcImageSize(levelSize);
+		for(int i=0;i<2;++i)
+			levelSize[i]=(levelSize[i]+1U)>>1;
+		}
+	
+	return result;
+	}
+
+void Texture::write(IO::File& file) const
+	{
+	file.setEndianness(Misc::LittleEndian);
+	
+	/* Write the file header: */
+	file.write<char>(textureFileMagic,sizeof(textureFileMagic));
+	file.write<Misc::UInt32>(textureFileVersion);
+	
+	/* Write the texture layout: */
+	for(int i=0;i<3;++i)
+		file.write<Misc::UInt32>(size[i]);
+	file.write<Misc::UInt32>(cubeMapFaces);
+	file.write<Misc::UInt32>(storageFormat);
+	file.write<Misc::UInt32>(maxMipMapLevel);
+	
+	/* Write the texture image data: */
+	size_t dataSize=calcDataSize();
+	file.write<Misc::UInt64>(dataSize);
+	file.writeRaw(data,dataSize);
+	}
+
+Texture Texture::read(IO::File& file)
+	{
+	file.setEndianness(Misc::LittleEndian);
+	
+	/* Check the file header: */
+	char magic[sizeof(textureFileMagic)];
+	file.read<char>(magic,sizeof(textureFileMagic));
+	if(memcmp(magic,textureFileMagic,sizeof(textureFileMagic))!=0)
+		Misc::throwStdErr("Texture::read: File is not a texture file");
+	if(file.read<Misc::UInt32>()!=textureFileVersion)
+		Misc::throwStdErr("Texture::read: Unsupported texture file version");
+	
+	/* Read the texture layout: */
+	Size fileSize;
+	for(int i=0;i<3;++i)
+		fileSize[i]=GLsizei(file.read<Misc::UInt32>());
+	unsigned int fileCubeMapFaces=file.read<Misc::UInt32>();
+	unsigned int fileStorageFormat=file.read<Misc::UInt32>();
+	if(fileStorageFormat>RXGB)
+		Misc::throwStdErr("Texture::read: Invalid storage format %u",fileStorageFormat);
+	unsigned int fileMaxMipMapLevel=file.read<Misc::UInt32>();
+	
+	/* Create the result texture and read its image data: */
+	Texture result(fileSize,fileCubeMapFaces,StorageFormat(fileStorageFormat),fileMaxMipMapLevel);
+	size_t dataSize=size_t(file.read<Misc::UInt64>());
+	if(dataSize!=result.calcDataSize()||result.maxMipMapLevel!=fileMaxMipMapLevel)
+		Misc::throwStdErr("Texture::read: Mismatching texture image data size");
+	file.readRaw(result.data,dataSize);
+	
+	return result;
+	}
+
 GLenum Texture::glGetTextureTarget(void) const
 	{
 	/* Determine the proper texture target: */
@@ -176,8 +528,8 @@ void Texture::glTexImage(void) const
 	/* Determine the proper texture data formats: */
 	GLenum internalFormat;
 	bool compressed;
-	GLenum externalFormat;
-	GLenum dataType;
+	GLenum externalFormat=GL_RGB;
+	GLenum dataType=GL_UNSIGNED_BYTE;
 	switch(storageFormat)
 		{
 		case RGB:
@@ -195,15 +547,31 @@ void Texture::glTexImage(void) const
 			break;
 		
 		case DXT1:
+			internalFormat=GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			compressed=true;
+			break;
+		
 		case DXT2:
 		case DXT3:
+			internalFormat=GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+			compressed=true;
+			break;
+		
 		case DXT4:
 		case DXT5:
 		case RXGB:
-			internalFormat=GL_RGB8;
+			internalFormat=GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 			compressed=true;
-			externalFormat=GL_RGB;
-			dataType=GL_UNSIGNED_BYTE;
+			break;
+		}
+	
+	if(compressed)
+		{
+		/* Initialize the extensions required to upload compressed textures: */
+		if(!GLARBTextureCompression::isSupported()||!GLEXTTextureCompressionS3TC::isSupported())
+			Misc::throwStdErr("Texture::glTexImage: S3TC texture compression not supported by local OpenGL");
+		GLARBTextureCompression::initExtension();
+		GLEXTTextureCompressionS3TC::initExtension();
 		}
 	
 	/* Prepare the current texture object for the correct number of mipmap levels: */
@@ -228,12 +596,18 @@ void Texture::glTexImage(void) const
 		size_t sliceSize=calcImageSize(levelSize);
 		if(size[2]==1U)
 			{
-			glTexImage2D(GL_TEXTURE_2D,level,internalFormat,levelSize[0],levelSize[1],0,externalFormat,dataType,levelData);
+			if(compressed)
+				glCompressedTexImage2DARB(GL_TEXTURE_2D,level,internalFormat,levelSize[0],levelSize[1],0,sliceSize,levelData);
+			else
+				glTexImage2D(GL_TEXTURE_2D,level,internalFormat,levelSize[0],levelSize[1],0,externalFormat,dataType,levelData);
 			levelData+=sliceSize;
 			}
 		else if(cubeMapFaces==NO_CUBEMAP)
 			{
-			glTexImage3DEXT(GL_TEXTURE_3D_EXT,level,internalFormat,levelSize[0],levelSize[1],levelSize[2],0,externalFormat,dataType,levelData);
+			if(compressed)
+				glCompressedTexImage3DARB(GL_TEXTURE_3D_EXT,level,internalFormat,levelSize[0],levelSize[1],levelSize[2],0,sliceSize*levelSize[2],levelData);
+			else
+				glTexImage3DEXT(GL_TEXTURE_3D_EXT,level,internalFormat,levelSize[0],levelSize[1],levelSize[2],0,externalFormat,dataType,levelData);
 			levelData+=sliceSize*levelSize[2];
 			}
 		else
@@ -242,7 +616,10 @@ void Texture::glTexImage(void) const
 				{
 				if(cubeMapFaces&(0x1U<<i))
 					{
-					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X_EXT+i,level,internalFormat,levelSize[0],levelSize[1],0,externalFormat,dataType,levelData);
+					if(compressed)
+						glCompressedTexImage2DARB(GL_TEXTURE_CUBE_MAP_POSITIVE_X_EXT+i,level,internalFormat,levelSize[0],levelSize[1],0,sliceSize,levelData);
+					else
+						glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X_EXT+i,level,internalFormat,levelSize[0],levelSize[1],0,externalFormat,dataType,levelData);
 					levelData+=sliceSize;
 					}
 				}
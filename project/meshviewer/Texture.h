@@ -7,8 +7,14 @@ Copyright (c) 2007-2009 Oliver Kreylos
 #ifndef TEXTURE_INCLUDED
 #define TEXTURE_INCLUDED
 
+#include <stddef.h>
 #include <GL/gl.h>
 
+/* Forward declarations: */
+namespace IO {
+class File;
+}
+
 class Texture
 	{
 	/* Embedded classes: */
@@ -135,6 +141,8 @@ class Texture
 		data=newData;
 		}
 	size_t calcImageSize(const Size& imageSize) const; // Calculates byte size of a slice or cube map face of the given image using the current storage format
+	size_t calcDataSize(void) const; // Calculates total byte size of the texture's image data for all mipmap levels
+	static void compressBlock(const unsigned char block[16][4],bool alpha,unsigned char* blockData); // Compresses a 4x4 block of RGBA pixels into a DXT1 or, if alpha is true, DXT5 block
 	
 	/* Constructors and destructors: */
 	public:
@@ -208,7 +216,19 @@ class Texture
 		{
 		return maxMipMapLevel;
 		}
+	bool isCompressed(void) const // Returns true if the texture is stored in a compressed format
+		{
+		return storageFormat!=RGB&&storageFormat!=RGBA;
+		}
+	size_t getDataSize(void) const // Returns the total byte size of the texture's image data
+		{
+		return calcDataSize();
+		}
 	void setLevelData(unsigned int level,const void* levelData,size_t levelDataSize); // Uploads raw image data for the given mipmap level into the texture
+	void generateMipMaps(void); // Calculates all mipmap levels of an uncompressed 2D texture from its base level using a box filter
+	Texture compress(void) const; // Returns a copy of an uncompressed 2D texture, including all mipmap levels, compressed to DXT1 for RGB or DXT5 for RGBA textures
+	void write(IO::File& file) const; // Writes the texture to a binary file
+	static Texture read(IO::File& file); // Reads a texture from a binary file
 	GLenum glGetTextureTarget(void) const; // Returns the OpenGL texture target used by this texture
 	void glTexImage(void) const; // Uploads the texture to OpenGL, using an appropriate texture target and internal format
 	};
@@ -79,7 +79,7 @@ void TextureMaterial::initContext(GLContextData& contextData) const
 	glTexParameteri(textureTarget,GL_TEXTURE_WRAP_S,wrapS);
 	glTexParameteri(textureTarget,GL_TEXTURE_WRAP_T,wrapT);
 	glTexParameteri(textureTarget,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-	glTexParameteri(textureTarget,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+	glTexParameteri(textureTarget,GL_TEXTURE_MIN_FILTER,map.getMaxMipMapLevel()>0?GL_LINEAR_MIPMAP_LINEAR:GL_LINEAR);
 	
 	#if 0
 	int width=314;